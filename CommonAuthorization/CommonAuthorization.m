@@ -154,12 +154,16 @@ static NSString * kKeyAuthRightDesc    = @"authRightDescription";
 		@{
 		  NSStringFromSelector(@selector(stopHelperWithAuthorization:withReply:)): dictStop,
 		  NSStringFromSelector(@selector(importPools:authorization:withReply:)): dictImport,
+		  NSStringFromSelector(@selector(importPoolBatch:authorization:withReply:)): dictImport,
 		  NSStringFromSelector(@selector(importablePools:authorization:withReply:)): dictImport,
+		  NSStringFromSelector(@selector(readPoolLabel:authorization:withReply:)): dictImport,
 		  NSStringFromSelector(@selector(exportPools:authorization:withReply:)): dictExport,
 		  NSStringFromSelector(@selector(mountFilesystems:authorization:withReply:)): dictMount,
 		  NSStringFromSelector(@selector(unmountFilesystems:authorization:withReply:)): dictUnmount,
 		  NSStringFromSelector(@selector(snapshotFilesystem:authorization:withReply:)):
 			  dictSnapshot,
+		  NSStringFromSelector(@selector(snapshotFilesystems:authorization:withReply:)):
+			  dictSnapshot,
 		  NSStringFromSelector(@selector(rollbackFilesystem:authorization:withReply:)):
 			  dictRollback,
 		  NSStringFromSelector(@selector(cloneSnapshot:authorization:withReply:)):
@@ -170,6 +174,8 @@ static NSString * kKeyAuthRightDesc    = @"authRightDescription";
 			  dictCreate,
 		  NSStringFromSelector(@selector(destroy:authorization:withReply:)):
 			  dictDestroy,
+		  NSStringFromSelector(@selector(destroySnapshots:authorization:withReply:)):
+			  dictDestroy,
 		  NSStringFromSelector(@selector(loadKeyForFilesystem:authorization:withReply:)): dictKey,
 		  NSStringFromSelector(@selector(unloadKeyForFilesystem:authorization:withReply:)): dictKey,
 		  NSStringFromSelector(@selector(scrubPool:authorization:withReply:)): dictScrub,
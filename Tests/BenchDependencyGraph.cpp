@@ -0,0 +1,38 @@
+//
+//  BenchDependencyGraph.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "ZetaCloneChainFixture.hpp"
+
+#include "ZetaDependencyGraph.hpp"
+
+using namespace zeta;
+
+ZETA_BENCH(benchCloneChain)
+{
+	size_t depth = bench::scaled(2000, scale);
+	auto fileSystems = fixture::cloneChain(depth, 50);
+	auto label = std::to_string(depth) + " deep clone chain";
+	DependencyGraph graph;
+	bench::measure("build graph, " + label, bench::scaled(10, scale), [&]
+	{
+		graph = DependencyGraph();
+		addFileSystems(graph, fileSystems, fixture::createTXG);
+		bench::consume(graph.names().size());
+	});
+	auto root = graph.find("pool/c0");
+	auto firstSnapshot = graph.find("pool/c0@s0");
+	bench::measure("rollback clones, " + label, bench::scaled(100, scale), [&]
+	{
+		bench::consume(graph.rollbackClones(firstSnapshot).size());
+	});
+	bench::measure("destroy dependents, " + label, bench::scaled(100, scale), [&]
+	{
+		bench::consume(graph.destroyDependents(root).size());
+	});
+}
@@ -0,0 +1,76 @@
+//
+//  BenchDeviceScan.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "ZetaDeviceFixture.hpp"
+
+#include "ZetaDeviceScan.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace zeta;
+
+//! Reads all four labels of every device, like the label scan of libzfs
+static size_t readAllLabels(fixture::DeviceDirectory const & dir)
+{
+	size_t const labelSize = 256 * 1024;
+	int64_t const size = fixture::DeviceDirectory::fileSize;
+	int64_t const offsets[] = { 0, int64_t(labelSize), size - 2 * int64_t(labelSize), size - int64_t(labelSize) };
+	std::vector<char> buffer(labelSize);
+	size_t read = 0;
+	for (size_t i = 0; i < dir.count; ++i)
+	{
+		int fd = open(dir.file(i).c_str(), O_RDONLY);
+		if (fd < 0)
+			continue;
+		for (auto offset : offsets)
+			read += size_t(std::max<ssize_t>(pread(fd, buffer.data(), buffer.size(), offset), 0));
+		close(fd);
+	}
+	return read;
+}
+
+ZETA_BENCH(benchDeviceScanCache)
+{
+	fixture::DeviceDirectory dir(bench::scaled(200, scale));
+	auto label = std::to_string(dir.count) + " sparse files";
+	auto iterations = bench::scaled(100, scale);
+	bench::measure("read all labels, " + label, iterations, [&]
+	{
+		bench::consume(readAllLabels(dir));
+	});
+	bench::measure("probe label digests, " + label, iterations, [&]
+	{
+		auto devices = scanDevices({dir.path});
+		std::atomic<uint64_t> digests(0);
+		parallelFor(devices.size(), 8, [&](size_t i)
+		{
+			digests += readLabelDigest(devices[i].path) != 0;
+		});
+		bench::consume(digests.load());
+	});
+	DeviceScanCache<size_t> cache(8);
+	size_t scans = 0;
+	auto scan = [&]
+	{
+		++scans;
+		return readAllLabels(dir);
+	};
+	bench::measure("cached scan, unchanged, " + label, iterations, [&]
+	{
+		bench::consume(cache.get({dir.path}, scan));
+	});
+	size_t changed = 0;
+	bench::measure("cached scan, one changed, " + label, iterations, [&]
+	{
+		dir.writeLabel(changed++ % dir.count, "exported");
+		bench::consume(cache.get({dir.path}, scan));
+	});
+	bench::consume(scans);
+}
@@ -0,0 +1,191 @@
+//
+//  BenchFormatHelpers.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+
+#include "ZetaFormatHelpers.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+using namespace zeta;
+
+//! The stream and regex based helpers before the buffer based ones, as they were
+namespace old
+{
+	template<typename T>
+	std::string formatPrefixedValue(T size, Prefix const * prefix, size_t prefixCount)
+	{
+		for (size_t p = 0; p < prefixCount; ++p)
+		{
+			if (size >= prefix[p].factor)
+			{
+				double scaledSize = size / double(prefix[p].factor);
+				std::stringstream ss;
+				ss << std::setprecision(2) << std::fixed << scaledSize << " " << prefix[p].prefix;
+				return ss.str();
+			}
+		}
+		return std::to_string(size) + " ";
+	}
+
+	template<typename T>
+	std::string formatInformationValue(T size)
+	{
+		return formatPrefixedValue(size, binaryPrefixes, binaryPrefixCount);
+	}
+
+	template<typename T>
+	std::string formatNormalValue(T size)
+	{
+		return formatPrefixedValue(size, metricPrefixes, metricPrefixCount);
+	}
+
+	template<typename T>
+	std::string formatBytes(T bytes)
+	{
+		return formatInformationValue(bytes) + "B";
+	}
+
+	template<typename T>
+	bool parseBytes(char const * byteString, T & outBytes)
+	{
+		std::regex byteRegex(R"((\d+\.?\d*)\s*([EPTGMk]?i?)B?)", std::regex::icase);
+		std::cmatch match;
+		if (std::regex_match(byteString, match, byteRegex))
+		{
+			double bytesFormated = std::stod(std::string(match[1].first, match[1].second));
+			std::string prefix(match[2].first, match[2].second);
+			std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::tolower);
+			if (prefix.length() == 1)
+				prefix += 'i';
+			Prefix const * foundPrefix = std::find_if(binaryPrefixes, binaryPrefixes + binaryPrefixCount,
+				[=](Prefix const & p)
+			{
+				std::string pp(p.prefix);
+				std::transform(pp.begin(), pp.end(), pp.begin(), ::tolower);
+				return prefix == pp;
+			});
+			if (foundPrefix != binaryPrefixes + binaryPrefixCount)
+			{
+				outBytes = static_cast<T>(bytesFormated * foundPrefix->factor);
+			}
+			else
+			{
+				outBytes = static_cast<T>(bytesFormated);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	inline std::string formatLatency(uint64_t nanoseconds)
+	{
+		char const * units[] = { "ns", "us", "ms", "s" };
+		double value = nanoseconds;
+		size_t unit = 0;
+		while (value >= 1000 && unit < 3)
+		{
+			value /= 1000;
+			++unit;
+		}
+		std::stringstream ss;
+		ss << std::setprecision(unit == 0 ? 0 : 1) << std::fixed << value << " " << units[unit];
+		return ss.str();
+	}
+}
+
+//! Values spread evenly over all magnitudes, or evenly below limit
+static std::vector<uint64_t> randomValues(size_t count, uint64_t limit = 0)
+{
+	std::mt19937_64 random(42);
+	std::vector<uint64_t> values(count);
+	for (auto & v : values)
+		v = limit ? random() % limit : random() >> (random() % 64);
+	return values;
+}
+
+template<typename New, typename Old>
+static void printDifferences(char const * label, std::vector<uint64_t> const & values,
+	New const & current, Old const & previous)
+{
+	size_t differences = 0;
+	for (auto v : values)
+		differences += current(v) != previous(v);
+	std::printf("  %-48s %11.3f%% of %zu values\n", label, 100.0 * differences / values.size(),
+		values.size());
+}
+
+ZETA_BENCH(benchFormatHelpers)
+{
+	auto values = randomValues(bench::scaled(100000, scale));
+	auto label = std::to_string(values.size()) + " values";
+	bench::measure("old formatBytes, " + label, 1, [&]
+	{
+		for (auto v : values)
+			bench::consume(old::formatBytes(v).size());
+	});
+	bench::measure("formatBytes, " + label, 1, [&]
+	{
+		for (auto v : values)
+			bench::consume(formatBytes(v).size());
+	});
+	bench::measure("formatBytes into a buffer, " + label, 1, [&]
+	{
+		char buffer[formatBufferSize];
+		for (auto v : values)
+			bench::consume(uint64_t(formatBytes(buffer, buffer + sizeof(buffer), v) - buffer));
+	});
+	bench::measure("old formatLatency, " + label, 1, [&]
+	{
+		for (auto v : values)
+			bench::consume(old::formatLatency(v).size());
+	});
+	bench::measure("formatLatency, " + label, 1, [&]
+	{
+		for (auto v : values)
+			bench::consume(formatLatency(v).size());
+	});
+	std::vector<std::string> strings;
+	for (size_t i = 0; i < std::min<size_t>(values.size(), bench::scaled(10000, scale)); ++i)
+		strings.push_back(formatBytes(values[i]));
+	auto parseLabel = std::to_string(strings.size()) + " strings";
+	bench::measure("old parseBytes, " + parseLabel, 1, [&]
+	{
+		for (auto const & s : strings)
+		{
+			uint64_t bytes = 0;
+			old::parseBytes(s.c_str(), bytes);
+			bench::consume(bytes);
+		}
+	});
+	bench::measure("parseBytes, " + parseLabel, 1, [&]
+	{
+		for (auto const & s : strings)
+		{
+			uint64_t bytes = 0;
+			parseBytes(s.c_str(), bytes);
+			bench::consume(bytes);
+		}
+	});
+	// Exact ties and carrying into the next prefix or unit change some outputs
+	auto latencies = randomValues(values.size(), 1000000);
+	auto newLatency = [](uint64_t v) { return formatLatency(v); };
+	auto oldLatency = [](uint64_t v) { return old::formatLatency(v); };
+	printDifferences("formatBytes differs from old", values,
+		[](uint64_t v) { return formatBytes(v); }, [](uint64_t v) { return old::formatBytes(v); });
+	printDifferences("formatNormalValue differs from old", values,
+		[](uint64_t v) { return formatNormalValue(v); }, [](uint64_t v) { return old::formatNormalValue(v); });
+	printDifferences("formatLatency differs from old", values, newLatency, oldLatency);
+	printDifferences("formatLatency below 1 ms differs from old", latencies, newLatency, oldLatency);
+}
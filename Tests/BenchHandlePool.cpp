@@ -0,0 +1,81 @@
+//
+//  BenchHandlePool.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "ZetaHandleFixture.hpp"
+
+#include "ZetaHandlePool.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace zeta;
+
+typedef fixture::Handle Handle;
+
+//! Runs requests on threads at once, each request on its own handle
+template<typename Request>
+static void concurrently(size_t threads, size_t requests, Request request)
+{
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t)
+	{
+		workers.emplace_back([&, t]
+		{
+			for (size_t i = t; i < requests; i += threads)
+				request(i);
+		});
+	}
+	for (auto & worker : workers)
+		worker.join();
+}
+
+ZETA_BENCH(benchHandlePool)
+{
+	Handle::pools = 8;
+	Handle::vdevsPerPool = 64;
+	auto label = std::to_string(Handle::pools) + " pools";
+	auto iterations = bench::scaled(10000, scale);
+	bench::measure("fresh handle per request, " + label, iterations, [&]
+	{
+		Handle handle;
+		bench::consume(handle.lookup(3));
+	});
+	HandlePool<Handle> pool(16);
+	bench::measure("leased handle per request, " + label, iterations, [&]
+	{
+		auto handle = pool.acquire();
+		bench::consume(handle->lookup(3));
+	});
+	// Like parallel mount workers, each with its own handle
+	size_t const threads = 8;
+	auto requests = bench::scaled(400, scale);
+	bench::measure("fresh handles, " + std::to_string(threads) + " threads", iterations / requests + 1, [&]
+	{
+		std::atomic<uint64_t> sum(0);
+		concurrently(threads, requests, [&](size_t i)
+		{
+			Handle handle;
+			sum += handle.lookup(i);
+		});
+		bench::consume(sum.load());
+	});
+	bench::measure("leased handles, " + std::to_string(threads) + " threads", iterations / requests + 1, [&]
+	{
+		std::atomic<uint64_t> sum(0);
+		concurrently(threads, requests, [&](size_t i)
+		{
+			auto handle = pool.acquire();
+			sum += handle->lookup(i);
+		});
+		bench::consume(sum.load());
+	});
+	Handle::pools = 4;
+	Handle::vdevsPerPool = 8;
+}
@@ -0,0 +1,90 @@
+//
+//  BenchLatencyHistogram.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+
+#include "ZetaLatencyHistogram.hpp"
+
+#include <random>
+#include <unordered_map>
+
+using namespace zeta;
+
+//! A pool of raidz groups of the given width, with a histogram per disk
+static PoolState groupedPool(size_t groups, size_t width)
+{
+	PoolState pool;
+	pool.name = "pool";
+	pool.guid = 1;
+	for (size_t g = 0; g < groups; ++g)
+	{
+		VDevState raidz;
+		raidz.guid = 1000 * (g + 1);
+		raidz.name = "raidz2-" + std::to_string(g);
+		raidz.type = "raidz";
+		auto parent = uint32_t(pool.vdevs.size());
+		pool.vdevs.push_back(raidz);
+		for (size_t d = 0; d < width; ++d)
+		{
+			VDevState disk;
+			disk.guid = raidz.guid + 1 + d;
+			disk.name = "disk" + std::to_string(g * width + d);
+			disk.type = "disk";
+			disk.parent = parent;
+			disk.depth = 1;
+			pool.vdevs.push_back(disk);
+		}
+	}
+	return pool;
+}
+
+static LatencyHistogram randomHistogram(std::mt19937_64 & rng)
+{
+	LatencyHistogram h;
+	std::uniform_int_distribution<uint64_t> count(0, 100000);
+	for (size_t b = 10; b < 24; ++b)
+		h.counts[b] = count(rng) >> (b > 16 ? 2 * (b - 16) : 0);
+	return h;
+}
+
+ZETA_BENCH(benchLatencyHistograms)
+{
+	size_t groups = bench::scaled(100, scale);
+	auto pool = groupedPool(groups, 12);
+	std::mt19937_64 rng(11);
+	std::unordered_map<uint64_t, LatencyHistogram> older, newer;
+	for (auto const & v : pool.vdevs)
+	{
+		older[v.guid] = randomHistogram(rng);
+		newer[v.guid] = older[v.guid];
+		newer[v.guid] += randomHistogram(rng);
+	}
+	auto label = std::to_string(pool.vdevs.size()) + " vdevs";
+	bench::measure("increase and merge, " + label, bench::scaled(1000, scale), [&]
+	{
+		LatencyHistogram total;
+		for (auto const & v : pool.vdevs)
+			total += increase(older[v.guid], newer[v.guid]);
+		bench::consume(total.counts[12]);
+	});
+	bench::measure("summarize, " + label, bench::scaled(1000, scale), [&]
+	{
+		uint64_t sum = 0;
+		for (auto const & v : pool.vdevs)
+			sum += summarize(newer[v.guid]).p99;
+		bench::consume(sum);
+	});
+	bench::measure("find outliers, " + label, bench::scaled(1000, scale), [&]
+	{
+		auto outliers = findLatencyOutliers(pool, [&](uint64_t guid)
+		{
+			return increase(older[guid], newer[guid]);
+		});
+		bench::consume(outliers.size());
+	});
+}
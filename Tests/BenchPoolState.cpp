@@ -0,0 +1,64 @@
+//
+//  BenchPoolState.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "ZetaPoolStateFixture.hpp"
+
+#include "ZetaPoolState.hpp"
+#include "ZetaPoolStateDiff.hpp"
+
+#include <cstdio>
+
+using namespace zeta;
+
+//! Reads what the main menu reads from the state when it opens, without AppKit
+static uint64_t openMenu(SystemState const & state)
+{
+	uint64_t work = 0;
+	char line[256];
+	for (auto const & pool : state.pools)
+	{
+		for (auto const & vdev : pool.vdevs)
+			work += vdev.stat.errorRead + vdev.stat.errorWrite + vdev.stat.errorChecksum;
+		for (auto const & fs : pool.fileSystems)
+		{
+			work += size_t(std::snprintf(line, sizeof(line), "%s (%d%d%d)", fs.name.c_str(),
+				fs.mounted, int(fs.keyStatus), fs.isEncryptionRoot));
+		}
+	}
+	work += encryptionRoots(state, FileSystemState::KeyStatus::unavailable).size();
+	work += encryptionRoots(state, FileSystemState::KeyStatus::available).size();
+	return work;
+}
+
+ZETA_BENCH(benchMenuOpen)
+{
+	size_t datasets = bench::scaled(10000, scale);
+	SystemState state;
+	bench::measure("build state, " + std::to_string(datasets) + " datasets", 1, [&]
+	{
+		state = fixture::systemState(4, datasets);
+	});
+	bench::measure("open menu", bench::scaled(100, scale), [&]
+	{
+		bench::consume(openMenu(state));
+	});
+}
+
+ZETA_BENCH(benchDiffSystemState)
+{
+	size_t datasets = bench::scaled(100000, scale);
+	auto before = fixture::systemState(4, datasets);
+	auto after = before;
+	for (size_t i = 0; i < after.pools[0].fileSystems.size(); i += 1000)
+		after.pools[0].fileSystems[i].mounted = !after.pools[0].fileSystems[i].mounted;
+	bench::measure("diff, " + std::to_string(datasets) + " datasets", bench::scaled(100, scale), [&]
+	{
+		bench::consume(diffSystemState(before, after).size());
+	});
+}
@@ -0,0 +1,55 @@
+//
+//  BenchPropertyTable.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "MockLibZFS.hpp"
+
+using namespace zeta;
+
+//! What the pool menu and the details submenu request
+static std::vector<DatasetProperty> const summaryProperties =
+{
+	DatasetProperty::mounted,
+	DatasetProperty::encryptionRoot,
+	DatasetProperty::keyStatus,
+};
+
+static std::vector<DatasetProperty> const detailProperties =
+{
+	DatasetProperty::mountable,
+	DatasetProperty::available,
+	DatasetProperty::used,
+	DatasetProperty::referenced,
+	DatasetProperty::logicalused,
+	DatasetProperty::compressRatio,
+	DatasetProperty::mountpoint,
+};
+
+static void benchBackends(std::string const & name, mock::LibZFS const & zfs,
+	std::vector<DatasetProperty> const & properties, size_t iterations)
+{
+	bench::measure(name + ", per property", iterations, [&]
+	{
+		auto table = fetchProperties(mock::PerPropertyBackend(zfs), properties);
+		bench::consume(table.datasetCount());
+	});
+	bench::measure(name + ", batched", iterations, [&]
+	{
+		auto table = fetchProperties(mock::BatchedBackend(zfs), properties);
+		bench::consume(table.datasetCount());
+	});
+}
+
+ZETA_BENCH(benchPropertyFetch)
+{
+	size_t datasets = bench::scaled(10000, scale);
+	auto zfs = mock::libZFS(datasets);
+	auto iterations = bench::scaled(20, scale);
+	benchBackends("summary, " + std::to_string(datasets) + " datasets", zfs, summaryProperties, iterations);
+	benchBackends("details, " + std::to_string(datasets) + " datasets", zfs, detailProperties, iterations);
+}
@@ -0,0 +1,56 @@
+//
+//  BenchSnapshotBatch.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+
+#include "ZetaSnapshotBatch.hpp"
+
+#include <cerrno>
+
+using namespace zeta;
+
+//! Snapshot names of datasets spread over pools, like a retention run
+static std::vector<std::string> snapshotNames(size_t pools, size_t datasetsPerPool)
+{
+	std::vector<std::string> names;
+	for (size_t d = 0; d < datasetsPerPool; ++d)
+	{
+		for (size_t p = 0; p < pools; ++p)
+			names.push_back("pool" + std::to_string(p) + "/fs" + std::to_string(d) + "@auto-2026-10-16-1200");
+	}
+	return names;
+}
+
+ZETA_BENCH(benchSnapshotBatch)
+{
+	auto names = snapshotNames(8, bench::scaled(1000, scale));
+	auto label = std::to_string(names.size()) + " snapshots in 8 pools";
+	auto iterations = bench::scaled(100, scale);
+	bench::measure("group by pool, " + label, iterations, [&]
+	{
+		bench::consume(groupByPool(names).size());
+	});
+	auto pools = groupByPool(names);
+	bench::measure("failures, all pools fail, " + label, iterations, [&]
+	{
+		std::map<std::string, int> failures;
+		for (auto const & pool : pools)
+			addBatchFailures(EEXIST, {{pool.second.front(), EEXIST}, {"N_MORE_ERRORS", 1}}, pool.second, failures);
+		bench::consume(failures.size());
+	});
+	bench::measure("failures, one pool fails, " + label, iterations, [&]
+	{
+		std::map<std::string, int> failures;
+		for (auto const & pool : pools)
+		{
+			bool failed = pool.first == "pool3";
+			addBatchFailures(failed ? ENOSPC : 0, {}, pool.second, failures);
+		}
+		bench::consume(failures.size());
+	});
+}
@@ -0,0 +1,128 @@
+//
+//  BenchVDevDecoder.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+#include "ZetaVDevFixture.hpp"
+
+#include "ZetaVDevDecoder.hpp"
+
+#include <algorithm>
+
+using namespace zeta;
+
+static void addLatencyHistogram(nvlist_t * statsEx, char const * name, LatencyHistogram & histogram)
+{
+	uint64_t * buckets = nullptr;
+	uint_t count = 0;
+	if (nvlist_lookup_uint64_array(statsEx, name, &buckets, &count) != 0)
+		return;
+	for (size_t i = 0; i < std::min<size_t>(count, latencyBucketCount); ++i)
+		histogram.counts[i] += buckets[i];
+}
+
+//! The sampler before the decoder, a lookup by name per field and a copy of the children
+static void walkVDevIOCounters(std::vector<nvlist_t *> const & devices,
+	std::vector<VDevIOSample> & samples)
+{
+	for (auto device : devices)
+	{
+		VDevIOSample s;
+		nvlist_lookup_uint64(device, ZPOOL_CONFIG_GUID, &s.guid);
+		vdev_stat_t * vs = nullptr;
+		uint_t count = 0;
+		if (nvlist_lookup_uint64_array(device, ZPOOL_CONFIG_VDEV_STATS,
+			reinterpret_cast<uint64_t**>(&vs), &count) == 0)
+		{
+			s.counters.readOps = vs->vs_ops[ZIO_TYPE_READ];
+			s.counters.writeOps = vs->vs_ops[ZIO_TYPE_WRITE];
+			s.counters.readBytes = vs->vs_bytes[ZIO_TYPE_READ];
+			s.counters.writeBytes = vs->vs_bytes[ZIO_TYPE_WRITE];
+		}
+		nvlist_t * statsEx = nullptr;
+		if (nvlist_lookup_nvlist(device, ZPOOL_CONFIG_VDEV_STATS_EX, &statsEx) == 0)
+		{
+			addLatencyHistogram(statsEx, ZPOOL_CONFIG_VDEV_DISK_R_LAT_HISTO, s.latency);
+			addLatencyHistogram(statsEx, ZPOOL_CONFIG_VDEV_DISK_W_LAT_HISTO, s.latency);
+		}
+		samples.push_back(s);
+		nvlist_t ** children = nullptr;
+		uint_t childCount = 0;
+		if (nvlist_lookup_nvlist_array(device, ZPOOL_CONFIG_CHILDREN, &children, &childCount) == 0)
+			walkVDevIOCounters(std::vector<nvlist_t *>(children, children + childCount), samples);
+	}
+}
+
+ZETA_BENCH(benchVDevDecoder)
+{
+	// Pools of 12 mirrors of 3 disks, with the extended stats the sampler reads
+	fixture::VDevTree tree;
+	std::vector<nvlist_t *> pools;
+	for (size_t p = 0; p < 4; ++p)
+		pools.push_back(tree.root(12, 3));
+	auto iterations = bench::scaled(1000, scale);
+	std::vector<VDevIOSample> samples;
+	bench::measure("lookup by name, 4 pools of 12x3 vdevs", iterations, [&]
+	{
+		samples.clear();
+		walkVDevIOCounters(pools, samples);
+		bench::consume(samples.back().latency.counts[12]);
+	});
+	bench::measure("single pass, 4 pools of 12x3 vdevs", iterations, [&]
+	{
+		samples.clear();
+		for (auto pool : pools)
+			appendVDevIOSamples(pool, samples);
+		bench::consume(samples.back().latency.counts[12]);
+	});
+	// The fields alone, without building samples
+	std::vector<nvlist_t *> leaves;
+	for (auto pool : pools)
+	{
+		auto root = decodeVDev(pool);
+		for (uint_t t = 0; t < root.childCount; ++t)
+		{
+			auto top = decodeVDev(root.children[t]);
+			leaves.insert(leaves.end(), top.children, top.children + top.childCount);
+		}
+	}
+	auto leafLabel = std::to_string(leaves.size()) + " leaves";
+	bench::measure("fields by name, " + leafLabel, iterations, [&]
+	{
+		uint64_t sum = 0;
+		for (auto leaf : leaves)
+		{
+			uint64_t guid = 0;
+			uint64_t * stat = nullptr;
+			uint_t count = 0;
+			nvlist_t * statsEx = nullptr;
+			nvlist_t ** children = nullptr;
+			uint_t childCount = 0;
+			nvlist_lookup_uint64(leaf, ZPOOL_CONFIG_GUID, &guid);
+			nvlist_lookup_uint64_array(leaf, ZPOOL_CONFIG_VDEV_STATS, &stat, &count);
+			nvlist_lookup_nvlist(leaf, ZPOOL_CONFIG_VDEV_STATS_EX, &statsEx);
+			nvlist_lookup_nvlist_array(leaf, ZPOOL_CONFIG_CHILDREN, &children, &childCount);
+			sum += guid + count + childCount + (statsEx != nullptr);
+		}
+		bench::consume(sum);
+	});
+	bench::measure("fields in one pass, " + leafLabel, iterations, [&]
+	{
+		uint64_t sum = 0;
+		for (auto leaf : leaves)
+		{
+			auto f = decodeVDev(leaf);
+			sum += f.guid + f.statCount + f.childCount + (f.statsEx != nullptr);
+		}
+		bench::consume(sum);
+	});
+	auto config = tree.config(12, 3);
+	bench::measure("pool config devices, 12x3 vdevs", iterations, [&]
+	{
+		bench::consume(poolConfigDevices(config).size());
+	});
+}
@@ -0,0 +1,184 @@
+//
+//  ZFSUtils.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef FakeZFSUtils_hpp
+#define FakeZFSUtils_hpp
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+/*!
+ Stand-in for the parts of libnvpair and the ZFS headers that
+ ZetaVDevDecoder uses, so that it builds without libzfs. Pairs keep their
+ order like in libnvpair. The values are owned by the list, nested lists
+ by whoever built them, see ZetaVDevFixture.hpp.
+ */
+
+typedef unsigned int uint_t;
+
+typedef enum
+{
+	DATA_TYPE_UNKNOWN = 0,
+	DATA_TYPE_UINT64 = 8,
+	DATA_TYPE_STRING = 9,
+	DATA_TYPE_UINT64_ARRAY = 16,
+	DATA_TYPE_NVLIST = 19,
+	DATA_TYPE_NVLIST_ARRAY = 20,
+} data_type_t;
+
+struct nvlist;
+
+typedef struct nvpair
+{
+	std::string name;
+	data_type_t type = DATA_TYPE_UNKNOWN;
+	uint64_t number = 0;
+	std::string string;
+	std::vector<uint64_t> numbers;
+	std::vector<nvlist *> lists;
+} nvpair_t;
+
+typedef struct nvlist
+{
+	std::vector<nvpair_t> pairs;
+} nvlist_t;
+
+inline nvpair_t * nvlist_next_nvpair(nvlist_t * list, nvpair_t * pair)
+{
+	if (!list || list->pairs.empty())
+		return nullptr;
+	if (!pair)
+		return &list->pairs.front();
+	return pair == &list->pairs.back() ? nullptr : pair + 1;
+}
+
+inline char * nvpair_name(nvpair_t * pair) { return const_cast<char *>(pair->name.c_str()); }
+inline data_type_t nvpair_type(nvpair_t * pair) { return pair->type; }
+
+inline int nvpair_value_uint64(nvpair_t * pair, uint64_t * value)
+{
+	if (pair->type != DATA_TYPE_UINT64)
+		return EINVAL;
+	*value = pair->number;
+	return 0;
+}
+
+inline int nvpair_value_string(nvpair_t * pair, char ** value)
+{
+	if (pair->type != DATA_TYPE_STRING)
+		return EINVAL;
+	*value = const_cast<char *>(pair->string.c_str());
+	return 0;
+}
+
+inline int nvpair_value_uint64_array(nvpair_t * pair, uint64_t ** values, uint_t * count)
+{
+	if (pair->type != DATA_TYPE_UINT64_ARRAY)
+		return EINVAL;
+	*values = pair->numbers.data();
+	*count = uint_t(pair->numbers.size());
+	return 0;
+}
+
+inline int nvpair_value_nvlist(nvpair_t * pair, nvlist_t ** value)
+{
+	if (pair->type != DATA_TYPE_NVLIST)
+		return EINVAL;
+	*value = pair->lists.front();
+	return 0;
+}
+
+inline int nvpair_value_nvlist_array(nvpair_t * pair, nvlist_t *** values, uint_t * count)
+{
+	if (pair->type != DATA_TYPE_NVLIST_ARRAY)
+		return EINVAL;
+	*values = pair->lists.data();
+	*count = uint_t(pair->lists.size());
+	return 0;
+}
+
+//! Scans the pairs for the first with name and type
+inline nvpair_t * fakeLookup(nvlist_t * list, char const * name, data_type_t type)
+{
+	for (auto & pair : list->pairs)
+	{
+		if (pair.type == type && std::strcmp(pair.name.c_str(), name) == 0)
+			return &pair;
+	}
+	return nullptr;
+}
+
+inline int nvlist_lookup_uint64(nvlist_t * list, char const * name, uint64_t * value)
+{
+	auto pair = fakeLookup(list, name, DATA_TYPE_UINT64);
+	return pair ? nvpair_value_uint64(pair, value) : ENOENT;
+}
+
+inline int nvlist_lookup_string(nvlist_t * list, char const * name, char ** value)
+{
+	auto pair = fakeLookup(list, name, DATA_TYPE_STRING);
+	return pair ? nvpair_value_string(pair, value) : ENOENT;
+}
+
+inline int nvlist_lookup_uint64_array(nvlist_t * list, char const * name, uint64_t ** values, uint_t * count)
+{
+	auto pair = fakeLookup(list, name, DATA_TYPE_UINT64_ARRAY);
+	return pair ? nvpair_value_uint64_array(pair, values, count) : ENOENT;
+}
+
+inline int nvlist_lookup_nvlist(nvlist_t * list, char const * name, nvlist_t ** value)
+{
+	auto pair = fakeLookup(list, name, DATA_TYPE_NVLIST);
+	return pair ? nvpair_value_nvlist(pair, value) : ENOENT;
+}
+
+inline int nvlist_lookup_nvlist_array(nvlist_t * list, char const * name, nvlist_t *** values, uint_t * count)
+{
+	auto pair = fakeLookup(list, name, DATA_TYPE_NVLIST_ARRAY);
+	return pair ? nvpair_value_nvlist_array(pair, values, count) : ENOENT;
+}
+
+#define ZPOOL_CONFIG_VDEV_TREE "vdev_tree"
+#define ZPOOL_CONFIG_TYPE "type"
+#define ZPOOL_CONFIG_GUID "guid"
+#define ZPOOL_CONFIG_PATH "path"
+#define ZPOOL_CONFIG_CHILDREN "children"
+#define ZPOOL_CONFIG_VDEV_STATS "vdev_stats"
+#define ZPOOL_CONFIG_VDEV_STATS_EX "vdev_stats_ex"
+#define ZPOOL_CONFIG_VDEV_DISK_R_LAT_HISTO "vdev_disk_r_lat_histo"
+#define ZPOOL_CONFIG_VDEV_DISK_W_LAT_HISTO "vdev_disk_w_lat_histo"
+
+enum { ZIO_TYPE_NULL, ZIO_TYPE_READ, ZIO_TYPE_WRITE, ZIO_TYPE_FREE, ZIO_TYPE_CLAIM, ZIO_TYPE_IOCTL, ZIO_TYPES };
+
+//! The start of vdev_stat_t, as in sys/fs/zfs.h
+typedef struct vdev_stat
+{
+	uint64_t vs_timestamp;
+	uint64_t vs_state;
+	uint64_t vs_aux;
+	uint64_t vs_alloc;
+	uint64_t vs_space;
+	uint64_t vs_dspace;
+	uint64_t vs_rsize;
+	uint64_t vs_esize;
+	uint64_t vs_ops[ZIO_TYPES];
+	uint64_t vs_bytes[ZIO_TYPES];
+	uint64_t vs_read_errors;
+	uint64_t vs_write_errors;
+	uint64_t vs_checksum_errors;
+	uint64_t vs_initialize_errors;
+	uint64_t vs_self_healed;
+	uint64_t vs_scan_removing;
+	uint64_t vs_scan_processed;
+	uint64_t vs_fragmentation;
+} vdev_stat_t;
+
+#endif /* FakeZFSUtils_hpp */
@@ -0,0 +1,114 @@
+//
+//  FuzzFormatHelpers.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaFormatHelpers.hpp"
+
+#include <algorithm>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//! Aborts, so libFuzzer keeps the input, and the random driver fails under ctest
+#define FUZZ_CHECK(expression, value) \
+	do { if (!(expression)) { \
+		std::fprintf(stderr, "%s:%d: %s failed for %llu\n", __FILE__, __LINE__, #expression, \
+			(unsigned long long)(value)); \
+		std::abort(); } } while (false)
+
+namespace
+{
+	//! Values at least this large may round up past the maximum when formatted
+	constexpr uint64_t roundsPastMaximum = 18440000000000000000ull;
+
+	//! Formatting, parsing and formatting again writes the same
+	void checkRoundTrip(uint64_t value, Prefix const * prefix, size_t prefixCount)
+	{
+		char buffer[formatBufferSize];
+		auto end = formatPrefixedValue(buffer, buffer + sizeof(buffer), value, prefix, prefixCount);
+		FUZZ_CHECK(end != nullptr, value);
+		std::string_view formatted(buffer, size_t(end - buffer));
+		uint64_t parsed = 0;
+		if (!parsePrefixedValue(formatted, prefix, prefixCount, "", parsed))
+		{
+			FUZZ_CHECK(value >= roundsPastMaximum, value);
+			return;
+		}
+		char again[formatBufferSize];
+		auto againEnd = formatPrefixedValue(again, again + sizeof(again), parsed, prefix, prefixCount);
+		FUZZ_CHECK(againEnd && formatted == std::string_view(again, size_t(againEnd - again)), value);
+		// The integer part before a prefix never reaches the factor between prefixes
+		auto dot = formatted.find('.');
+		if (dot != std::string_view::npos)
+			FUZZ_CHECK(dot <= 4 && (dot < 4 || formatted.substr(0, 4) < "1024"), value);
+	}
+
+	//! Below seconds, the integer part has at most three digits
+	void checkLatency(uint64_t nanoseconds)
+	{
+		char buffer[formatBufferSize];
+		auto end = formatLatency(buffer, buffer + sizeof(buffer), nanoseconds);
+		FUZZ_CHECK(end != nullptr, nanoseconds);
+		std::string_view formatted(buffer, size_t(end - buffer));
+		auto space = formatted.find(' ');
+		FUZZ_CHECK(space != std::string_view::npos, nanoseconds);
+		auto unit = formatted.substr(space + 1);
+		auto integer = formatted.substr(0, std::min(space, formatted.find('.')));
+		if (unit != "s")
+			FUZZ_CHECK(integer.size() <= 3, nanoseconds);
+		if (unit == "ns")
+			FUZZ_CHECK(integer == std::to_string(nanoseconds), nanoseconds);
+	}
+
+	//! Output into buffers that are too small is dropped, never truncated or overrun
+	void checkShortBuffer(uint64_t value, size_t size)
+	{
+		char buffer[formatBufferSize + 1];
+		buffer[size] = '\x7f';
+		auto end = formatBytes(buffer, buffer + size, value);
+		FUZZ_CHECK(buffer[size] == '\x7f', value);
+		FUZZ_CHECK(!end || (end >= buffer && end <= buffer + size), value);
+		char full[formatBufferSize];
+		auto fullEnd = formatBytes(full, full + sizeof(full), value);
+		FUZZ_CHECK(fullEnd != nullptr, value);
+		FUZZ_CHECK(!end == (size < size_t(fullEnd - full)), value);
+		if (end)
+			FUZZ_CHECK(std::memcmp(buffer, full, size_t(end - buffer)) == 0, value);
+	}
+
+	//! Anything the parser accepts formats to a string it parses back to the same
+	void checkParse(std::string_view string)
+	{
+		uint64_t value = 0;
+		if (parsePrefixedValue(string, binaryPrefixes, binaryPrefixCount, "B", value))
+			checkRoundTrip(value, binaryPrefixes, binaryPrefixCount);
+		if (parsePrefixedValue(string, metricPrefixes, metricPrefixCount, "", value))
+			checkRoundTrip(value, metricPrefixes, metricPrefixCount);
+	}
+}
+
+/*!
+ The first eight bytes are a value that is formatted in every way, the
+ rest is parsed as text. Runs with libFuzzer, or with random inputs from
+ ZetaFuzzMain.cpp.
+ */
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const * data, size_t size)
+{
+	uint64_t value = 0;
+	std::memcpy(&value, data, std::min<size_t>(size, sizeof(value)));
+	checkRoundTrip(value, binaryPrefixes, binaryPrefixCount);
+	checkRoundTrip(value, metricPrefixes, metricPrefixCount);
+	checkLatency(value);
+	checkShortBuffer(value, size % (formatBufferSize + 1));
+	double rate = 0;
+	std::memcpy(&rate, &value, sizeof(rate));
+	FUZZ_CHECK(!formatNormalRate(rate).empty(), value);
+	if (size > sizeof(value))
+		checkParse(std::string_view(reinterpret_cast<char const *>(data) + sizeof(value), size - sizeof(value)));
+	return 0;
+}
@@ -0,0 +1,264 @@
+//
+//  MockLibZFS.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef MockLibZFS_hpp
+#define MockLibZFS_hpp
+
+#include "ZetaPropertyTable.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+/*!
+ Stand-in for the libzfs dataset handles behind LibZFSPropertyBackend. Each
+ dataset has a property list laid out like the one zfs_get_all_props returns,
+ which libzfs searches linearly on every lookup, and the mock counts the
+ calls a backend makes into it.
+ */
+namespace zeta::mock
+{
+	struct Field
+	{
+		std::string name;
+		uint64_t value;
+		std::string string;
+	};
+
+	//! A property, stored as a nested list with its value and source
+	struct ListEntry
+	{
+		ListEntry(std::string name, uint64_t value, std::string string = std::string()) :
+			name(std::move(name)),
+			fields{{"value", value, std::move(string)}, {"source", 0, std::string()}} {}
+
+		Field const * field(std::string const & fieldName) const
+		{
+			for (auto const & f : fields)
+			{
+				if (f.name == fieldName)
+					return &f;
+			}
+			return nullptr;
+		}
+
+		std::string name;
+		std::vector<Field> fields;
+	};
+
+	struct Dataset
+	{
+		std::string name;
+		std::vector<ListEntry> properties;
+		bool mounted = false;
+		bool mountable = false;
+		std::string mountpoint;
+	};
+
+	struct LibZFS
+	{
+		std::vector<Dataset> datasets;
+		mutable uint64_t calls = 0;
+
+		//! Like zfs_prop_get_int, which looks up the property, its value and its source
+		Field const * lookup(size_t dataset, std::string const & name) const
+		{
+			++calls;
+			for (auto const & entry : datasets[dataset].properties)
+			{
+				if (entry.name == name)
+				{
+					auto source = entry.field("source");
+					auto value = entry.field("value");
+					return source ? value : nullptr;
+				}
+			}
+			return nullptr;
+		}
+
+		//! Like zfs_get_all_props, the whole list in one call
+		std::vector<ListEntry> const & propertyList(size_t dataset) const
+		{
+			++calls;
+			return datasets[dataset].properties;
+		}
+	};
+
+	//! Builds datasets with a property list of the size libzfs reports
+	inline LibZFS libZFS(size_t datasetCount)
+	{
+		static char const * const filler[] =
+		{
+			"type", "creation", "createtxg", "guid", "objsetid", "recordsize",
+			"checksum", "compression", "atime", "devices", "exec", "setuid",
+			"readonly", "snapdir", "aclmode", "aclinherit", "canmount", "xattr",
+			"copies", "version", "utf8only", "normalization", "casesensitivity",
+			"primarycache", "secondarycache", "usedbysnapshots", "usedbydataset",
+			"usedbychildren", "usedbyrefreservation", "logbias", "dedup",
+			"sync", "refcompressratio", "written", "logicalreferenced",
+		};
+		LibZFS zfs;
+		zfs.datasets.resize(datasetCount);
+		for (size_t i = 0; i < datasetCount; ++i)
+		{
+			auto & d = zfs.datasets[i];
+			d.name = "tank/fs" + std::to_string(i);
+			for (auto name : filler)
+				d.properties.push_back({name, i});
+			d.properties.push_back({"used", 1000 * i + 1});
+			d.properties.push_back({"available", 2000 * i + 2});
+			d.properties.push_back({"referenced", 3000 * i + 3});
+			d.properties.push_back({"logicalused", 4000 * i + 4});
+			d.properties.push_back({"compressratio", 100 + i % 300});
+			if (i % 10 == 5)
+			{
+				d.properties.push_back({"keystatus", 1 + i % 2});
+				d.properties.push_back({"encryptionroot", 0, d.name});
+			}
+			else if (i % 10 == 6)
+			{
+				d.properties.push_back({"keystatus", 2});
+				d.properties.push_back({"encryptionroot", 0, "tank/fs" + std::to_string(i - 1)});
+			}
+			d.mounted = i % 3 != 0;
+			d.mountable = i % 4 != 0;
+			d.mountpoint = "/Volumes/" + d.name;
+		}
+		return zfs;
+	}
+
+	//! The old LibZFSPropertyBackend, one accessor call per property and dataset
+	class PerPropertyBackend : public PropertyBackend
+	{
+	public:
+		explicit PerPropertyBackend(LibZFS const & zfs) : m_zfs(zfs) {}
+
+	public:
+		size_t datasetCount() const override { return m_zfs.datasets.size(); }
+
+		void fetch(PropertyTable & table) const override
+		{
+			for (size_t i = 0; i < m_zfs.datasets.size(); ++i)
+			{
+				auto const & d = m_zfs.datasets[i];
+				for (auto property : table.properties())
+				{
+					switch (property)
+					{
+						case DatasetProperty::mounted:
+							++m_zfs.calls;
+							table.numericColumn(property)[i] = d.mounted;
+							break;
+						case DatasetProperty::mountable:
+							++m_zfs.calls;
+							table.numericColumn(property)[i] = d.mountable;
+							break;
+						case DatasetProperty::mountpoint:
+							++m_zfs.calls;
+							table.stringColumn(property)[i] = d.mountpoint;
+							break;
+						case DatasetProperty::encryptionRoot:
+						{
+							auto value = m_zfs.lookup(i, "encryptionroot");
+							table.numericColumn(property)[i] = value && value->string == d.name;
+							break;
+						}
+						default:
+						{
+							auto value = m_zfs.lookup(i, listName(property));
+							table.setListValue(property, i, value ? value->value : 0);
+							break;
+						}
+					}
+				}
+			}
+		}
+
+	private:
+		static std::string listName(DatasetProperty property)
+		{
+			switch (property)
+			{
+				case DatasetProperty::keyStatus: return "keystatus";
+				case DatasetProperty::available: return "available";
+				case DatasetProperty::used: return "used";
+				case DatasetProperty::referenced: return "referenced";
+				case DatasetProperty::logicalused: return "logicalused";
+				case DatasetProperty::compressRatio: return "compressratio";
+				default: return std::string();
+			}
+		}
+
+	private:
+		LibZFS const & m_zfs;
+	};
+
+	//! Same structure as LibZFSPropertyBackend, one pass over each property list
+	class BatchedBackend : public PropertyBackend
+	{
+	public:
+		explicit BatchedBackend(LibZFS const & zfs) : m_zfs(zfs) {}
+
+	public:
+		size_t datasetCount() const override { return m_zfs.datasets.size(); }
+
+		void fetch(PropertyTable & table) const override
+		{
+			bool needsPropertyList = false;
+			for (auto property : table.properties())
+				needsPropertyList = needsPropertyList || inPropertyList(property);
+			auto mounted = table.contains(DatasetProperty::mounted) ?
+				table.numericColumn(DatasetProperty::mounted) : nullptr;
+			auto mountable = table.contains(DatasetProperty::mountable) ?
+				table.numericColumn(DatasetProperty::mountable) : nullptr;
+			auto mountpoint = table.contains(DatasetProperty::mountpoint) ?
+				table.stringColumn(DatasetProperty::mountpoint) : nullptr;
+			for (size_t i = 0; i < m_zfs.datasets.size(); ++i)
+			{
+				auto const & d = m_zfs.datasets[i];
+				if (needsPropertyList)
+				{
+					for (auto const & entry : m_zfs.propertyList(i))
+					{
+						DatasetProperty property;
+						if (!propertyFromListName(entry.name, property) || !table.contains(property))
+							continue;
+						auto value = entry.field("value");
+						if (!value)
+							continue;
+						if (property == DatasetProperty::encryptionRoot)
+							table.setListValue(property, i, value->string == d.name);
+						else
+							table.setListValue(property, i, value->value);
+					}
+				}
+				if (mounted)
+				{
+					++m_zfs.calls;
+					mounted[i] = d.mounted;
+				}
+				if (mountable)
+				{
+					++m_zfs.calls;
+					mountable[i] = d.mountable;
+				}
+				if (mountpoint)
+				{
+					++m_zfs.calls;
+					mountpoint[i] = d.mountpoint;
+				}
+			}
+		}
+
+	private:
+		LibZFS const & m_zfs;
+	};
+}
+
+#endif /* MockLibZFS_hpp */
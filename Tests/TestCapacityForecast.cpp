@@ -0,0 +1,57 @@
+//
+//  TestCapacityForecast.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaPoolStateFixture.hpp"
+
+#include "ZetaCapacityForecast.hpp"
+
+using namespace zeta;
+
+ZETA_TEST(testCapacityForecast)
+{
+	CapacityForecaster forecaster(std::chrono::hours(24 * 7), std::chrono::hours(12));
+	std::time_t const hour = 60 * 60;
+	std::time_t const start = 1000000;
+	for (std::time_t t = 0; t <= 24 * hour; t += hour)
+	{
+		forecaster.record("pool/fs", start + t, 1000000 + uint64_t(t / hour) * 1000, 100000);
+		EXPECT_EQ(forecaster.forecast("pool/fs").valid, t >= 12 * hour);
+	}
+	auto f = forecaster.forecast("pool/fs");
+	EXPECT(f.bytesPerDay > 23999 && f.bytesPerDay < 24001);
+	EXPECT(f.daysUntilFull > 4.16 && f.daysUntilFull < 4.17);
+	forecaster.forget(start + 25 * hour);
+	EXPECT(!forecaster.forecast("pool/fs").valid);
+}
+
+ZETA_TEST(testCapacityCandidates)
+{
+	auto state = fixture::systemState(1, 100);
+	auto & fileSystems = state.pools[0].fileSystems;
+	for (auto & fs : fileSystems)
+		fs.hasSpace = true;
+	// Two datasets limited by a quota, the fixture's sizes grow with the index
+	fileSystems[17].available = 1000;
+	fileSystems[42].available = 10;
+	fileSystems[60].hasSpace = false;
+	CapacityCandidates candidates(4, std::chrono::hours(1));
+	EXPECT(candidates.needsFullRead("pool0", 1000));
+	candidates.choose("pool0", fileSystems, 1000);
+	EXPECT(!candidates.needsFullRead("pool0", 1000 + 3599));
+	EXPECT(candidates.needsFullRead("pool0", 1000 + 3600));
+	EXPECT(candidates.needsFullRead("pool1", 1000));
+	EXPECT(candidates.contains("pool0", fileSystems[17].name));
+	EXPECT(candidates.contains("pool0", fileSystems[42].name));
+	EXPECT(candidates.contains("pool0", fileSystems[99].name));
+	EXPECT(candidates.contains("pool0", fileSystems[98].name));
+	EXPECT(!candidates.contains("pool0", fileSystems[97].name));
+	EXPECT(!candidates.contains("pool0", fileSystems[60].name));
+	candidates.forget(1001);
+	EXPECT(!candidates.contains("pool0", fileSystems[17].name));
+}
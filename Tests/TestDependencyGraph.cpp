@@ -0,0 +1,81 @@
+//
+//  TestDependencyGraph.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaCloneChainFixture.hpp"
+
+#include "ZetaDependencyGraph.hpp"
+
+using namespace zeta;
+
+ZETA_TEST(testCloneOrigins)
+{
+	DependencyGraph graph;
+	addFileSystems(graph, fixture::cloneChain(3, 4), fixture::createTXG);
+	auto c1 = graph.find("pool/c1");
+	EXPECT(c1 != noDataset);
+	EXPECT_EQ(graph.origin(c1), graph.find("pool/c0@s2"));
+	EXPECT_EQ(graph.origin(graph.find("pool/c0")), noDataset);
+	auto clones = graph.clones(graph.find("pool/c1@s2"));
+	EXPECT_EQ(clones.size(), 1u);
+	EXPECT_EQ(clones[0], graph.find("pool/c2"));
+}
+
+ZETA_TEST(testLaterSnapshots)
+{
+	DependencyGraph graph;
+	addFileSystems(graph, fixture::cloneChain(1, 4), fixture::createTXG);
+	auto later = graph.laterSnapshots(graph.find("pool/c0@s1"));
+	EXPECT_EQ(later.size(), 2u);
+	EXPECT_EQ(later[0], graph.find("pool/c0@s2"));
+	EXPECT_EQ(later[1], graph.find("pool/c0@s3"));
+	EXPECT(graph.laterSnapshots(graph.find("pool/c0@s3")).empty());
+}
+
+ZETA_TEST(testLaterSnapshotsListOrder)
+{
+	// Later means a later createtxg, whatever order libzfs lists snapshots in
+	auto fileSystems = fixture::cloneChain(1, 5);
+	auto & snapshots = fileSystems[0].fsSnapshots;
+	std::swap(snapshots[1], snapshots[4]);
+	std::swap(snapshots[0], snapshots[2]);
+	DependencyGraph graph;
+	addFileSystems(graph, fileSystems, fixture::createTXG);
+	auto later = graph.laterSnapshots(graph.find("pool/c0@s1"));
+	EXPECT_EQ(later.size(), 3u);
+	EXPECT_EQ(later[0], graph.find("pool/c0@s2"));
+	EXPECT_EQ(later[1], graph.find("pool/c0@s3"));
+	EXPECT_EQ(later[2], graph.find("pool/c0@s4"));
+	EXPECT_EQ(graph.laterSnapshots(graph.find("pool/c0@s0")).size(), 4u);
+	EXPECT(graph.laterSnapshots(graph.find("pool/c0@s4")).empty());
+}
+
+ZETA_TEST(testRollbackClones)
+{
+	size_t depth = 50, snapshots = 6;
+	DependencyGraph graph;
+	addFileSystems(graph, fixture::cloneChain(depth, snapshots), fixture::createTXG);
+	// Rolling back past the origin of c1 takes the whole chain after c0
+	auto clones = graph.rollbackClones(graph.find("pool/c0@s2"));
+	EXPECT_EQ(clones.size(), (depth - 1) * (1 + snapshots));
+	EXPECT_EQ(clones[0], graph.find("pool/c1"));
+	// Rolling back to the origin itself keeps it
+	EXPECT(graph.rollbackClones(graph.find("pool/c0@s3")).empty());
+}
+
+ZETA_TEST(testDestroyDependents)
+{
+	size_t depth = 10000, snapshots = 4;
+	DependencyGraph graph;
+	addFileSystems(graph, fixture::cloneChain(depth, snapshots), fixture::createTXG);
+	auto dependents = graph.destroyDependents(graph.find("pool/c0"));
+	// Bookmarks are not dependents, the chain is deeper than any recursion would allow
+	EXPECT_EQ(dependents.size(), snapshots + (depth - 1) * (1 + snapshots));
+	auto last = graph.destroyDependents(graph.find("pool/c" + std::to_string(depth - 1)));
+	EXPECT_EQ(last.size(), snapshots);
+}
@@ -0,0 +1,87 @@
+//
+//  TestDeviceScan.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaDeviceFixture.hpp"
+
+#include "ZetaDeviceScan.hpp"
+
+#include <atomic>
+
+using namespace zeta;
+
+ZETA_TEST(testScanDevices)
+{
+	fixture::DeviceDirectory dir(3);
+	auto devices = scanDevices({dir.path});
+	EXPECT_EQ(devices.size(), 3u);
+	for (size_t i = 0; i < devices.size(); ++i)
+	{
+		EXPECT_EQ(devices[i].path, dir.file(i));
+		EXPECT(devices[i].isFile);
+		EXPECT_EQ(devices[i].size, fixture::DeviceDirectory::fileSize);
+	}
+	EXPECT(scanDevices({dir.path + "/missing"}).empty());
+}
+
+ZETA_TEST(testLabelDigest)
+{
+	fixture::DeviceDirectory dir(2);
+	auto a = readLabelDigest(dir.file(0));
+	EXPECT(a != 0);
+	EXPECT(a != readLabelDigest(dir.file(1)));
+	dir.writeLabel(0, "exported");
+	EXPECT(a != readLabelDigest(dir.file(0)));
+	EXPECT_EQ(readLabelDigest(dir.path + "/missing"), 0u);
+}
+
+ZETA_TEST(testDeviceScanCache)
+{
+	fixture::DeviceDirectory dir(4);
+	std::atomic<size_t> digests(0);
+	DeviceScanCache<size_t> cache(2, [&](std::string const & path)
+	{
+		++digests;
+		return readLabelDigest(path);
+	});
+	size_t scans = 0;
+	auto scan = [&] { return ++scans; };
+	EXPECT_EQ(cache.get({dir.path}, scan), 1u);
+	EXPECT_EQ(digests.load(), 4u);
+	// Unchanged files are neither read nor scanned again
+	EXPECT_EQ(cache.get({dir.path}, scan), 1u);
+	EXPECT_EQ(digests.load(), 4u);
+	// Only the changed file is read
+	dir.writeLabel(2, "imported");
+	EXPECT_EQ(cache.get({dir.path}, scan), 2u);
+	EXPECT_EQ(digests.load(), 5u);
+	dir.add();
+	EXPECT_EQ(cache.get({dir.path}, scan), 3u);
+	EXPECT_EQ(digests.load(), 6u);
+	cache.invalidate();
+	EXPECT_EQ(cache.get({dir.path}, scan), 4u);
+	// Other search paths are a different scan
+	EXPECT_EQ(cache.get({dir.path, dir.path + "/missing"}, scan), 5u);
+}
+
+ZETA_TEST(testDeviceScanCacheNoticesLabelOnlyChanges)
+{
+	// Like a disk, whose label changes without any change to its node
+	fixture::DeviceDirectory dir(2);
+	uint64_t label = 1;
+	DeviceScanCache<size_t> cache(2, [&](std::string const &) { return label; });
+	size_t scans = 0;
+	auto scan = [&] { return ++scans; };
+	cache.get({dir.path}, scan);
+	EXPECT_EQ(cache.get({dir.path}, scan), 1u);
+	// Files are trusted while their identity is unchanged, so this goes unnoticed
+	label = 2;
+	EXPECT_EQ(cache.get({dir.path}, scan), 1u);
+	dir.touch(0);
+	EXPECT_EQ(cache.get({dir.path}, scan), 2u);
+}
@@ -0,0 +1,104 @@
+//
+//  TestDiskInformationCache.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "IDDiskInformationCache.hpp"
+
+using namespace ID;
+
+namespace
+{
+	//! Stand-in for the DiskArbitration and IORegistry queries, counts how often it is asked
+	struct FakeProvider
+	{
+		DiskInformation operator()()
+		{
+			++queries;
+			return info;
+		}
+
+		DiskInformation info;
+		size_t queries = 0;
+	};
+
+	DiskInformation disk(std::string bsdName, std::string mediaUUID)
+	{
+		DiskInformation info;
+		info.mediaBSDName = std::move(bsdName);
+		info.mediaUUID = std::move(mediaUUID);
+		info.mediaWhole = true;
+		return info;
+	}
+}
+
+ZETA_TEST(testDiskInformationCacheLookup)
+{
+	DiskInformationCache cache;
+	FakeProvider provider;
+	provider.info = disk("disk4", "A1");
+	auto provide = [&] { return provider(); };
+	EXPECT_EQ(cache.lookup("/dev/disk4", provide).mediaUUID, "A1");
+	EXPECT_EQ(provider.queries, 1u);
+	// Hits don't query again, with or without /dev/
+	EXPECT_EQ(cache.lookup("disk4", provide).mediaUUID, "A1");
+	EXPECT_EQ(cache.lookup("/dev/disk4", provide).mediaUUID, "A1");
+	EXPECT_EQ(provider.queries, 1u);
+	DiskInformation info;
+	EXPECT(cache.findByMediaUUID("A1", info) && info.mediaBSDName == "disk4");
+	// A provider that failed has no BSD name, nothing is cached
+	provider.info = DiskInformation();
+	EXPECT(cache.lookup("disk5", provide).mediaBSDName.empty());
+	EXPECT(cache.lookup("disk5", provide).mediaBSDName.empty());
+	EXPECT_EQ(provider.queries, 3u);
+	EXPECT_EQ(cache.size(), 1u);
+}
+
+ZETA_TEST(testDiskInformationCacheReplaceByMediaUUID)
+{
+	DiskInformationCache cache;
+	cache.insert(disk("disk4", "A1"));
+	cache.insert(disk("disk5", "B2"));
+	// The same disk reappears under another BSD name
+	cache.insert(disk("/dev/disk7", "A1"));
+	DiskInformation info;
+	EXPECT(!cache.find("disk4", info));
+	EXPECT(cache.find("disk7", info) && info.mediaUUID == "A1");
+	EXPECT(cache.findByMediaUUID("A1", info) && info.mediaBSDName == "/dev/disk7");
+	EXPECT_EQ(cache.size(), 2u);
+	// Another disk under a known BSD name drops the old media UUID
+	cache.insert(disk("disk5", "C3"));
+	EXPECT(!cache.findByMediaUUID("B2", info));
+	EXPECT(cache.findByMediaUUID("C3", info) && info.mediaBSDName == "disk5");
+	// Disks without media UUID are only found by BSD name
+	cache.insert(disk("disk8", ""));
+	EXPECT(cache.find("disk8", info));
+	EXPECT(!cache.findByMediaUUID("", info));
+	EXPECT_EQ(cache.size(), 3u);
+}
+
+ZETA_TEST(testDiskInformationCacheErase)
+{
+	DiskInformationCache cache;
+	cache.insert(disk("disk4", "A1"));
+	cache.insert(disk("disk5", "B2"));
+	DiskInformation info;
+	EXPECT(cache.erase("/dev/disk4", info) && info.mediaUUID == "A1");
+	EXPECT(!cache.erase("disk4", info));
+	EXPECT(!cache.find("disk4", info));
+	EXPECT(!cache.findByMediaUUID("A1", info));
+	EXPECT_EQ(cache.size(), 1u);
+	// After an erase, the next lookup queries again
+	FakeProvider provider;
+	provider.info = disk("disk4", "A1");
+	cache.lookup("disk4", [&] { return provider(); });
+	EXPECT_EQ(provider.queries, 1u);
+	cache.clear();
+	EXPECT_EQ(cache.size(), 0u);
+	EXPECT(!cache.findByMediaUUID("B2", info));
+}
@@ -0,0 +1,37 @@
+//
+//  TestFormatHelpers.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaFormatHelpers.hpp"
+
+ZETA_TEST(testFormatNormalRate)
+{
+	EXPECT_EQ(formatNormalRate(0), "0.00 ");
+	EXPECT_EQ(formatNormalRate(1.0 / 3), "0.33 ");
+	EXPECT_EQ(formatNormalRate(7.0 / 2), "3.50 ");
+	EXPECT_EQ(formatNormalRate(999.996), "1.00 k");
+	EXPECT_EQ(formatNormalRate(1500), "1.50 k");
+	EXPECT_EQ(formatNormalRate(2.5e6), "2.50 M");
+	EXPECT_EQ(formatNormalRate(-1), "0.00 ");
+}
+
+ZETA_TEST(testFormatLatency)
+{
+	EXPECT_EQ(formatLatency(0), "0 ns");
+	EXPECT_EQ(formatLatency(999), "999 ns");
+	EXPECT_EQ(formatLatency(1000), "1.0 us");
+	EXPECT_EQ(formatLatency(1050), "1.0 us");
+	EXPECT_EQ(formatLatency(1150), "1.2 us");
+	// Rounding carries into the next unit instead of writing 1000.0
+	EXPECT_EQ(formatLatency(999949), "999.9 us");
+	EXPECT_EQ(formatLatency(999950), "1.0 ms");
+	EXPECT_EQ(formatLatency(999950000), "1.0 s");
+	EXPECT_EQ(formatLatency(999949999), "999.9 ms");
+	EXPECT_EQ(formatLatency(1999950000000), "2000.0 s");
+}
@@ -0,0 +1,91 @@
+//
+//  TestHandlePool.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaHandleFixture.hpp"
+
+#include "ZetaHandlePool.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace zeta;
+
+typedef fixture::Handle Handle;
+
+ZETA_TEST(testHandlePoolReuse)
+{
+	HandlePool<Handle> pool(2);
+	auto created = Handle::created.load();
+	Handle const * first = nullptr;
+	{
+		auto lease = pool.acquire();
+		first = &*lease;
+	}
+	{
+		auto lease = pool.acquire();
+		EXPECT(&*lease == first);
+		// Concurrent leases never share a handle
+		auto other = pool.acquire();
+		EXPECT(&*other != first);
+	}
+	EXPECT_EQ(Handle::created - created, 2u);
+	// At most maxIdle handles are kept
+	{
+		std::vector<HandlePool<Handle>::Lease> leases;
+		for (int i = 0; i < 5; ++i)
+			leases.push_back(pool.acquire());
+	}
+	auto alive = Handle::alive.load();
+	pool.invalidate();
+	EXPECT_EQ(alive - Handle::alive, 2u);
+}
+
+ZETA_TEST(testHandlePoolInvalidate)
+{
+	HandlePool<Handle> pool(4);
+	auto lease = pool.acquire();
+	{
+		auto idle = pool.acquire();
+	}
+	auto alive = Handle::alive.load();
+	pool.invalidate();
+	EXPECT_EQ(Handle::alive, alive - 1);
+	// A handle leased before the invalidation is destroyed when it is returned
+	lease = HandlePool<Handle>::Lease();
+	EXPECT_EQ(Handle::alive, alive - 2);
+	auto fresh = pool.acquire();
+	EXPECT(fresh);
+	EXPECT_EQ(Handle::alive, alive - 1);
+}
+
+ZETA_TEST(testHandlePoolThreads)
+{
+	HandlePool<Handle> pool(8);
+	auto alive = Handle::alive.load();
+	std::vector<std::thread> threads;
+	std::atomic<uint64_t> sum(0);
+	for (int t = 0; t < 8; ++t)
+	{
+		threads.emplace_back([&, t]
+		{
+			for (int i = 0; i < 200; ++i)
+			{
+				auto lease = pool.acquire();
+				sum += lease->lookup(size_t(t + i));
+				if (i % 50 == 0)
+					pool.invalidate();
+			}
+		});
+	}
+	for (auto & thread : threads)
+		thread.join();
+	EXPECT_EQ(sum.load(), 8u * 200u * Handle::vdevsPerPool);
+	pool.invalidate();
+	EXPECT_EQ(Handle::alive.load(), alive);
+}
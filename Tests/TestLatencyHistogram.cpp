@@ -0,0 +1,67 @@
+//
+//  TestLatencyHistogram.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaPoolStateFixture.hpp"
+
+#include "ZetaLatencyHistogram.hpp"
+
+using namespace zeta;
+
+ZETA_TEST(testLatencySummary)
+{
+	LatencyHistogram h;
+	EXPECT_EQ(summarize(h).count, 0u);
+	h.counts[9] = 50;
+	h.counts[12] = 49;
+	h.counts[20] = 1;
+	auto s = summarize(h);
+	EXPECT_EQ(s.count, 100u);
+	EXPECT_EQ(s.p50, 1024u);
+	EXPECT_EQ(s.p99, 8192u);
+	EXPECT_EQ(s.p999, uint64_t(1) << 21);
+}
+
+ZETA_TEST(testLatencyIncrease)
+{
+	LatencyHistogram older, newer;
+	older.counts[3] = 10;
+	newer.counts[3] = 15;
+	older.counts[4] = 7;
+	newer.counts[4] = 2;
+	auto d = increase(older, newer);
+	EXPECT_EQ(d.counts[3], 5u);
+	EXPECT_EQ(d.counts[4], 0u);
+	older += d;
+	EXPECT_EQ(older.counts[3], 15u);
+}
+
+ZETA_TEST(testLatencyOutliers)
+{
+	auto state = fixture::systemState(1, 1);
+	auto const & pool = state.pools[0];
+	auto slowGUID = pool.vdevs[3].guid;
+	size_t count = 1000;
+	auto latency = [&](uint64_t guid)
+	{
+		LatencyHistogram h;
+		h.counts[guid == slowGUID ? 14 : 10] = count;
+		return h;
+	};
+	auto outliers = findLatencyOutliers(pool, latency);
+	EXPECT_EQ(outliers.size(), 1u);
+	if (!outliers.empty())
+	{
+		EXPECT_EQ(outliers[0].vdevGUID, slowGUID);
+		EXPECT_EQ(outliers[0].oldValue, uint64_t(1) << 11);
+		EXPECT_EQ(outliers[0].newValue, uint64_t(1) << 15);
+	}
+	// Too few I/Os in the window to tell
+	count = 10;
+	EXPECT(findLatencyOutliers(pool, latency).empty());
+}
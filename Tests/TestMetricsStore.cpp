@@ -0,0 +1,108 @@
+//
+//  TestMetricsStore.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaMetricsStore.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace zeta;
+
+namespace
+{
+	//! A fresh directory that is removed with its files at the end of the test
+	struct TemporaryDirectory
+	{
+		TemporaryDirectory()
+		{
+			char pattern[] = "/tmp/ZetaMetricsXXXXXX";
+			if (mkdtemp(pattern))
+				path = pattern;
+		}
+
+		~TemporaryDirectory()
+		{
+			if (DIR * dir = opendir(path.c_str()))
+			{
+				while (dirent * entry = readdir(dir))
+				{
+					if (entry->d_name[0] != '.')
+						unlink((path + "/" + entry->d_name).c_str());
+				}
+				closedir(dir);
+			}
+			rmdir(path.c_str());
+		}
+
+		std::string path;
+	};
+
+	std::time_t const day = 24 * 60 * 60;
+	std::time_t const start = 20000 * day;
+}
+
+ZETA_TEST(testMetricsRoundTrip)
+{
+	TemporaryDirectory dir;
+	std::vector<std::time_t> times;
+	{
+		MetricsStore store(dir.path);
+		// Regular polls past the size of a chunk, then a gap longer than a 16 bit delta
+		for (std::time_t t = start; t < start + 200 * 60; t += 60)
+			times.push_back(t);
+		times.push_back(start + 200 * 60 + 70000);
+		times.push_back(start + 200 * 60 + 70001);
+		for (size_t i = 0; i < times.size(); ++i)
+			store.append(times[i], {{1, Metric::alloc, i}, {2, Metric::alloc, 1000 + i}});
+		auto points = store.read(1, Metric::alloc, start, start + day);
+		EXPECT_EQ(points.size(), times.size());
+		for (size_t i = 0; i < points.size() && i < times.size(); ++i)
+		{
+			EXPECT_EQ(points[i].time, times[i]);
+			EXPECT_EQ(points[i].value, i);
+		}
+	}
+	// Reopened, both from the series file and the day file
+	MetricsStore store(dir.path);
+	auto points = store.read(2, Metric::alloc, start + 60, start + 120 * 60);
+	EXPECT_EQ(points.size(), 119u);
+	if (!points.empty())
+	{
+		EXPECT_EQ(points.front().time, start + 60);
+		EXPECT_EQ(points.front().value, 1001u);
+	}
+	store.append(times.back() + 5, {{2, Metric::alloc, 7}});
+	points = store.read(2, Metric::alloc, times.back(), start + day);
+	EXPECT_EQ(points.size(), 2u);
+	if (points.size() == 2)
+		EXPECT_EQ(points[1].time, times.back() + 5);
+	EXPECT(store.read(3, Metric::alloc, start, start + day).empty());
+}
+
+ZETA_TEST(testMetricsCompactAndExpire)
+{
+	TemporaryDirectory dir;
+	MetricsStore store(dir.path);
+	for (std::time_t t = start; t < start + 3 * day; t += 600)
+		store.append(t, {{1, Metric::space, uint64_t(t)}});
+	store.compact(start + 2 * day, std::chrono::hours(1));
+	auto points = store.read(1, Metric::space, start, start + day);
+	// The last record of each hour
+	EXPECT_EQ(points.size(), 24u);
+	if (!points.empty())
+		EXPECT_EQ(points.front().time, start + 3000);
+	EXPECT_EQ(store.read(1, Metric::space, start + 2 * day, start + 3 * day).size(), 144u);
+	store.expire(start + 2 * day);
+	EXPECT(store.read(1, Metric::space, start, start + 2 * day).empty());
+	EXPECT_EQ(store.read(1, Metric::space, start + 2 * day, start + 3 * day).size(), 144u);
+}
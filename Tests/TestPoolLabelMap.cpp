@@ -0,0 +1,222 @@
+//
+//  TestPoolLabelMap.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaPoolLabelMap.hpp"
+
+#include <algorithm>
+#include <set>
+
+using namespace zeta;
+
+namespace
+{
+	/*!
+	 Stand-in for DiskArbitration and the label reading helper. Describes a
+	 pool with top level vdevs of equal width, and hands out the label each of
+	 its devices would have when it appears.
+	 */
+	struct FakePool
+	{
+		FakePool(uint64_t poolGUID, std::string topType, uint64_t tops, uint64_t width,
+			uint64_t parity = 0) :
+			poolGUID(poolGUID), topType(std::move(topType)), tops(tops), width(width),
+			parity(parity) {}
+
+		std::string device(uint64_t top, uint64_t child) const
+		{
+			return "/dev/disk" + std::to_string(poolGUID) + "s" + std::to_string(top * width + child);
+		}
+
+		PoolLabel label(uint64_t top, uint64_t child) const
+		{
+			PoolLabel label;
+			label.device = device(top, child);
+			label.poolName = "pool" + std::to_string(poolGUID);
+			label.poolGUID = poolGUID;
+			label.poolState = state;
+			label.foreignHost = foreignHost;
+			label.txg = txg;
+			label.vdevChildren = tops;
+			label.guid = leaf(top, child);
+			label.topIndex = top;
+			label.topGUID = poolGUID * 1000 + top;
+			label.topType = topType;
+			label.topParity = parity;
+			for (uint64_t c = 0; c < width; ++c)
+				label.topChildren.push_back({leaf(top, c)});
+			return label;
+		}
+
+		uint64_t leaf(uint64_t top, uint64_t child) const
+		{
+			return poolGUID * 1000 + 100 + top * width + child;
+		}
+
+		uint64_t poolGUID;
+		std::string topType;
+		uint64_t tops;
+		uint64_t width;
+		uint64_t parity;
+		uint64_t state = poolStateExported;
+		bool foreignHost = false;
+		uint64_t txg = 10;
+	};
+
+	//! The label handling of ZetaAutoImporter, without libzfs and the timer
+	struct FakeImporter
+	{
+		ImportDecision appeared(PoolLabel label)
+		{
+			auto poolGUID = labels.deviceAppeared(std::move(label));
+			auto decision = decideImport(labels, poolGUID, importedBefore.count(poolGUID) > 0,
+				importedHere.count(poolGUID) > 0);
+			if (decision == ImportDecision::imported)
+				importedBefore.insert(poolGUID);
+			return decision;
+		}
+
+		uint64_t disappeared(std::string const & device)
+		{
+			auto poolGUID = labels.deviceDisappeared(device);
+			importedBefore.erase(poolGUID);
+			return poolGUID;
+		}
+
+		PoolLabelMap labels;
+		std::set<uint64_t> importedBefore;
+		std::set<uint64_t> importedHere;
+	};
+}
+
+ZETA_TEST(testLabelMapMirrorCompletes)
+{
+	FakePool pool(1, "mirror", 2, 2);
+	FakeImporter importer;
+	EXPECT(importer.appeared(pool.label(0, 0)) == ImportDecision::wait);
+	// One side of each mirror is enough
+	EXPECT(importer.appeared(pool.label(1, 1)) == ImportDecision::importable);
+	EXPECT(importer.appeared(pool.label(0, 1)) == ImportDecision::importable);
+	EXPECT_EQ(importer.labels.devices(1).size(), 3u);
+	// Losing both sides of a mirror makes it incomplete again
+	EXPECT_EQ(importer.disappeared(pool.device(1, 1)), 1u);
+	EXPECT(!importer.labels.complete(1));
+	EXPECT_EQ(importer.disappeared(pool.device(1, 1)), 0u);
+}
+
+ZETA_TEST(testLabelMapRaidzParity)
+{
+	FakePool pool(2, "raidz", 1, 5, 2);
+	FakeImporter importer;
+	EXPECT(importer.appeared(pool.label(0, 0)) == ImportDecision::wait);
+	EXPECT(importer.appeared(pool.label(0, 1)) == ImportDecision::wait);
+	EXPECT(importer.appeared(pool.label(0, 2)) == ImportDecision::importable);
+	importer.disappeared(pool.device(0, 0));
+	EXPECT(!importer.labels.complete(2));
+}
+
+ZETA_TEST(testLabelMapNewestLabel)
+{
+	FakePool pool(3, "disk", 2, 1);
+	FakeImporter importer;
+	importer.appeared(pool.label(0, 0));
+	// A device that was added later describes a pool with more top level vdevs
+	pool.txg = 20;
+	pool.tops = 3;
+	importer.appeared(pool.label(1, 0));
+	EXPECT_EQ(importer.labels.label(3)->txg, 20u);
+	EXPECT(!importer.labels.complete(3));
+	EXPECT(importer.appeared(pool.label(2, 0)) == ImportDecision::importable);
+	// The same device appearing again replaces its label
+	importer.appeared(pool.label(2, 0));
+	EXPECT_EQ(importer.labels.devices(3).size(), 3u);
+	EXPECT_EQ(importer.labels.pools().size(), 1u);
+}
+
+ZETA_TEST(testImportDecisionActivePools)
+{
+	// Not exported, last used on this system, for example before a crash
+	FakePool crashed(4, "mirror", 1, 2);
+	crashed.state = poolStateActive;
+	FakeImporter importer;
+	EXPECT(importer.appeared(crashed.label(0, 0)) == ImportDecision::importable);
+	// Not exported on another system
+	FakePool foreign(5, "disk", 1, 1);
+	foreign.state = poolStateActive;
+	foreign.foreignHost = true;
+	EXPECT(importer.appeared(foreign.label(0, 0)) == ImportDecision::foreignHost);
+	// Only pools that were not exported can be in use elsewhere
+	FakePool exported(6, "disk", 1, 1);
+	exported.foreignHost = true;
+	EXPECT(importer.appeared(exported.label(0, 0)) == ImportDecision::importable);
+}
+
+ZETA_TEST(testImportDecisionImportedPools)
+{
+	FakePool pool(7, "mirror", 1, 2);
+	pool.state = poolStateActive;
+	FakeImporter importer;
+	importer.importedHere.insert(7);
+	// A mirror side of an imported pool comes back, even while incomplete
+	EXPECT(importer.appeared(pool.label(0, 0)) == ImportDecision::imported);
+	EXPECT(importer.appeared(pool.label(0, 1)) == ImportDecision::ignore);
+	// Once exported, the pool is known until one of its devices disappears
+	importer.importedHere.clear();
+	pool.state = poolStateExported;
+	pool.txg = 11;
+	EXPECT(importer.appeared(pool.label(0, 1)) == ImportDecision::ignore);
+	importer.disappeared(pool.device(0, 1));
+	EXPECT(importer.appeared(pool.label(0, 1)) == ImportDecision::importable);
+}
+
+ZETA_TEST(testImportDecisionNotImportable)
+{
+	FakeImporter importer;
+	for (uint64_t state : {2, 3, 4, 5, 6})
+	{
+		FakePool pool(10 + state, "disk", 1, 1);
+		pool.state = state;
+		EXPECT(importer.appeared(pool.label(0, 0)) == ImportDecision::ignore);
+	}
+	EXPECT(decideImport(importer.labels, 99, false, false) == ImportDecision::ignore);
+}
+
+ZETA_TEST(testLabelMapEventSequence)
+{
+	// Devices of several pools appear interleaved, and some go away again
+	std::vector<FakePool> pools;
+	for (uint64_t p = 0; p < 8; ++p)
+		pools.emplace_back(20 + p, p % 2 ? "raidz" : "mirror", 1 + p % 3, 3, 1);
+	FakeImporter importer;
+	std::set<uint64_t> importable;
+	for (uint64_t child = 0; child < 3; ++child)
+	{
+		for (uint64_t top = 0; top < 3; ++top)
+		{
+			for (auto const & pool : pools)
+			{
+				if (top >= pool.tops)
+					continue;
+				if (importer.appeared(pool.label(top, child)) == ImportDecision::importable)
+					importable.insert(pool.poolGUID);
+			}
+		}
+		// A single side of each mirror is enough, raidz needs all but one
+		if (child == 0)
+			EXPECT_EQ(importable.size(), pools.size() / 2);
+	}
+	EXPECT_EQ(importable.size(), pools.size());
+	for (auto const & pool : pools)
+	{
+		importer.disappeared(pool.device(0, 0));
+		importer.disappeared(pool.device(0, 1));
+		EXPECT(pool.topType == "mirror" ? importer.labels.complete(pool.poolGUID) :
+			!importer.labels.complete(pool.poolGUID));
+	}
+}
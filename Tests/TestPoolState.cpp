@@ -0,0 +1,48 @@
+//
+//  TestPoolState.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaPoolStateFixture.hpp"
+
+using namespace zeta;
+
+ZETA_TEST(testSortedByGUID)
+{
+	std::vector<VDevState> vdevs(4);
+	uint64_t guids[] = { 30, 10, 40, 20 };
+	for (size_t i = 0; i < vdevs.size(); ++i)
+		vdevs[i].guid = guids[i];
+	auto order = sortedByGUID(vdevs);
+	EXPECT_EQ(order.size(), 4u);
+	for (size_t i = 1; i < order.size(); ++i)
+		EXPECT(vdevs[order[i-1]].guid < vdevs[order[i]].guid);
+}
+
+ZETA_TEST(testEncryptionRoots)
+{
+	auto state = fixture::systemState(2, 100);
+	auto locked = encryptionRoots(state, FileSystemState::KeyStatus::unavailable);
+	auto unlocked = encryptionRoots(state, FileSystemState::KeyStatus::available);
+	// Datasets 5, 25 and 45 of each pool are unlocked, 15 and 35 locked
+	EXPECT_EQ(locked.size(), 4u);
+	EXPECT_EQ(unlocked.size(), 6u);
+	for (auto fs : locked)
+		EXPECT(fs->isEncryptionRoot && fs->keyStatus == FileSystemState::KeyStatus::unavailable);
+}
+
+ZETA_TEST(testFixtureTree)
+{
+	auto state = fixture::systemState(1, 111);
+	auto const & pool = state.pools[0];
+	EXPECT_EQ(pool.fileSystems.size(), 111u);
+	EXPECT_EQ(pool.datasets.size(), 111u);
+	auto fs = pool.datasets.find("pool0/fs1/fs11");
+	EXPECT(fs != noDataset);
+	EXPECT_EQ(pool.datasets.depth(fs), 2u);
+	EXPECT_EQ(pool.datasets.name(pool.datasets.parent(fs)), std::string("pool0/fs1"));
+}
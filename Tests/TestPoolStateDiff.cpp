@@ -0,0 +1,123 @@
+//
+//  TestPoolStateDiff.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaPoolStateFixture.hpp"
+
+#include "ZetaPoolStateDiff.hpp"
+
+#include <algorithm>
+
+using namespace zeta;
+
+typedef PoolStateChange::Kind Kind;
+
+static size_t count(std::vector<PoolStateChange> const & changes, Kind kind)
+{
+	return size_t(std::count_if(changes.begin(), changes.end(),
+		[&](PoolStateChange const & c) { return c.kind == kind; }));
+}
+
+ZETA_TEST(testDiffIdentical)
+{
+	auto state = fixture::systemState(3, 300);
+	EXPECT(diffSystemState(state, state).empty());
+}
+
+ZETA_TEST(testDiffPoolsAddedAndRemoved)
+{
+	auto before = fixture::systemState(3, 30);
+	auto after = before;
+	after.pools.erase(after.pools.begin());
+	after.poolsByGUID = sortedByGUID(after.pools);
+	auto changes = diffSystemState(before, after);
+	EXPECT_EQ(changes.size(), 1u);
+	EXPECT_EQ(count(changes, Kind::poolRemoved), 1u);
+	EXPECT_EQ(changes[0].poolName, std::string("pool0"));
+	// A new pool with errors reports them once
+	after = before;
+	before.pools.pop_back();
+	before.poolsByGUID = sortedByGUID(before.pools);
+	after.pools.back().vdevs[3].stat.errorChecksum = 7;
+	changes = diffSystemState(before, after);
+	EXPECT_EQ(count(changes, Kind::poolAdded), 1u);
+	EXPECT_EQ(count(changes, Kind::vdevErrorsIncreased), 1u);
+}
+
+ZETA_TEST(testDiffVDevs)
+{
+	auto before = fixture::systemState(1, 10);
+	auto after = before;
+	after.pools[0].vdevs[2].stat.state = 5;
+	after.pools[0].vdevs[4].stat.errorRead = 3;
+	after.pools[0].vdevs[4].stat.errorWrite = 1;
+	auto changes = diffSystemState(before, after);
+	EXPECT_EQ(changes.size(), 2u);
+	EXPECT_EQ(count(changes, Kind::vdevStateChanged), 1u);
+	auto errors = std::find_if(changes.begin(), changes.end(),
+		[](PoolStateChange const & c) { return c.kind == Kind::vdevErrorsIncreased; });
+	EXPECT(errors != changes.end());
+	if (errors != changes.end())
+	{
+		EXPECT_EQ(errors->vdevGUID, after.pools[0].vdevs[4].guid);
+		EXPECT_EQ(errors->errorRead, 3u);
+		EXPECT_EQ(errors->errorWrite, 1u);
+		EXPECT_EQ(errors->errorChecksum, 0u);
+	}
+	// Errors that were cleared are not an increase
+	EXPECT(diffSystemState(after, before).size() == 1);
+}
+
+ZETA_TEST(testDiffScan)
+{
+	auto before = fixture::systemState(1, 10);
+	auto after = before;
+	after.pools[0].scan.state = ScanStatus::scanning;
+	after.pools[0].scan.scanStartTime = 100;
+	EXPECT_EQ(count(diffSystemState(before, after), Kind::scanStateChanged), 1u);
+	before = after;
+	after.pools[0].scan.issued = 4096;
+	auto changes = diffSystemState(before, after);
+	EXPECT_EQ(count(changes, Kind::scanProgressed), 1u);
+	EXPECT_EQ(changes[0].newValue, 4096u);
+}
+
+ZETA_TEST(testDiffFileSystems)
+{
+	auto before = fixture::systemState(1, 100);
+	auto after = before;
+	auto & fileSystems = after.pools[0].fileSystems;
+	fileSystems[3].mounted = !fileSystems[3].mounted;
+	fileSystems[15].keyStatus = FileSystemState::KeyStatus::available;
+	// Changes of datasets that are not encryption roots are not key events
+	fileSystems[16].keyStatus = FileSystemState::KeyStatus::available;
+	auto changes = diffSystemState(before, after);
+	EXPECT_EQ(changes.size(), 2u);
+	EXPECT_EQ(count(changes, fileSystems[3].mounted ? Kind::fileSystemMounted : Kind::fileSystemUnmounted), 1u);
+	EXPECT_EQ(count(changes, Kind::keyLoaded), 1u);
+}
+
+ZETA_TEST(testDiffIndependentOfOrder)
+{
+	auto before = fixture::systemState(3, 300);
+	auto after = before;
+	after.pools[1].fileSystems[42].mounted = !after.pools[1].fileSystems[42].mounted;
+	std::reverse(after.pools.begin(), after.pools.end());
+	for (auto & pool : after.pools)
+		std::reverse(pool.fileSystems.begin(), pool.fileSystems.end());
+	// Stale orders are ignored, missing ones are computed
+	after.poolsByGUID.clear();
+	for (auto & pool : after.pools)
+		pool.fileSystemsByName.clear();
+	auto changes = diffSystemState(before, after);
+	EXPECT_EQ(changes.size(), 1u);
+	after.poolsByGUID = sortedByGUID(after.pools);
+	for (auto & pool : after.pools)
+		pool.fileSystemsByName = sortedByName(pool.fileSystems);
+	EXPECT_EQ(diffSystemState(before, after).size(), 1u);
+}
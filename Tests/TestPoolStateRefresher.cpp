@@ -0,0 +1,145 @@
+//
+//  TestPoolStateRefresher.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaPoolStateRefresher.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace zeta;
+
+namespace
+{
+	//! Each load is a generation, every pool of it has the generation as status
+	SystemState loadGeneration(uint64_t generation, size_t poolCount,
+		PoolStateRefresher::PoolCallback const & poolLoaded)
+	{
+		SystemState state;
+		for (size_t p = 0; p < poolCount; ++p)
+		{
+			PoolState pool;
+			pool.name = "pool" + std::to_string(p);
+			pool.guid = p + 1;
+			pool.status = generation;
+			state.pools.push_back(pool);
+			poolLoaded(pool);
+			std::this_thread::yield();
+		}
+		state.poolsByGUID = sortedByGUID(state.pools);
+		state.refreshTime = std::chrono::system_clock::now();
+		return state;
+	}
+
+	/*!
+	 Pools read by the refresh in progress are of one generation, stale ones
+	 of an older one. A complete snapshot has only pools of one generation.
+	 */
+	bool consistent(SystemState const & state, bool complete)
+	{
+		uint64_t fresh = 0;
+		uint64_t newestStale = 0;
+		for (auto const & pool : state.pools)
+		{
+			if (pool.stale)
+			{
+				if (complete)
+					return false;
+				newestStale = std::max(newestStale, pool.status);
+			}
+			else if (fresh == 0)
+				fresh = pool.status;
+			else if (pool.status != fresh)
+				return false;
+		}
+		return fresh == 0 || newestStale < fresh;
+	}
+}
+
+ZETA_TEST(testPoolStateRefresherGenerations)
+{
+	size_t const poolCount = 6;
+	std::atomic<uint64_t> loads(0);
+	std::atomic<uint64_t> inconsistent(0);
+	std::atomic<uint64_t> completeGeneration(0);
+	std::atomic<uint64_t> outOfOrder(0);
+	PoolStateRefresher refresher(
+		[&](PoolStateRefresher::PoolCallback const & poolLoaded)
+		{
+			return loadGeneration(++loads, poolCount, poolLoaded);
+		},
+		[&](std::shared_ptr<SystemState const> const & state, bool complete)
+		{
+			if (!consistent(*state, complete))
+				++inconsistent;
+			if (complete)
+			{
+				// The snapshot passed along is the completed one, even if others follow
+				auto generation = state->pools.front().status;
+				if (generation != loads || generation <= completeGeneration)
+					++outOfOrder;
+				completeGeneration = generation;
+			}
+		});
+	std::atomic<bool> stop(false);
+	std::atomic<uint64_t> reads(0);
+	std::thread reader([&]
+	{
+		while (!stop)
+		{
+			if (!consistent(*refresher.state(), false))
+				++inconsistent;
+			++reads;
+		}
+	});
+	for (size_t i = 0; i < 200; ++i)
+	{
+		refresher.requestRefresh();
+		if (i % 10 == 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+	EXPECT(refresher.waitForRefresh(std::chrono::seconds(10)));
+	stop = true;
+	reader.join();
+	EXPECT_EQ(inconsistent.load(), 0u);
+	EXPECT_EQ(outOfOrder.load(), 0u);
+	EXPECT(reads.load() > 0);
+	auto state = refresher.state();
+	EXPECT(consistent(*state, true));
+	EXPECT_EQ(state->pools.size(), poolCount);
+	EXPECT_EQ(state->pools.front().status, loads.load());
+	EXPECT_EQ(completeGeneration.load(), loads.load());
+	EXPECT(!refresher.isRefreshing());
+}
+
+ZETA_TEST(testPoolStateRefresherPartialState)
+{
+	// While refreshing, pools not read yet are marked stale, the rest is the new generation
+	typedef std::vector<std::pair<size_t, size_t>> Counts; //!< Pools and stale pools
+	std::atomic<uint64_t> loads(0);
+	Counts partials;
+	PoolStateRefresher refresher(
+		[&](PoolStateRefresher::PoolCallback const & poolLoaded)
+		{
+			return loadGeneration(++loads, 3, poolLoaded);
+		},
+		[&](std::shared_ptr<SystemState const> const & state, bool complete)
+		{
+			size_t stale = 0;
+			for (auto const & pool : state->pools)
+				stale += pool.stale;
+			if (!complete && loads == 2)
+				partials.emplace_back(state->pools.size(), stale);
+		});
+	refresher.requestRefresh();
+	EXPECT(refresher.waitForRefresh(std::chrono::seconds(10)));
+	refresher.requestRefresh();
+	EXPECT(refresher.waitForRefresh(std::chrono::seconds(10)));
+	EXPECT(partials == Counts({{3, 2}, {3, 1}, {3, 0}}));
+}
@@ -0,0 +1,93 @@
+//
+//  TestPropertyTable.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "MockLibZFS.hpp"
+
+using namespace zeta;
+
+static std::vector<DatasetProperty> const allProperties =
+{
+	DatasetProperty::mounted,
+	DatasetProperty::mountable,
+	DatasetProperty::encryptionRoot,
+	DatasetProperty::keyStatus,
+	DatasetProperty::available,
+	DatasetProperty::used,
+	DatasetProperty::referenced,
+	DatasetProperty::logicalused,
+	DatasetProperty::compressRatio,
+	DatasetProperty::mountpoint,
+};
+
+ZETA_TEST(testPropertyListNames)
+{
+	DatasetProperty property;
+	EXPECT(propertyFromListName("compressratio", property));
+	EXPECT(property == DatasetProperty::compressRatio);
+	EXPECT(propertyFromListName("keystatus", property));
+	EXPECT(property == DatasetProperty::keyStatus);
+	EXPECT(!propertyFromListName("mountpoint", property));
+	EXPECT(!propertyFromListName("usedbysnapshots", property));
+	for (auto p : allProperties)
+		EXPECT_EQ(inPropertyList(p), propertyKind(p) != PropertyKind::string &&
+			p != DatasetProperty::mounted && p != DatasetProperty::mountable);
+}
+
+ZETA_TEST(testListValues)
+{
+	PropertyTable table({DatasetProperty::compressRatio, DatasetProperty::used}, 2);
+	table.setListValue(DatasetProperty::compressRatio, 1, 150);
+	table.setListValue(DatasetProperty::used, 0, 42);
+	EXPECT_EQ(table.real(DatasetProperty::compressRatio, 1), 1.5);
+	EXPECT_EQ(table.real(DatasetProperty::compressRatio, 0), 0.0);
+	EXPECT_EQ(table.numeric(DatasetProperty::used, 0), 42u);
+}
+
+ZETA_TEST(testBatchedMatchesPerProperty)
+{
+	auto zfs = mock::libZFS(100);
+	auto perProperty = fetchProperties(mock::PerPropertyBackend(zfs), allProperties);
+	auto perPropertyCalls = zfs.calls;
+	zfs.calls = 0;
+	auto batched = fetchProperties(mock::BatchedBackend(zfs), allProperties);
+	for (size_t i = 0; i < 100; ++i)
+	{
+		for (auto p : allProperties)
+		{
+			switch (propertyKind(p))
+			{
+				case PropertyKind::numeric:
+					EXPECT_EQ(batched.numeric(p, i), perProperty.numeric(p, i));
+					break;
+				case PropertyKind::real:
+					EXPECT_EQ(batched.real(p, i), perProperty.real(p, i));
+					break;
+				case PropertyKind::string:
+					EXPECT_EQ(batched.string(p, i), perProperty.string(p, i));
+					break;
+			}
+		}
+	}
+	EXPECT_EQ(batched.numeric(DatasetProperty::encryptionRoot, 5), 1u);
+	EXPECT_EQ(batched.numeric(DatasetProperty::encryptionRoot, 6), 0u);
+	EXPECT_EQ(batched.numeric(DatasetProperty::keyStatus, 6), 2u);
+	EXPECT_EQ(batched.numeric(DatasetProperty::keyStatus, 7), 0u);
+	// One property list per dataset, plus the three computed properties
+	EXPECT_EQ(perPropertyCalls, 10u * 100);
+	EXPECT_EQ(zfs.calls, 4u * 100);
+}
+
+ZETA_TEST(testBatchedSkipsListWhenUnneeded)
+{
+	auto zfs = mock::libZFS(10);
+	auto table = fetchProperties(mock::BatchedBackend(zfs), {DatasetProperty::mounted});
+	EXPECT_EQ(zfs.calls, 10u);
+	EXPECT_EQ(table.numeric(DatasetProperty::mounted, 0), 0u);
+	EXPECT_EQ(table.numeric(DatasetProperty::mounted, 1), 1u);
+}
@@ -0,0 +1,158 @@
+//
+//  TestRetention.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaRetention.hpp"
+
+#include <limits>
+
+using namespace zeta;
+
+namespace
+{
+	//! 2026-10-16 00:00:00 UTC, a friday
+	constexpr int64_t friday = 1792108800;
+	constexpr int64_t hour = 3600;
+	constexpr int64_t day = 86400;
+}
+
+ZETA_TEST(testRetentionPeriods)
+{
+	EXPECT_EQ(periodStart(RetentionPeriod::day, periodIndex(RetentionPeriod::day, friday + 5, 0), 0), friday);
+	// Weeks start on monday, 2026-10-12
+	EXPECT_EQ(periodStart(RetentionPeriod::week, periodIndex(RetentionPeriod::week, friday, 0), 0), friday - 4 * day);
+	EXPECT_EQ(periodStart(RetentionPeriod::month, periodIndex(RetentionPeriod::month, friday, 0), 0), 1790812800);
+	EXPECT_EQ(periodStart(RetentionPeriod::month, periodIndex(RetentionPeriod::month, friday, 0) + 1, 0), 1793491200);
+	// Two hours east of UTC, local midnight is at 22:00 UTC
+	int64_t offset = 2 * hour;
+	EXPECT_EQ(periodStart(RetentionPeriod::day, periodIndex(RetentionPeriod::day, friday - hour, offset), offset),
+		friday - offset);
+	// Before the epoch
+	EXPECT_EQ(periodIndex(RetentionPeriod::day, -1, 0), -1);
+	EXPECT_EQ(periodIndex(RetentionPeriod::week, -day, 0), 0);
+	EXPECT_EQ(periodIndex(RetentionPeriod::week, -4 * day, 0), -1);
+}
+
+ZETA_TEST(testPlanPruningHourly)
+{
+	// A snapshot every 15 minutes over a day
+	std::vector<int64_t> times;
+	for (int64_t t = friday; t < friday + day; t += 15 * 60)
+		times.push_back(t);
+	RetentionPolicy policy;
+	policy.hourly = 6;
+	auto prune = planPruning(times, policy, 0);
+	EXPECT_EQ(prune.size(), times.size() - 6);
+	// The newest of each of the last six hours is kept
+	for (size_t i = 0; i < prune.size(); ++i)
+	{
+		bool lastOfHour = (times[prune[i]] - friday) % hour == 45 * 60;
+		bool recent = times[prune[i]] >= friday + 18 * hour;
+		EXPECT(!(lastOfHour && recent));
+	}
+	EXPECT_EQ(prune.back(), times.size() - 2);
+}
+
+ZETA_TEST(testPlanPruningCombined)
+{
+	// Daily snapshots at noon over 90 days, ending on a friday
+	std::vector<int64_t> times;
+	for (int64_t d = 89; d >= 0; --d)
+		times.push_back(friday - d * day + 12 * hour);
+	RetentionPolicy policy;
+	policy.daily = 7;
+	policy.weekly = 4;
+	policy.monthly = 3;
+	auto prune = planPruning(times, policy, 0);
+	std::vector<bool> kept(times.size(), true);
+	for (auto i : prune)
+		kept[i] = false;
+	size_t keptCount = 0;
+	for (bool k : kept)
+		keptCount += k ? 1 : 0;
+	// 7 days, which include the sunday of last week, the sundays of the two
+	// weeks before, and the ends of august and september
+	EXPECT_EQ(keptCount, 7u + 2u + 2u);
+	for (size_t i = times.size() - 7; i < times.size(); ++i)
+		EXPECT(kept[i]);
+	EXPECT(kept[times.size() - 1 - 12]); // sunday 2026-10-04
+	EXPECT(!kept[times.size() - 1 - 13]);
+	EXPECT(kept[times.size() - 1 - 16]); // 2026-09-30
+	// Pruning is stable, the kept snapshots are kept again
+	std::vector<int64_t> remaining;
+	for (size_t i = 0; i < times.size(); ++i)
+	{
+		if (kept[i])
+			remaining.push_back(times[i]);
+	}
+	EXPECT(planPruning(remaining, policy, 0).empty());
+}
+
+ZETA_TEST(testPlanPruningEmptyPolicy)
+{
+	std::vector<int64_t> times = {friday, friday + hour};
+	EXPECT(planPruning(times, RetentionPolicy(), 0).empty());
+	RetentionPolicy policy;
+	policy.daily = 1;
+	EXPECT(planPruning({}, policy, 0).empty());
+	// Snapshots in the same period, only the newest is kept
+	auto prune = planPruning(times, policy, 0);
+	EXPECT_EQ(prune.size(), 1u);
+	EXPECT_EQ(prune[0], 0u);
+}
+
+ZETA_TEST(testNextSnapshotTime)
+{
+	RetentionPolicy policy;
+	policy.daily = 7;
+	policy.weekly = 4;
+	EXPECT_EQ(nextSnapshotTime(0, false, policy, 0), std::numeric_limits<int64_t>::min());
+	// The shortest period decides
+	EXPECT_EQ(nextSnapshotTime(friday + 5 * hour, true, policy, 0), friday + day);
+	EXPECT_EQ(nextSnapshotTime(friday, true, policy, 0), friday + day);
+	policy.hourly = 24;
+	EXPECT_EQ(nextSnapshotTime(friday + 5 * hour + 10, true, policy, 0), friday + 6 * hour);
+	RetentionPolicy weekly;
+	weekly.weekly = 1;
+	EXPECT_EQ(nextSnapshotTime(friday, true, weekly, 0), friday + 3 * day);
+	// Local midnight two hours east of UTC
+	RetentionPolicy daily;
+	daily.daily = 1;
+	EXPECT_EQ(nextSnapshotTime(friday, true, daily, 2 * hour), friday + day - 2 * hour);
+	EXPECT_EQ(nextSnapshotTime(friday, true, RetentionPolicy(), 0), std::numeric_limits<int64_t>::max());
+}
+
+ZETA_TEST(testAutoSnapshotName)
+{
+	int64_t time = friday + 13 * hour + 7 * 60 + 9;
+	EXPECT_EQ(autoSnapshotName(time), std::string("ZetaAuto-2026-10-16-13-07-09"));
+	int64_t parsed = 0;
+	EXPECT(parseAutoSnapshotName(autoSnapshotName(time), parsed));
+	EXPECT_EQ(parsed, time);
+	// Leap day and before the epoch round trip
+	for (int64_t t : {int64_t(1709164800 + 59), int64_t(-day + 1), int64_t(0)})
+	{
+		EXPECT(parseAutoSnapshotName(autoSnapshotName(t), parsed));
+		EXPECT_EQ(parsed, t);
+	}
+}
+
+ZETA_TEST(testParseAutoSnapshotNameRejects)
+{
+	int64_t time = 42;
+	EXPECT(!parseAutoSnapshotName("", time));
+	EXPECT(!parseAutoSnapshotName("manual-2026-10-16-13-07-09", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026-10-16-13-07", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026-10-16-13-07-09x", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026-13-16-13-07-09", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026-10-00-13-07-09", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026-1a-16-13-07-09", time));
+	EXPECT(!parseAutoSnapshotName("ZetaAuto-2026_10-16-13-07-09", time));
+	EXPECT_EQ(time, 42);
+}
@@ -0,0 +1,61 @@
+//
+//  TestSnapshotBatch.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaSnapshotBatch.hpp"
+
+#include <cerrno>
+
+using namespace zeta;
+
+ZETA_TEST(testGroupByPool)
+{
+	auto pools = groupByPool({"tank/a@s", "backup@s", "tank@s", "tank/a/b@s", "backup/x@s"});
+	EXPECT_EQ(pools.size(), 2u);
+	EXPECT_EQ(pools["tank"].size(), 3u);
+	EXPECT_EQ(pools["tank"][1], std::string("tank@s"));
+	EXPECT_EQ(pools["backup"].size(), 2u);
+	EXPECT(groupByPool({}).empty());
+}
+
+ZETA_TEST(testBatchFailuresSucceeded)
+{
+	std::map<std::string, int> failures;
+	addBatchFailures(0, {}, {"tank@a", "tank/x@a"}, failures);
+	EXPECT(failures.empty());
+}
+
+ZETA_TEST(testBatchFailuresAllOrNothing)
+{
+	std::vector<std::string> names = {"tank@a", "tank/x@a", "tank/y@a"};
+	// Only the snapshot that caused it is listed, the others were not created either
+	std::map<std::string, int> failures;
+	addBatchFailures(EEXIST, {{"tank/x@a", EEXIST}}, names, failures);
+	EXPECT_EQ(failures.size(), 3u);
+	EXPECT_EQ(failures["tank/x@a"], EEXIST);
+	EXPECT_EQ(failures["tank@a"], EEXIST);
+	// Listed errors take precedence over the error of the call
+	failures.clear();
+	addBatchFailures(EBUSY, {{"tank@a", EEXIST}, {"tank/y@a", ENOENT}}, names, failures);
+	EXPECT_EQ(failures["tank@a"], EEXIST);
+	EXPECT_EQ(failures["tank/x@a"], EBUSY);
+	EXPECT_EQ(failures["tank/y@a"], ENOENT);
+}
+
+ZETA_TEST(testBatchFailuresUnlistedEntries)
+{
+	std::map<std::string, int> failures;
+	addBatchFailures(ENOSPC, {{"N_MORE_ERRORS", 4}}, {"tank@a"}, failures);
+	EXPECT_EQ(failures.size(), 1u);
+	EXPECT_EQ(failures["tank@a"], ENOSPC);
+	// Failures of other pools are kept
+	addBatchFailures(EBUSY, {}, {"backup@a"}, failures);
+	EXPECT_EQ(failures.size(), 2u);
+	EXPECT_EQ(failures["tank@a"], ENOSPC);
+}
@@ -0,0 +1,150 @@
+//
+//  TestSnapshotIndex.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaSnapshotIndex.hpp"
+
+using namespace zeta;
+
+namespace
+{
+	//! A local time, so that the stamps don't depend on the time zone of the test
+	std::time_t localTime(int year, int month, int day, int hour, int minute = 20)
+	{
+		std::tm t = {};
+		t.tm_year = year - 1900;
+		t.tm_mon = month - 1;
+		t.tm_mday = day;
+		t.tm_hour = hour;
+		t.tm_min = minute;
+		t.tm_isdst = -1;
+		return std::mktime(&t);
+	}
+
+	std::vector<std::string> shortNames(SnapshotIndex const & index, std::vector<uint32_t> const & selection)
+	{
+		std::vector<std::string> names;
+		for (auto i : selection)
+			names.emplace_back(index.shortName(i));
+		return names;
+	}
+}
+
+ZETA_TEST(testParseSnapshotStamp)
+{
+	EXPECT_EQ(parseSnapshotStamp("daily-2026-10-16-1200"), 2026101612u);
+	EXPECT_EQ(parseSnapshotStamp("autosnap_2026-10-16_12:00:00_hourly"), 2026101612u);
+	EXPECT_EQ(parseSnapshotStamp("2026-10-16T08"), 2026101608u);
+	EXPECT_EQ(parseSnapshotStamp("20261016"), 2026101600u);
+	EXPECT_EQ(parseSnapshotStamp("zfs-auto-snap_weekly-2026.10.16"), 2026101600u);
+	// An hour that isn't one is ignored, the date still counts
+	EXPECT_EQ(parseSnapshotStamp("2026-10-16-2500"), 2026101600u);
+	// Malformed dates
+	EXPECT_EQ(parseSnapshotStamp(""), 0u);
+	EXPECT_EQ(parseSnapshotStamp("manual"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("2026-10"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("2026-13-01"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("2026-10-32"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("2026-00-10"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("1969-12-31"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("2026-1-16"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("12026-10-16"), 0u);
+	EXPECT_EQ(parseSnapshotStamp("v3-2026-10-1x"), 0u);
+}
+
+ZETA_TEST(testSnapshotStamp)
+{
+	EXPECT_EQ(snapshotStamp(localTime(2026, 10, 16, 12)), 2026101612u);
+	EXPECT_EQ(snapshotStamp(localTime(2025, 12, 31, 23, 50)), 2025123123u);
+	EXPECT_EQ(snapshotStamp(localTime(2026, 1, 1, 0, 5)), 2026010100u);
+}
+
+ZETA_TEST(testSnapshotIndexOrder)
+{
+	// Iterated in another order than created, with names that sort the other way
+	SnapshotIndex index("tank/fs");
+	index.append("tank/fs@c", localTime(2026, 10, 1, 12), 300, 0, false);
+	index.append("tank/fs@a", localTime(2026, 10, 3, 12), 500, 0, false);
+	index.append("tank/fs@b", localTime(2026, 10, 2, 12), 400, 2, true);
+	index.append("tank/fs@z", localTime(2026, 9, 30, 12), 100, 0, false);
+	EXPECT_EQ(index.size(), 4u);
+	EXPECT_EQ(index[0].createTXG, 100u);
+	EXPECT_EQ(index.name(3), "tank/fs@a");
+	EXPECT(shortNames(index, index.select("")) == std::vector<std::string>({"a", "b", "c", "z"}));
+	EXPECT(shortNames(index, index.select("B")) == std::vector<std::string>({"b"}));
+	EXPECT(index.select("nothing").empty());
+	EXPECT_EQ(index[2].cloneCount, 2u);
+	EXPECT(index[2].mounted);
+}
+
+ZETA_TEST(testSnapshotIndexGroupByCreation)
+{
+	SnapshotIndex index("tank/fs");
+	// The name claims a different date than the creation, the creation wins
+	index.append("tank/fs@daily-2020-01-01", localTime(2025, 12, 15, 12), 10, 0, false);
+	index.append("tank/fs@before-upgrade", localTime(2026, 9, 15, 12), 20, 0, false);
+	index.append("tank/fs@manual", localTime(2026, 10, 15, 9), 30, 0, false);
+	index.append("tank/fs@manual2", localTime(2026, 10, 15, 12), 40, 0, false);
+	// Without a creation time, the name is all there is
+	index.append("tank/fs@hourly-2026-10-16-1400", 0, 50, 0, false);
+	index.append("tank/fs@unknown", 0, 60, 0, false);
+
+	auto selection = index.select("");
+	auto months = index.group(selection, SnapshotGrouping::month);
+	EXPECT_EQ(months.size(), 4u);
+	EXPECT_EQ(months[0].key, 202610u);
+	EXPECT_EQ(months[0].end - months[0].begin, 3u);
+	EXPECT_EQ(months[1].key, 202609u);
+	EXPECT_EQ(months[2].key, 202512u);
+	EXPECT_EQ(months[3].key, 0u);
+	EXPECT(shortNames(index, selection) == std::vector<std::string>(
+		{"hourly-2026-10-16-1400", "manual2", "manual", "before-upgrade", "daily-2020-01-01", "unknown"}));
+	EXPECT_EQ(formatSnapshotGroup(months[2].key, SnapshotGrouping::month), "2025-12");
+
+	selection = index.select("");
+	auto days = index.group(selection, SnapshotGrouping::day);
+	EXPECT_EQ(days.size(), 5u);
+	EXPECT_EQ(days[0].key, 20261016u);
+	EXPECT_EQ(days[1].key, 20261015u);
+	EXPECT_EQ(days[1].end - days[1].begin, 2u);
+	EXPECT_EQ(formatSnapshotGroup(days[1].key, SnapshotGrouping::day), "2026-10-15");
+
+	selection = index.select("manual");
+	auto hours = index.group(selection, SnapshotGrouping::hour);
+	EXPECT_EQ(hours.size(), 2u);
+	EXPECT_EQ(formatSnapshotGroup(hours[1].key, SnapshotGrouping::hour), "2026-10-15 09:00");
+
+	selection = index.select("");
+	auto none = index.group(selection, SnapshotGrouping::none);
+	EXPECT_EQ(none.size(), 1u);
+	EXPECT_EQ(none[0].end, 6u);
+}
+
+ZETA_TEST(testSnapshotIndexCacheExpiry)
+{
+	typedef SnapshotIndexCache::Clock Clock;
+	SnapshotIndexCache cache(std::chrono::seconds(60));
+	auto start = Clock::now();
+	cache.insert(std::make_shared<SnapshotIndex>("tank/a"), start);
+	cache.insert(std::make_shared<SnapshotIndex>("tank/b"), start + std::chrono::seconds(30));
+	EXPECT(cache.find("tank/a", start + std::chrono::seconds(60)) != nullptr);
+	EXPECT(cache.find("tank/c", start) == nullptr);
+	// Expired entries are removed when they are looked up
+	EXPECT(cache.find("tank/a", start + std::chrono::seconds(61)) == nullptr);
+	EXPECT_EQ(cache.size(), 1u);
+	// And by the next insert, even if they are never looked up again
+	cache.insert(std::make_shared<SnapshotIndex>("tank/c"), start + std::chrono::seconds(100));
+	EXPECT_EQ(cache.size(), 1u);
+	EXPECT(cache.find("tank/c", start + std::chrono::seconds(100)) != nullptr);
+	// Inserting again restarts the age
+	cache.insert(std::make_shared<SnapshotIndex>("tank/c"), start + std::chrono::seconds(150));
+	EXPECT(cache.find("tank/c", start + std::chrono::seconds(200)) != nullptr);
+	cache.clear();
+	EXPECT_EQ(cache.size(), 0u);
+}
@@ -0,0 +1,95 @@
+//
+//  TestTimerWheel.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include "ZetaTimerWheel.hpp"
+
+#include <algorithm>
+#include <map>
+
+using namespace zeta;
+
+ZETA_TEST(testTimerWheelNeverEarly)
+{
+	TimerWheel wheel(60, 8, 1000);
+	wheel.schedule(1, 1130);
+	wheel.schedule(2, 1140);
+	// 1139 is in the tick of 1130, but before it
+	EXPECT(wheel.advance(1139).empty());
+	auto expired = wheel.advance(1140);
+	std::sort(expired.begin(), expired.end());
+	EXPECT_EQ(expired.size(), 2u);
+	EXPECT_EQ(wheel.size(), 0u);
+}
+
+ZETA_TEST(testTimerWheelReschedule)
+{
+	TimerWheel wheel(10, 4, 0);
+	wheel.schedule(1, 25);
+	wheel.schedule(2, 25);
+	wheel.schedule(1, 55);
+	wheel.cancel(2);
+	EXPECT(!wheel.scheduled(2));
+	EXPECT(wheel.advance(50).empty());
+	// A later round of the same slots, and the stale entry is dropped
+	auto expired = wheel.advance(60);
+	EXPECT_EQ(expired.size(), 1u);
+	EXPECT_EQ(expired[0], 1u);
+	// Deadlines in the past expire on the next advance
+	wheel.schedule(3, -100);
+	EXPECT(wheel.advance(60).empty());
+	EXPECT_EQ(wheel.advance(70).size(), 1u);
+}
+
+ZETA_TEST(testTimerWheelLongPause)
+{
+	TimerWheel wheel(60, 16, 0);
+	for (uint64_t id = 0; id < 100; ++id)
+		wheel.schedule(id, int64_t(id) * 97);
+	// Far beyond a whole round, every timer expires exactly once
+	auto expired = wheel.advance(1000000);
+	EXPECT_EQ(expired.size(), 100u);
+	EXPECT_EQ(wheel.size(), 0u);
+	wheel.schedule(5, 1000000 + 1);
+	wheel.clear();
+	EXPECT(wheel.advance(2000000).empty());
+}
+
+ZETA_TEST(testTimerWheelAgainstReference)
+{
+	// Random deadlines, compared with a map ordered by deadline
+	TimerWheel wheel(60, 32, 0);
+	std::map<uint64_t, int64_t> reference;
+	uint64_t seed = 12345;
+	auto next = [&] { seed = seed * 6364136223846793005ull + 1442695040888963407ull; return seed >> 33; };
+	int64_t now = 0;
+	for (int step = 0; step < 2000; ++step)
+	{
+		uint64_t id = next() % 50;
+		int64_t deadline = now + int64_t(next() % 5000);
+		wheel.schedule(id, deadline);
+		reference[id] = deadline;
+		now += int64_t(next() % 90);
+		auto expired = wheel.advance(now);
+		for (auto id : expired)
+		{
+			auto it = reference.find(id);
+			EXPECT(it != reference.end());
+			if (it == reference.end())
+				continue;
+			// Never early, and late by less than one tick
+			EXPECT(it->second <= now);
+			EXPECT(now - it->second < 60 + 90);
+			reference.erase(it);
+		}
+		for (auto const & r : reference)
+			EXPECT(r.second > now - 60);
+	}
+	EXPECT_EQ(wheel.size(), reference.size());
+}
@@ -0,0 +1,127 @@
+//
+//  TestVDevDecoder.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+#include "ZetaVDevFixture.hpp"
+
+#include "ZetaVDevDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace zeta;
+
+ZETA_TEST(testVDevDecoderFields)
+{
+	fixture::VDevTree tree;
+	auto leaf = tree.leaf(1, 1002, "/dev/disk3s1", true);
+	auto f = decodeVDev(leaf);
+	EXPECT_EQ(f.guid, 1002u);
+	EXPECT(f.type && std::strcmp(f.type, "disk") == 0);
+	EXPECT(f.path && std::strcmp(f.path, "/dev/disk3s1") == 0);
+	EXPECT_EQ(f.statCount, fixture::VDevTree::statCount);
+	EXPECT(f.statsEx != nullptr);
+	EXPECT_EQ(f.childCount, 0u);
+	// The kernel doesn't promise an order, the decoder doesn't depend on one
+	std::reverse(leaf->pairs.begin(), leaf->pairs.end());
+	auto reversed = decodeVDev(leaf);
+	EXPECT_EQ(reversed.guid, 1002u);
+	EXPECT(reversed.path && std::strcmp(reversed.path, "/dev/disk3s1") == 0);
+	EXPECT(reversed.stat == f.stat);
+	auto mirror = decodeVDev(tree.top(0, 3, false));
+	EXPECT(mirror.type && std::strcmp(mirror.type, "mirror") == 0);
+	EXPECT(mirror.path == nullptr);
+	EXPECT(mirror.statsEx == nullptr);
+	EXPECT_EQ(mirror.childCount, 3u);
+	EXPECT_EQ(decodeVDev(mirror.children[2]).guid, 1003u);
+}
+
+ZETA_TEST(testVDevDecoderMissingFields)
+{
+	fixture::VDevTree tree;
+	auto empty = decodeVDev(tree.list());
+	EXPECT_EQ(empty.guid, 0u);
+	EXPECT(empty.type == nullptr && empty.stat == nullptr && empty.children == nullptr);
+	// A field with the right name but the wrong type is ignored
+	auto odd = tree.list();
+	fixture::VDevTree::add(odd, ZPOOL_CONFIG_GUID, std::string("7"));
+	fixture::VDevTree::add(odd, ZPOOL_CONFIG_TYPE, uint64_t(7));
+	auto f = decodeVDev(odd);
+	EXPECT_EQ(f.guid, 0u);
+	EXPECT(f.type == nullptr);
+	auto status = decodeVDevStatus(f);
+	EXPECT_EQ(status.state, 0u);
+	EXPECT_EQ(status.space, 0u);
+}
+
+ZETA_TEST(testVDevDecoderShortStats)
+{
+	fixture::VDevTree tree;
+	auto leaf = tree.leaf(3, 1004, "/dev/disk5s1", false);
+	auto full = decodeVDevStatus(decodeVDev(leaf));
+	EXPECT_EQ(full.state, 7u);
+	EXPECT_EQ(full.space, 4016000u);
+	EXPECT_EQ(full.errorRead, 3u);
+	EXPECT_EQ(full.errorChecksum, 6u);
+	EXPECT_EQ(full.fragmentation, 12u);
+	// Stats of an older kernel, ending before the error counters
+	auto & stats = std::find_if(leaf->pairs.begin(), leaf->pairs.end(),
+		[](nvpair_t const & p) { return p.name == ZPOOL_CONFIG_VDEV_STATS; })->numbers;
+	stats.resize(offsetof(vdev_stat_t, vs_read_errors) / sizeof(uint64_t));
+	auto f = decodeVDev(leaf);
+	auto status = decodeVDevStatus(f);
+	EXPECT_EQ(status.state, 7u);
+	EXPECT_EQ(status.alloc, 1004000u);
+	EXPECT_EQ(status.errorRead, 0u);
+	EXPECT_EQ(status.errorChecksum, 0u);
+	EXPECT_EQ(status.fragmentation, 0u);
+	std::vector<VDevIOSample> samples;
+	appendVDevIOSamples(leaf, samples);
+	EXPECT_EQ(samples.front().counters.readOps, 10040u);
+	// Too short for the byte counters
+	stats.resize(offsetof(vdev_stat_t, vs_bytes) / sizeof(uint64_t) + 1);
+	samples.clear();
+	appendVDevIOSamples(leaf, samples);
+	EXPECT_EQ(samples.front().guid, 1004u);
+	EXPECT_EQ(samples.front().counters.readOps, 0u);
+	EXPECT_EQ(decodeVDevStatus(decodeVDev(leaf)).space, 4016000u);
+}
+
+ZETA_TEST(testVDevDecoderIOSamples)
+{
+	fixture::VDevTree tree;
+	std::vector<VDevIOSample> samples;
+	appendVDevIOSamples(tree.root(2, 2), samples);
+	std::vector<uint64_t> guids;
+	for (auto const & s : samples)
+		guids.push_back(s.guid);
+	EXPECT(guids == std::vector<uint64_t>({1, 1000, 1001, 1002, 2000, 2001, 2002}));
+	EXPECT_EQ(samples[2].counters.readOps, 10010u);
+	EXPECT_EQ(samples[2].counters.writeBytes, 1001u * 8192);
+	// Only the disk latencies are summed, the fixture puts them in 12 and 13
+	for (auto const & s : samples)
+	{
+		uint64_t total = 0;
+		for (auto c : s.latency.counts)
+			total += c;
+		EXPECT_EQ(total, 2u);
+		EXPECT_EQ(s.latency.counts[12], 1u);
+		EXPECT_EQ(s.latency.counts[13], 1u);
+	}
+}
+
+ZETA_TEST(testVDevDecoderPoolDevices)
+{
+	fixture::VDevTree tree;
+	EXPECT(poolConfigDevices(tree.config(2, 2)) == std::vector<std::string>(
+		{"/dev/disk2s1", "/dev/disk3s1", "/dev/disk4s1", "/dev/disk5s1"}));
+	EXPECT(poolConfigDevices(tree.config(3, 1)) == std::vector<std::string>(
+		{"/dev/disk2s1", "/dev/disk3s1", "/dev/disk4s1"}));
+	EXPECT(poolConfigDevices(tree.list()).empty());
+	EXPECT(poolConfigDevices(nullptr).empty());
+}
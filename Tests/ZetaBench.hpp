@@ -0,0 +1,47 @@
+//
+//  ZetaBench.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaBench_hpp
+#define ZetaBench_hpp
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*!
+ Minimal benchmark registry. Benchmarks register with ZETA_BENCH and receive
+ a scale, which is 1 for a full run and smaller with --quick, so ctest can
+ check that they still run without spending the time.
+ */
+namespace zeta::bench
+{
+	typedef void (*BenchFunction)(double scale);
+
+	struct Registrar
+	{
+		Registrar(char const * name, BenchFunction function);
+	};
+
+	//! Calls f iterations times and prints the time per iteration
+	void measure(std::string const & label, size_t iterations, std::function<void()> const & f);
+
+	//! Scales a problem size, never below 1
+	size_t scaled(size_t size, double scale);
+
+	//! Keeps the compiler from optimizing a result away
+	void consume(uint64_t value);
+}
+
+#define ZETA_BENCH(name) \
+	static void name(double scale); \
+	static zeta::bench::Registrar name##Registrar(#name, &name); \
+	static void name(double scale)
+
+#endif /* ZetaBench_hpp */
@@ -0,0 +1,81 @@
+//
+//  ZetaBenchMain.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaBench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace zeta::bench
+{
+	struct BenchCase
+	{
+		char const * name;
+		BenchFunction function;
+	};
+
+	static std::vector<BenchCase> & registry()
+	{
+		static std::vector<BenchCase> benches;
+		return benches;
+	}
+
+	static std::atomic<uint64_t> sink(0);
+
+	Registrar::Registrar(char const * name, BenchFunction function)
+	{
+		registry().push_back({name, function});
+	}
+
+	void measure(std::string const & label, size_t iterations, std::function<void()> const & f)
+	{
+		iterations = std::max<size_t>(iterations, 1);
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; ++i)
+			f();
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		std::printf("  %-48s %12.3f us/iteration (%zu iterations)\n",
+			label.c_str(), elapsed.count() / iterations, iterations);
+	}
+
+	size_t scaled(size_t size, double scale)
+	{
+		return std::max<size_t>(size_t(size * scale), 1);
+	}
+
+	void consume(uint64_t value)
+	{
+		sink.fetch_add(value, std::memory_order_relaxed);
+	}
+}
+
+//! Runs all benchmarks, or those whose name contains the argument, --quick shrinks them
+int main(int argc, char ** argv)
+{
+	using namespace zeta::bench;
+	double scale = 1;
+	char const * filter = nullptr;
+	for (int a = 1; a < argc; ++a)
+	{
+		if (std::strcmp(argv[a], "--quick") == 0)
+			scale = 0.01;
+		else
+			filter = argv[a];
+	}
+	for (auto const & bench : registry())
+	{
+		if (filter && !std::strstr(bench.name, filter))
+			continue;
+		std::printf("%s\n", bench.name);
+		bench.function(scale);
+	}
+	return 0;
+}
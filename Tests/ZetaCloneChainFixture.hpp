@@ -0,0 +1,84 @@
+//
+//  ZetaCloneChainFixture.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaCloneChainFixture_hpp
+#define ZetaCloneChainFixture_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zeta::fixture
+{
+	//! The part of zfs::ZFileSystem that addFileSystems reads
+	struct FileSystem
+	{
+		enum class FSType { filesystem, snapshot, volume, pool, bookmark };
+
+		struct Property
+		{
+			std::string name;
+			std::string value;
+		};
+
+		std::string fsName;
+		FSType fsType = FSType::filesystem;
+		std::vector<FileSystem> fsSnapshots;
+		std::vector<FileSystem> fsBookmarks;
+		std::vector<Property> fsProperties;
+		uint64_t fsCreateTXG = 0;
+
+		char const * name() const { return fsName.c_str(); }
+		FSType type() const { return fsType; }
+		std::vector<FileSystem> const & snapshots() const { return fsSnapshots; }
+		std::vector<FileSystem> const & bookmarks() const { return fsBookmarks; }
+		std::vector<Property> const & properties() const { return fsProperties; }
+	};
+
+	//! What the app reads as ZFS_PROP_CREATETXG
+	inline uint64_t createTXG(FileSystem const & snapshot)
+	{
+		return snapshot.fsCreateTXG;
+	}
+
+	/*!
+	 A pool with a chain of depth file systems, pool/c0 to pool/c<depth-1>,
+	 each with the given number of snapshots and one bookmark. Every file
+	 system but the first is a clone of the middle snapshot of the previous.
+	 Snapshots are listed and numbered in createtxg order.
+	 */
+	inline std::vector<FileSystem> cloneChain(size_t depth, size_t snapshotCount)
+	{
+		std::vector<FileSystem> fileSystems(depth);
+		for (size_t c = 0; c < depth; ++c)
+		{
+			auto & fs = fileSystems[c];
+			fs.fsName = "pool/c" + std::to_string(c);
+			for (size_t s = 0; s < snapshotCount; ++s)
+			{
+				FileSystem snap;
+				snap.fsName = fs.fsName + "@s" + std::to_string(s);
+				snap.fsType = FileSystem::FSType::snapshot;
+				snap.fsCreateTXG = c * snapshotCount + s + 1;
+				fs.fsSnapshots.push_back(std::move(snap));
+			}
+			FileSystem bookmark;
+			bookmark.fsName = fs.fsName + "#b";
+			bookmark.fsType = FileSystem::FSType::bookmark;
+			fs.fsBookmarks.push_back(std::move(bookmark));
+			fs.fsProperties.push_back({"type", "filesystem"});
+			std::string origin = "-";
+			if (c > 0)
+				origin = "pool/c" + std::to_string(c - 1) + "@s" + std::to_string(snapshotCount / 2);
+			fs.fsProperties.push_back({"origin", origin});
+		}
+		return fileSystems;
+	}
+}
+
+#endif /* ZetaCloneChainFixture_hpp */
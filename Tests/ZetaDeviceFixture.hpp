@@ -0,0 +1,92 @@
+//
+//  ZetaDeviceFixture.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaDeviceFixture_hpp
+#define ZetaDeviceFixture_hpp
+
+#include "ZetaDeviceScan.hpp"
+
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace zeta::fixture
+{
+	/*!
+	 A temporary directory of sparse files that look like file vdevs, each
+	 with a fake label config where ZFS keeps it. Removed at the end.
+	 */
+	struct DeviceDirectory
+	{
+		static constexpr int64_t fileSize = 64 * 1024 * 1024;
+
+		explicit DeviceDirectory(size_t count)
+		{
+			char pattern[] = "/tmp/ZetaDevicesXXXXXX";
+			if (mkdtemp(pattern))
+				path = pattern;
+			for (size_t i = 0; i < count; ++i)
+				add();
+		}
+
+		~DeviceDirectory()
+		{
+			for (size_t i = 0; i < count; ++i)
+				unlink(file(i).c_str());
+			rmdir(path.c_str());
+		}
+
+		std::string file(size_t i) const
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "/vdev%04zu", i);
+			return path + name;
+		}
+
+		void add()
+		{
+			int fd = open(file(count).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0)
+				return;
+			if (ftruncate(fd, fileSize) != 0)
+				perror("ftruncate");
+			close(fd);
+			writeLabel(count++, "active");
+		}
+
+		void writeLabel(size_t i, std::string const & state)
+		{
+			int fd = open(file(i).c_str(), O_RDWR);
+			if (fd < 0)
+				return;
+			auto label = "name=pool guid=" + std::to_string(1000 + i) + " state=" + state;
+			if (pwrite(fd, label.data(), label.size(), labelDigestOffset) != ssize_t(label.size()))
+				perror("pwrite");
+			close(fd);
+			touch(i);
+		}
+
+		//! Sets a new modification time, file system timestamps are too coarse to rely on
+		void touch(size_t i)
+		{
+			struct timespec times[2] = {{0, UTIME_OMIT}, {++clock, 0}};
+			utimensat(AT_FDCWD, file(i).c_str(), times, 0);
+		}
+
+		std::string path;
+		size_t count = 0;
+		time_t clock = 1000000;
+	};
+}
+
+#endif /* ZetaDeviceFixture_hpp */
@@ -0,0 +1,59 @@
+//
+//  ZetaFuzzMain.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const * data, size_t size);
+
+/*!
+ Runs a fuzz target on random inputs without libFuzzer, so it runs under
+ ctest with any compiler. Values are spread over all magnitudes and the
+ text is drawn from the characters the parsers look at.
+ Usage: ZetaFormatFuzz [iterations] [seed]
+ */
+int main(int argc, char ** argv)
+{
+	size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+	uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : std::random_device()();
+	std::printf("%zu iterations, seed %llu\n", iterations, (unsigned long long)seed);
+	std::mt19937_64 random(seed);
+	static char const alphabet[] = "0123456789..  \tkKmMgGtTpPeEiIbBx";
+	std::vector<uint8_t> input;
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		uint64_t value = random() >> (random() % 64);
+		// Just below the boundaries where rounding changes the prefix or unit
+		if (i % 4 == 1)
+		{
+			uint64_t unit = 1;
+			for (size_t u = random() % 6; u > 0; --u)
+				unit *= 1000;
+			value = unit * 1000 - random() % (unit / 10 + 1);
+		}
+		else if (i % 4 == 2)
+		{
+			uint64_t unit = uint64_t(1) << (10 * (random() % 6));
+			value = unit * 1024 - random() % (unit / 100 + 1);
+		}
+		input.resize(sizeof(value));
+		std::memcpy(input.data(), &value, sizeof(value));
+		size_t length = random() % 16;
+		for (size_t c = 0; c < length; ++c)
+			input.push_back(uint8_t(alphabet[random() % (sizeof(alphabet) - 1)]));
+		// Short inputs exercise the zero padded value
+		if (i % 16 == 0)
+			input.resize(random() % sizeof(value));
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+	return 0;
+}
@@ -0,0 +1,60 @@
+//
+//  ZetaHandleFixture.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaHandleFixture_hpp
+#define ZetaHandleFixture_hpp
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace zeta::fixture
+{
+	/*!
+	 Stand-in for zfs::LibZFSHandle, which loads the configuration of every
+	 pool when it is created. Counts the live and created handles.
+	 */
+	struct Handle
+	{
+		static std::atomic<size_t> created;
+		static std::atomic<size_t> alive;
+		static size_t pools;
+		static size_t vdevsPerPool;
+
+		Handle()
+		{
+			++created;
+			++alive;
+			for (size_t p = 0; p < pools; ++p)
+			{
+				auto & vdevs = configs["pool" + std::to_string(p)];
+				for (size_t v = 0; v < vdevsPerPool; ++v)
+					vdevs.push_back(p * 1000 + v);
+			}
+		}
+		Handle(Handle const &) = delete;
+		~Handle() { --alive; }
+
+		uint64_t lookup(size_t pool) const
+		{
+			auto it = configs.find("pool" + std::to_string(pool % pools));
+			return it == configs.end() ? 0 : it->second.size();
+		}
+
+		std::map<std::string, std::vector<uint64_t>> configs;
+	};
+
+	inline std::atomic<size_t> Handle::created(0);
+	inline std::atomic<size_t> Handle::alive(0);
+	inline size_t Handle::pools = 4;
+	inline size_t Handle::vdevsPerPool = 8;
+}
+
+#endif /* ZetaHandleFixture_hpp */
@@ -0,0 +1,75 @@
+//
+//  ZetaPoolStateFixture.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolStateFixture_hpp
+#define ZetaPoolStateFixture_hpp
+
+#include "ZetaPoolState.hpp"
+
+#include <string>
+
+namespace zeta::fixture
+{
+	/*!
+	 A synthetic system with the given number of pools, each with a raidz of
+	 six disks and its share of datasets, in a tree of fan out 10. Every tenth
+	 dataset is an encryption root, every third one unmounted.
+	 */
+	inline SystemState systemState(size_t poolCount, size_t datasetCount)
+	{
+		SystemState state;
+		for (size_t p = 0; p < poolCount; ++p)
+		{
+			PoolState pool;
+			pool.name = "pool" + std::to_string(p);
+			pool.guid = 1000 + p;
+			VDevState raidz;
+			raidz.guid = pool.guid * 100;
+			raidz.name = "raidz1-0";
+			raidz.type = "raidz";
+			pool.vdevs.push_back(raidz);
+			for (uint32_t d = 0; d < 6; ++d)
+			{
+				VDevState disk;
+				disk.guid = raidz.guid + 1 + d;
+				disk.name = "disk" + std::to_string(p * 6 + d);
+				disk.type = "disk";
+				disk.parent = 0;
+				disk.depth = 1;
+				pool.vdevs.push_back(disk);
+			}
+			pool.vdevsByGUID = sortedByGUID(pool.vdevs);
+			size_t share = datasetCount / poolCount + (p < datasetCount % poolCount ? 1 : 0);
+			std::vector<std::string> names;
+			names.push_back(pool.name);
+			for (size_t i = 1; i < share; ++i)
+				names.push_back(names[(i - 1) / 10] + "/fs" + std::to_string(i));
+			for (size_t i = 0; i < names.size(); ++i)
+			{
+				FileSystemState fs;
+				fs.name = names[i];
+				fs.index = pool.datasets.insert(fs.name, DatasetKind::filesystem);
+				fs.isRoot = i == 0;
+				fs.mounted = i % 3 != 0;
+				fs.isEncryptionRoot = i % 10 == 5;
+				fs.keyStatus = fs.isEncryptionRoot ?
+					(i % 20 == 5 ? FileSystemState::KeyStatus::available : FileSystemState::KeyStatus::unavailable) :
+					FileSystemState::KeyStatus::none;
+				fs.used = i * 4096;
+				fs.available = 1ull << 40;
+				pool.fileSystems.push_back(std::move(fs));
+			}
+			pool.fileSystemsByName = sortedByName(pool.fileSystems);
+			state.pools.push_back(std::move(pool));
+		}
+		state.poolsByGUID = sortedByGUID(state.pools);
+		return state;
+	}
+}
+
+#endif /* ZetaPoolStateFixture_hpp */
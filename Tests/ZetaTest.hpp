@@ -0,0 +1,53 @@
+//
+//  ZetaTest.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaTest_hpp
+#define ZetaTest_hpp
+
+#include <sstream>
+#include <string>
+
+/*!
+ Minimal test registry for the portable parts of ZetaWatch. Tests register
+ themselves with ZETA_TEST, and failed expectations are counted and reported
+ without aborting the test.
+ */
+namespace zeta::test
+{
+	typedef void (*TestFunction)();
+
+	struct Registrar
+	{
+		Registrar(char const * name, TestFunction function);
+	};
+
+	void fail(char const * file, int line, std::string const & message);
+
+	template<typename A, typename B>
+	void expectEqual(A const & a, B const & b, char const * expression, char const * file, int line)
+	{
+		if (a == b)
+			return;
+		std::ostringstream ss;
+		ss << expression << ": " << a << " != " << b;
+		fail(file, line, ss.str());
+	}
+}
+
+#define ZETA_TEST(name) \
+	static void name(); \
+	static zeta::test::Registrar name##Registrar(#name, &name); \
+	static void name()
+
+#define EXPECT(expression) \
+	do { if (!(expression)) zeta::test::fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define EXPECT_EQ(a, b) \
+	zeta::test::expectEqual((a), (b), #a " == " #b, __FILE__, __LINE__)
+
+#endif /* ZetaTest_hpp */
@@ -0,0 +1,64 @@
+//
+//  ZetaTestMain.cpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTest.hpp"
+
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+namespace zeta::test
+{
+	struct TestCase
+	{
+		char const * name;
+		TestFunction function;
+	};
+
+	static std::vector<TestCase> & registry()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	static size_t failures = 0;
+
+	Registrar::Registrar(char const * name, TestFunction function)
+	{
+		registry().push_back({name, function});
+	}
+
+	void fail(char const * file, int line, std::string const & message)
+	{
+		std::cerr << file << ":" << line << ": " << message << "\n";
+		++failures;
+	}
+}
+
+//! Runs all tests, or those whose name contains the first argument
+int main(int argc, char ** argv)
+{
+	using namespace zeta::test;
+	size_t run = 0;
+	size_t failed = 0;
+	for (auto const & test : registry())
+	{
+		if (argc > 1 && !std::strstr(test.name, argv[1]))
+			continue;
+		size_t before = failures;
+		test.function();
+		++run;
+		if (failures != before)
+		{
+			++failed;
+			std::cerr << "FAILED " << test.name << "\n";
+		}
+	}
+	std::cout << run - failed << " of " << run << " tests passed\n";
+	return failed == 0 ? 0 : 1;
+}
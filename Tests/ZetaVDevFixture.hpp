@@ -0,0 +1,205 @@
+//
+//  ZetaVDevFixture.hpp
+//  ZetaWatchTests
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaVDevFixture_hpp
+#define ZetaVDevFixture_hpp
+
+#include "ZFSUtils.hpp"
+
+#include <deque>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace zeta::fixture
+{
+	/*!
+	 Builds nvlists shaped like the config of a pool after libzfs unpacked it
+	 from the kernel, with the pairs in the order the kernel writes them and
+	 the stats of OpenZFS 2.x. Owns all lists it creates.
+	 */
+	class VDevTree
+	{
+	public:
+		//! Number of uint64_t in the vdev stats, newer than vdev_stat_t here
+		static constexpr size_t statCount = 48;
+		static constexpr size_t latencyBuckets = 37;
+		static constexpr size_t sizeBuckets = 25;
+
+		nvlist_t * list()
+		{
+			m_lists.emplace_back();
+			return &m_lists.back();
+		}
+
+		static void add(nvlist_t * list, std::string name, uint64_t value)
+		{
+			nvpair_t pair;
+			pair.name = std::move(name);
+			pair.type = DATA_TYPE_UINT64;
+			pair.number = value;
+			list->pairs.push_back(std::move(pair));
+		}
+
+		static void add(nvlist_t * list, std::string name, std::string value)
+		{
+			nvpair_t pair;
+			pair.name = std::move(name);
+			pair.type = DATA_TYPE_STRING;
+			pair.string = std::move(value);
+			list->pairs.push_back(std::move(pair));
+		}
+
+		static void add(nvlist_t * list, std::string name, std::vector<uint64_t> values)
+		{
+			nvpair_t pair;
+			pair.name = std::move(name);
+			pair.type = DATA_TYPE_UINT64_ARRAY;
+			pair.numbers = std::move(values);
+			list->pairs.push_back(std::move(pair));
+		}
+
+		static void add(nvlist_t * list, std::string name, std::vector<nvlist_t *> lists, bool array)
+		{
+			nvpair_t pair;
+			pair.name = std::move(name);
+			pair.type = array ? DATA_TYPE_NVLIST_ARRAY : DATA_TYPE_NVLIST;
+			pair.lists = std::move(lists);
+			list->pairs.push_back(std::move(pair));
+		}
+
+		//! Stats with ops and bytes derived from guid, and the given error counts
+		static std::vector<uint64_t> stats(uint64_t guid, uint64_t errors)
+		{
+			std::vector<uint64_t> s(statCount, 0);
+			s[offsetof(vdev_stat_t, vs_state) / 8] = 7; // VDEV_STATE_HEALTHY
+			s[offsetof(vdev_stat_t, vs_alloc) / 8] = guid * 1000;
+			s[offsetof(vdev_stat_t, vs_space) / 8] = guid * 4000;
+			s[offsetof(vdev_stat_t, vs_ops) / 8 + ZIO_TYPE_READ] = guid * 10;
+			s[offsetof(vdev_stat_t, vs_ops) / 8 + ZIO_TYPE_WRITE] = guid * 20;
+			s[offsetof(vdev_stat_t, vs_bytes) / 8 + ZIO_TYPE_READ] = guid * 4096;
+			s[offsetof(vdev_stat_t, vs_bytes) / 8 + ZIO_TYPE_WRITE] = guid * 8192;
+			s[offsetof(vdev_stat_t, vs_read_errors) / 8] = errors;
+			s[offsetof(vdev_stat_t, vs_checksum_errors) / 8] = 2 * errors;
+			s[offsetof(vdev_stat_t, vs_fragmentation) / 8] = 12;
+			return s;
+		}
+
+		//! The extended stats, latency histograms have one in bucket 10 + kind
+		nvlist_t * statsEx()
+		{
+			static char const * const queues[] = { "syncq_read", "syncq_write", "asyncq_read", "asyncq_write", "scrubq_read", "trimq_write" };
+			static char const * const latencies[] = { "tot_r", "tot_w", "disk_r", "disk_w", "sync_r", "sync_w", "async_r", "async_w", "scrub", "trim", "rebuild" };
+			static char const * const sizes[] = { "sync_ind_r", "sync_ind_w", "async_ind_r", "async_ind_w", "ind_scrub", "ind_trim", "sync_agg_r", "sync_agg_w", "async_agg_r", "async_agg_w", "agg_scrub", "agg_trim" };
+			auto ex = list();
+			for (auto q : queues)
+				add(ex, std::string("vdev_") + q + "_active_queue", uint64_t(0));
+			for (auto q : queues)
+				add(ex, std::string("vdev_") + q + "_pend_queue", uint64_t(0));
+			uint64_t kind = 0;
+			for (auto l : latencies)
+			{
+				std::vector<uint64_t> buckets(latencyBuckets, 0);
+				buckets[10 + kind++] = 1;
+				add(ex, std::string("vdev_") + l + "_lat_histo", std::move(buckets));
+			}
+			for (auto s : sizes)
+				add(ex, std::string("vdev_") + s + "_histo", std::vector<uint64_t>(sizeBuckets, 0));
+			return ex;
+		}
+
+		nvlist_t * leaf(uint64_t id, uint64_t guid, std::string const & path, bool withStatsEx)
+		{
+			auto v = list();
+			add(v, ZPOOL_CONFIG_TYPE, std::string("disk"));
+			add(v, "id", id);
+			add(v, ZPOOL_CONFIG_GUID, guid);
+			add(v, ZPOOL_CONFIG_PATH, path);
+			add(v, "devid", "media-" + std::to_string(guid));
+			add(v, "phys_path", "IODeviceTree:/" + std::to_string(guid));
+			add(v, "whole_disk", uint64_t(1));
+			add(v, "DTL", guid + 1);
+			add(v, "create_txg", uint64_t(4));
+			add(v, "com.delphix:vdev_zap_leaf", guid + 2);
+			add(v, ZPOOL_CONFIG_VDEV_STATS, stats(guid, id));
+			if (withStatsEx)
+				add(v, ZPOOL_CONFIG_VDEV_STATS_EX, {statsEx()}, false);
+			return v;
+		}
+
+		//! A mirror, or a plain disk for width 1
+		nvlist_t * top(uint64_t index, size_t width, bool withStatsEx)
+		{
+			uint64_t guid = 1000 * (index + 1);
+			if (width == 1)
+				return leaf(index, guid, "/dev/disk" + std::to_string(index + 2) + "s1", withStatsEx);
+			std::vector<nvlist_t *> children;
+			for (size_t c = 0; c < width; ++c)
+			{
+				auto name = "/dev/disk" + std::to_string(index * width + c + 2) + "s1";
+				children.push_back(leaf(c, guid + c + 1, name, withStatsEx));
+			}
+			auto v = list();
+			add(v, ZPOOL_CONFIG_TYPE, std::string("mirror"));
+			add(v, "id", index);
+			add(v, ZPOOL_CONFIG_GUID, guid);
+			add(v, "metaslab_array", uint64_t(256));
+			add(v, "metaslab_shift", uint64_t(34));
+			add(v, "ashift", uint64_t(12));
+			add(v, "asize", uint64_t(1) << 42);
+			add(v, "is_log", uint64_t(0));
+			add(v, "create_txg", uint64_t(4));
+			add(v, "com.delphix:vdev_zap_top", guid + 3);
+			add(v, ZPOOL_CONFIG_CHILDREN, std::move(children), true);
+			add(v, ZPOOL_CONFIG_VDEV_STATS, stats(guid, 0));
+			if (withStatsEx)
+				add(v, ZPOOL_CONFIG_VDEV_STATS_EX, {statsEx()}, false);
+			return v;
+		}
+
+		//! The root vdev of a pool of tops top level vdevs of width disks each
+		nvlist_t * root(size_t tops, size_t width, bool withStatsEx = true)
+		{
+			std::vector<nvlist_t *> children;
+			for (size_t t = 0; t < tops; ++t)
+				children.push_back(top(t, width, withStatsEx));
+			auto v = list();
+			add(v, ZPOOL_CONFIG_TYPE, std::string("root"));
+			add(v, "id", uint64_t(0));
+			add(v, ZPOOL_CONFIG_GUID, uint64_t(1));
+			add(v, "create_txg", uint64_t(4));
+			add(v, ZPOOL_CONFIG_CHILDREN, std::move(children), true);
+			add(v, ZPOOL_CONFIG_VDEV_STATS, stats(1, 0));
+			if (withStatsEx)
+				add(v, ZPOOL_CONFIG_VDEV_STATS_EX, {statsEx()}, false);
+			return v;
+		}
+
+		//! A pool config with the vdev tree after the pool properties
+		nvlist_t * config(size_t tops, size_t width)
+		{
+			auto c = list();
+			add(c, "version", uint64_t(5000));
+			add(c, "name", std::string("tank"));
+			add(c, "state", uint64_t(0));
+			add(c, "txg", uint64_t(123456));
+			add(c, "pool_guid", uint64_t(42));
+			add(c, "errata", uint64_t(0));
+			add(c, "hostid", uint64_t(0x1234));
+			add(c, "hostname", std::string("host"));
+			add(c, "vdev_children", uint64_t(tops));
+			add(c, ZPOOL_CONFIG_VDEV_TREE, {root(tops, width)}, false);
+			return c;
+		}
+
+	private:
+		std::deque<nvlist_t> m_lists;
+	};
+}
+
+#endif /* ZetaVDevFixture_hpp */
@@ -13,6 +13,234 @@
 
 #include "ZFSWrapper/ZFSUtils.hpp"
 #include "ZetaCPPUtils.hpp"
+#include "ZetaDependencyGraph.hpp"
+#include "ZetaDeviceScan.hpp"
+#include "ZetaHandlePool.hpp"
+#include "ZetaMountScheduler.hpp"
+#include "ZetaSnapshotBatch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+#include <libzfs_core.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef decltype(std::declval<zfs::LibZFSHandle &>().importablePools({})) ImportablePools;
+
+//! Scanning all devices for labels is slow, and requested on every disk change
+static zeta::DeviceScanCache<ImportablePools> importablePoolsCache(8);
+
+/*!
+ Creating a libzfs handle loads all pool configs, requests reuse them instead.
+ This is safe because requests only keep the libzfs handle. They open pools
+ and file systems anew, and zpool_open and zfs_open read the properties,
+ including the altroot and mount state, from the kernel each time. What the
+ handle caches itself is the pool namespace, so it is invalidated when pools
+ are imported or exported.
+ */
+static size_t const handleBudget = 16;
+static zeta::HandlePool<zfs::LibZFSHandle> libZFSHandles(handleBudget);
+
+//! Pools imported concurrently by importPoolBatch, whatever the client asks for
+static size_t const maxImportParallelism = 8;
+
+/*!
+ Mount workers for each of parallelRequests concurrent requests. Every
+ request holds a handle of its own and every worker leases one, together
+ they stay within the handles the pool keeps.
+ */
+static size_t mountWorkers(size_t parallelRequests)
+{
+	// Mounting mostly waits for the kernel, more workers than cores help
+	size_t wanted = std::max(2 * std::thread::hardware_concurrency(), 2u);
+	size_t available = handleBudget / std::max<size_t>(parallelRequests, 1);
+	return std::max<size_t>(std::min(wanted, available - 1), 1);
+}
+
+//! Call after importing or exporting pools
+static void poolConfigurationChanged()
+{
+	importablePoolsCache.invalidate();
+	libZFSHandles.invalidate();
+}
+
+//! File systems at or below rootName with a path mountpoint, that satisfy filter
+template<typename Filter>
+static std::vector<zeta::MountTarget> mountTargets(zfs::LibZFSHandle & zfs,
+	std::string const & rootName, Filter filter)
+{
+	std::vector<zeta::MountTarget> targets;
+	for (auto const & fs : zfs.pool(std::string(zeta::poolName(rootName))).allFileSystems())
+	{
+		std::string name = fs.name();
+		bool inside = name.compare(0, rootName.size(), rootName) == 0 &&
+			(name.size() == rootName.size() || name[rootName.size()] == '/');
+		if (!inside || fs.type() != zfs::ZFileSystem::FSType::filesystem || !filter(fs))
+			continue;
+		auto mountpoint = fs.mountpoint();
+		if (mountpoint.empty() || mountpoint[0] != '/')
+			continue; // legacy and none
+		targets.push_back({std::move(name), std::move(mountpoint)});
+	}
+	return targets;
+}
+
+//! The outcome of scheduleMounts
+struct MountReport
+{
+	std::vector<std::string> failures;
+	//! Time taken by each file system, in mountpoint order
+	std::vector<std::pair<std::string, double>> seconds;
+};
+
+/*!
+ Runs action on the file system of each target in mountpoint order on up to
+ workers threads, with one libzfs handle per worker so that error messages
+ don't mix. Returns the failures and the time each file system took, and
+ logs a summary.
+ */
+template<typename Action>
+static MountReport scheduleMounts(std::vector<zeta::MountTarget> targets,
+	zeta::MountScheduler::Order order, size_t workers, Action action)
+{
+	typedef std::chrono::duration<double> Seconds;
+	auto start = std::chrono::steady_clock::now();
+	std::vector<zeta::HandlePool<zfs::LibZFSHandle>::Lease> handles(workers);
+	zeta::MountScheduler scheduler(std::move(targets));
+	auto results = scheduler.run(order, workers,
+		[&](size_t worker, zeta::MountTarget const & target) -> std::string
+	{
+		auto & zfs = handles[worker];
+		if (!zfs)
+			zfs = libZFSHandles.acquire();
+		auto fs = zfs->filesystem(target.name);
+		if (action(fs) == 0)
+			return std::string();
+		return zfs->lastError();
+	});
+	MountReport report;
+	report.seconds.reserve(results.size());
+	size_t slowest = 0;
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		if (!results[i].error.empty())
+			report.failures.push_back(scheduler.target(i).name + ": " + results[i].error);
+		report.seconds.emplace_back(scheduler.target(i).name, results[i].seconds);
+		if (results[i].seconds > results[slowest].seconds)
+			slowest = i;
+	}
+	if (!results.empty())
+	{
+		NSLog(@"Processed %zu file systems in %.3f s, %zu failed, slowest %s with %.3f s",
+			  results.size(), Seconds(std::chrono::steady_clock::now() - start).count(),
+			  report.failures.size(), scheduler.target(slowest).name.c_str(), results[slowest].seconds);
+	}
+	return report;
+}
+
+//! File system name to seconds, for the reply
+static NSDictionary * toDictionary(std::vector<std::pair<std::string, double>> const & seconds)
+{
+	NSMutableDictionary * dict = [NSMutableDictionary dictionaryWithCapacity:seconds.size()];
+	for (auto const & s : seconds)
+		dict[[NSString stringWithUTF8String:s.first.c_str()]] = [NSNumber numberWithDouble:s.second];
+	return dict;
+}
+
+static MountReport mountRecursive(zfs::LibZFSHandle & zfs, std::string const & rootName,
+	size_t workers)
+{
+	auto targets = mountTargets(zfs, rootName, [](zfs::ZFileSystem const & fs)
+	{
+		return fs.mountable() && !fs.mounted() &&
+			fs.keyStatus() != zfs::ZFileSystem::KeyStatus::unavailable;
+	});
+	return scheduleMounts(std::move(targets), zeta::MountScheduler::Order::parentsFirst, workers,
+		[](zfs::ZFileSystem & fs) { return fs.mount(); });
+}
+
+static MountReport unmountRecursive(zfs::LibZFSHandle & zfs, std::string const & rootName,
+	bool force, size_t workers)
+{
+	auto targets = mountTargets(zfs, rootName, [](zfs::ZFileSystem const & fs)
+	{
+		return fs.mounted();
+	});
+	// Children are unmounted first, so forcing the recursive unmount only affects fs itself
+	return scheduleMounts(std::move(targets), zeta::MountScheduler::Order::childrenFirst, workers,
+		[=](zfs::ZFileSystem & fs) { return force ? fs.unmountRecursive(true) : fs.unmount(); });
+}
+
+//! nil if there are no failures
+static NSError * errorFromFailures(std::vector<std::string> const & failures)
+{
+	if (failures.empty())
+		return nil;
+	NSDictionary * userInfo = @{
+		NSLocalizedDescriptionKey: [NSString stringWithUTF8String:
+			formatForHumans(failures).c_str()]
+	};
+	return [NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo];
+}
+
+static void readImportProps(NSDictionary * data, zfs::LibZFSHandle::ImportProps & props)
+{
+	if (id ar = [data objectForKey:@"altroot"])
+		props.altroot.assign([ar UTF8String]);
+	if (id aidm = [data objectForKey:@"allowHostIDMismatch"])
+		props.allowHostIDMismatch = [aidm boolValue];
+	if (id auh = [data objectForKey:@"allowUnhealthy"])
+		props.allowUnhealthy = [auh boolValue];
+	if (id ro = [data objectForKey:@"readOnly"])
+		props.readOnly = [ro boolValue];
+}
+
+namespace
+{
+	struct PoolImport
+	{
+		uint64_t guid = 0;
+		std::string name;
+		zfs::LibZFSHandle::ImportProps props;
+		std::string error;
+		double importSeconds = 0;
+		double mountSeconds = 0;
+		std::vector<std::pair<std::string, double>> datasetSeconds;
+	};
+
+	//! Imports and mounts a single pool with its own libzfs handle and up to mountWorkers more
+	void importAndMount(PoolImport & p, size_t mountWorkers)
+	{
+		typedef std::chrono::duration<double> Seconds;
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			auto handle = libZFSHandles.acquire();
+			auto & zfs = *handle;
+			auto pool = zfs.import(p.guid, p.props);
+			poolConfigurationChanged();
+			p.name = pool.name();
+			auto imported = std::chrono::steady_clock::now();
+			p.importSeconds = Seconds(imported - start).count();
+			auto report = mountRecursive(zfs, p.name, mountWorkers);
+			if (!report.failures.empty())
+				p.error = formatForHumans(report.failures);
+			p.datasetSeconds = std::move(report.seconds);
+			p.mountSeconds = Seconds(std::chrono::steady_clock::now() - imported).count();
+		}
+		catch (std::exception const & e)
+		{
+			p.error = e.what();
+			p.importSeconds = Seconds(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+}
 
 @interface ZetaAuthorizationHelper () <NSXPCListenerDelegate, ZetaAuthorizationHelperProtocol>
 {
@@ -190,18 +418,12 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 		std::vector<std::string> failures;
 		NSNumber * pool = [importData objectForKey:@"poolGUID"];
 		zfs::LibZFSHandle::ImportProps props;
-		if (id ar = [importData objectForKey:@"altroot"])
-			props.altroot.assign([ar UTF8String]);
-		if (id aidm = [importData objectForKey:@"allowHostIDMismatch"])
-			props.allowHostIDMismatch = [aidm boolValue];
-		if (id auh = [importData objectForKey:@"allowUnhealthy"])
-			props.allowUnhealthy = [auh boolValue];
-		if (id ro = [importData objectForKey:@"readOnly"])
-			props.readOnly = [ro boolValue];
+		readImportProps(importData, props);
 		if (id spo = [importData objectForKey:@"searchPathOverride"])
 			props.searchPathOverride = fromArray(spo);
 		std::vector<zfs::ZPool> importedPools;
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		if (pool != nil)
 		{
 			importedPools.emplace_back(zfs.import([pool unsignedLongLongValue], props));
@@ -210,6 +432,7 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 		{
 			importedPools = zfs.importAllPools(props);
 		}
+		poolConfigurationChanged();
 		if (failures.empty())
 		{
 			reply(nullptr);
@@ -225,6 +448,89 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 	});
 }
 
+- (void)importPoolBatch:(NSDictionary *)batchData authorization:(NSData *)authData
+			  withReply:(void (^)(NSError *, NSArray *))reply
+{
+	NSError * error = checkAuthorization(authData, _cmd);
+	if (error)
+	{
+		reply(error, nullptr);
+		return;
+	}
+	try
+	{
+		zfs::LibZFSHandle::ImportProps defaultProps;
+		readImportProps(batchData, defaultProps);
+		if (id spo = [batchData objectForKey:@"searchPathOverride"])
+			defaultProps.searchPathOverride = fromArray(spo);
+		size_t parallelism = 4;
+		if (id par = [batchData objectForKey:@"parallelism"])
+			parallelism = std::clamp<size_t>([par unsignedIntegerValue], 1, maxImportParallelism);
+		std::vector<PoolImport> imports;
+		if (NSArray * pools = [batchData objectForKey:@"pools"])
+		{
+			for (NSDictionary * pool in pools)
+			{
+				NSNumber * guid = [pool objectForKey:@"poolGUID"];
+				if (!guid)
+					continue;
+				PoolImport p;
+				p.guid = [guid unsignedLongLongValue];
+				if (NSString * name = [pool objectForKey:@"poolName"])
+					p.name = [name UTF8String];
+				p.props = defaultProps;
+				readImportProps(pool, p.props);
+				imports.push_back(std::move(p));
+			}
+		}
+		else
+		{
+			// Without explicit pools, import all that are importable
+			auto handle = libZFSHandles.acquire();
+			auto & zfs = *handle;
+			auto const & spo = defaultProps.searchPathOverride;
+			auto pools = importablePoolsCache.get(spo, [&]
+			{
+				return zfs.importablePools(spo);
+			});
+			for (auto const & pool : pools)
+			{
+				PoolImport p;
+				p.guid = pool.guid;
+				p.name = pool.name;
+				p.props = defaultProps;
+				imports.push_back(std::move(p));
+			}
+		}
+		// One budget of mount workers for the whole batch, split among the concurrent imports
+		parallelism = std::max<size_t>(std::min(parallelism, imports.size()), 1);
+		auto workers = mountWorkers(parallelism);
+		parallelFor(imports.size(), parallelism, [&](size_t i)
+		{
+			importAndMount(imports[i], workers);
+		});
+		poolConfigurationChanged();
+		NSMutableArray * results = [[NSMutableArray alloc] initWithCapacity:imports.size()];
+		for (auto const & p : imports)
+		{
+			NSMutableDictionary * result = [NSMutableDictionary dictionary];
+			result[@"poolGUID"] = [NSNumber numberWithUnsignedLongLong:p.guid];
+			result[@"poolName"] = [NSString stringWithUTF8String:p.name.c_str()];
+			result[@"importSeconds"] = [NSNumber numberWithDouble:p.importSeconds];
+			result[@"mountSeconds"] = [NSNumber numberWithDouble:p.mountSeconds];
+			result[@"datasetSeconds"] = toDictionary(p.datasetSeconds);
+			if (!p.error.empty())
+				result[@"error"] = [NSString stringWithUTF8String:p.error.c_str()];
+			[results addObject:result];
+		}
+		reply(nullptr, results);
+	}
+	catch (std::exception const & e)
+	{
+		reply([NSError errorWithDomain:@"ZFSException" code:-1 userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithUTF8String:e.what()]}], nullptr);
+	}
+}
+
 - (void)importablePools:(NSDictionary *)importData
 		  authorization:(NSData *)authData
 			  withReply:(void (^)(NSError *, NSArray *))reply
@@ -237,11 +543,15 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 	}
 	try
 	{
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		std::vector<std::string> searchPathOverride;
 		if (id spo = [importData objectForKey:@"searchPathOverride"])
 			searchPathOverride = fromArray(spo);
-		auto pools = zfs.importablePools(searchPathOverride);
+		auto pools = importablePoolsCache.get(searchPathOverride, [&]
+		{
+			return zfs.importablePools(searchPathOverride);
+		});
 		NSMutableArray * poolsArray = [[NSMutableArray alloc] initWithCapacity:pools.size()];
 		for (auto const & pool : pools)
 		{
@@ -261,6 +571,124 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 	}
 }
 
+static void collectLeafGUIDs(nvlist_t * vdev, NSMutableArray<NSNumber*> * guids)
+{
+	nvlist_t ** children = nullptr;
+	uint_t childCount = 0;
+	if (nvlist_lookup_nvlist_array(vdev, ZPOOL_CONFIG_CHILDREN, &children, &childCount) != 0)
+	{
+		uint64_t guid = 0;
+		if (nvlist_lookup_uint64(vdev, ZPOOL_CONFIG_GUID, &guid) == 0)
+			[guids addObject:[NSNumber numberWithUnsignedLongLong:guid]];
+		return;
+	}
+	for (uint_t c = 0; c < childCount; ++c)
+		collectLeafGUIDs(children[c], guids);
+}
+
+//! The fields of a label that zeta::PoolLabel needs, nil for labels without a pool
+static NSDictionary * labelToDictionary(nvlist_t * config)
+{
+	nvlist_t * tree = nullptr;
+	uint64_t poolGUID = 0;
+	if (nvlist_lookup_uint64(config, ZPOOL_CONFIG_POOL_GUID, &poolGUID) != 0 ||
+		nvlist_lookup_nvlist(config, ZPOOL_CONFIG_VDEV_TREE, &tree) != 0 ||
+		!nvlist_exists(config, ZPOOL_CONFIG_POOL_NAME) || !nvlist_exists(tree, ZPOOL_CONFIG_TYPE))
+		return nil;
+	auto number = [](nvlist_t * list, char const * name)
+	{
+		uint64_t value = 0;
+		nvlist_lookup_uint64(list, name, &value);
+		return [NSNumber numberWithUnsignedLongLong:value];
+	};
+	// Children of the top level vdev with the leaves below each of them
+	NSMutableArray * topChildren = [[NSMutableArray alloc] init];
+	nvlist_t ** children = nullptr;
+	uint_t childCount = 0;
+	if (nvlist_lookup_nvlist_array(tree, ZPOOL_CONFIG_CHILDREN, &children, &childCount) == 0)
+	{
+		for (uint_t c = 0; c < childCount; ++c)
+		{
+			NSMutableArray<NSNumber*> * leaves = [[NSMutableArray alloc] init];
+			collectLeafGUIDs(children[c], leaves);
+			[topChildren addObject:leaves];
+		}
+	}
+	else
+	{
+		[topChildren addObject:@[number(tree, ZPOOL_CONFIG_GUID)]];
+	}
+	char const * poolName = fnvlist_lookup_string(config, ZPOOL_CONFIG_POOL_NAME);
+	char const * topType = fnvlist_lookup_string(tree, ZPOOL_CONFIG_TYPE);
+	// Like libzfs, labels without a hostid belong to no particular system
+	uint64_t hostID = 0;
+	nvlist_lookup_uint64(config, ZPOOL_CONFIG_HOSTID, &hostID);
+	bool foreignHost = hostID != 0 && hostID != get_system_hostid();
+	return @{
+		@"poolName": [NSString stringWithUTF8String:poolName],
+		@"poolGUID": [NSNumber numberWithUnsignedLongLong:poolGUID],
+		@"poolState": number(config, ZPOOL_CONFIG_POOL_STATE),
+		@"foreignHost": [NSNumber numberWithBool:foreignHost],
+		@"txg": number(config, ZPOOL_CONFIG_POOL_TXG),
+		@"vdevChildren": number(config, ZPOOL_CONFIG_VDEV_CHILDREN),
+		@"guid": number(config, ZPOOL_CONFIG_GUID),
+		@"topIndex": number(tree, ZPOOL_CONFIG_ID),
+		@"topGUID": number(tree, ZPOOL_CONFIG_GUID),
+		@"topType": [NSString stringWithUTF8String:topType],
+		@"topParity": number(tree, ZPOOL_CONFIG_NPARITY),
+		@"topChildren": topChildren,
+	};
+}
+
+- (void)readPoolLabel:(NSDictionary *)deviceData authorization:(NSData *)authData
+			withReply:(void (^)(NSError *, NSDictionary *))reply
+{
+	NSError * error = checkAuthorization(authData, _cmd);
+	if (error)
+	{
+		reply(error, nullptr);
+		return;
+	}
+	NSString * device = [deviceData objectForKey:@"device"];
+	if (!device)
+	{
+		reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}], nullptr);
+		return;
+	}
+	// The path comes from the client, opening a FIFO or tty must not block
+	// the helper, and only disks and pool files have labels to read
+	int fd = open(device.UTF8String, O_RDONLY | O_NONBLOCK | O_NOFOLLOW | O_CLOEXEC);
+	if (fd < 0)
+	{
+		reply([NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil], nullptr);
+		return;
+	}
+	struct stat st;
+	int code = 0;
+	if (fstat(fd, &st) != 0)
+		code = errno;
+	else if (!S_ISREG(st.st_mode) && !S_ISBLK(st.st_mode))
+		code = EFTYPE;
+	if (code != 0)
+	{
+		close(fd);
+		reply([NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:nil], nullptr);
+		return;
+	}
+	nvlist_t * config = nullptr;
+	int labelCount = 0;
+	int result = zpool_read_label(fd, &config, &labelCount);
+	close(fd);
+	// Devices without a valid label are not an error, most disks are not ZFS
+	NSDictionary * label = nil;
+	if (result == 0 && config)
+	{
+		label = labelToDictionary(config);
+		nvlist_free(config);
+	}
+	reply(nullptr, label);
+}
+
 - (void)exportPools:(NSDictionary *)exportData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply
 {
 	processWithExceptionForwarding(authData, _cmd, reply, [=]()
@@ -274,18 +702,21 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto pool = zfs.pool(std::string(poolName.UTF8String));
 		// Export Pool
 		pool.exportPool(force);
+		poolConfigurationChanged();
 		reply(nullptr);
 	});
 }
 
 - (void)mountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData
-			   withReply:(void (^)(NSError *))reply
+			   withReply:(void (^)(NSError *, NSDictionary *))reply
 {
-	processWithExceptionForwarding(authData, _cmd, reply, [=]()
+	auto errorOnly = [=](NSError * error) { reply(error, nil); };
+	processWithExceptionForwarding(authData, _cmd, errorOnly, [=]()
 	{
 		NSString * fsName = [mountData objectForKey:@"filesystem"];
 		bool recursive = false;
@@ -293,35 +724,34 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			recursive = [o boolValue];
 		if (!fsName)
 		{
-			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
+			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}], nil);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
-		auto fs = zfs.filesystem([fsName UTF8String]);
-		int ret = 0;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
+		MountReport report;
 		if (recursive)
-			ret = fs.mountRecursive();
-		else
-			ret = fs.mount();
-		if (ret == 0)
 		{
-			reply(nullptr);
+			report = mountRecursive(zfs, [fsName UTF8String], mountWorkers(1));
 		}
 		else
 		{
-			NSDictionary * userInfo = @{
-				NSLocalizedDescriptionKey: [NSString stringWithUTF8String:
-					zfs.lastError().c_str()]
-			};
-			reply([NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo]);
+			typedef std::chrono::duration<double> Seconds;
+			auto start = std::chrono::steady_clock::now();
+			auto fs = zfs.filesystem([fsName UTF8String]);
+			if (fs.mount() != 0)
+				report.failures.push_back(zfs.lastError());
+			report.seconds.emplace_back(fs.name(), Seconds(std::chrono::steady_clock::now() - start).count());
 		}
+		reply(errorFromFailures(report.failures), toDictionary(report.seconds));
 	});
 }
 
 - (void)unmountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData
-				 withReply:(void (^)(NSError *))reply
+				 withReply:(void (^)(NSError *, NSDictionary *))reply
 {
-	processWithExceptionForwarding(authData, _cmd, reply, [=]()
+	auto errorOnly = [=](NSError * error) { reply(error, nil); };
+	processWithExceptionForwarding(authData, _cmd, errorOnly, [=]()
 	{
 		NSString * fsName = [mountData objectForKey:@"filesystem"];
 		bool force = false;
@@ -332,28 +762,26 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			recursive = [o boolValue];
 		if (!fsName)
 		{
-			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
+			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}], nil);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
-		auto fs = zfs.filesystem([fsName UTF8String]);
-		int ret = 0;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
+		MountReport report;
 		if (recursive)
-			ret = fs.unmountRecursive(force);
-		else
-			ret = fs.unmount();
-		if (ret == 0)
 		{
-			reply(nullptr);
+			report = unmountRecursive(zfs, [fsName UTF8String], force, mountWorkers(1));
 		}
 		else
 		{
-			NSDictionary * userInfo = @{
-				NSLocalizedDescriptionKey: [NSString stringWithUTF8String:
-					zfs.lastError().c_str()]
-			};
-			reply([NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo]);
+			typedef std::chrono::duration<double> Seconds;
+			auto start = std::chrono::steady_clock::now();
+			auto fs = zfs.filesystem([fsName UTF8String]);
+			if (fs.unmount() != 0)
+				report.failures.push_back(zfs.lastError());
+			report.seconds.emplace_back(fs.name(), Seconds(std::chrono::steady_clock::now() - start).count());
 		}
+		reply(errorFromFailures(report.failures), toDictionary(report.seconds));
 	});
 }
 
@@ -371,7 +799,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto fs = zfs.filesystem([fsName UTF8String]);
 		auto ret = fs.snapshot([snapName UTF8String], recursive);
 		if (ret == 0)
@@ -388,6 +817,197 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 	});
 }
 
+//! Adds the failures of a pool's lzc call to failures, see zeta::addBatchFailures
+static void collectFailures(int error, nvlist_t * errlist, std::vector<std::string> const & names,
+	NSMutableDictionary * failures)
+{
+	if (error == 0)
+		return;
+	std::vector<std::pair<std::string, int>> itemErrors;
+	for (nvpair_t * pair = errlist ? nvlist_next_nvpair(errlist, nullptr) : nullptr; pair;
+		 pair = nvlist_next_nvpair(errlist, pair))
+	{
+		int32_t itemError = 0;
+		if (nvpair_value_int32(pair, &itemError) == 0)
+			itemErrors.emplace_back(nvpair_name(pair), itemError);
+	}
+	std::map<std::string, int> nameErrors;
+	zeta::addBatchFailures(error, itemErrors, names, nameErrors);
+	for (auto const & nameError : nameErrors)
+	{
+		failures[[NSString stringWithUTF8String:nameError.first.c_str()]] =
+			[NSString stringWithUTF8String:strerror(nameError.second)];
+	}
+}
+
+/*!
+ Expands a snapshot range like zfs destroy, fs@a%b means the snapshots of fs
+ from a to b in creation order, either end can be left out.
+ */
+static std::vector<std::string> expandSnapshotRange(zfs::LibZFSHandle & zfs, std::string const & range)
+{
+	auto at = range.find('@');
+	auto percent = range.find('%', at);
+	if (at == std::string::npos || percent == std::string::npos)
+		return {range};
+	auto fsName = range.substr(0, at);
+	auto first = range.substr(at + 1, percent - at - 1);
+	auto last = range.substr(percent + 1);
+	// Order by createtxg, never by however libzfs happens to list them
+	std::vector<std::pair<uint64_t, std::string>> ordered;
+	for (auto const & snap : zfs.filesystem(fsName).snapshots())
+		ordered.emplace_back(zfs_prop_get_int(snap.handle(), ZFS_PROP_CREATETXG), snap.name());
+	std::sort(ordered.begin(), ordered.end());
+	std::vector<std::string> names;
+	bool inRange = first.empty();
+	bool foundLast = last.empty();
+	for (auto & snap : ordered)
+	{
+		std::string name = std::move(snap.second);
+		std::string shortName = name.substr(name.find('@') + 1);
+		if (shortName == first)
+			inRange = true;
+		if (inRange)
+			names.push_back(std::move(name));
+		if (inRange && shortName == last)
+		{
+			foundLast = true;
+			break;
+		}
+	}
+	if (!inRange || !foundLast)
+		throw std::runtime_error("Invalid snapshot range " + range);
+	return names;
+}
+
+- (void)snapshotFilesystems:(NSDictionary *)fsData authorization:(NSData *)authData
+				  withReply:(void(^)(NSError * error, NSDictionary * failures))reply
+{
+	NSError * error = checkAuthorization(authData, _cmd);
+	if (error)
+	{
+		reply(error, nullptr);
+		return;
+	}
+	NSArray<NSString*> * fsNames = [fsData objectForKey:@"filesystems"];
+	NSString * snapName = [fsData objectForKey:@"snapshot"];
+	bool recursive = false;
+	if (id o = [fsData objectForKey:@"recursive"])
+		recursive = [o boolValue];
+	if (!fsNames || !snapName)
+	{
+		reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}], nullptr);
+		return;
+	}
+	try
+	{
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
+		auto roots = fromArray(fsNames);
+		std::vector<std::string> names;
+		for (auto const & pool : zeta::groupByPool(roots))
+		{
+			if (!recursive)
+			{
+				names.insert(names.end(), pool.second.begin(), pool.second.end());
+				continue;
+			}
+			for (auto const & fs : zfs.pool(pool.first).allFileSystems())
+			{
+				std::string name = fs.name();
+				bool below = std::any_of(pool.second.begin(), pool.second.end(), [&](std::string const & root)
+				{
+					return name.compare(0, root.size(), root) == 0 &&
+						(name.size() == root.size() || name[root.size()] == '/');
+				});
+				if (below)
+					names.push_back(std::move(name));
+			}
+		}
+		std::string suffix = std::string("@") + [snapName UTF8String];
+		NSMutableDictionary * failures = [NSMutableDictionary dictionary];
+		// One transaction per pool, all snapshots of a pool are created or none
+		for (auto const & pool : zeta::groupByPool(names))
+		{
+			std::vector<std::string> snapshots;
+			nvlist_t * snaps = fnvlist_alloc();
+			for (auto const & name : pool.second)
+			{
+				snapshots.push_back(name + suffix);
+				fnvlist_add_boolean(snaps, snapshots.back().c_str());
+			}
+			nvlist_t * errlist = nullptr;
+			int ret = lzc_snapshot(snaps, nullptr, &errlist);
+			collectFailures(ret, errlist, snapshots, failures);
+			fnvlist_free(snaps);
+			if (errlist)
+				fnvlist_free(errlist);
+		}
+		reply(nullptr, failures);
+	}
+	catch (std::exception const & e)
+	{
+		reply([NSError errorWithDomain:@"ZFSException" code:-1 userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithUTF8String:e.what()]}], nullptr);
+	}
+}
+
+- (void)destroySnapshots:(NSDictionary *)snapData authorization:(NSData *)authData
+			   withReply:(void(^)(NSError * error, NSDictionary * failures))reply
+{
+	NSError * error = checkAuthorization(authData, _cmd);
+	if (error)
+	{
+		reply(error, nullptr);
+		return;
+	}
+	NSArray<NSString*> * snapNames = [snapData objectForKey:@"snapshots"];
+	bool defer = false;
+	if (id o = [snapData objectForKey:@"defer"])
+		defer = [o boolValue];
+	if (!snapNames)
+	{
+		reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}], nullptr);
+		return;
+	}
+	try
+	{
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
+		std::vector<std::string> names;
+		for (NSString * snapName in snapNames)
+		{
+			std::string name = [snapName UTF8String];
+			if (name.find('@') == std::string::npos)
+			{
+				reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Not a Snapshot"}], nullptr);
+				return;
+			}
+			auto expanded = expandSnapshotRange(zfs, name);
+			names.insert(names.end(), expanded.begin(), expanded.end());
+		}
+		NSMutableDictionary * failures = [NSMutableDictionary dictionary];
+		// All snapshots of a pool are destroyed or none. The kernel refuses
+		// snapshots with clones or holds, unless deferred
+		for (auto const & pool : zeta::groupByPool(names))
+		{
+			nvlist_t * snaps = fnvlist_alloc();
+			for (auto const & name : pool.second)
+				fnvlist_add_boolean(snaps, name.c_str());
+			nvlist_t * errlist = nullptr;
+			int ret = lzc_destroy_snaps(snaps, defer ? B_TRUE : B_FALSE, &errlist);
+			collectFailures(ret, errlist, pool.second, failures);
+			fnvlist_free(snaps);
+			if (errlist)
+				fnvlist_free(errlist);
+		}
+		reply(nullptr, failures);
+	}
+	catch (std::exception const & e)
+	{
+		reply([NSError errorWithDomain:@"ZFSException" code:-1 userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithUTF8String:e.what()]}], nullptr);
+	}
+}
+
 - (void)rollbackFilesystem:(NSDictionary *)fsData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply
 {
 	processWithExceptionForwarding(authData, _cmd, reply, [=]()
@@ -401,7 +1021,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto snap = zfs.filesystem([snapName UTF8String]);
 		auto res = snap.rollback(force);
 		if (res == 0)
@@ -429,7 +1050,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		std::string newFSNameStr = [newFSName UTF8String];
 		auto snap = zfs.filesystem([snapName UTF8String]);
 		if (snap.clone(newFSNameStr) == 0)
@@ -459,7 +1081,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		std::string newFSNameStr = [newFSName UTF8String];
 		std::string mountpointStr = mountpoint ? [mountpoint UTF8String] : "";
 		if (zfs.createFilesystem(newFSNameStr, mountpointStr) == 0)
@@ -490,7 +1113,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		std::string newFSNameStr = [newFSName UTF8String];
 		auto s = [size unsignedLongLongValue];
 		auto bs = blocksize != nullptr ? [blocksize unsignedLongLongValue] : 0;
@@ -522,7 +1146,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto fs = zfs.filesystem([fsName UTF8String]);
 		int ret = 0;
 		if (recursive)
@@ -531,12 +1156,20 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 		}
 		else
 		{
-			auto dependents = fs.dependents();
-			if (dependents.empty())
+			// Same analysis as the confirmation in the app
+			zeta::DependencyGraph graph;
+			zeta::addFileSystems(graph, zfs.pool(std::string(zeta::poolName(fs.name()))).allFileSystems(),
+				[](zfs::ZFileSystem const & snap) { return zfs_prop_get_int(snap.handle(), ZFS_PROP_CREATETXG); });
+			auto fsIndex = graph.find(fs.name());
+			if (fsIndex == zeta::noDataset)
 			{
-				ret = fs.destroy(force);
+				NSDictionary * userInfo = @{
+					NSLocalizedDescriptionKey: @"Filesystem not found"
+				};
+				reply([NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo]);
+				return;
 			}
-			else
+			if (!graph.destroyDependents(fsIndex).empty())
 			{
 				NSDictionary * userInfo = @{
 					NSLocalizedDescriptionKey: @"Filesystem has Dependents"
@@ -544,6 +1177,7 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 				reply([NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo]);
 				return;
 			}
+			ret = fs.destroy(force);
 		}
 		if (ret == 0)
 		{
@@ -570,7 +1204,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto fs = zfs.filesystem([fsName UTF8String]);
 		int ret = 0;
 		if (key)
@@ -617,7 +1252,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto fs = zfs.filesystem([fsName UTF8String]);
 		auto ret = fs.unloadKey();
 		if (ret == 0)
@@ -647,7 +1283,8 @@ void processWithExceptionForwarding(NSData * authData, SEL command,
 			reply([NSError errorWithDomain:@"ZFSArgError" code:-1 userInfo:@{NSLocalizedDescriptionKey: @"Missing Arguments"}]);
 			return;
 		}
-		zfs::LibZFSHandle zfs;
+		auto handle = libZFSHandles.acquire();
+		auto & zfs = *handle;
 		auto pool = zfs.pool(std::string(poolName.UTF8String));
 		if (command)
 		{
@@ -19,16 +19,24 @@
 
 - (void)importPools:(NSDictionary *)importData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
 
+- (void)importPoolBatch:(NSDictionary *)batchData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSArray * results))reply;
+
 - (void)importablePools:(NSDictionary *)importData authorization:(NSData*)authData withReply:(void(^)(NSError * error, NSArray * importablePools))reply;
 
+- (void)readPoolLabel:(NSDictionary *)deviceData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSDictionary * label))reply;
+
 - (void)exportPools:(NSDictionary *)exportData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
 
-- (void)mountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
+- (void)mountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply;
 
-- (void)unmountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
+- (void)unmountFilesystems:(NSDictionary *)mountData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply;
 
 - (void)snapshotFilesystem:(NSDictionary *)fsData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
 
+- (void)snapshotFilesystems:(NSDictionary *)fsData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSDictionary * failures))reply;
+
+- (void)destroySnapshots:(NSDictionary *)snapData authorization:(NSData *)authData withReply:(void(^)(NSError * error, NSDictionary * failures))reply;
+
 - (void)rollbackFilesystem:(NSDictionary *)fsData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
 
 - (void)cloneSnapshot:(NSDictionary *)fsData authorization:(NSData *)authData withReply:(void(^)(NSError * error))reply;
@@ -9,10 +9,11 @@
 #ifndef ZetaCPPUtils_h
 #define ZetaCPPUtils_h
 
-#include "ZFSWrapper/ZFSUtils.hpp"
-
 #include <vector>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 template<typename T>
 inline std::string formatForHumans(std::vector<T> const & things)
@@ -28,4 +29,26 @@ inline std::string formatForHumans(std::vector<T> const & things)
 	return ss.str();
 }
 
+/*!
+ Calls f(i) for every i in [0, count) on at most parallelism threads, and
+ returns when all calls returned. f must not throw.
+ */
+template<typename F>
+inline void parallelFor(size_t count, size_t parallelism, F f)
+{
+	std::atomic<size_t> next(0);
+	auto work = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+			f(i);
+	};
+	size_t threadCount = std::min(count, std::max<size_t>(parallelism, 1));
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < threadCount; ++t)
+		threads.emplace_back(work);
+	work();
+	for (auto & t : threads)
+		t.join();
+}
+
 #endif /* ZetaCPPUtils_h */
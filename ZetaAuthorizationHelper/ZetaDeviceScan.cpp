@@ -0,0 +1,122 @@
+//
+//  ZetaDeviceScan.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaDeviceScan.hpp"
+
+#include <algorithm>
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace zeta
+{
+	bool DeviceIdentity::operator==(DeviceIdentity const & other) const
+	{
+		return path == other.path && device == other.device && inode == other.inode &&
+			modifyTime == other.modifyTime && changeTime == other.changeTime &&
+			size == other.size && isFile == other.isFile;
+	}
+
+	namespace
+	{
+		int64_t nanoseconds(struct timespec const & time)
+		{
+			return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+		}
+
+		int64_t modifyTime(struct stat const & info)
+		{
+#ifdef __APPLE__
+			return nanoseconds(info.st_mtimespec);
+#else
+			return nanoseconds(info.st_mtim);
+#endif
+		}
+
+		int64_t changeTime(struct stat const & info)
+		{
+#ifdef __APPLE__
+			return nanoseconds(info.st_ctimespec);
+#else
+			return nanoseconds(info.st_ctim);
+#endif
+		}
+
+		void scanDirectory(std::string const & directory, bool disksOnly,
+			std::vector<DeviceIdentity> & devices)
+		{
+			DIR * dir = opendir(directory.c_str());
+			if (!dir)
+				return;
+			while (dirent * entry = readdir(dir))
+			{
+				std::string name = entry->d_name;
+				if (name == "." || name == ".." || (disksOnly && name.compare(0, 4, "disk") != 0))
+					continue;
+				DeviceIdentity d;
+				d.path = directory + "/" + name;
+				// Follows links, the search paths are mostly links to the disks
+				struct stat info;
+				if (stat(d.path.c_str(), &info) != 0)
+					continue;
+				if (S_ISBLK(info.st_mode) || S_ISCHR(info.st_mode))
+					d.device = uint64_t(info.st_rdev);
+				else if (S_ISREG(info.st_mode))
+				{
+					d.device = uint64_t(info.st_dev);
+					d.isFile = true;
+				}
+				else
+					continue;
+				d.inode = uint64_t(info.st_ino);
+				d.modifyTime = modifyTime(info);
+				d.changeTime = changeTime(info);
+				d.size = int64_t(info.st_size);
+				devices.push_back(std::move(d));
+			}
+			closedir(dir);
+		}
+	}
+
+	std::vector<DeviceIdentity> scanDevices(std::vector<std::string> const & searchPaths)
+	{
+		std::vector<DeviceIdentity> devices;
+		if (searchPaths.empty())
+			scanDirectory("/dev", true, devices);
+		for (auto const & path : searchPaths)
+			scanDirectory(path, false, devices);
+		std::sort(devices.begin(), devices.end(), [](DeviceIdentity const & a, DeviceIdentity const & b)
+		{
+			return a.path < b.path;
+		});
+		return devices;
+	}
+
+	uint64_t readLabelDigest(std::string const & path)
+	{
+		int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+		if (fd < 0)
+			return 0;
+		// Raw disks only allow aligned reads, offset and size are multiples of the sector size
+		alignas(4096) unsigned char buffer[labelDigestSize];
+		auto count = pread(fd, buffer, sizeof(buffer), labelDigestOffset);
+		close(fd);
+		if (count <= 0)
+			return 0;
+		// FNV-1a, it only has to notice changes, not resist collisions
+		uint64_t hash = 14695981039346656037ull;
+		for (ssize_t i = 0; i < count; ++i)
+		{
+			hash ^= buffer[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
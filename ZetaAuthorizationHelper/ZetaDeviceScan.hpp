@@ -0,0 +1,167 @@
+//
+//  ZetaDeviceScan.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaDeviceScan_hpp
+#define ZetaDeviceScan_hpp
+
+#include "ZetaCPPUtils.hpp"
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+namespace zeta
+{
+	//! What identifies the device behind a path, changes when it is replaced
+	struct DeviceIdentity
+	{
+		std::string path;
+		uint64_t device = 0; //!< st_rdev for device nodes, st_dev for files
+		uint64_t inode = 0;
+		int64_t modifyTime = 0; //!< st_mtime in ns
+		int64_t changeTime = 0; //!< st_ctime in ns
+		int64_t size = 0;
+		bool isFile = false; //!< Regular files change their modification time when written
+
+		bool operator==(DeviceIdentity const & other) const;
+	};
+
+	/*!
+	 Lists the devices and files in the search paths that could contain pool
+	 labels, sorted by path. Only metadata is read, so this is much cheaper
+	 than reading the labels themselves. An empty list of search paths means
+	 the disks in /dev, like the default of libzfs.
+	 */
+	std::vector<DeviceIdentity> scanDevices(std::vector<std::string> const & searchPaths);
+
+	//! Offset and size of the part of the first label that holds the pool name, state and txg
+	constexpr int64_t labelDigestOffset = 16 * 1024;
+	constexpr size_t labelDigestSize = 4096;
+
+	//! Hash of the start of the first label's config, 0 if it can't be read
+	uint64_t readLabelDigest(std::string const & path);
+
+	//! A device together with the digest of its label when it was probed
+	struct DeviceProbe
+	{
+		DeviceIdentity identity;
+		uint64_t labelDigest = 0;
+
+		bool operator==(DeviceProbe const & other) const
+		{
+			return identity == other.identity && labelDigest == other.labelDigest;
+		}
+	};
+
+	/*!
+	 \brief Caches a scan of the pool labels, keyed on the state of each device
+
+	 Every device in the search paths is probed for its identity and a digest
+	 of the start of its first label, which changes with the pool state and
+	 txg. The result of the last scan is reused while no device was added,
+	 removed or changed. Files are only read again when their identity
+	 changes. Disks are written by the kernel without touching their node, so
+	 their label is read on every request, on at most parallelism threads.
+	 This notices pools that were exported, imported or cleared with the
+	 command line tools, at the cost of 4 KiB per disk instead of all labels.
+
+	 Thread safe. The mutex only guards the stored probes and result, the
+	 probes and scans of concurrent requests run in parallel.
+	 */
+	template<typename Result>
+	class DeviceScanCache
+	{
+	public:
+		typedef std::function<uint64_t(std::string const & path)> DigestReader;
+
+	public:
+		explicit DeviceScanCache(size_t parallelism, DigestReader readDigest = readLabelDigest) :
+			m_parallelism(parallelism), m_readDigest(std::move(readDigest)) {}
+
+		template<typename Scan>
+		Result get(std::vector<std::string> const & searchPaths, Scan scan)
+		{
+			auto devices = scanDevices(searchPaths);
+			std::vector<DeviceProbe> previous;
+			uint64_t generation;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_searchPaths == searchPaths)
+					previous = m_probes;
+				generation = m_generation;
+			}
+			auto probes = probe(std::move(devices), previous);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_valid && m_generation == generation && m_searchPaths == searchPaths && m_probes == probes)
+					return m_result;
+			}
+			Result result = scan();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// Results of scans that started before an invalidation are not kept
+			if (m_generation == generation)
+			{
+				m_result = result;
+				m_searchPaths = searchPaths;
+				m_probes = std::move(probes);
+				m_valid = true;
+			}
+			return result;
+		}
+
+		//! Call after importing or exporting pools, which might not be visible in the labels yet
+		void invalidate()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_valid = false;
+			++m_generation;
+		}
+
+	private:
+		//! Both lists sorted by path
+		std::vector<DeviceProbe> probe(std::vector<DeviceIdentity> devices,
+			std::vector<DeviceProbe> const & previous) const
+		{
+			std::vector<DeviceProbe> probes(devices.size());
+			std::vector<size_t> unread;
+			auto p = previous.begin();
+			for (size_t i = 0; i < devices.size(); ++i)
+			{
+				probes[i].identity = std::move(devices[i]);
+				auto const & identity = probes[i].identity;
+				while (p != previous.end() && p->identity.path < identity.path)
+					++p;
+				if (identity.isFile && p != previous.end() && p->identity == identity)
+					probes[i].labelDigest = p->labelDigest;
+				else
+					unread.push_back(i);
+			}
+			parallelFor(unread.size(), m_parallelism, [&](size_t u)
+			{
+				auto & d = probes[unread[u]];
+				d.labelDigest = m_readDigest(d.identity.path);
+			});
+			return probes;
+		}
+
+	private:
+		size_t m_parallelism;
+		DigestReader m_readDigest;
+		std::mutex m_mutex;
+		bool m_valid = false;
+		uint64_t m_generation = 0;
+		std::vector<std::string> m_searchPaths;
+		std::vector<DeviceProbe> m_probes;
+		Result m_result;
+	};
+}
+
+#endif /* ZetaDeviceScan_hpp */
@@ -0,0 +1,111 @@
+//
+//  ZetaHandlePool.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaHandlePool_hpp
+#define ZetaHandlePool_hpp
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+namespace zeta
+{
+	/*!
+	 \brief Keeps handles alive between requests
+
+	 Handle is zfs::LibZFSHandle, which is expensive to create and not thread
+	 safe. A lease gives exclusive use of a handle and returns it when it is
+	 destroyed, so concurrent requests each get their own. After operations
+	 that change the pool configuration, invalidate() makes sure no handle
+	 from before is reused. Handles leased at that time are destroyed when
+	 they are returned.
+	 */
+	template<typename Handle>
+	class HandlePool
+	{
+	public:
+		class Lease
+		{
+		public:
+			Lease() = default;
+			Lease(Lease && other) = default;
+			Lease & operator=(Lease && other)
+			{
+				release();
+				m_pool = other.m_pool;
+				m_generation = other.m_generation;
+				m_handle = std::move(other.m_handle);
+				return *this;
+			}
+			~Lease() { release(); }
+
+			Handle & operator*() const { return *m_handle; }
+			Handle * operator->() const { return m_handle.get(); }
+			explicit operator bool() const { return bool(m_handle); }
+
+		private:
+			friend class HandlePool;
+			Lease(HandlePool * pool, uint64_t generation, std::unique_ptr<Handle> handle) :
+				m_pool(pool), m_generation(generation), m_handle(std::move(handle)) {}
+
+			void release()
+			{
+				if (m_handle)
+					m_pool->giveBack(m_generation, std::move(m_handle));
+			}
+
+		private:
+			HandlePool * m_pool = nullptr;
+			uint64_t m_generation = 0;
+			std::unique_ptr<Handle> m_handle;
+		};
+
+	public:
+		//! At most maxIdle handles are kept while nobody uses them
+		explicit HandlePool(size_t maxIdle) : m_maxIdle(maxIdle) {}
+
+		Lease acquire()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			auto generation = m_generation;
+			if (!m_idle.empty())
+			{
+				auto handle = std::move(m_idle.back());
+				m_idle.pop_back();
+				return Lease(this, generation, std::move(handle));
+			}
+			lock.unlock();
+			return Lease(this, generation, std::make_unique<Handle>());
+		}
+
+		void invalidate()
+		{
+			std::vector<std::unique_ptr<Handle>> stale;
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_generation;
+			stale.swap(m_idle);
+		}
+
+	private:
+		void giveBack(uint64_t generation, std::unique_ptr<Handle> handle)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (generation == m_generation && m_idle.size() < m_maxIdle)
+				m_idle.push_back(std::move(handle));
+		}
+
+	private:
+		size_t m_maxIdle;
+		std::mutex m_mutex;
+		uint64_t m_generation = 0;
+		std::vector<std::unique_ptr<Handle>> m_idle;
+	};
+}
+
+#endif /* ZetaHandlePool_hpp */
@@ -0,0 +1,144 @@
+//
+//  ZetaMountScheduler.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaMountScheduler.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+namespace zeta
+{
+	namespace
+	{
+		void removeTrailingSlashes(std::string & path)
+		{
+			while (path.size() > 1 && path.back() == '/')
+				path.pop_back();
+		}
+
+		//! Orders '/' before every other character, which sorts paths depth first
+		bool pathLess(std::string const & a, std::string const & b)
+		{
+			auto key = [](char c)
+			{
+				return c == '/' ? 0 : int(static_cast<unsigned char>(c)) + 1;
+			};
+			return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+				[&](char x, char y) { return key(x) < key(y); });
+		}
+
+		//! Whether path is mountpoint or below it
+		bool contains(std::string const & mountpoint, std::string const & path)
+		{
+			if (path.size() < mountpoint.size() || path.compare(0, mountpoint.size(), mountpoint) != 0)
+				return false;
+			return path.size() == mountpoint.size() || mountpoint.back() == '/' ||
+				path[mountpoint.size()] == '/';
+		}
+	}
+
+	MountScheduler::MountScheduler(std::vector<MountTarget> targets) :
+		m_targets(std::move(targets)), m_parent(m_targets.size(), npos), m_children(m_targets.size())
+	{
+		for (auto & t : m_targets)
+			removeTrailingSlashes(t.mountpoint);
+		std::vector<size_t> sorted(m_targets.size());
+		std::iota(sorted.begin(), sorted.end(), 0);
+		std::sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b)
+		{
+			auto const & ta = m_targets[a];
+			auto const & tb = m_targets[b];
+			if (ta.mountpoint != tb.mountpoint)
+				return pathLess(ta.mountpoint, tb.mountpoint);
+			return ta.name < tb.name;
+		});
+		// In depth first order, the parent is on the stack of the current path
+		std::vector<size_t> stack;
+		for (auto i : sorted)
+		{
+			while (!stack.empty() && !contains(m_targets[stack.back()].mountpoint, m_targets[i].mountpoint))
+				stack.pop_back();
+			if (!stack.empty())
+			{
+				m_parent[i] = stack.back();
+				m_children[stack.back()].push_back(i);
+			}
+			stack.push_back(i);
+		}
+	}
+
+	std::vector<MountResult> MountScheduler::run(Order order, size_t workers,
+		Operation const & operation) const
+	{
+		std::vector<MountResult> results(size());
+		// Number of targets that have to be processed before each target
+		std::vector<size_t> pending(size());
+		std::vector<size_t> ready;
+		for (size_t i = 0; i < size(); ++i)
+		{
+			pending[i] = order == Order::parentsFirst ?
+				(m_parent[i] != npos ? 1 : 0) : m_children[i].size();
+			if (pending[i] == 0)
+				ready.push_back(i);
+		}
+		size_t remaining = size();
+		std::mutex mutex;
+		std::condition_variable changed;
+		auto work = [&](size_t worker)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				changed.wait(lock, [&]{ return !ready.empty() || remaining == 0; });
+				if (ready.empty())
+					return;
+				auto i = ready.back();
+				ready.pop_back();
+				lock.unlock();
+				auto start = std::chrono::steady_clock::now();
+				std::string error;
+				try
+				{
+					error = operation(worker, m_targets[i]);
+				}
+				catch (std::exception const & e)
+				{
+					error = e.what();
+				}
+				auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				lock.lock();
+				results[i].error = std::move(error);
+				results[i].seconds = seconds;
+				auto release = [&](size_t dependent)
+				{
+					if (--pending[dependent] == 0)
+						ready.push_back(dependent);
+				};
+				if (order == Order::parentsFirst)
+					std::for_each(m_children[i].begin(), m_children[i].end(), release);
+				else if (m_parent[i] != npos)
+					release(m_parent[i]);
+				--remaining;
+				changed.notify_all();
+			}
+		};
+		size_t threadCount = std::min(size(), std::max<size_t>(workers, 1));
+		std::vector<std::thread> threads;
+		for (size_t t = 1; t < threadCount; ++t)
+			threads.emplace_back(work, t);
+		work(0);
+		for (auto & t : threads)
+			t.join();
+		return results;
+	}
+}
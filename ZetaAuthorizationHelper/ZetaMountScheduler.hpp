@@ -0,0 +1,75 @@
+//
+//  ZetaMountScheduler.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaMountScheduler_hpp
+#define ZetaMountScheduler_hpp
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace zeta
+{
+	struct MountTarget
+	{
+		std::string name;
+		std::string mountpoint;
+	};
+
+	struct MountResult
+	{
+		std::string error; //!< empty on success
+		double seconds = 0;
+	};
+
+	/*!
+	 \brief Mounts or unmounts file systems in parallel, in mountpoint order
+
+	 A file system depends on the file system with the longest mountpoint that
+	 is a path prefix of its own. Mounting handles parents before children,
+	 unmounting the reverse, and independent branches run concurrently.
+	 */
+	class MountScheduler
+	{
+	public:
+		enum class Order
+		{
+			parentsFirst,  //!< for mounting
+			childrenFirst, //!< for unmounting
+		};
+
+		//! Called with the index of the calling worker, returns an error message or nothing
+		typedef std::function<std::string(size_t worker, MountTarget const & target)> Operation;
+
+		static constexpr size_t npos = size_t(-1);
+
+	public:
+		explicit MountScheduler(std::vector<MountTarget> targets);
+
+		size_t size() const { return m_targets.size(); }
+		MountTarget const & target(size_t i) const { return m_targets[i]; }
+		//! npos for targets that don't depend on another
+		size_t parent(size_t i) const { return m_parent[i]; }
+		std::vector<size_t> const & children(size_t i) const { return m_children[i]; }
+
+		/*!
+		 Runs operation on every target, on at most workers threads including
+		 the calling one. Errors don't stop dependents from being processed,
+		 like zfs mount -a. Returns the results in target order.
+		 */
+		std::vector<MountResult> run(Order order, size_t workers, Operation const & operation) const;
+
+	private:
+		std::vector<MountTarget> m_targets;
+		std::vector<size_t> m_parent;
+		std::vector<std::vector<size_t>> m_children;
+	};
+}
+
+#endif /* ZetaMountScheduler_hpp */
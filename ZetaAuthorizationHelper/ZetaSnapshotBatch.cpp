@@ -0,0 +1,38 @@
+//
+//  ZetaSnapshotBatch.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaSnapshotBatch.hpp"
+
+#include "ZetaDatasetTree.hpp"
+
+#include <unordered_map>
+
+namespace zeta
+{
+	std::map<std::string, std::vector<std::string>> groupByPool(std::vector<std::string> const & names)
+	{
+		std::map<std::string, std::vector<std::string>> pools;
+		for (auto const & name : names)
+			pools[std::string(poolName(name))].push_back(name);
+		return pools;
+	}
+
+	void addBatchFailures(int error, std::vector<std::pair<std::string, int>> const & errlist,
+		std::vector<std::string> const & names, std::map<std::string, int> & failures)
+	{
+		if (error == 0)
+			return;
+		// errlist can also contain entries that are not names, such as N_MORE_ERRORS
+		std::unordered_map<std::string, int> itemErrors(errlist.begin(), errlist.end());
+		for (auto const & name : names)
+		{
+			auto it = itemErrors.find(name);
+			failures[name] = it != itemErrors.end() && it->second != 0 ? it->second : error;
+		}
+	}
+}
@@ -0,0 +1,32 @@
+//
+//  ZetaSnapshotBatch.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaSnapshotBatch_hpp
+#define ZetaSnapshotBatch_hpp
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace zeta
+{
+	//! Groups dataset or snapshot names by pool, lzc calls only work within one pool
+	std::map<std::string, std::vector<std::string>> groupByPool(std::vector<std::string> const & names);
+
+	/*!
+	 Adds the failures of one lzc_snapshot or lzc_destroy_snaps call to
+	 failures, as name and errno. The calls are atomic per pool, if error is
+	 not 0, none of the names were created or destroyed. Each name fails with
+	 its own error from errlist if it has one, otherwise with error.
+	 */
+	void addBatchFailures(int error, std::vector<std::pair<std::string, int>> const & errlist,
+		std::vector<std::string> const & names, std::map<std::string, int> & failures);
+}
+
+#endif /* ZetaSnapshotBatch_hpp */
@@ -14,6 +14,7 @@
 
 #include "IDDiskArbitrationHandler.hpp"
 #include "IDDiskArbitrationUtils.hpp"
+#include "IDDiskInformationCache.hpp"
 
 #include <DiskArbitration/DiskArbitration.h>
 
@@ -91,6 +92,7 @@ namespace ID
 	void DiskArbitrationDispatcher::diskAppeared(DADiskRef disk) const
 	{
 		DiskInformation info = getDiskInformation(disk);
+		diskInformationCache().insert(info);
 		std::lock_guard<std::mutex> lock(m_impl->mutex);
 		for (auto const & handler: m_impl->handler)
 			handler->diskAppeared(disk, info);
@@ -98,7 +100,10 @@ namespace ID
 
 	void DiskArbitrationDispatcher::diskDisappeared(DADiskRef disk) const
 	{
-		DiskInformation info = getDiskInformation(disk);
+		DiskInformation info;
+		char const * bsdName = DADiskGetBSDName(disk);
+		if (!bsdName || !diskInformationCache().erase(bsdName, info))
+			info = getDiskInformation(disk);
 		std::lock_guard<std::mutex> lock(m_impl->mutex);
 		for (auto const & handler: m_impl->handler)
 			handler->diskDisappeared(disk, info);
@@ -13,12 +13,12 @@
 #ifndef ID_DISKARBITRATIONHANDLER_HPP
 #define ID_DISKARBITRATIONHANDLER_HPP
 
+#include "IDDiskInformation.hpp"
+
 #include <DiskArbitration/DADisk.h>
 
 namespace ID
 {
-	class DiskInformation;
-
 	class DiskArbitrationHandler
 	{
 	public:
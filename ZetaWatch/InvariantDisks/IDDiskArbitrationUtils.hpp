@@ -13,6 +13,8 @@
 #ifndef ID_DISKARBITRATIONUTILS_HPP
 #define ID_DISKARBITRATIONUTILS_HPP
 
+#include "IDDiskInformation.hpp"
+
 #include <DiskArbitration/DiskArbitration.h>
 
 #include <iostream>
@@ -20,33 +22,6 @@
 
 namespace ID
 {
-	struct DiskInformation
-	{
-		std::string volumeKind;
-		std::string volumeUUID;
-		std::string volumeName;
-		std::string volumePath;
-		std::string mediaKind;
-		std::string mediaType;
-		std::string mediaUUID;
-		std::string mediaBSDName;
-		std::string mediaName;
-		std::string mediaPath;
-		std::string mediaContent;
-		bool isDevice;
-		bool mediaWhole;
-		bool mediaLeaf;
-		bool mediaWritable;
-		std::string deviceGUID;
-		std::string devicePath;
-		std::string deviceProtocol;
-		std::string deviceModel;
-		std::string busName;
-		std::string busPath;
-		std::string ioSerial;
-		std::string imagePath;
-	};
-
 	DiskInformation getDiskInformation(DADiskRef disk);
 
 	bool isDevice(DiskInformation const & di);
@@ -0,0 +1,48 @@
+//
+//  IDDiskInformation.hpp
+//  InvariantDisks
+//
+//  Created by Gerhard Röthlin on 2026.10.16.
+//  Copyright (c) 2026 the-color-black.net. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are permitted
+//  provided that the conditions of the "3-Clause BSD" license described in the BSD.LICENSE file are met.
+//  Additional licensing options are described in the README file.
+//
+
+#ifndef ID_DISKINFORMATION_HPP
+#define ID_DISKINFORMATION_HPP
+
+#include <string>
+
+namespace ID
+{
+	struct DiskInformation
+	{
+		std::string volumeKind;
+		std::string volumeUUID;
+		std::string volumeName;
+		std::string volumePath;
+		std::string mediaKind;
+		std::string mediaType;
+		std::string mediaUUID;
+		std::string mediaBSDName;
+		std::string mediaName;
+		std::string mediaPath;
+		std::string mediaContent;
+		bool isDevice = false;
+		bool mediaWhole = false;
+		bool mediaLeaf = false;
+		bool mediaWritable = false;
+		std::string deviceGUID;
+		std::string devicePath;
+		std::string deviceProtocol;
+		std::string deviceModel;
+		std::string busName;
+		std::string busPath;
+		std::string ioSerial;
+		std::string imagePath;
+	};
+}
+
+#endif
@@ -0,0 +1,120 @@
+//
+//  IDDiskInformationCache.cpp
+//  InvariantDisks
+//
+//  Created by Gerhard Röthlin on 2026.10.16.
+//  Copyright (c) 2026 the-color-black.net. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are permitted
+//  provided that the conditions of the "3-Clause BSD" license described in the BSD.LICENSE file are met.
+//  Additional licensing options are described in the README file.
+//
+
+#include "IDDiskInformationCache.hpp"
+
+namespace ID
+{
+	static std::string const devPrefix = "/dev/";
+
+	static std::string cacheKey(std::string const & bsdName)
+	{
+		if (bsdName.compare(0, devPrefix.size(), devPrefix) == 0)
+			return bsdName.substr(devPrefix.size());
+		return bsdName;
+	}
+
+	DiskInformation DiskInformationCache::lookup(std::string const & bsdName, Provider const & provider)
+	{
+		DiskInformation info;
+		if (find(bsdName, info))
+			return info;
+		// Queried without holding the lock, a concurrent insert of the same disk is harmless
+		info = provider();
+		if (!info.mediaBSDName.empty())
+			insert(info);
+		return info;
+	}
+
+	bool DiskInformationCache::find(std::string const & bsdName, DiskInformation & info) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_byBSDName.find(cacheKey(bsdName));
+		if (it == m_byBSDName.end())
+			return false;
+		info = it->second;
+		return true;
+	}
+
+	bool DiskInformationCache::findByMediaUUID(std::string const & mediaUUID, DiskInformation & info) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_bsdNameByMediaUUID.find(mediaUUID);
+		if (it == m_bsdNameByMediaUUID.end())
+			return false;
+		info = m_byBSDName.at(it->second);
+		return true;
+	}
+
+	void DiskInformationCache::insert(DiskInformation info)
+	{
+		auto key = cacheKey(info.mediaBSDName);
+		if (key.empty())
+			return;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		eraseLocked(key);
+		// A disk that reappeared under a different BSD name replaces its old entry
+		if (!info.mediaUUID.empty())
+		{
+			auto it = m_bsdNameByMediaUUID.find(info.mediaUUID);
+			if (it != m_bsdNameByMediaUUID.end())
+				eraseLocked(std::string(it->second));
+			m_bsdNameByMediaUUID[info.mediaUUID] = key;
+		}
+		m_byBSDName[key] = std::move(info);
+	}
+
+	bool DiskInformationCache::erase(std::string const & bsdName, DiskInformation & info)
+	{
+		auto key = cacheKey(bsdName);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_byBSDName.find(key);
+		if (it == m_byBSDName.end())
+			return false;
+		info = std::move(it->second);
+		m_byBSDName.erase(it);
+		auto uuid = m_bsdNameByMediaUUID.find(info.mediaUUID);
+		if (uuid != m_bsdNameByMediaUUID.end() && uuid->second == key)
+			m_bsdNameByMediaUUID.erase(uuid);
+		return true;
+	}
+
+	void DiskInformationCache::eraseLocked(std::string const & bsdName)
+	{
+		auto it = m_byBSDName.find(bsdName);
+		if (it == m_byBSDName.end())
+			return;
+		auto uuid = m_bsdNameByMediaUUID.find(it->second.mediaUUID);
+		if (uuid != m_bsdNameByMediaUUID.end() && uuid->second == bsdName)
+			m_bsdNameByMediaUUID.erase(uuid);
+		m_byBSDName.erase(it);
+	}
+
+	void DiskInformationCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_byBSDName.clear();
+		m_bsdNameByMediaUUID.clear();
+	}
+
+	size_t DiskInformationCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_byBSDName.size();
+	}
+
+	DiskInformationCache & diskInformationCache()
+	{
+		static DiskInformationCache cache;
+		return cache;
+	}
+}
@@ -0,0 +1,70 @@
+//
+//  IDDiskInformationCache.hpp
+//  InvariantDisks
+//
+//  Created by Gerhard Röthlin on 2026.10.16.
+//  Copyright (c) 2026 the-color-black.net. All rights reserved.
+//
+//  Redistribution and use in source and binary forms, with or without modification, are permitted
+//  provided that the conditions of the "3-Clause BSD" license described in the BSD.LICENSE file are met.
+//  Additional licensing options are described in the README file.
+//
+
+#ifndef ID_DISKINFORMATIONCACHE_HPP
+#define ID_DISKINFORMATIONCACHE_HPP
+
+#include "IDDiskInformation.hpp"
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ID
+{
+	/*!
+	 \brief DiskInformation of the disks that are currently present
+
+	 Gathering DiskInformation takes many DiskArbitration and IORegistry
+	 queries. The DiskArbitrationDispatcher fills this cache when disks appear
+	 and evicts them when they disappear, so everyone else can look disks up
+	 by BSD name or media UUID without querying again. Independent of
+	 DiskArbitration, the caller provides the information on a miss.
+	 */
+	class DiskInformationCache
+	{
+	public:
+		typedef std::function<DiskInformation()> Provider;
+
+	public:
+		/*!
+		 Returns the cached information for the BSD name, with or without
+		 /dev/ in front. On a miss, the provider's result is cached and
+		 returned, unless it has no BSD name, which means it failed.
+		 */
+		DiskInformation lookup(std::string const & bsdName, Provider const & provider);
+		bool find(std::string const & bsdName, DiskInformation & info) const;
+		bool findByMediaUUID(std::string const & mediaUUID, DiskInformation & info) const;
+
+		//! Replaces any entry with the same BSD name or media UUID
+		void insert(DiskInformation info);
+		//! Removes the entry and returns it in info, false if there was none
+		bool erase(std::string const & bsdName, DiskInformation & info);
+		void clear();
+
+		size_t size() const;
+
+	private:
+		void eraseLocked(std::string const & bsdName);
+
+	private:
+		mutable std::mutex m_mutex;
+		std::unordered_map<std::string, DiskInformation> m_byBSDName;
+		std::unordered_map<std::string, std::string> m_bsdNameByMediaUUID;
+	};
+
+	//! The cache shared by the DiskArbitrationDispatcher and its users
+	DiskInformationCache & diskInformationCache();
+}
+
+#endif
@@ -26,17 +26,25 @@
 - (void)importPools:(NSDictionary *)importData
 		  withReply:(void(^)(NSError * error))reply;
 
+//! Imports the given pools, or all importable ones, replies with one result per pool
+- (void)importPoolBatch:(NSDictionary *)batchData
+			  withReply:(void(^)(NSError * error, NSArray * results))reply;
+
 - (void)importablePools:(NSDictionary *)importData
 			  withReply:(void(^)(NSError * error, NSArray * importablePools))reply;
 
+- (void)readPoolLabel:(NSDictionary *)deviceData
+			withReply:(void(^)(NSError * error, NSDictionary * label))reply;
+
 - (void)exportPools:(NSDictionary *)exportData
 		  withReply:(void(^)(NSError * error))reply;
 
+//! Replies with the seconds each file system took to mount, by name
 - (void)mountFilesystems:(NSDictionary *)mountData
-			   withReply:(void(^)(NSError * error))reply;
+			   withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply;
 
 - (void)unmountFilesystems:(NSDictionary *)mountData
-				 withReply:(void(^)(NSError * error))reply;
+				 withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply;
 
 - (void)snapshotFilesystem:(NSDictionary *)snapshotData
 				 withReply:(void(^)(NSError * error))reply;
@@ -56,6 +64,14 @@
 - (void)destroy:(NSDictionary *)fsData
 	  withReply:(void(^)(NSError * error))reply;
 
+//! Snapshots all filesystems atomically per pool, failures maps snapshot names to errors
+- (void)snapshotFilesystems:(NSDictionary *)snapshotData
+				  withReply:(void(^)(NSError * error, NSDictionary * failures))reply;
+
+//! Destroys a list of snapshots or fs@a%b ranges, one kernel call per pool
+- (void)destroySnapshots:(NSDictionary *)snapshotData
+			   withReply:(void(^)(NSError * error, NSDictionary * failures))reply;
+
 - (void)loadKeyForFilesystem:(NSDictionary *)loadData
 				   withReply:(void(^)(NSError * error))reply;
 
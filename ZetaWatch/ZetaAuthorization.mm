@@ -250,6 +250,39 @@
 		withNotification:notification];
 }
 
+- (void)importPoolBatch:(NSDictionary *)batchData
+			  withReply:(void(^)(NSError * error, NSArray * results))reply
+{
+	NSArray * pools = batchData[@"pools"];
+	NSString * target;
+	if (pools == nil)
+		target = NSLocalizedString(@"all pools", @"All Pools");
+	else
+		target = [NSString stringWithFormat:NSLocalizedString(@"%lu pools", @"Pool Count"),
+			(unsigned long)pools.count];
+	ZetaNotification * notification = [self startNotificationForAction:
+		NSLocalizedString(@"Importing", @"Importing Action") withTarget:target];
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy importPoolBatch:batchData
+				  authorization:self.authorization
+					  withReply:^(NSError * error, NSArray * results)
+		  {
+			  [self dispatchReply:^(){
+				  reply(error, results);
+				  [self stopNotification:notification withError:error];
+			  }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){
+			 reply(error, nil);
+			 [self stopNotification:notification withError:error];
+		 }];
+	 }];
+}
+
 - (void)importablePools:(NSDictionary *)importData
 			  withReply:(void(^)(NSError * error, NSArray * importablePools))reply
 {
@@ -268,6 +301,24 @@
 	 }];
 }
 
+- (void)readPoolLabel:(NSDictionary *)deviceData
+			withReply:(void(^)(NSError * error, NSDictionary * label))reply
+{
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy readPoolLabel:deviceData
+				authorization:self.authorization
+					withReply:^(NSError * error, NSDictionary * label)
+		  {
+			  [self dispatchReply:^(){ reply(error, label); }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){ reply(error, nil); }];
+	 }];
+}
+
 - (void)exportPools:(NSDictionary *)exportData
 		  withReply:(void(^)(NSError * error))reply
 {
@@ -282,29 +333,61 @@
 }
 
 - (void)mountFilesystems:(NSDictionary *)mountData
-			   withReply:(void(^)(NSError * error))reply
+			   withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply
 {
 	NSString * target = mountData[@"filesystem"];
 	if (target == nil)
 		target = NSLocalizedString(@"all filesystems", @"All Filesystems");
 	ZetaNotification * notification = [self startNotificationForAction:
 		NSLocalizedString(@"Mounting", @"Mounting Action") withTarget:target];
-	[self executeOnProxy:@selector(mountFilesystems:authorization:withReply:)
-				withData:mountData withReply:reply
-		withNotification:notification];
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy mountFilesystems:mountData
+				authorization:self.authorization
+					withReply:^(NSError * error, NSDictionary * datasetSeconds)
+		  {
+			  [self dispatchReply:^(){
+				  reply(error, datasetSeconds);
+				  [self stopNotification:notification withError:error];
+			  }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){
+			 reply(error, nil);
+			 [self stopNotification:notification withError:error];
+		 }];
+	 }];
 }
 
 - (void)unmountFilesystems:(NSDictionary *)mountData
-			   withReply:(void(^)(NSError * error))reply
+			   withReply:(void(^)(NSError * error, NSDictionary * datasetSeconds))reply
 {
 	NSString * target = mountData[@"filesystem"];
 	if (target == nil)
 		target = NSLocalizedString(@"all filesystems", @"All Filesystems");
 	ZetaNotification * notification = [self startNotificationForAction:
 		NSLocalizedString(@"Unmounting", @"Unmounting Action") withTarget:target];
-	[self executeOnProxy:@selector(unmountFilesystems:authorization:withReply:)
-				withData:mountData withReply:reply
-		withNotification:notification];
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy unmountFilesystems:mountData
+				authorization:self.authorization
+					withReply:^(NSError * error, NSDictionary * datasetSeconds)
+		  {
+			  [self dispatchReply:^(){
+				  reply(error, datasetSeconds);
+				  [self stopNotification:notification withError:error];
+			  }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){
+			 reply(error, nil);
+			 [self stopNotification:notification withError:error];
+		 }];
+	 }];
 }
 
 - (void)snapshotFilesystem:(NSDictionary *)snapshotData
@@ -389,6 +472,64 @@
 		withNotification:notification];
 }
 
+- (void)snapshotFilesystems:(NSDictionary *)snapshotData
+				  withReply:(void(^)(NSError * error, NSDictionary * failures))reply
+{
+	NSArray * filesystems = snapshotData[@"filesystems"];
+	NSString * target = [NSString stringWithFormat:NSLocalizedString(@"%lu filesystems", @"Filesystem Count"),
+		(unsigned long)filesystems.count];
+	ZetaNotification * notification = [self startNotificationForAction:
+		NSLocalizedString(@"Snapshotting", @"Snapshot Action") withTarget:target];
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy snapshotFilesystems:snapshotData
+					  authorization:self.authorization
+						  withReply:^(NSError * error, NSDictionary * failures)
+		  {
+			  [self dispatchReply:^(){
+				  reply(error, failures);
+				  [self stopNotification:notification withError:error];
+			  }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){
+			 reply(error, nil);
+			 [self stopNotification:notification withError:error];
+		 }];
+	 }];
+}
+
+- (void)destroySnapshots:(NSDictionary *)snapshotData
+			   withReply:(void(^)(NSError * error, NSDictionary * failures))reply
+{
+	NSArray * snapshots = snapshotData[@"snapshots"];
+	NSString * target = [NSString stringWithFormat:NSLocalizedString(@"%lu snapshots", @"Snapshot Count"),
+		(unsigned long)snapshots.count];
+	ZetaNotification * notification = [self startNotificationForAction:
+		NSLocalizedString(@"Destroying", @"Destroy Action") withTarget:target];
+	[self executeWhenConnected:^(id proxy)
+	 {
+		 [proxy destroySnapshots:snapshotData
+				   authorization:self.authorization
+					   withReply:^(NSError * error, NSDictionary * failures)
+		  {
+			  [self dispatchReply:^(){
+				  reply(error, failures);
+				  [self stopNotification:notification withError:error];
+			  }];
+		  }];
+	 }
+					   onError:^(NSError * error)
+	 {
+		 [self dispatchReply:^(){
+			 reply(error, nil);
+			 [self stopNotification:notification withError:error];
+		 }];
+	 }];
+}
+
 - (void)loadKeyForFilesystem:(NSDictionary *)data
 					withReply:(void(^)(NSError * error))reply
 {
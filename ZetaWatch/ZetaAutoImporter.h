@@ -15,10 +15,14 @@
 
 #include <vector>
 
-@interface ZetaAutoImporter : ZetaCommanderBase
+@interface ZetaAutoImporter : ZetaCommanderBase <ZetaPoolWatcherDelegate>
 
 - (id)init;
 
+- (void)poolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes;
+
+@property (weak) IBOutlet ZetaPoolWatcher * poolWatcher;
+
 @property (readonly) std::vector<zfs::ImportablePool> const & importablePools;
 
 @end
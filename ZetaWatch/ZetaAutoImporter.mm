@@ -12,6 +12,10 @@
 #include "IDDiskArbitrationHandler.hpp"
 #include "IDDiskArbitrationUtils.hpp"
 
+#include "ZetaPoolLabelMap.hpp"
+#include "ZetaPoolRegistry.hpp"
+#include "ZetaVDevDecoder.hpp"
+
 #include <vector>
 #include <set>
 #include <string>
@@ -24,6 +28,11 @@
  set prevents attempting to import a pool multiple times in case of an error.
  Pools that were imported previously are added to the knownPools set and are
  not imported. They are ignored until one of their underlying devices disappears.
+
+ Devices that appear are probed individually, and their labels are collected
+ per pool. A pool whose devices are all present is importable without scanning
+ all devices again, see zeta::decideImport. Only pools that stay incomplete,
+ for example because of removed top level vdevs, are left to a full scan.
  */
 @interface ZetaAutoImporter ()
 {
@@ -33,10 +42,14 @@
 
 	// Management
 	std::vector<zfs::ImportablePool> _importable;
-	std::vector<zfs::ImportablePool> _importedBefore;
+	zeta::PoolRegistry _importedBefore;
+	zeta::PoolLabelMap _labels;
+	bool _scanRequested;
 }
 
 - (void)scheduleChecking;
+- (void)scheduleTimer;
+- (void)handleAppearedDevice:(ID::DiskInformation const &)info;
 - (void)handleDisappearedDevice:(ID::DiskInformation const &)info;
 
 @end
@@ -52,12 +65,11 @@ public:
 public:
 	virtual void diskAppeared(DADiskRef disk, ID::DiskInformation const & info)
 	{
-		scheduleChecking();
+		[watcher handleAppearedDevice:info];
 	}
 
 	virtual void diskDisappeared(DADiskRef disk, ID::DiskInformation const & info)
 	{
-		scheduleChecking();
 		[watcher handleDisappearedDevice:info];
 	}
 
@@ -86,12 +98,26 @@ private:
 	return self;
 }
 
+- (void)awakeFromNib
+{
+	if (self.poolWatcher)
+	{
+		[self.poolWatcher.delegates addObject:self];
+	}
+}
+
 - (void)dealloc
 {
 	_idDispatcher.stop();
 }
 
 - (void)scheduleChecking
+{
+	_scanRequested = true;
+	[self scheduleTimer];
+}
+
+- (void)scheduleTimer
 {
 	if (checkTimer && [checkTimer isValid])
 	{
@@ -103,24 +129,123 @@ private:
 	[[NSRunLoop currentRunLoop] addTimer:checkTimer forMode:NSDefaultRunLoopMode];
 }
 
+zeta::PoolLabel labelFromDictionary(NSDictionary * dict, std::string const & device)
+{
+	zeta::PoolLabel label;
+	label.device = device;
+	label.poolName = [dict[@"poolName"] UTF8String];
+	label.poolGUID = [dict[@"poolGUID"] unsignedLongLongValue];
+	label.poolState = [dict[@"poolState"] unsignedLongLongValue];
+	label.foreignHost = [dict[@"foreignHost"] boolValue];
+	label.txg = [dict[@"txg"] unsignedLongLongValue];
+	label.vdevChildren = [dict[@"vdevChildren"] unsignedLongLongValue];
+	label.guid = [dict[@"guid"] unsignedLongLongValue];
+	label.topIndex = [dict[@"topIndex"] unsignedLongLongValue];
+	label.topGUID = [dict[@"topGUID"] unsignedLongLongValue];
+	label.topType = [dict[@"topType"] UTF8String];
+	label.topParity = [dict[@"topParity"] unsignedLongLongValue];
+	for (NSArray<NSNumber*> * child in dict[@"topChildren"])
+	{
+		std::vector<uint64_t> leaves;
+		for (NSNumber * leaf in child)
+			leaves.push_back([leaf unsignedLongLongValue]);
+		label.topChildren.push_back(std::move(leaves));
+	}
+	return label;
+}
+
+- (void)handleAppearedDevice:(ID::DiskInformation const &)info
+{
+	// Labels are on partitions, or on whole disks without partitions
+	if (info.mediaBSDName.empty() || !info.mediaLeaf)
+		return;
+	std::string devicePath = "/dev/" + info.mediaBSDName;
+	[_authorization readPoolLabel:@{@"device": [NSString stringWithUTF8String:devicePath.c_str()]}
+						withReply:^(NSError * error, NSDictionary * label)
+	 {
+		if (error)
+			[self scheduleChecking];
+		else if (label)
+			[self handleLabel:labelFromDictionary(label, devicePath)];
+	 }];
+}
+
+- (bool)isImportedHere:(uint64_t)poolGUID
+{
+	auto state = self.poolWatcher.state;
+	return state && std::any_of(state->pools.begin(), state->pools.end(),
+		[&](zeta::PoolState const & pool) { return pool.guid == poolGUID; });
+}
+
+- (zeta::ImportDecision)decideImport:(uint64_t)poolGUID
+{
+	return zeta::decideImport(_labels, poolGUID, _importedBefore.contains(poolGUID),
+		[self isImportedHere:poolGUID]);
+}
+
+- (void)handleLabel:(zeta::PoolLabel)label
+{
+	auto poolGUID = _labels.deviceAppeared(std::move(label));
+	uint64_t status = ZPOOL_STATUS_OK;
+	switch ([self decideImport:poolGUID])
+	{
+		case zeta::ImportDecision::ignore:
+			return;
+		case zeta::ImportDecision::imported:
+			// A device of an imported pool that came back after it disappeared
+			_importedBefore.insert(poolGUID, _labels.devices(poolGUID));
+			return;
+		case zeta::ImportDecision::wait:
+			// The remaining devices usually show up before the timer fires
+			[self scheduleTimer];
+			return;
+		case zeta::ImportDecision::importable:
+			break;
+		case zeta::ImportDecision::foreignHost:
+			// What libzfs reports for pools that were not exported on another system
+			status = ZPOOL_STATUS_HOSTID_MISMATCH;
+			break;
+	}
+	std::vector<zfs::ImportablePool> importable = _importable;
+	importable.erase(std::remove_if(importable.begin(), importable.end(),
+		[&](zfs::ImportablePool const & pool) { return pool.guid == poolGUID; }), importable.end());
+	importable.push_back({_labels.label(poolGUID)->poolName, poolGUID, status, _labels.devices(poolGUID)});
+	std::sort(importable.begin(), importable.end());
+	[self updateImportablePools:std::move(importable)];
+}
+
 - (void)handleDisappearedDevice:(ID::DiskInformation const &)info
 {
 	if (info.mediaBSDName.empty())
 		return;
 	std::string devicePath = "/dev/" + info.mediaBSDName;
+	auto poolGUID = _labels.deviceDisappeared(devicePath);
+	if (poolGUID != 0 && !_labels.complete(poolGUID))
+	{
+		_importable.erase(std::remove_if(_importable.begin(), _importable.end(),
+			[&](zfs::ImportablePool const & pool) { return pool.guid == poolGUID; }), _importable.end());
+	}
 	// Forget pools that were once importable but now are no longer since at
 	// least one device was removed
-	_importedBefore.erase(
-		std::remove_if(_importedBefore.begin(), _importedBefore.end(),
-					   [&](zfs::ImportablePool const & pool)
+	_importedBefore.eraseDevice(devicePath);
+}
+
+- (bool)hasIncompletePools
+{
+	auto pools = _labels.pools();
+	return std::any_of(pools.begin(), pools.end(), [&](uint64_t poolGUID)
 	{
-		auto const & devices = pool.devices;
-		return std::find(devices.begin(), devices.end(), devicePath) != devices.end();
-	}), _importedBefore.end());
+		return [self decideImport:poolGUID] == zeta::ImportDecision::wait;
+	});
 }
 
 - (void)checkForImportablePools
 {
+	// Pools that could not be completed from their labels, for example
+	// because of removed top level vdevs, are left to a full scan
+	if (!_scanRequested && ![self hasIncompletePools])
+		return;
+	_scanRequested = false;
 	auto defaults = [NSUserDefaults standardUserDefaults];
 	NSMutableDictionary * importData = [[NSMutableDictionary alloc] init];
 	if (auto spo = [defaults arrayForKey:@"searchPathOverride"])
@@ -163,40 +288,67 @@ std::vector<zfs::ImportablePool> arrayToPoolVec(NSArray * poolsArray)
 	return pools;
 }
 
-- (void)seedKnownPools
+- (std::vector<zfs::ImportablePool>)currentlyImportedPools
 {
 	zfs::LibZFSHandle lib;
-	std::vector<zfs::ImportablePool> knownPools;
+	std::vector<zfs::ImportablePool> importedPools;
 	for (auto const & pool : lib.pools())
 	{
-		knownPools.push_back({
+		importedPools.push_back({
 			pool.name(),
 			pool.guid(),
 			pool.status(),
-			lib.devicesFromPoolConfig(pool.config()),
+			zeta::poolConfigDevices(pool.config().toList()),
 		});
 	}
-	std::sort(knownPools.begin(), knownPools.end());
-	_importedBefore = std::move(knownPools);
+	return importedPools;
+}
+
+- (void)seedKnownPools
+{
+	_importedBefore.clear();
+	for (auto const & pool : [self currentlyImportedPools])
+		_importedBefore.insert(pool.guid, pool.devices);
+}
+
+- (void)poolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes
+{
+	// Pools that get imported while running, for example from the import
+	// menu, are known as well, and should not be auto-imported after export
+	bool poolAdded = std::any_of(changes.begin(), changes.end(), [](auto const & change)
+	{
+		return change.kind == zeta::PoolStateChange::Kind::poolAdded;
+	});
+	if (!poolAdded)
+		return;
+	try
+	{
+		for (auto const & pool : [self currentlyImportedPools])
+			_importedBefore.insert(pool.guid, pool.devices);
+	}
+	catch (std::exception const &)
+	{
+		// Keep the previous set, the next added pool will try again
+	}
 }
 
 - (void)handleImportablePools:(NSArray*)importablePools
 {
-	std::vector<zfs::ImportablePool> importableCurrent = arrayToPoolVec(importablePools);
+	[self updateImportablePools:arrayToPoolVec(importablePools)];
+}
+
+- (void)updateImportablePools:(std::vector<zfs::ImportablePool>)importableCurrent
+{
 	// Find the pools that had not been imported before, for auto import
 	std::vector<zfs::ImportablePool> importableNew;
-	std::set_difference(importableCurrent.begin(), importableCurrent.end(),
-						_importedBefore.begin(), _importedBefore.end(),
-						std::back_inserter(importableNew));
+	std::copy_if(importableCurrent.begin(), importableCurrent.end(), std::back_inserter(importableNew),
+				 [&](zfs::ImportablePool const & pool) { return !_importedBefore.contains(pool.guid); });
 	auto importedPools = [self handleNewImportablePools:importableNew];
 	// Aggregate all known pools to prevent double-auto import
-	std::vector<zfs::ImportablePool> importedBefore;
-	std::set_union(_importedBefore.begin(), _importedBefore.end(),
-				   importedPools.begin(), importedPools.end(),
-				   std::back_inserter(importedBefore));
+	for (auto const & pool : importedPools)
+		_importedBefore.insert(pool.guid, pool.devices);
 	// Update currently importable pools collection
 	_importable = std::move(importableCurrent);
-	_importedBefore = std::move(importedBefore);
 }
 
 - (std::vector<zfs::ImportablePool>)handleNewImportablePools:(std::vector<zfs::ImportablePool> const &)importableNew
@@ -206,6 +358,7 @@ std::vector<zfs::ImportablePool> arrayToPoolVec(NSArray * poolsArray)
 	bool allowHostIDMismatch = [defaults boolForKey:@"allowHostIDMismatch"];
 	if ([defaults boolForKey:@"autoImport"])
 	{
+		NSMutableArray * pools = [NSMutableArray array];
 		for (auto const & pool : importableNew)
 		{
 			if (!zfs::healthy(pool.status, allowHostIDMismatch))
@@ -221,45 +374,67 @@ std::vector<zfs::ImportablePool> arrayToPoolVec(NSArray * poolsArray)
 								  @"Pool AutoImport format"),
 								name, guid];
 			[self notifySuccessWithTitle:title text:text];
-			NSDictionary * poolDict = @{ @"poolGUID": guid, @"poolName": name};
-			NSMutableDictionary * mutablePool = [poolDict mutableCopy];
-			[mutablePool setValue:[NSNumber numberWithBool:allowHostIDMismatch]
-						   forKey:@"allowHostIDMismatch"];
-			if ([defaults boolForKey:@"useAltroot"])
-			{
-				[mutablePool setObject:[defaults stringForKey:@"defaultAltroot"]
-								forKey:@"altroot"];
-			}
-			if (auto spo = [defaults arrayForKey:@"searchPathOverride"])
-			{
-				[mutablePool setObject:spo forKey:@"searchPathOverride"];
-			}
-			[_authorization importPools:mutablePool withReply:^(NSError * error)
-			 {
-				 [self handlePoolImportReply:error forPool:poolDict];
-			 }];
+			[pools addObject:@{ @"poolGUID": guid, @"poolName": name}];
 			importedPools.push_back(pool);
 		}
+		if (pools.count == 0)
+			return importedPools;
+		// All pools in a single request, the helper imports them in parallel
+		NSMutableDictionary * batch = [NSMutableDictionary dictionary];
+		batch[@"pools"] = pools;
+		batch[@"allowHostIDMismatch"] = [NSNumber numberWithBool:allowHostIDMismatch];
+		if ([defaults boolForKey:@"useAltroot"])
+		{
+			batch[@"altroot"] = [defaults stringForKey:@"defaultAltroot"];
+		}
+		if (auto spo = [defaults arrayForKey:@"searchPathOverride"])
+		{
+			batch[@"searchPathOverride"] = spo;
+		}
+		[_authorization importPoolBatch:batch withReply:^(NSError * error, NSArray * results)
+		 {
+			 if (error)
+			 {
+				 [self notifyErrorFromHelper:error];
+				 return;
+			 }
+			 for (NSDictionary * result in results)
+			 {
+				 [self handlePoolImportResult:result];
+			 }
+		 }];
 	}
 	return importedPools;
 }
 
-- (void)handlePoolImportReply:(NSError*)error forPool:(NSDictionary*)pool
+- (void)handlePoolImportResult:(NSDictionary*)result
 {
-	if (error)
+	NSDictionary<NSString*, NSNumber*> * datasetSeconds = result[@"datasetSeconds"];
+	NSString * slowest = nil;
+	for (NSString * dataset in datasetSeconds)
+	{
+		if (!slowest || [datasetSeconds[dataset] doubleValue] > [datasetSeconds[slowest] doubleValue])
+			slowest = dataset;
+	}
+	NSLog(@"Auto-import of %@ took %.2f s, mounting %.2f s, slowest %@ with %.2f s",
+		  result[@"poolName"], [result[@"importSeconds"] doubleValue],
+		  [result[@"mountSeconds"] doubleValue], slowest,
+		  slowest ? [datasetSeconds[slowest] doubleValue] : 0.0);
+	if (NSString * message = result[@"error"])
 	{
-		[self notifyErrorFromHelper:error];
+		[self notifyErrorFromHelper:[NSError errorWithDomain:@"ZFSError" code:-1
+			userInfo:@{NSLocalizedDescriptionKey: message}]];
 	}
 	else
 	{
 		NSString * title = [NSString stringWithFormat:
 			NSLocalizedString(@"Pool %@ auto-imported",
 							  @"Pool AutoImport Success short format"),
-				pool[@"poolName"]];
+				result[@"poolName"]];
 		NSString * text = [NSString stringWithFormat:
 			NSLocalizedString(@"Pool %@ (%@) auto-imported",
 							  @"Pool AutoImport Success format"),
-			pool[@"poolName"], pool[@"poolGUID"]];
+			result[@"poolName"], result[@"poolGUID"]];
 		[self notifySuccessWithTitle:title text:text];
 	}
 }
@@ -0,0 +1,64 @@
+//
+//  ZetaBackgroundLoad.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaBackgroundLoad_hpp
+#define ZetaBackgroundLoad_hpp
+
+#include <dispatch/dispatch.h>
+
+#include <memory>
+#include <functional>
+#include <chrono>
+
+namespace zeta
+{
+	//! How long menus wait for data before showing a placeholder instead
+	constexpr std::chrono::milliseconds menuLatencyCap(250);
+
+	/*!
+	 Runs load on a background queue, and passes the result to apply on the
+	 main queue. Waits at most timeout for load to finish. If it finishes in
+	 time, apply is called before returning and true is returned. Otherwise
+	 apply is called later from the main queue. Call only from the main thread.
+	 */
+	template<typename T>
+	bool loadInBackground(std::function<T()> load, std::function<void(T const &)> apply,
+		std::chrono::milliseconds timeout = menuLatencyCap)
+	{
+		struct Load
+		{
+			T result;
+			bool applied = false;
+			dispatch_semaphore_t done;
+		};
+		auto l = std::make_shared<Load>();
+		l->done = dispatch_semaphore_create(0);
+		dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^
+		{
+			l->result = load();
+			dispatch_semaphore_signal(l->done);
+			dispatch_async(dispatch_get_main_queue(), ^
+			{
+				if (!l->applied)
+				{
+					l->applied = true;
+					apply(l->result);
+				}
+			});
+		});
+		auto deadline = dispatch_time(DISPATCH_TIME_NOW,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+		if (dispatch_semaphore_wait(l->done, deadline) != 0)
+			return false;
+		l->applied = true;
+		apply(l->result);
+		return true;
+	}
+}
+
+#endif /* ZetaBackgroundLoad_hpp */
@@ -18,7 +18,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface ZetaBookmarkMenu : ZetaCommanderBase <NSMenuDelegate>
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs delegate:(ZetaMainMenu*)main;
+- (id)initWithFileSystemName:(NSString*)fsName delegate:(ZetaMainMenu*)main;
 
 - (void)menuNeedsUpdate:(NSMenu*)menu;
 
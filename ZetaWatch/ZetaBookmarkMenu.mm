@@ -10,27 +10,35 @@
 
 #import "ZetaMainMenu.h"
 
+#include "ZetaBackgroundLoad.hpp"
+
+struct BookmarkList
+{
+	std::vector<std::string> bookmarks;
+	std::string error;
+};
+
 @implementation ZetaBookmarkMenu
 {
-	zfs::ZFileSystem _fs;
+	NSString * _fsName;
 	ZetaMainMenu __weak * _delegate;
 }
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs delegate:(ZetaMainMenu*)delegate
+- (id)initWithFileSystemName:(NSString*)fsName delegate:(ZetaMainMenu*)delegate
 {
 	if (self = [super init])
 	{
-		_fs = std::move(fs);
+		_fsName = fsName;
 		_delegate = delegate;
 	}
 	return self;
 }
 
-NSMenuItem * createBookmarkMenu(zfs::ZFileSystem const & bookmark, ZetaMainMenu * delegate)
+NSMenuItem * createBookmarkMenu(std::string const & bookmark, ZetaMainMenu * delegate)
 {
 	NSMenu * bMenu = [[NSMenu alloc] init];
 	[bMenu setAutoenablesItems:NO];
-	NSString * bName = [NSString stringWithUTF8String:bookmark.name()];
+	NSString * bName = [NSString stringWithUTF8String:bookmark.c_str()];
 	auto addBookmarkCommand = [&](NSString * title, SEL selector)
 	{
 		auto item = [bMenu addItemWithTitle:title
@@ -45,23 +53,57 @@ NSMenuItem * createBookmarkMenu(zfs::ZFileSystem const & bookmark, ZetaMainMenu
 	return item;
 }
 
-- (void)menuNeedsUpdate:(NSMenu*)menu
+BookmarkList loadBookmarks(std::string const & fsName)
+{
+	BookmarkList list;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto fs = lib.filesystem(fsName);
+		for (auto const & bookmark : fs.bookmarks())
+			list.bookmarks.push_back(bookmark.name());
+	}
+	catch (std::exception const & e)
+	{
+		list.error = e.what();
+	}
+	return list;
+}
+
+void fillBookmarkMenu(NSMenu * menu, BookmarkList const & list, ZetaMainMenu * delegate)
 {
 	[menu removeAllItems];
-	auto bookmarks = _fs.bookmarks();
-	if (!bookmarks.empty())
+	auto const & bookmarks = list.bookmarks;
+	for (size_t i = bookmarks.size(); i > 0; --i)
 	{
-		for (size_t i = bookmarks.size(); i > 0; --i)
-		{
-			NSMenuItem * item = createBookmarkMenu(bookmarks[i-1], _delegate);
-			[menu addItem:item];
-		}
+		NSMenuItem * item = createBookmarkMenu(bookmarks[i-1], delegate);
+		[menu addItem:item];
 	}
-	else
+	if (!list.error.empty())
+	{
+		NSString * error = [NSString stringWithFormat:@"Exception during bookmark iteration: %s", list.error.c_str()];
+		[menu addItemWithTitle:error action:NULL keyEquivalent:@""];
+	}
+	else if (bookmarks.empty())
 	{
 		[menu addItemWithTitle:NSLocalizedString(@"No bookmarks found", @"No Bookmarks")
 						action:NULL keyEquivalent:@""];
 	}
 }
 
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	[menu removeAllItems];
+	std::string fsName = [_fsName UTF8String];
+	ZetaMainMenu * delegate = _delegate;
+	bool loaded = zeta::loadInBackground<BookmarkList>(
+		[fsName]{ return loadBookmarks(fsName); },
+		[menu, delegate](BookmarkList const & list){ fillBookmarkMenu(menu, list, delegate); });
+	if (!loaded)
+	{
+		[menu addItemWithTitle:NSLocalizedString(@"Refreshing...", @"Refreshing")
+						action:NULL keyEquivalent:@""];
+	}
+}
+
 @end
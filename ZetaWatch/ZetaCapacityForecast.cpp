@@ -0,0 +1,187 @@
+//
+//  ZetaCapacityForecast.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaCapacityForecast.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace zeta
+{
+	namespace
+	{
+		double const secondsPerDay = 24 * 60 * 60;
+	}
+
+	GrowthTrend::GrowthTrend(double timeConstant) :
+		m_timeConstant(timeConstant)
+	{
+	}
+
+	void GrowthTrend::add(double time, double value)
+	{
+		if (m_weight == 0)
+		{
+			m_origin = time;
+			m_first = time;
+		}
+		else
+		{
+			double decay = std::exp(-(time - m_last) / m_timeConstant);
+			m_weight *= decay;
+			m_t *= decay;
+			m_y *= decay;
+			m_tt *= decay;
+			m_ty *= decay;
+		}
+		if (time - m_origin > 4 * m_timeConstant)
+		{
+			// Move the origin to the newest sample, the sums are of t - origin
+			double shift = time - m_origin;
+			m_tt += shift * (m_weight * shift - 2 * m_t);
+			m_ty -= shift * m_y;
+			m_t -= shift * m_weight;
+			m_origin = time;
+		}
+		double t = time - m_origin;
+		m_weight += 1;
+		m_t += t;
+		m_y += value;
+		m_tt += t * t;
+		m_ty += t * value;
+		m_last = time;
+	}
+
+	double GrowthTrend::slope() const
+	{
+		double denominator = m_weight * m_tt - m_t * m_t;
+		if (!(denominator > 0))
+			return 0;
+		return (m_weight * m_ty - m_t * m_y) / denominator;
+	}
+
+	double GrowthTrend::span() const
+	{
+		return m_last - m_first;
+	}
+
+	CapacityForecaster::CapacityForecaster(std::chrono::hours timeConstant, std::chrono::hours minimumSpan) :
+		m_timeConstant(std::chrono::duration<double>(timeConstant).count()),
+		m_minimumSpan(std::chrono::duration<double>(minimumSpan).count())
+	{
+	}
+
+	void CapacityForecaster::record(std::string const & name, std::time_t time,
+		uint64_t used, uint64_t available)
+	{
+		auto it = m_entries.find(name);
+		if (it == m_entries.end())
+			it = m_entries.emplace(name, Entry{GrowthTrend(m_timeConstant)}).first;
+		auto & entry = it->second;
+		if (time <= entry.last)
+			return;
+		entry.trend.add(double(time), double(used));
+		entry.last = time;
+		entry.available = available;
+	}
+
+	CapacityForecast CapacityForecaster::forecast(std::string const & name) const
+	{
+		CapacityForecast f;
+		auto it = m_entries.find(name);
+		if (it == m_entries.end() || it->second.trend.span() < m_minimumSpan)
+			return f;
+		f.valid = true;
+		f.bytesPerDay = it->second.trend.slope() * secondsPerDay;
+		if (f.bytesPerDay > 0)
+			f.daysUntilFull = it->second.available / f.bytesPerDay;
+		return f;
+	}
+
+	void CapacityForecaster::forget(std::time_t before)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (it->second.last < before)
+				it = m_entries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	CapacityCandidates::CapacityCandidates(size_t count, std::chrono::seconds interval) :
+		m_count(count), m_interval(std::time_t(interval.count()))
+	{
+	}
+
+	bool CapacityCandidates::needsFullRead(std::string const & pool, std::time_t now) const
+	{
+		auto it = m_pools.find(pool);
+		return it == m_pools.end() || now - it->second.chosen >= m_interval || now < it->second.chosen;
+	}
+
+	bool CapacityCandidates::contains(std::string const & pool, std::string const & dataset) const
+	{
+		auto it = m_pools.find(pool);
+		return it != m_pools.end() && it->second.datasets.count(dataset) > 0;
+	}
+
+	void CapacityCandidates::choose(std::string const & pool,
+		std::vector<FileSystemState> const & fileSystems, std::time_t now)
+	{
+		uint64_t rootAvailable = 0;
+		for (auto const & fs : fileSystems)
+		{
+			if (fs.isRoot && fs.hasSpace)
+				rootAvailable = fs.available;
+		}
+		std::vector<FileSystemState const *> limited;
+		std::vector<FileSystemState const *> others;
+		for (auto const & fs : fileSystems)
+		{
+			if (fs.hasSpace)
+				(fs.available < rootAvailable ? limited : others).push_back(&fs);
+		}
+		auto take = [&](std::vector<FileSystemState const *> & list, auto better)
+		{
+			auto n = std::min(list.size(), m_count);
+			std::partial_sort(list.begin(), list.begin() + ptrdiff_t(n), list.end(), better);
+			list.resize(n);
+		};
+		take(limited, [](FileSystemState const * a, FileSystemState const * b)
+		{
+			return a->available < b->available;
+		});
+		take(others, [](FileSystemState const * a, FileSystemState const * b)
+		{
+			return a->used > b->used;
+		});
+		auto & entry = m_pools[pool];
+		entry.chosen = now;
+		entry.datasets.clear();
+		for (auto list : {&limited, &others})
+		{
+			for (auto fs : *list)
+			{
+				if (entry.datasets.size() < m_count)
+					entry.datasets.insert(fs->name);
+			}
+		}
+	}
+
+	void CapacityCandidates::forget(std::time_t before)
+	{
+		for (auto it = m_pools.begin(); it != m_pools.end();)
+		{
+			if (it->second.chosen < before)
+				it = m_pools.erase(it);
+			else
+				++it;
+		}
+	}
+}
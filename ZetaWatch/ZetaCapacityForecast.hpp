@@ -0,0 +1,132 @@
+//
+//  ZetaCapacityForecast.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaCapacityForecast_hpp
+#define ZetaCapacityForecast_hpp
+
+#include "ZetaPoolState.hpp"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+namespace zeta
+{
+	/*!
+	 \brief Least squares line through samples, with exponential forgetting
+
+	 Only the weighted sums are kept, so adding a sample and querying the
+	 slope are constant time. Older samples decay with the time constant, so
+	 the slope follows recent changes in the growth rate.
+	 */
+	class GrowthTrend
+	{
+	public:
+		explicit GrowthTrend(double timeConstant);
+
+		void add(double time, double value);
+		//! Value change per unit of time, 0 if not enough samples were added
+		double slope() const;
+		//! Time between the oldest and newest sample
+		double span() const;
+
+	private:
+		double m_timeConstant;
+		double m_origin = 0; //!< Time of the first sample, keeps the sums small
+		double m_first = 0;
+		double m_last = 0;
+		double m_weight = 0;
+		double m_t = 0;
+		double m_y = 0;
+		double m_tt = 0;
+		double m_ty = 0;
+	};
+
+	struct CapacityForecast
+	{
+		bool valid = false; //!< False until the history covers the minimum span
+		double bytesPerDay = 0;
+		double daysUntilFull = 0; //!< Only meaningful if bytesPerDay is positive
+	};
+
+	/*!
+	 Fits the growth of used space of pools or datasets, keyed by name, and
+	 extrapolates when the available space runs out.
+	 */
+	class CapacityForecaster
+	{
+	public:
+		explicit CapacityForecaster(std::chrono::hours timeConstant = std::chrono::hours(7 * 24),
+			std::chrono::hours minimumSpan = std::chrono::hours(12));
+
+		void record(std::string const & name, std::time_t time, uint64_t used, uint64_t available);
+		CapacityForecast forecast(std::string const & name) const;
+		//! Drops the entries that were not recorded since before
+		void forget(std::time_t before);
+
+	private:
+		struct Entry
+		{
+			GrowthTrend trend;
+			std::time_t last = 0;
+			uint64_t available = 0;
+		};
+
+	private:
+		double m_timeConstant;
+		double m_minimumSpan;
+		std::unordered_map<std::string, Entry> m_entries;
+	};
+
+	/*!
+	 \brief The datasets of each pool whose growth is forecast
+
+	 Datasets share the space of their pool, so only those limited by a quota
+	 or reservation fill up before it, and of the others only the largest
+	 matter. Instead of reading the space of every dataset on every refresh,
+	 the candidates are chosen from a read of all of them once per interval,
+	 and only theirs is read in between.
+	 */
+	class CapacityCandidates
+	{
+	public:
+		explicit CapacityCandidates(size_t count,
+			std::chrono::seconds interval = std::chrono::hours(1));
+
+		//! True if the space of all datasets of the pool should be read to choose again
+		bool needsFullRead(std::string const & pool, std::time_t now) const;
+		bool contains(std::string const & pool, std::string const & dataset) const;
+		/*!
+		 Chooses up to count datasets of the pool from those with hasSpace,
+		 first those with less available than the pool root, fullest first,
+		 then the largest others.
+		 */
+		void choose(std::string const & pool, std::vector<FileSystemState> const & fileSystems,
+			std::time_t now);
+		//! Drops pools that were not chosen for since before
+		void forget(std::time_t before);
+
+	private:
+		struct Pool
+		{
+			std::time_t chosen = 0;
+			std::unordered_set<std::string> datasets;
+		};
+
+	private:
+		size_t m_count;
+		std::time_t m_interval;
+		std::unordered_map<std::string, Pool> m_pools;
+	};
+}
+
+#endif /* ZetaCapacityForecast_hpp */
@@ -0,0 +1,217 @@
+//
+//  ZetaDatasetTree.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaDatasetTree.hpp"
+
+#include <functional>
+#include <algorithm>
+
+namespace zeta
+{
+	static constexpr uint32_t noComponent = uint32_t(-1);
+
+	static size_t componentEnd(std::string_view name, size_t begin)
+	{
+		auto end = name.find_first_of("/@#", begin);
+		return end == std::string_view::npos ? name.size() : end;
+	}
+
+	static DatasetKind kindForSeparator(char separator)
+	{
+		switch (separator)
+		{
+			case '@': return DatasetKind::snapshot;
+			case '#': return DatasetKind::bookmark;
+			default: return DatasetKind::filesystem;
+		}
+	}
+
+	static char separatorForKind(DatasetKind kind)
+	{
+		switch (kind)
+		{
+			case DatasetKind::snapshot: return '@';
+			case DatasetKind::bookmark: return '#';
+			default: return '/';
+		}
+	}
+
+	DatasetTree::List DatasetTree::listOf(DatasetKind kind)
+	{
+		switch (kind)
+		{
+			case DatasetKind::snapshot: return snapshotList;
+			case DatasetKind::bookmark: return bookmarkList;
+			default: return childList;
+		}
+	}
+
+	uint64_t DatasetTree::childKey(DatasetIndex parent, List list, uint32_t component)
+	{
+		// Roots have noDataset as parent, which wraps around to zero
+		return (uint64_t(parent + 1) << 32) | (uint64_t(list) << 30) | component;
+	}
+
+	DatasetTree::Range DatasetTree::list(DatasetIndex index, List l) const
+	{
+		return Range(this, m_nodes[index].first[l]);
+	}
+
+	std::string_view DatasetTree::component(DatasetIndex index) const
+	{
+		auto const & c = m_components[m_nodes[index].component];
+		return std::string_view(m_arena.data() + c.offset, c.length);
+	}
+
+	void DatasetTree::appendName(DatasetIndex index, std::string & name) const
+	{
+		// Well above the nesting limit of zfs, which is 50 by default
+		DatasetIndex path[256];
+		uint32_t depth = 0;
+		for (auto i = index; i != noDataset && depth < 256; i = m_nodes[i].parent)
+			path[depth++] = i;
+		for (uint32_t d = depth; d > 0; --d)
+		{
+			auto i = path[d-1];
+			if (d != depth)
+				name.push_back(separatorForKind(m_nodes[i].kind));
+			name.append(component(i));
+		}
+	}
+
+	std::string DatasetTree::name(DatasetIndex index) const
+	{
+		std::string n;
+		appendName(index, n);
+		return n;
+	}
+
+	uint32_t DatasetTree::findComponent(std::string_view component) const
+	{
+		if (m_componentSlots.empty())
+			return noComponent;
+		size_t mask = m_componentSlots.size() - 1;
+		for (size_t s = std::hash<std::string_view>()(component) & mask;; s = (s + 1) & mask)
+		{
+			auto slot = m_componentSlots[s];
+			if (slot == 0)
+				return noComponent;
+			auto const & c = m_components[slot - 1];
+			if (std::string_view(m_arena.data() + c.offset, c.length) == component)
+				return slot - 1;
+		}
+	}
+
+	void DatasetTree::growComponentSlots()
+	{
+		std::vector<uint32_t> slots(std::max<size_t>(64, m_componentSlots.size() * 2), 0);
+		size_t mask = slots.size() - 1;
+		for (uint32_t id = 0; id < m_components.size(); ++id)
+		{
+			auto const & c = m_components[id];
+			std::string_view v(m_arena.data() + c.offset, c.length);
+			size_t s = std::hash<std::string_view>()(v) & mask;
+			while (slots[s] != 0)
+				s = (s + 1) & mask;
+			slots[s] = id + 1;
+		}
+		m_componentSlots = std::move(slots);
+	}
+
+	uint32_t DatasetTree::intern(std::string_view component)
+	{
+		auto id = findComponent(component);
+		if (id != noComponent)
+			return id;
+		// Keep the load factor below one half
+		if ((m_components.size() + 1) * 2 > m_componentSlots.size())
+			growComponentSlots();
+		id = uint32_t(m_components.size());
+		m_components.push_back({uint32_t(m_arena.size()), uint32_t(component.size())});
+		m_arena.append(component);
+		size_t mask = m_componentSlots.size() - 1;
+		size_t s = std::hash<std::string_view>()(component) & mask;
+		while (m_componentSlots[s] != 0)
+			s = (s + 1) & mask;
+		m_componentSlots[s] = id + 1;
+		return id;
+	}
+
+	DatasetIndex DatasetTree::findChild(DatasetIndex parent, std::string_view component, DatasetKind kind) const
+	{
+		auto c = findComponent(component);
+		if (c == noComponent)
+			return noDataset;
+		auto it = m_childIndex.find(childKey(parent, listOf(kind), c));
+		return it != m_childIndex.end() ? it->second : noDataset;
+	}
+
+	DatasetIndex DatasetTree::insertChild(DatasetIndex parent, std::string_view component, DatasetKind kind)
+	{
+		auto c = intern(component);
+		auto l = listOf(kind);
+		auto key = childKey(parent, l, c);
+		auto it = m_childIndex.find(key);
+		if (it != m_childIndex.end())
+			return it->second;
+		auto index = DatasetIndex(m_nodes.size());
+		Node node;
+		node.component = c;
+		node.parent = parent;
+		node.depth = parent == noDataset ? 0 : m_nodes[parent].depth + 1;
+		node.kind = kind;
+		m_nodes.push_back(node);
+		m_childIndex.emplace(key, index);
+		auto & first = parent == noDataset ? m_firstRoot : m_nodes[parent].first[l];
+		auto & last = parent == noDataset ? m_lastRoot : m_nodes[parent].last[l];
+		if (last != noDataset)
+			m_nodes[last].next = index;
+		else
+			first = index;
+		last = index;
+		return index;
+	}
+
+	DatasetIndex DatasetTree::insert(std::string_view name, DatasetKind kind)
+	{
+		DatasetIndex index = noDataset;
+		size_t begin = 0;
+		auto currentKind = DatasetKind::filesystem;
+		while (true)
+		{
+			size_t end = componentEnd(name, begin);
+			bool last = end == name.size();
+			index = insertChild(index, name.substr(begin, end - begin), last ? kind : currentKind);
+			if (last)
+				return index;
+			currentKind = kindForSeparator(name[end]);
+			begin = end + 1;
+		}
+	}
+
+	DatasetIndex DatasetTree::find(std::string_view name) const
+	{
+		DatasetIndex index = noDataset;
+		size_t begin = 0;
+		auto currentKind = DatasetKind::filesystem;
+		while (true)
+		{
+			size_t end = componentEnd(name, begin);
+			index = findChild(index, name.substr(begin, end - begin), currentKind);
+			if (index == noDataset || end == name.size())
+				return index;
+			currentKind = kindForSeparator(name[end]);
+			begin = end + 1;
+		}
+	}
+
+	std::string_view poolName(std::string_view datasetName)
+	{
+		return datasetName.substr(0, componentEnd(datasetName, 0));
+	}
+}
@@ -0,0 +1,158 @@
+//
+//  ZetaDatasetTree.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaDatasetTree_hpp
+#define ZetaDatasetTree_hpp
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <iterator>
+#include <cstdint>
+
+namespace zeta
+{
+	typedef uint32_t DatasetIndex;
+	constexpr DatasetIndex noDataset = DatasetIndex(-1);
+
+	enum class DatasetKind : uint8_t
+	{
+		filesystem,
+		volume,
+		snapshot,
+		bookmark,
+	};
+
+	/*!
+	 \brief Compact tree of dataset names
+
+	 Datasets are nodes in a flat array, and are referred to by their index.
+	 Each node stores its parent and only the last component of its name.
+	 Components are interned in a single arena, so that names that repeat
+	 across datasets, such as snapshot names created by a schedule, are only
+	 stored once. Child filesystems and volumes, snapshots and bookmarks of a
+	 dataset are separate lists in insertion order.
+
+	 Full names are only parsed when datasets are inserted or looked up by
+	 name, all other queries work on indices.
+	 */
+	class DatasetTree
+	{
+	public:
+		class Range
+		{
+		public:
+			class iterator
+			{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef DatasetIndex value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef DatasetIndex const * pointer;
+				typedef DatasetIndex reference;
+
+			public:
+				iterator(DatasetTree const * tree, DatasetIndex index) : m_tree(tree), m_index(index) {}
+				DatasetIndex operator*() const { return m_index; }
+				iterator & operator++() { m_index = m_tree->m_nodes[m_index].next; return *this; }
+				bool operator==(iterator const & o) const { return m_index == o.m_index; }
+				bool operator!=(iterator const & o) const { return m_index != o.m_index; }
+
+			private:
+				DatasetTree const * m_tree;
+				DatasetIndex m_index;
+			};
+
+		public:
+			Range(DatasetTree const * tree, DatasetIndex first) : m_tree(tree), m_first(first) {}
+			iterator begin() const { return iterator(m_tree, m_first); }
+			iterator end() const { return iterator(m_tree, noDataset); }
+			bool empty() const { return m_first == noDataset; }
+
+		private:
+			DatasetTree const * m_tree;
+			DatasetIndex m_first;
+		};
+
+	public:
+		//! Inserts a dataset by its full name, missing parents are added as filesystems
+		DatasetIndex insert(std::string_view name, DatasetKind kind);
+		//! Inserts a dataset below parent, component is the last part of its name
+		DatasetIndex insertChild(DatasetIndex parent, std::string_view component, DatasetKind kind);
+
+		DatasetIndex find(std::string_view name) const;
+		DatasetIndex findChild(DatasetIndex parent, std::string_view component, DatasetKind kind) const;
+
+	public:
+		size_t size() const { return m_nodes.size(); }
+		size_t componentCount() const { return m_components.size(); }
+
+		DatasetIndex parent(DatasetIndex index) const { return m_nodes[index].parent; }
+		DatasetKind kind(DatasetIndex index) const { return m_nodes[index].kind; }
+		uint32_t depth(DatasetIndex index) const { return m_nodes[index].depth; }
+		//! The last name component, valid until the next insertion
+		std::string_view component(DatasetIndex index) const;
+		std::string name(DatasetIndex index) const;
+		void appendName(DatasetIndex index, std::string & name) const;
+
+		Range roots() const { return Range(this, m_firstRoot); }
+		Range children(DatasetIndex index) const { return list(index, childList); }
+		Range snapshots(DatasetIndex index) const { return list(index, snapshotList); }
+		Range bookmarks(DatasetIndex index) const { return list(index, bookmarkList); }
+
+	private:
+		enum List : uint8_t
+		{
+			childList,
+			snapshotList,
+			bookmarkList,
+			listCount,
+		};
+
+		struct Node
+		{
+			uint32_t component;
+			DatasetIndex parent;
+			DatasetIndex next = noDataset;
+			DatasetIndex first[listCount] = { noDataset, noDataset, noDataset };
+			DatasetIndex last[listCount] = { noDataset, noDataset, noDataset };
+			uint16_t depth;
+			DatasetKind kind;
+		};
+
+		struct Component
+		{
+			uint32_t offset;
+			uint32_t length;
+		};
+
+	private:
+		static List listOf(DatasetKind kind);
+		static uint64_t childKey(DatasetIndex parent, List list, uint32_t component);
+		Range list(DatasetIndex index, List l) const;
+		uint32_t intern(std::string_view component);
+		uint32_t findComponent(std::string_view component) const;
+		void growComponentSlots();
+
+	private:
+		std::vector<Node> m_nodes;
+		DatasetIndex m_firstRoot = noDataset;
+		DatasetIndex m_lastRoot = noDataset;
+		std::unordered_map<uint64_t, DatasetIndex> m_childIndex;
+		// Interned name components, open addressing into m_components
+		std::string m_arena;
+		std::vector<Component> m_components;
+		std::vector<uint32_t> m_componentSlots;
+	};
+
+	//! The first component of a dataset name
+	std::string_view poolName(std::string_view datasetName);
+}
+
+#endif /* ZetaDatasetTree_hpp */
@@ -0,0 +1,129 @@
+//
+//  ZetaDependencyGraph.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaDependencyGraph.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	void DependencyGraph::resize()
+	{
+		m_origin.resize(m_names.size(), noDataset);
+		m_firstClone.resize(m_names.size(), noDataset);
+		m_nextClone.resize(m_names.size(), noDataset);
+		m_createTXG.resize(m_names.size(), 0);
+	}
+
+	DatasetIndex DependencyGraph::add(std::string_view name, DatasetKind kind, uint64_t createTXG)
+	{
+		auto index = m_names.insert(name, kind);
+		resize();
+		m_createTXG[index] = createTXG;
+		return index;
+	}
+
+	void DependencyGraph::setOrigin(DatasetIndex clone, std::string_view originSnapshot)
+	{
+		auto origin = m_names.find(originSnapshot);
+		if (origin == noDataset || m_origin[clone] != noDataset)
+			return;
+		m_origin[clone] = origin;
+		m_nextClone[clone] = m_firstClone[origin];
+		m_firstClone[origin] = clone;
+	}
+
+	DatasetIndex DependencyGraph::origin(DatasetIndex dataset) const
+	{
+		return m_origin[dataset];
+	}
+
+	std::vector<DatasetIndex> DependencyGraph::clones(DatasetIndex snapshot) const
+	{
+		std::vector<DatasetIndex> clones;
+		for (auto c = m_firstClone[snapshot]; c != noDataset; c = m_nextClone[c])
+			clones.push_back(c);
+		return clones;
+	}
+
+	std::vector<DatasetIndex> DependencyGraph::laterSnapshots(DatasetIndex snapshot) const
+	{
+		std::vector<DatasetIndex> later;
+		auto parent = m_names.parent(snapshot);
+		if (parent == noDataset)
+			return later;
+		auto txg = m_createTXG[snapshot];
+		for (auto s : m_names.snapshots(parent))
+		{
+			if (m_createTXG[s] > txg)
+				later.push_back(s);
+		}
+		std::sort(later.begin(), later.end(), [&](DatasetIndex a, DatasetIndex b)
+		{
+			return m_createTXG[a] < m_createTXG[b];
+		});
+		return later;
+	}
+
+	void DependencyGraph::collectDependents(DatasetIndex dataset, std::vector<DatasetIndex> & dependents,
+		std::vector<bool> & visited) const
+	{
+		// Bookmarks are not listed, like in zfs_iter_dependents. An explicit
+		// stack is used since clone chains can be much deeper than the hierarchy
+		std::vector<DatasetIndex> stack(1, dataset);
+		while (!stack.empty())
+		{
+			auto d = stack.back();
+			stack.pop_back();
+			auto push = [&](DatasetIndex i)
+			{
+				if (!visited[i])
+				{
+					visited[i] = true;
+					dependents.push_back(i);
+					stack.push_back(i);
+				}
+			};
+			for (auto c : m_names.children(d))
+				push(c);
+			for (auto s : m_names.snapshots(d))
+				push(s);
+			for (auto c = m_firstClone[d]; c != noDataset; c = m_nextClone[c])
+				push(c);
+		}
+	}
+
+	std::vector<DatasetIndex> DependencyGraph::destroyDependents(DatasetIndex dataset) const
+	{
+		std::vector<DatasetIndex> dependents;
+		std::vector<bool> visited(m_names.size(), false);
+		visited[dataset] = true;
+		collectDependents(dataset, dependents, visited);
+		return dependents;
+	}
+
+	std::vector<DatasetIndex> DependencyGraph::rollbackClones(DatasetIndex snapshot) const
+	{
+		std::vector<DatasetIndex> clones;
+		std::vector<bool> visited(m_names.size(), false);
+		for (auto s : laterSnapshots(snapshot))
+		{
+			visited[s] = true;
+			for (auto c = m_firstClone[s]; c != noDataset; c = m_nextClone[c])
+			{
+				if (!visited[c])
+				{
+					visited[c] = true;
+					clones.push_back(c);
+					collectDependents(c, clones, visited);
+				}
+			}
+		}
+		return clones;
+	}
+}
@@ -0,0 +1,102 @@
+//
+//  ZetaDependencyGraph.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaDependencyGraph_hpp
+#define ZetaDependencyGraph_hpp
+
+#include "ZetaDatasetTree.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+namespace zeta
+{
+	/*!
+	 \brief Clone dependencies between the datasets of a pool
+
+	 Combines the dataset hierarchy with the origin of every clone, so that
+	 the datasets that rollbacks and recursive destroys take with them can be
+	 found without asking libzfs about each snapshot. Snapshots are ordered by
+	 their createtxg, not by the order they were added in.
+	 */
+	class DependencyGraph
+	{
+	public:
+		//! createTXG is only used for snapshots
+		DatasetIndex add(std::string_view name, DatasetKind kind, uint64_t createTXG = 0);
+		//! Records that clone was created from the snapshot with the given name
+		void setOrigin(DatasetIndex clone, std::string_view originSnapshot);
+
+	public:
+		DatasetTree const & names() const { return m_names; }
+		DatasetIndex find(std::string_view name) const { return m_names.find(name); }
+		DatasetIndex origin(DatasetIndex dataset) const;
+		uint64_t createTXG(DatasetIndex dataset) const { return m_createTXG[dataset]; }
+		std::vector<DatasetIndex> clones(DatasetIndex snapshot) const;
+
+		//! Snapshots with a later createtxg in the same dataset, oldest first, which rolling back destroys
+		std::vector<DatasetIndex> laterSnapshots(DatasetIndex snapshot) const;
+		//! Everything destroyed with dataset when destroying recursively, including clones, but no bookmarks
+		std::vector<DatasetIndex> destroyDependents(DatasetIndex dataset) const;
+		//! Everything destroyed by rolling back to snapshot, except the later snapshots and bookmarks
+		std::vector<DatasetIndex> rollbackClones(DatasetIndex snapshot) const;
+
+	private:
+		void resize();
+		void collectDependents(DatasetIndex dataset, std::vector<DatasetIndex> & dependents,
+			std::vector<bool> & visited) const;
+
+	private:
+		DatasetTree m_names;
+		std::vector<DatasetIndex> m_origin;
+		std::vector<DatasetIndex> m_firstClone;
+		std::vector<DatasetIndex> m_nextClone;
+		std::vector<uint64_t> m_createTXG;
+	};
+
+	/*!
+	 Adds the given file systems of a pool with their snapshots and bookmarks
+	 to the graph. FileSystem is zfs::ZFileSystem, this is a template so that
+	 the app and the helper can use it with their own include of ZFSWrapper.
+	 createTXG returns the createtxg of a snapshot, from the properties its
+	 handle already holds. Reads one property list per file system, and none
+	 per snapshot.
+	 */
+	template<typename FileSystem, typename CreateTXG>
+	void addFileSystems(DependencyGraph & graph, std::vector<FileSystem> const & fileSystems,
+		CreateTXG createTXG)
+	{
+		// Origins are set last, once every snapshot they can refer to exists
+		std::vector<std::pair<DatasetIndex, std::string>> origins;
+		for (auto const & fs : fileSystems)
+		{
+			auto kind = fs.type() == FileSystem::FSType::volume ? DatasetKind::volume : DatasetKind::filesystem;
+			auto index = graph.add(fs.name(), kind);
+			for (auto const & snap : fs.snapshots())
+				graph.add(snap.name(), DatasetKind::snapshot, createTXG(snap));
+			for (auto const & bookmark : fs.bookmarks())
+				graph.add(bookmark.name(), DatasetKind::bookmark);
+			for (auto const & p : fs.properties())
+			{
+				if (p.name == "origin")
+				{
+					if (!p.value.empty() && p.value != "-")
+						origins.emplace_back(index, p.value);
+					break;
+				}
+			}
+		}
+		for (auto const & o : origins)
+			graph.setOrigin(o.first, o.second);
+	}
+}
+
+#endif /* ZetaDependencyGraph_hpp */
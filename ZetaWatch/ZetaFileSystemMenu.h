@@ -0,0 +1,31 @@
+//
+//  ZetaFileSystemMenu.h
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "ZetaCommanderBase.h"
+
+#include "ZetaPoolState.hpp"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class ZetaMainMenu;
+
+/*!
+ Builds the submenu of a single dataset when it is opened. The pool menu only
+ knows the dataset summary, the remaining properties are read on demand.
+ */
+@interface ZetaFileSystemMenu : ZetaCommanderBase <NSMenuDelegate>
+
+- (id)initWithFileSystem:(zeta::FileSystemState const &)fs delegate:(ZetaMainMenu*)main;
+
+- (void)menuNeedsUpdate:(NSMenu*)menu;
+
+@end
+
+NS_ASSUME_NONNULL_END
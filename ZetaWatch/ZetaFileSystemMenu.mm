@@ -0,0 +1,204 @@
+//
+//  ZetaFileSystemMenu.mm
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#import "ZetaFileSystemMenu.h"
+
+#import "ZetaMainMenu.h"
+#import "ZetaSnapshotMenu.h"
+#import "ZetaBookmarkMenu.h"
+#import "ZetaFileSystemPropertyMenu.h"
+
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaBackgroundLoad.hpp"
+
+struct FileSystemDetailsResult
+{
+	zeta::FileSystemDetails details;
+	std::string error;
+};
+
+@implementation ZetaFileSystemMenu
+{
+	zeta::FileSystemState _fs;
+	ZetaMainMenu __weak * _delegate;
+}
+
+- (id)initWithFileSystem:(zeta::FileSystemState const &)fs delegate:(ZetaMainMenu*)delegate
+{
+	if (self = [super init])
+	{
+		_fs = fs;
+		_delegate = delegate;
+	}
+	return self;
+}
+
+void fillFileSystemMenu(NSMenu * fsMenu, zeta::FileSystemState const & fs,
+	FileSystemDetailsResult const * result, ZetaMainMenu * delegate)
+{
+	[fsMenu removeAllItems];
+	[fsMenu setAutoenablesItems:NO];
+	bool hasDetails = result && result->error.empty();
+	zeta::FileSystemDetails const * details = hasDetails ? &result->details : nullptr;
+	NSString * fsName = [NSString stringWithUTF8String:fs.name.c_str()];
+	auto addFSCommand = [&](NSString * title, SEL selector)
+	{
+		auto item = [fsMenu addItemWithTitle:title
+									  action:selector keyEquivalent:@""];
+		item.representedObject = fsName;
+		item.target = delegate;
+	};
+	if (fs.type == zeta::FileSystemState::Type::filesystem)
+	{
+		if (fs.isEncryptionRoot)
+		{
+			if (fs.keyStatus != zeta::FileSystemState::KeyStatus::available)
+			{
+				addFSCommand(NSLocalizedString(@"Load Key...", @"Load Key"), @selector(loadKey:));
+			}
+			else
+			{
+				addFSCommand(NSLocalizedString(@"Unload Key", @"Unload Key"), @selector(unloadKey:));
+			}
+			[fsMenu addItem:[NSMenuItem separatorItem]];
+		}
+		addFSCommand(NSLocalizedString(@"Mount Recursively", @"Mount Recursively"), @selector(mountFilesystemRecursive:));
+		if (!fs.mounted && (!details || details->mountable))
+		{
+			addFSCommand(NSLocalizedString(@"Mount", @"Mount"), @selector(mountFilesystem:));
+		}
+		addFSCommand(NSLocalizedString(@"Unmount Recursively", @"Unmount Recursively"), @selector(unmountFilesystemRecursive:));
+		if (fs.mounted)
+		{
+			addFSCommand(NSLocalizedString(@"Unmount", @"Unmount"), @selector(unmountFilesystem:));
+			addFSCommand(NSLocalizedString(@"Unmount (Force)", @"Unmount (Force)"), @selector(unmountFilesystemForce:));
+		}
+	}
+	// Snapshots
+	[fsMenu addItem:[NSMenuItem separatorItem]];
+	addFSCommand(NSLocalizedString(@"Snapshot...", @"Snapshot"), @selector(snapshotFilesystem:));
+	addFSCommand(NSLocalizedString(@"Snapshot Recursively...", @"Snapshot Recursively"), @selector(snapshotFilesystemRecursive:));
+	{
+		// Snapshots submenu
+		NSString * snapsTitle = NSLocalizedString(@"Snapshots", @"Snapshots");
+		NSMenu * snaps = [[NSMenu alloc] initWithTitle:snapsTitle];
+		ZetaSnapshotMenu * sd = [[ZetaSnapshotMenu alloc] initWithFileSystemName:fsName delegate:delegate];
+		snaps.delegate = sd;
+		NSMenuItem * snapsItem = [[NSMenuItem alloc] initWithTitle:snapsTitle
+			action:nullptr keyEquivalent:@""];
+		snapsItem.submenu = snaps;
+		snapsItem.representedObject = sd;
+		[fsMenu addItem:snapsItem];
+	}
+	{
+		// Bookmarks Submenu
+		NSString * bookmarksTitle = NSLocalizedString(@"Bookmarks", @"Bookmarks");
+		NSMenu * bookmarks = [[NSMenu alloc] initWithTitle:bookmarksTitle];
+		ZetaBookmarkMenu * bd = [[ZetaBookmarkMenu alloc] initWithFileSystemName:fsName delegate:delegate];
+		bookmarks.delegate = bd;
+		NSMenuItem * bookmarksItem = [[NSMenuItem alloc] initWithTitle:bookmarksTitle
+			action:nullptr keyEquivalent:@""];
+		bookmarksItem.submenu = bookmarks;
+		bookmarksItem.representedObject = bd;
+		[fsMenu addItem:bookmarksItem];
+	}
+	// Create
+	[fsMenu addItem:[NSMenuItem separatorItem]];
+	addFSCommand(NSLocalizedString(@"Create Filesystem...", @"Create Filesystem..."),
+		@selector(createFilesystem:));
+	addFSCommand(NSLocalizedString(@"Create Volume...", @"Create Volume..."),
+		@selector(createVolume:));
+	// Destroy
+	[fsMenu addItem:[NSMenuItem separatorItem]];
+	if (!fs.isRoot)
+	{
+		addFSCommand(NSLocalizedString(@"Destroy", @"Destroy"), @selector(destroy:));
+	}
+	addFSCommand(NSLocalizedString(@"Destroy Recursively", @"Destroy Recursively"), @selector(destroyRecursive:));
+	// Selected Properties
+	[fsMenu addItem:[NSMenuItem separatorItem]];
+	if (!result)
+	{
+		[fsMenu addItemWithTitle:NSLocalizedString(@"Refreshing...", @"Refreshing")
+						  action:NULL keyEquivalent:@""];
+	}
+	else if (!details)
+	{
+		NSString * error = [NSString stringWithFormat:@"Exception during property iteration: %s", result->error.c_str()];
+		[fsMenu addItemWithTitle:error action:NULL keyEquivalent:@""];
+	}
+	else
+	{
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Available:          \t %s", @"FS Available Menu Entry"),
+					formatBytes(details->available));
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Used:               \t %s", @"FS Used Menu Entry"),
+					formatBytes(details->used));
+		auto forecast = [[delegate poolWatcher] capacityForecastForDataset:fs.name];
+		if (forecast.valid && forecast.bytesPerDay > 0)
+		{
+			addMenuItem(fsMenu, delegate,
+						NSLocalizedString(@"Growth:             \t %s per day, full in about %llu days", @"FS Growth Menu Entry"),
+						formatBytes(uint64_t(forecast.bytesPerDay)), uint64_t(forecast.daysUntilFull));
+		}
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Referenced:         \t %s", @"FS Referenced Menu Entry"),
+					formatBytes(details->referenced));
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Logical Used:       \t %s", @"FS Logically Used Menu Entry"),
+					formatBytes(details->logicalused));
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Compression Ratio:  \t %1.2fx", @"FS Compression Menu Entry"),
+					details->compressRatio);
+		addMenuItem(fsMenu, delegate,
+					NSLocalizedString(@"Mount Point:        \t %s", @"FS Mountpoint Menu Entry"),
+					details->mountpoint);
+	}
+	// All Properties
+	NSString * allPropsTitle = NSLocalizedString(@"All Properties", @"All Properties");
+	NSMenu * allProps = [[NSMenu alloc] initWithTitle:allPropsTitle];
+	ZetaFileSystemPropertyMenu * pd = [[ZetaFileSystemPropertyMenu alloc] initWithFileSystemName:fsName];
+	allProps.delegate = pd;
+	NSMenuItem * allPropsItem = [[NSMenuItem alloc] initWithTitle:allPropsTitle
+		action:nullptr keyEquivalent:@""];
+	allPropsItem.submenu = allProps;
+	allPropsItem.representedObject = pd;
+	[fsMenu addItem:allPropsItem];
+}
+
+FileSystemDetailsResult loadDetails(std::string const & fsName)
+{
+	FileSystemDetailsResult result;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		result.details = zeta::loadFileSystemDetails(lib.filesystem(fsName));
+	}
+	catch (std::exception const & e)
+	{
+		result.error = e.what();
+	}
+	return result;
+}
+
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	zeta::FileSystemState fs = _fs;
+	ZetaMainMenu * delegate = _delegate;
+	bool loaded = zeta::loadInBackground<FileSystemDetailsResult>(
+		[name = fs.name]{ return loadDetails(name); },
+		[menu, fs, delegate](FileSystemDetailsResult const & result)
+		{ fillFileSystemMenu(menu, fs, &result, delegate); });
+	if (!loaded)
+	{
+		fillFileSystemMenu(menu, fs, nullptr, delegate);
+	}
+}
+
+@end
@@ -15,7 +15,7 @@
 
 @interface ZetaFileSystemPropertyMenu : ZetaCommanderBase <NSMenuDelegate>
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs;
+- (id)initWithFileSystemName:(NSString*)fsName;
 
 - (void)menuNeedsUpdate:(NSMenu*)menu;
 
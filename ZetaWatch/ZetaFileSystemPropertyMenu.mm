@@ -8,25 +8,57 @@
 
 #import "ZetaFileSystemPropertyMenu.h"
 
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaBackgroundLoad.hpp"
+
+struct PropertyList
+{
+	struct Property
+	{
+		std::string name;
+		std::string value;
+		std::string source;
+	};
+	std::vector<Property> properties;
+	std::string error;
+};
+
 @implementation ZetaFileSystemPropertyMenu
 {
-	zfs::ZFileSystem _fs;
+	NSString * _fsName;
 }
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs
+- (id)initWithFileSystemName:(NSString*)fsName
 {
 	if (self = [super init])
 	{
-		_fs = std::move(fs);
+		_fsName = fsName;
 	}
 	return self;
 }
 
-- (void)menuNeedsUpdate:(NSMenu*)menu
+PropertyList loadFileSystemProperties(std::string const & fsName)
+{
+	PropertyList list;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto fs = lib.filesystem(fsName);
+		for (auto const & p : fs.properties())
+			list.properties.push_back({p.name, p.value, p.source});
+		zeta::countPropertyReads(list.properties.size());
+	}
+	catch (std::exception const & e)
+	{
+		list.error = e.what();
+	}
+	return list;
+}
+
+- (void)fillMenu:(NSMenu*)menu withProperties:(PropertyList const &)list
 {
 	[menu removeAllItems];
-	auto props = _fs.properties();
-	for (auto const & p : props)
+	for (auto const & p : list.properties)
 	{
 		if (p.source.size() > 0)
 		{
@@ -39,6 +71,26 @@
 						p.name, p.value);
 		}
 	}
+	if (!list.error.empty())
+	{
+		NSString * error = [NSString stringWithFormat:@"Exception during property iteration: %s", list.error.c_str()];
+		[menu addItemWithTitle:error action:NULL keyEquivalent:@""];
+	}
+}
+
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	[menu removeAllItems];
+	std::string fsName = [_fsName UTF8String];
+	ZetaFileSystemPropertyMenu __weak * weakSelf = self;
+	bool loaded = zeta::loadInBackground<PropertyList>(
+		[fsName]{ return loadFileSystemProperties(fsName); },
+		[menu, weakSelf](PropertyList const & list){ [weakSelf fillMenu:menu withProperties:list]; });
+	if (!loaded)
+	{
+		[menu addItemWithTitle:NSLocalizedString(@"Refreshing...", @"Refreshing")
+						action:NULL keyEquivalent:@""];
+	}
 }
 
 @end
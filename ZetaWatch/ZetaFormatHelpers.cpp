@@ -8,25 +8,247 @@
 
 #include "ZetaFormatHelpers.hpp"
 
-Prefix const metricPrefixes[] = {
-	{ 1000000000000000000, "E" },
-	{    1000000000000000, "P" },
-	{       1000000000000, "T" },
-	{	       1000000000, "G" },
-	{             1000000, "M" },
-	{                1000, "k" },
-};
-
-size_t const metricPrefixCount = std::extent<decltype(metricPrefixes)>::value;
-
-// https://en.wikipedia.org/wiki/Binary_prefix
-Prefix const binaryPrefixes[] = {
-	{ 1ull << 60, "Ei" },
-	{ 1ull << 50, "Pi" },
-	{ 1ull << 40, "Ti" },
-	{ 1ull << 30, "Gi" },
-	{ 1ull << 20, "Mi" },
-	{ 1ull << 10, "ki" },
-};
-
-size_t const binaryPrefixCount = std::extent<decltype(binaryPrefixes)>::value;
+#include <algorithm>
+#include <charconv>
+
+namespace
+{
+	typedef unsigned __int128 uint128_t;
+
+	constexpr uint64_t powersOfTen[] = {
+		1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+		100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+		10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+		100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+	};
+
+	constexpr size_t maxDecimals = std::extent_v<decltype(powersOfTen)> - 1;
+
+	char * appendText(char * first, char * last, std::string_view text)
+	{
+		if (!first || size_t(last - first) < text.size())
+			return nullptr;
+		return std::copy(text.begin(), text.end(), first);
+	}
+
+	char * appendNumber(char * first, char * last, uint64_t value)
+	{
+		if (!first)
+			return nullptr;
+		auto result = std::to_chars(first, last, value);
+		return result.ec == std::errc() ? result.ptr : nullptr;
+	}
+
+	//! numerator / denominator in units of 1 / scale, rounded with ties to even like printf
+	uint128_t roundedQuotient(uint64_t numerator, uint64_t denominator, uint64_t scale)
+	{
+		uint128_t scaled = uint128_t(numerator) * scale / denominator;
+		uint128_t remainder = uint128_t(numerator) * scale % denominator;
+		if (remainder * 2 > denominator || (remainder * 2 == denominator && scaled % 2 == 1))
+			++scaled;
+		return scaled;
+	}
+
+	char * appendFixed(char * first, char * last, uint64_t numerator, uint64_t denominator,
+		size_t decimals)
+	{
+		uint64_t scale = powersOfTen[decimals];
+		uint128_t scaled = roundedQuotient(numerator, denominator, scale);
+		first = appendNumber(first, last, uint64_t(scaled / scale));
+		if (decimals == 0)
+			return first;
+		first = appendText(first, last, ".");
+		char digits[maxDecimals];
+		uint64_t fraction = uint64_t(scaled % scale);
+		for (size_t d = decimals; d > 0; --d, fraction /= 10)
+			digits[d - 1] = char('0' + fraction % 10);
+		return appendText(first, last, std::string_view(digits, decimals));
+	}
+
+	char toLower(char c)
+	{
+		return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+	}
+
+	bool startsWithIgnoringCase(std::string_view string, std::string_view start)
+	{
+		if (string.size() < start.size())
+			return false;
+		for (size_t i = 0; i < start.size(); ++i)
+		{
+			if (toLower(string[i]) != toLower(start[i]))
+				return false;
+		}
+		return true;
+	}
+
+	bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	std::string toString(char const * first, char const * last)
+	{
+		return last ? std::string(first, last) : std::string();
+	}
+}
+
+char * formatPrefixedValue(char * first, char * last, uint64_t size,
+	Prefix const * prefix, size_t prefixCount)
+{
+	for (size_t p = 0; p < prefixCount; ++p)
+	{
+		if (size >= prefix[p].factor)
+		{
+			// Values that round up to the next prefix are written with it, so they parse back the same
+			if (p > 0 && roundedQuotient(size, prefix[p].factor, 100) >=
+				uint128_t(prefix[p - 1].factor / prefix[p].factor) * 100)
+				--p;
+			first = appendFixed(first, last, size, prefix[p].factor, 2);
+			first = appendText(first, last, " ");
+			return appendText(first, last, prefix[p].prefix);
+		}
+	}
+	return appendText(appendNumber(first, last, size), last, " ");
+}
+
+char * formatBytes(char * first, char * last, uint64_t bytes)
+{
+	return appendText(formatPrefixedValue(first, last, bytes, binaryPrefixes, binaryPrefixCount), last, "B");
+}
+
+char * formatLatency(char * first, char * last, uint64_t nanoseconds)
+{
+	char const * units[] = { " ns", " us", " ms", " s" };
+	uint64_t divisor = 1;
+	size_t unit = 0;
+	while (nanoseconds / divisor >= 1000 && unit < 3)
+	{
+		divisor *= 1000;
+		++unit;
+	}
+	// Values that round up to 1000.0 are written with the next unit, like formatPrefixedValue
+	if (unit > 0 && unit < 3 && roundedQuotient(nanoseconds, divisor, 10) >= 10000)
+	{
+		divisor *= 1000;
+		++unit;
+	}
+	first = appendFixed(first, last, nanoseconds, divisor, unit == 0 ? 0 : 1);
+	return appendText(first, last, units[unit]);
+}
+
+bool parsePrefixedValue(std::string_view string, Prefix const * prefix, size_t prefixCount,
+	std::string_view unit, uint64_t & outValue)
+{
+	size_t pos = 0;
+	uint64_t integer = 0;
+	size_t integerDigits = 0;
+	for (; pos < string.size() && isDigit(string[pos]); ++pos, ++integerDigits)
+	{
+		uint64_t digit = uint64_t(string[pos] - '0');
+		if (integer > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+			return false;
+		integer = integer * 10 + digit;
+	}
+	if (integerDigits == 0)
+		return false;
+	// Decimals past what a uint64_t holds can't change the result by more than rounding
+	uint64_t fraction = 0;
+	size_t decimals = 0;
+	if (pos < string.size() && string[pos] == '.')
+	{
+		for (++pos; pos < string.size() && isDigit(string[pos]); ++pos)
+		{
+			if (decimals < maxDecimals)
+			{
+				fraction = fraction * 10 + uint64_t(string[pos] - '0');
+				++decimals;
+			}
+		}
+	}
+	while (pos < string.size() && isSpace(string[pos]))
+		++pos;
+	uint64_t factor = 1;
+	auto rest = string.substr(pos);
+	for (size_t p = 0; p < prefixCount; ++p)
+	{
+		std::string_view name(prefix[p].prefix);
+		if (startsWithIgnoringCase(rest, name))
+		{
+			factor = prefix[p].factor;
+			rest.remove_prefix(name.size());
+			break;
+		}
+		if (name.size() > 1 && toLower(name.back()) == 'i' &&
+			startsWithIgnoringCase(rest, name.substr(0, name.size() - 1)))
+		{
+			factor = prefix[p].factor;
+			rest.remove_prefix(name.size() - 1);
+			break;
+		}
+	}
+	if (startsWithIgnoringCase(rest, unit))
+		rest.remove_prefix(unit.size());
+	if (!rest.empty())
+		return false;
+	uint128_t value = uint128_t(integer) * factor +
+		(uint128_t(fraction) * factor + powersOfTen[decimals] / 2) / powersOfTen[decimals];
+	if (value > std::numeric_limits<uint64_t>::max())
+		return false;
+	outValue = uint64_t(value);
+	return true;
+}
+
+std::string formatPrefixedValue(uint64_t size, Prefix const * prefix, size_t prefixCount)
+{
+	char buffer[formatBufferSize];
+	return toString(buffer, formatPrefixedValue(buffer, buffer + sizeof(buffer), size, prefix, prefixCount));
+}
+
+std::string formatBytes(uint64_t bytes)
+{
+	char buffer[formatBufferSize];
+	return toString(buffer, formatBytes(buffer, buffer + sizeof(buffer), bytes));
+}
+
+static std::string formatByteRate(uint64_t bytesPerSecond)
+{
+	char buffer[formatBufferSize];
+	auto last = buffer + sizeof(buffer);
+	return toString(buffer, appendText(formatBytes(buffer, last, bytesPerSecond), last, "/s"));
+}
+
+std::string formatRate(uint64_t bytes, std::chrono::seconds const & time)
+{
+	return formatByteRate(bytes / time.count());
+}
+
+std::string formatRate(double bytesPerSecond)
+{
+	return formatByteRate(uint64_t(bytesPerSecond));
+}
+
+std::string formatNormalRate(double perSecond)
+{
+	// A few operations over a long window are still shown, instead of 0
+	auto const & smallest = metricPrefixes[metricPrefixCount - 1];
+	if (!(perSecond >= 0))
+		perSecond = 0;
+	uint64_t hundredths = uint64_t(std::min(perSecond, 1e16) * 100 + 0.5);
+	if (hundredths >= smallest.factor * 100)
+		return formatNormalValue(uint64_t(std::min(perSecond, 1e19) + 0.5));
+	char buffer[formatBufferSize];
+	auto last = buffer + sizeof(buffer);
+	return toString(buffer, appendText(appendFixed(buffer, last, hundredths, 100, 2), last, " "));
+}
+
+std::string formatLatency(uint64_t nanoseconds)
+{
+	char buffer[formatBufferSize];
+	return toString(buffer, formatLatency(buffer, buffer + sizeof(buffer), nanoseconds));
+}
@@ -9,10 +9,13 @@
 #ifndef ZetaFormatHelpers_hpp
 #define ZetaFormatHelpers_hpp
 
-#include <sstream>
 #include <string>
-#include <iomanip>
-#include <regex>
+#include <string_view>
+#include <chrono>
+#include <limits>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
 
 struct Prefix
 {
@@ -20,83 +23,105 @@ struct Prefix
 	char const * prefix;
 };
 
-extern Prefix const metricPrefixes[];
-extern size_t const metricPrefixCount;
+inline constexpr Prefix metricPrefixes[] = {
+	{ 1000000000000000000, "E" },
+	{    1000000000000000, "P" },
+	{       1000000000000, "T" },
+	{          1000000000, "G" },
+	{             1000000, "M" },
+	{                1000, "k" },
+};
 
-extern Prefix const binaryPrefixes[];
-extern size_t const binaryPrefixCount;
+inline constexpr size_t metricPrefixCount = std::extent_v<decltype(metricPrefixes)>;
 
-template<typename T>
-std::string formatPrefixedValue(T size, Prefix const * prefix, size_t prefixCount)
-{
-	for (size_t p = 0; p < prefixCount; ++p)
-	{
-		if (size >= prefix[p].factor)
-		{
-			double scaledSize = size / double(prefix[p].factor);
-			std::stringstream ss;
-			ss << std::setprecision(2) << std::fixed << scaledSize << " " << prefix[p].prefix;
-			return ss.str();
-		}
-	}
-	return std::to_string(size) + " ";
-}
+// https://en.wikipedia.org/wiki/Binary_prefix
+inline constexpr Prefix binaryPrefixes[] = {
+	{ 1ull << 60, "Ei" },
+	{ 1ull << 50, "Pi" },
+	{ 1ull << 40, "Ti" },
+	{ 1ull << 30, "Gi" },
+	{ 1ull << 20, "Mi" },
+	{ 1ull << 10, "ki" },
+};
 
-template<typename T>
-std::string formatInformationValue(T size)
+inline constexpr size_t binaryPrefixCount = std::extent_v<decltype(binaryPrefixes)>;
+
+//! Large enough for anything the buffer based functions below write
+constexpr size_t formatBufferSize = 32;
+
+/*!
+ Writes size with two decimals, a space and the largest prefix that is not
+ larger than it, or the plain number and a space if no prefix fits. Writes
+ into [first, last) without terminator or allocation, and returns the end
+ of the output, or nullptr if it does not fit.
+ */
+char * formatPrefixedValue(char * first, char * last, uint64_t size,
+	Prefix const * prefix, size_t prefixCount);
+char * formatBytes(char * first, char * last, uint64_t bytes);
+
+/*!
+ Writes nanoseconds in the largest unit up to seconds that keeps it below
+ 1000, with one decimal from microseconds on. Values that round up to
+ 1000.0 are written with the next unit. Exact ties round to even, where the
+ old floating point version rounded them either way, so about 0.4% of
+ latencies below a millisecond format differently, 1150 ns is now "1.2 us".
+ */
+char * formatLatency(char * first, char * last, uint64_t nanoseconds);
+
+/*!
+ Parses a number with optional decimals, optional whitespace, an optional
+ prefix from the table, and an optional unit, ignoring case. A prefix ending
+ in i also matches without it, so G is read as Gi, like zfs does. The result
+ is rounded to the nearest integer, so everything formatPrefixedValue writes
+ parses back to a value that formats the same, except for values so close to
+ the maximum that they are rounded up past it. Returns false for malformed
+ input and for values that don't fit.
+ */
+bool parsePrefixedValue(std::string_view string, Prefix const * prefix, size_t prefixCount,
+	std::string_view unit, uint64_t & outValue);
+
+std::string formatPrefixedValue(uint64_t size, Prefix const * prefix, size_t prefixCount);
+
+inline std::string formatInformationValue(uint64_t size)
 {
 	return formatPrefixedValue(size, binaryPrefixes, binaryPrefixCount);
 }
 
-template<typename T>
-std::string formatNormalValue(T size)
+inline std::string formatNormalValue(uint64_t size)
 {
 	return formatPrefixedValue(size, metricPrefixes, metricPrefixCount);
 }
 
-template<typename T>
-std::string formatBytes(T bytes)
-{
-	return formatInformationValue(bytes) + "B";
-}
+std::string formatBytes(uint64_t bytes);
 
 template<typename T>
 bool parseBytes(char const * byteString, T & outBytes)
 {
-	std::regex byteRegex(R"((\d+\.?\d*)\s*([EPTGMk]?i?)B?)", std::regex::icase);
-	std::cmatch match;
-	if (std::regex_match(byteString, match, byteRegex))
-	{
-		double bytesFormated = std::stod(std::string(match[1].first, match[1].second));
-		std::string prefix(match[2].first, match[2].second);
-		std::transform(prefix.begin(), prefix.end(), prefix.begin(), ::tolower);
-		if (prefix.length() == 1)
-			prefix += 'i';
-		Prefix const * foundPrefix = std::find_if(binaryPrefixes, binaryPrefixes + binaryPrefixCount,
-			[=](Prefix const & p)
-		{
-			std::string pp(p.prefix);
-			std::transform(pp.begin(), pp.end(), pp.begin(), ::tolower);
-			return prefix == pp;
-		});
-		if (foundPrefix != binaryPrefixes + binaryPrefixCount)
-		{
-			outBytes = static_cast<T>(bytesFormated * foundPrefix->factor);
-		}
-		else
-		{
-			outBytes = static_cast<T>(bytesFormated);
-		}
-		return true;
-	}
-	return false;
+	uint64_t bytes = 0;
+	if (!parsePrefixedValue(byteString, binaryPrefixes, binaryPrefixCount, "B", bytes) ||
+		bytes > uint64_t(std::numeric_limits<T>::max()))
+		return false;
+	outBytes = static_cast<T>(bytes);
+	return true;
 }
 
-inline std::string formatRate(uint64_t bytes, std::chrono::seconds const & time)
+template<typename T>
+bool parseNormalValue(char const * string, T & outValue)
 {
-	return formatBytes(bytes / time.count()) + "/s";
+	uint64_t value = 0;
+	if (!parsePrefixedValue(string, metricPrefixes, metricPrefixCount, "", value) ||
+		value > uint64_t(std::numeric_limits<T>::max()))
+		return false;
+	outValue = static_cast<T>(value);
+	return true;
 }
 
+std::string formatRate(uint64_t bytes, std::chrono::seconds const & time);
+std::string formatRate(double bytesPerSecond);
+//! A count per second, with two decimals below the first metric prefix
+std::string formatNormalRate(double perSecond);
+std::string formatLatency(uint64_t nanoseconds);
+
 template<typename T> T toFormatable(T t)
 {
 	return t;
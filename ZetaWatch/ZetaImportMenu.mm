@@ -136,14 +136,29 @@
 	{
 		[mutablePool setObject:spo forKey:@"searchPathOverride"];
 	}
-	[_authorization importPools:mutablePool withReply:^(NSError * error)
+	// Without a list of pools, the helper imports all importable ones in parallel
+	[_authorization importPoolBatch:mutablePool withReply:^(NSError * error, NSArray * results)
 	 {
 		 if (!error)
 		 {
-			 NSString * title = [NSString stringWithFormat:
-				NSLocalizedString(@"All pools imported",
-								  @"Pool Import Success all")];
-			 [self notifySuccessWithTitle:title text:nil];
+			 NSMutableArray<NSString*> * failures = [NSMutableArray array];
+			 for (NSDictionary * result in results)
+			 {
+				 if (NSString * message = result[@"error"])
+					 [failures addObject:[NSString stringWithFormat:@"%@: %@", result[@"poolName"], message]];
+			 }
+			 if (failures.count > 0)
+			 {
+				 error = [NSError errorWithDomain:@"ZFSError" code:-1 userInfo:@{
+					 NSLocalizedDescriptionKey: [failures componentsJoinedByString:@", "]}];
+			 }
+			 else
+			 {
+				 NSString * title = [NSString stringWithFormat:
+					NSLocalizedString(@"All pools imported",
+									  @"Pool Import Success all")];
+				 [self notifySuccessWithTitle:title text:nil];
+			 }
 		 }
 		 [self handlePoolChangeReply:error];
 	 }];
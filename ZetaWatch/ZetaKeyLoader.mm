@@ -492,17 +492,15 @@ encoding:NSUTF8StringEncoding];
 	[_passwordField abortEditing];
 }
 
-- (void)newPoolDetected:(const zfs::ZPool &)pool
+- (void)newPoolDetected:(zeta::PoolState const &)pool
 {
 	if ([[NSUserDefaults standardUserDefaults] boolForKey:@"autoUnlock"])
 	{
-		for (auto & fs : pool.allFileSystems())
+		for (auto const & fs : pool.fileSystems)
 		{
-			auto [encRoot, isRoot] = fs.encryptionRoot();
-			auto keyStatus = fs.keyStatus();
-			if (isRoot && keyStatus == zfs::ZFileSystem::KeyStatus::unavailable)
+			if (fs.isEncryptionRoot && fs.keyStatus == zeta::FileSystemState::KeyStatus::unavailable)
 			{
-				NSString * fsName = [NSString stringWithUTF8String:fs.name()];
+				NSString * fsName = [NSString stringWithUTF8String:fs.name.c_str()];
 				[self unlockFileSystem:fsName];
 			}
 		}
@@ -0,0 +1,114 @@
+//
+//  ZetaLatencyHistogram.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaLatencyHistogram.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	LatencyHistogram & LatencyHistogram::operator+=(LatencyHistogram const & other)
+	{
+		for (size_t i = 0; i < latencyBucketCount; ++i)
+			counts[i] += other.counts[i];
+		return *this;
+	}
+
+	LatencyHistogram increase(LatencyHistogram const & older, LatencyHistogram const & newer)
+	{
+		LatencyHistogram h;
+		for (size_t i = 0; i < latencyBucketCount; ++i)
+			h.counts[i] = newer.counts[i] >= older.counts[i] ? newer.counts[i] - older.counts[i] : 0;
+		return h;
+	}
+
+	static uint64_t bucketLimit(size_t bucket)
+	{
+		return uint64_t(1) << (bucket + 1);
+	}
+
+	LatencySummary summarize(LatencyHistogram const & histogram)
+	{
+		LatencySummary s;
+		for (auto c : histogram.counts)
+			s.count += c;
+		if (s.count == 0)
+			return s;
+		// Ranks of the quantiles, rounded up
+		uint64_t r50 = (s.count * 500 + 999) / 1000;
+		uint64_t r99 = (s.count * 990 + 999) / 1000;
+		uint64_t r999 = (s.count * 999 + 999) / 1000;
+		uint64_t cumulative = 0;
+		for (size_t i = 0; i < latencyBucketCount; ++i)
+		{
+			cumulative += histogram.counts[i];
+			if (s.p50 == 0 && cumulative >= r50)
+				s.p50 = bucketLimit(i);
+			if (s.p99 == 0 && cumulative >= r99)
+				s.p99 = bucketLimit(i);
+			if (cumulative >= r999)
+			{
+				s.p999 = bucketLimit(i);
+				break;
+			}
+		}
+		return s;
+	}
+
+	std::vector<PoolStateChange> findLatencyOutliers(PoolState const & pool,
+		std::function<LatencyHistogram(uint64_t guid)> const & latency,
+		LatencyOutlierThresholds const & thresholds)
+	{
+		std::vector<PoolStateChange> outliers;
+		auto const & vdevs = pool.vdevs;
+		// Children directly follow their parent in the flattened tree
+		std::vector<bool> isLeaf(vdevs.size(), true);
+		for (auto const & v : vdevs)
+		{
+			if (v.parent != noVDev)
+				isLeaf[v.parent] = false;
+		}
+		std::vector<LatencySummary> summaries(vdevs.size());
+		for (size_t i = 0; i < vdevs.size(); ++i)
+		{
+			if (isLeaf[i] && vdevs[i].parent != noVDev)
+				summaries[i] = summarize(latency(vdevs[i].guid));
+		}
+		std::vector<uint64_t> siblings;
+		for (size_t i = 0; i < vdevs.size(); ++i)
+		{
+			auto parent = vdevs[i].parent;
+			if (!isLeaf[i] || parent == noVDev || summaries[i].count < thresholds.minimumCount)
+				continue;
+			siblings.clear();
+			for (size_t j = parent + 1; j < vdevs.size() && vdevs[j].depth > vdevs[parent].depth; ++j)
+			{
+				if (j != i && vdevs[j].parent == parent && isLeaf[j] &&
+					summaries[j].count >= thresholds.minimumCount)
+					siblings.push_back(summaries[j].p99);
+			}
+			if (siblings.empty())
+				continue;
+			auto median = siblings.begin() + siblings.size() / 2;
+			std::nth_element(siblings.begin(), median, siblings.end());
+			if (*median > 0 && summaries[i].p99 >= thresholds.factor * *median)
+			{
+				PoolStateChange c;
+				c.kind = PoolStateChange::Kind::vdevLatencyDiverged;
+				c.poolGUID = pool.guid;
+				c.poolName = pool.name;
+				c.vdevGUID = vdevs[i].guid;
+				c.objectName = vdevs[i].name;
+				c.oldValue = *median;
+				c.newValue = summaries[i].p99;
+				outliers.push_back(std::move(c));
+			}
+		}
+		return outliers;
+	}
+}
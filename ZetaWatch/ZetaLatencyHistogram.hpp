@@ -0,0 +1,63 @@
+//
+//  ZetaLatencyHistogram.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaLatencyHistogram_hpp
+#define ZetaLatencyHistogram_hpp
+
+#include "ZetaPoolStateDiff.hpp"
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace zeta
+{
+	//! VDEV_L_HISTO_BUCKETS, bucket i counts I/Os that took [2^i, 2^(i+1)) ns
+	constexpr size_t latencyBucketCount = 37;
+
+	//! Fixed size, so that merging and differencing are plain vector loops
+	struct LatencyHistogram
+	{
+		std::array<uint64_t, latencyBucketCount> counts = {};
+
+		LatencyHistogram & operator+=(LatencyHistogram const & other);
+	};
+
+	//! Bucket wise increase from older to newer, zero where counters restarted
+	LatencyHistogram increase(LatencyHistogram const & older, LatencyHistogram const & newer);
+
+	struct LatencySummary
+	{
+		uint64_t count = 0;
+		uint64_t p50 = 0; //!< Upper bound of the bucket containing the quantile, in ns
+		uint64_t p99 = 0;
+		uint64_t p999 = 0;
+	};
+
+	//! All three quantiles in one pass over the buckets
+	LatencySummary summarize(LatencyHistogram const & histogram);
+
+	struct LatencyOutlierThresholds
+	{
+		double factor = 8; //!< Three buckets
+		uint64_t minimumCount = 100; //!< I/Os in the window, per vdev
+	};
+
+	/*!
+	 Finds leaf vdevs whose p99 latency is at least factor times the median
+	 p99 of their siblings, the other children of the same vdev. Returns one
+	 vdevLatencyDiverged change per outlier, with oldValue the siblings' and
+	 newValue the vdev's p99 in nanoseconds.
+	 */
+	std::vector<PoolStateChange> findLatencyOutliers(PoolState const & pool,
+		std::function<LatencyHistogram(uint64_t guid)> const & latency,
+		LatencyOutlierThresholds const & thresholds = LatencyOutlierThresholds());
+}
+
+#endif /* ZetaLatencyHistogram_hpp */
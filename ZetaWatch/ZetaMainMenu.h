@@ -29,7 +29,7 @@ enum ZetaMenuTags
 	ActionAnchorMenuTag = 101
 };
 
-@interface ZetaMainMenu : ZetaCommanderBase <NSMenuDelegate>
+@interface ZetaMainMenu : ZetaCommanderBase <NSMenuDelegate, ZetaPoolWatcherDelegate>
 
 @property (weak) IBOutlet ZetaPoolWatcher * poolWatcher;
 @property (weak) IBOutlet ZetaKeyLoader * zetaKeyLoader;
@@ -51,6 +51,8 @@ enum ZetaMenuTags
 - (IBAction)rollbackFilesystem:(id)sender;
 - (IBAction)rollbackFilesystemForce:(id)sender;
 - (IBAction)cloneSnapshot:(id)sender;
+- (IBAction)createFilesystem:(id)sender;
+- (IBAction)createVolume:(id)sender;
 - (IBAction)destroy:(id)sender;
 - (IBAction)destroyRecursive:(id)sender;
 - (IBAction)loadKey:(id)sender;
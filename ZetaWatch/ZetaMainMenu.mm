@@ -14,16 +14,20 @@
 #import "ZetaImportMenu.h"
 #import "ZetaPoolWatcher.h"
 #import "ZetaAuthorization.h"
+#import "ZetaFileSystemMenu.h"
 #import "ZetaSnapshotMenu.h"
-#import "ZetaBookmarkMenu.h"
-#import "ZetaFileSystemPropertyMenu.h"
 #import "ZetaPoolPropertyMenu.h"
 #import "ZetaNotificationCenter.h"
 
+#include "ZetaPoolState.hpp"
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaBackgroundLoad.hpp"
+
 #include "ZFSUtils.hpp"
 #include "ZFSStrings.hpp"
 
 #include "InvariantDisks/IDDiskArbitrationUtils.hpp"
+#include "InvariantDisks/IDDiskInformationCache.hpp"
 
 #include <type_traits>
 #include <iomanip>
@@ -34,7 +38,10 @@
 {
 	NSMutableArray * _dynamicMenus;
 	DASessionRef _diskArbitrationSession;
-	zfs::LibZFSHandle _zfs;
+	std::shared_ptr<zeta::SystemState const> _state;
+	NSMenu * _openMenu;
+	bool _showingStale;
+	uint64_t _propertyReadsAtUpdate;
 }
 
 @end
@@ -51,15 +58,57 @@
 	return self;
 }
 
+- (void)awakeFromNib
+{
+	if (self.poolWatcher)
+	{
+		[self.poolWatcher.delegates addObject:self];
+	}
+}
+
 - (void)dealloc
 {
 	CFRelease(_diskArbitrationSession);
 }
 
 - (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	// Wait only briefly for fresh state. Pools that take longer are shown
+	// from the previous state, and get updated while the menu is open.
+	_propertyReadsAtUpdate = zeta::propertyReadCount();
+	std::chrono::duration<double> timeout = zeta::menuLatencyCap;
+	[self.poolWatcher refreshWithTimeout:timeout.count()];
+	[self rebuildMenu:menu];
+}
+
+- (void)menuWillOpen:(NSMenu*)menu
+{
+	_openMenu = menu;
+}
+
+- (void)menuDidClose:(NSMenu*)menu
+{
+	_openMenu = nil;
+#if DEBUG
+	// Includes the reads of submenus and of refreshes while the menu was open
+	NSLog(@"Properties read while the menu was open: %llu",
+		  zeta::propertyReadCount() - _propertyReadsAtUpdate);
+#endif
+}
+
+- (void)poolStateRefreshed
+{
+	if (_openMenu && _showingStale)
+		[self rebuildMenu:_openMenu];
+}
+
+- (void)rebuildMenu:(NSMenu*)menu
 {
 	[self clearDynamicMenu:menu];
-	[self resetLibZFS];
+	_state = self.poolWatcher.state;
+	if (!_state)
+		_state = std::make_shared<zeta::SystemState const>();
+	_showingStale = self.poolWatcher.isRefreshing;
 	[self createNotificationMenu:menu];
 	[self createPoolMenu:menu];
 	[self createActionMenu:menu];
@@ -67,11 +116,13 @@
 
 #pragma mark Formating
 
-NSString * formatErrorStat(zfs::VDevStat stat, bool emoji)
+NSString * formatErrorStat(zeta::VDevStatus const & stat, bool emoji)
 {
+	auto state = vdev_state_t(stat.state);
+	auto aux = vdev_aux_t(stat.aux);
 	NSString * status = emoji ?
-		zfs::emojistring_vdev_state_t(stat.state, stat.aux) :
-		zfs::localized_describe_vdev_state_t(stat.state, stat.aux);
+		zfs::emojistring_vdev_state_t(state, aux) :
+		zfs::localized_describe_vdev_state_t(state, aux);
 	NSString * errors = nil;
 	if (stat.errorRead == 0 && stat.errorWrite == 0 && stat.errorChecksum == 0)
 	{
@@ -85,21 +136,9 @@ NSString * formatErrorStat(zfs::VDevStat stat, bool emoji)
 	return [NSString stringWithFormat:@"%@, %@", status, errors];
 }
 
-std::chrono::seconds getElapsed(zfs::ScanStat const & scanStat)
-{
-	auto elapsed = time(0) - scanStat.passStartTime;
-	elapsed -= scanStat.passPausedSeconds;
-	elapsed = (elapsed > 0) ? elapsed : 1;
-	return std::chrono::seconds(elapsed);
-}
-
-inline std::string formatTimeRemaining(zfs::ScanStat const & scanStat, std::chrono::seconds const & time)
+inline std::string formatTimeRemaining(std::chrono::seconds const & remaining)
 {
-	auto bytesRemaining = scanStat.total - scanStat.issued;
-	auto issued = scanStat.passIssued;
-	if (issued == 0)
-		issued = 1;
-	auto secondsRemaining = bytesRemaining * time.count() / issued;
+	auto secondsRemaining = remaining.count();
 	std::stringstream ss;
 	ss << std::setfill('0');
 	ss << (secondsRemaining / (60*60*24)) << " days "
@@ -111,150 +150,36 @@ inline std::string formatTimeRemaining(zfs::ScanStat const & scanStat, std::chro
 
 #pragma mark ZFS Inspection
 
-NSMenu * createFSMenu(zfs::ZFileSystem && fs, ZetaMainMenu * delegate)
+NSString * formatStatus(zeta::FileSystemState const & fs)
 {
-	NSMenu * fsMenu = [[NSMenu alloc] init];
-	[fsMenu setAutoenablesItems:NO];
-	NSString * fsName = [NSString stringWithUTF8String:fs.name()];
-	auto addFSCommand = [&](NSString * title, SEL selector)
-	{
-		auto item = [fsMenu addItemWithTitle:title
-									  action:selector keyEquivalent:@""];
-		item.representedObject = fsName;
-		item.target = delegate;
-	};
-	if (fs.type() == zfs::ZFileSystem::FSType::filesystem)
-	{
-		auto [encRoot, isRoot] = fs.encryptionRoot();
-		if (isRoot)
-		{
-			if (fs.keyStatus() != zfs::ZFileSystem::KeyStatus::available)
-			{
-				addFSCommand(NSLocalizedString(@"Load Key...", @"Load Key"), @selector(loadKey:));
-			}
-			else
-			{
-				addFSCommand(NSLocalizedString(@"Unload Key", @"Unload Key"), @selector(unloadKey:));
-			}
-			[fsMenu addItem:[NSMenuItem separatorItem]];
-		}
-		addFSCommand(NSLocalizedString(@"Mount Recursively", @"Mount Recursively"), @selector(mountFilesystemRecursive:));
-		if (!fs.mounted() && fs.mountable())
-		{
-			addFSCommand(NSLocalizedString(@"Mount", @"Mount"), @selector(mountFilesystem:));
-		}
-		addFSCommand(NSLocalizedString(@"Unmount Recursively", @"Unmount Recursively"), @selector(unmountFilesystemRecursive:));
-		if (fs.mounted())
-		{
-			addFSCommand(NSLocalizedString(@"Unmount", @"Unmount"), @selector(unmountFilesystem:));
-			addFSCommand(NSLocalizedString(@"Unmount (Force)", @"Unmount (Force)"), @selector(unmountFilesystemForce:));
-		}
-	}
-	// Snapshots
-	[fsMenu addItem:[NSMenuItem separatorItem]];
-	addFSCommand(NSLocalizedString(@"Snapshot...", @"Snapshot"), @selector(snapshotFilesystem:));
-	addFSCommand(NSLocalizedString(@"Snapshot Recursively...", @"Snapshot Recursively"), @selector(snapshotFilesystemRecursive:));
-	{
-		// Snapshots submenu
-		NSString * snapsTitle = NSLocalizedString(@"Snapshots", @"Snapshots");
-		NSMenu * snaps = [[NSMenu alloc] initWithTitle:snapsTitle];
-		ZetaSnapshotMenu * sd = [[ZetaSnapshotMenu alloc] initWithFileSystem:zfs::ZFileSystem(fs) delegate:delegate];
-		snaps.delegate = sd;
-		NSMenuItem * snapsItem = [[NSMenuItem alloc] initWithTitle:snapsTitle
-			action:nullptr keyEquivalent:@""];
-		snapsItem.submenu = snaps;
-		snapsItem.representedObject = sd;
-		[fsMenu addItem:snapsItem];
-	}
-	{
-		// Bookmarks Submenu
-		NSString * bookmarksTitle = NSLocalizedString(@"Bookmarks", @"Bookmarks");
-		NSMenu * bookmarks = [[NSMenu alloc] initWithTitle:bookmarksTitle];
-		ZetaBookmarkMenu * bd = [[ZetaBookmarkMenu alloc] initWithFileSystem:zfs::ZFileSystem(fs) delegate:delegate];
-		bookmarks.delegate = bd;
-		NSMenuItem * bookmarksItem = [[NSMenuItem alloc] initWithTitle:bookmarksTitle
-			action:nullptr keyEquivalent:@""];
-		bookmarksItem.submenu = bookmarks;
-		bookmarksItem.representedObject = bd;
-		[fsMenu addItem:bookmarksItem];
-	}
-	// Create
-	[fsMenu addItem:[NSMenuItem separatorItem]];
-	addFSCommand(NSLocalizedString(@"Create Filesystem...", @"Create Filesystem..."),
-		@selector(createFilesystem:));
-	addFSCommand(NSLocalizedString(@"Create Volume...", @"Create Volume..."),
-		@selector(createVolume:));
-	// Destroy
-	[fsMenu addItem:[NSMenuItem separatorItem]];
-	if (!fs.isRoot())
-	{
-		addFSCommand(NSLocalizedString(@"Destroy", @"Destroy"), @selector(destroy:));
-	}
-	addFSCommand(NSLocalizedString(@"Destroy Recursively", @"Destroy Recursively"), @selector(destroyRecursive:));
-	// Selected Properties
-	[fsMenu addItem:[NSMenuItem separatorItem]];
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Available:          \t %s", @"FS Available Menu Entry"),
-				formatBytes(fs.available()));
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Used:               \t %s", @"FS Used Menu Entry"),
-				formatBytes(fs.used()));
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Referenced:         \t %s", @"FS Referenced Menu Entry"),
-				formatBytes(fs.referenced()));
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Logical Used:       \t %s", @"FS Logically Used Menu Entry"),
-				formatBytes(fs.logicalused()));
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Compression Ratio:  \t %1.2fx", @"FS Compression Menu Entry"),
-				fs.compressRatio());
-	addMenuItem(fsMenu, delegate,
-				NSLocalizedString(@"Mount Point:        \t %s", @"FS Mountpoint Menu Entry"),
-				fs.mountpoint());
-	// All Properties
-	NSString * allPropsTitle = NSLocalizedString(@"All Properties", @"All Properties");
-	NSMenu * allProps = [[NSMenu alloc] initWithTitle:allPropsTitle];
-	ZetaFileSystemPropertyMenu * pd = [[ZetaFileSystemPropertyMenu alloc] initWithFileSystem:std::move(fs)];
-	allProps.delegate = pd;
-	NSMenuItem * allPropsItem = [[NSMenuItem alloc] initWithTitle:allPropsTitle
-		action:nullptr keyEquivalent:@""];
-	allPropsItem.submenu = allProps;
-	allPropsItem.representedObject = pd;
-	[fsMenu addItem:allPropsItem];
-	return fsMenu;
-}
-
-NSString * formatStatus(zfs::ZFileSystem const & fs)
-{
-	NSString * mountStatus = fs.mounted() ?
+	NSString * mountStatus = fs.mounted ?
 		NSLocalizedString(@"📌", @"mounted status") :
 		NSLocalizedString(@"🕳", @"unmounted status");
 	NSString * encStatus = nil;
-	switch (fs.keyStatus())
+	switch (fs.keyStatus)
 	{
-		case zfs::ZFileSystem::KeyStatus::none:
+		case zeta::FileSystemState::KeyStatus::none:
 			encStatus = @"";
 			break;
-		case zfs::ZFileSystem::KeyStatus::unavailable:
+		case zeta::FileSystemState::KeyStatus::unavailable:
 			encStatus = NSLocalizedString(@"🔒", @"locked status");
 			break;
-		case zfs::ZFileSystem::KeyStatus::available:
+		case zeta::FileSystemState::KeyStatus::available:
 			encStatus = NSLocalizedString(@"🔑", @"unlocked status");
 			break;
 	}
-	auto [encRoot, isRoot] = fs.encryptionRoot();
-	NSString * encRootStr = isRoot ? @"🎁" : @"";
-	NSString * fsLine = [NSString stringWithFormat:NSLocalizedString(@"%s (%@%@%@)", @"File System Menu Entry"), fs.name(), mountStatus, encStatus, encRootStr];
+	NSString * encRootStr = fs.isEncryptionRoot ? @"🎁" : @"";
+	NSString * fsLine = [NSString stringWithFormat:NSLocalizedString(@"%s (%@%@%@)", @"File System Menu Entry"), fs.name.c_str(), mountStatus, encStatus, encRootStr];
 	return fsLine;
 }
 
-NSMenuItem * addVdev(zfs::ZPool const & pool, zfs::NVList const & device,
+NSMenuItem * addVdev(zeta::VDevState const & vdev,
 	NSMenu * menu, DASessionRef daSession, ZetaMainMenu * delegate)
 {
 	// Menu Item
-	auto stat = zfs::vdevStat(device);
+	auto const & stat = vdev.stat;
 	auto item = addMenuItem(menu, delegate, NSLocalizedString(@"%s (%@)", @"Device Menu Entry"),
-							pool.vdevName(device), formatErrorStat(stat, true));
+							vdev.name, formatErrorStat(stat, true));
 	// Submenu
 	// ZFS Info
 	NSMenu * subMenu = [[NSMenu alloc] init];
@@ -262,39 +187,70 @@ NSMenuItem * addVdev(zfs::ZPool const & pool, zfs::NVList const & device,
 	addMenuItem(subMenu, delegate,
 				NSLocalizedString(@"Space:          \t %s used / %s total", @"VDev Space Menu Entry"),
 				formatBytes(stat.alloc), formatBytes(stat.space));
+	// Compared to the first record of the day a week ago, which the watcher reads while recording
+	auto weekAgo = [[delegate poolWatcher] weekAgoAllocForVDev:vdev.guid];
+	if (weekAgo.time != 0)
+	{
+		auto then = weekAgo.value;
+		addMenuItem(subMenu, delegate,
+					NSLocalizedString(@"Last 7 Days:    \t %s%s", @"VDev Space Growth Menu Entry"),
+					stat.alloc >= then ? "+" : "-", formatBytes(stat.alloc >= then ? stat.alloc - then : then - stat.alloc));
+	}
 	addMenuItem(subMenu, delegate,
 				NSLocalizedString(@"Fragmentation:  \t %llu%%", @"VDev Fragmentation Menu Entry"),
 				stat.fragmentation);
+	auto io = [[delegate poolWatcher] ioRatesForVDev:vdev.guid];
+	if (io.window.count() > 0)
+	{
+		addMenuItem(subMenu, delegate,
+					NSLocalizedString(@"Read:           \t %s, %sops/s", @"VDev Read Rate Menu Entry"),
+					formatRate(io.increase.readBytes, io.window), formatNormalRate(double(io.increase.readOps) / io.window.count()));
+		addMenuItem(subMenu, delegate,
+					NSLocalizedString(@"Write:          \t %s, %sops/s", @"VDev Write Rate Menu Entry"),
+					formatRate(io.increase.writeBytes, io.window), formatNormalRate(double(io.increase.writeOps) / io.window.count()));
+		auto latency = zeta::summarize(io.latency);
+		if (latency.count > 0)
+		{
+			addMenuItem(subMenu, delegate,
+						NSLocalizedString(@"Latency:        \t p50 %s, p99 %s, p99.9 %s", @"VDev Latency Menu Entry"),
+						formatLatency(latency.p50), formatLatency(latency.p99), formatLatency(latency.p999));
+		}
+	}
 	addMenuItem(subMenu, delegate,
 				NSLocalizedString(@"VDev GUID:      \t %llu", @"VDev GUID Menu Entry"),
-				zfs::vdevGUID(device));
-	std::string type = zfs::vdevType(device);
+				vdev.guid);
 	addMenuItem(subMenu, delegate,
 				NSLocalizedString(@"Device:         \t %s (%s)", @"VDev Device Menu Entry"),
-				pool.vdevDevice(device), type);
+				vdev.device, vdev.type);
 	// Disk Info, only if state is at least 5 or higher, (FAULTED, DEGRADED, HEALTHY)
-	if (type == "disk" && stat.state >= 5)
+	if (vdev.type == "disk" && stat.state >= 5)
 	{
 		[subMenu addItem:[NSMenuItem separatorItem]];
-		auto devicePath = pool.vdevDevice(device);
-		DADiskRef daDisk = DADiskCreateFromBSDName(nullptr, daSession, devicePath.c_str());
-		auto diskInfo = ID::getDiskInformation(daDisk);
+		auto diskInfo = ID::diskInformationCache().lookup(vdev.device, [&]()
+		{
+			ID::DiskInformation info;
+			if (DADiskRef daDisk = DADiskCreateFromBSDName(nullptr, daSession, vdev.device.c_str()))
+			{
+				info = ID::getDiskInformation(daDisk);
+				CFRelease(daDisk);
+			}
+			return info;
+		});
 		addMenuItem(subMenu, delegate,
 					NSLocalizedString(@"UUID:           \t %s", @"VDev MediaUUID Menu Entry"), diskInfo.mediaUUID);
 		addMenuItem(subMenu, delegate,
 					NSLocalizedString(@"Model:          \t %s", @"VDev Model Menu Entry"), trim(diskInfo.deviceModel));
 		addMenuItem(subMenu, delegate,
 					NSLocalizedString(@"Serial:         \t %s", @"VDev Serial Menu Entry"), trim(diskInfo.ioSerial));
-		CFRelease(daDisk);
 	}
 	item.submenu = subMenu;
 	return item;
 }
 
-void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMenu)
+void createScrubMenu(zeta::PoolState const & pool, ZetaMainMenu * delegate, NSMenu * vdevMenu)
 {
 	// Scrub
-	auto scrub = pool.scanStat();
+	auto const & scrub = pool.scan;
 	auto startDate = [NSDate dateWithTimeIntervalSince1970:scrub.scanStartTime];
 	auto endDate = [NSDate dateWithTimeIntervalSince1970:scrub.scanEndTime];
 	auto startString = [NSDateFormatter localizedStringFromDate:startDate dateStyle:NSDateFormatterMediumStyle timeStyle:NSDateFormatterMediumStyle];
@@ -302,27 +258,27 @@ void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMe
 	NSString * scanLine0;
 	switch (scrub.state)
 	{
-		case zfs::ScanStat::stateNone:
+		case zeta::ScanStatus::stateNone:
 		{
 			scanLine0 = [NSString stringWithFormat:NSLocalizedString(
 				@"Never scrubbed", @"Scrub None")];
 			break;
 		}
-		case zfs::ScanStat::scanning:
+		case zeta::ScanStatus::scanning:
 		{
 			scanLine0 = [NSString stringWithFormat:NSLocalizedString(
 				@"Scrub started %@ still in progress", @"Scrub Scanning"),
 				startString];
 			break;
 		}
-		case zfs::ScanStat::finished:
+		case zeta::ScanStatus::finished:
 		{
 			scanLine0 = [NSString stringWithFormat:NSLocalizedString(
 				@"Scrub started %@ finished successfully at %@", @"Scrub Finished"),
 				startString, endString];
 			break;
 		}
-		case zfs::ScanStat::canceled:
+		case zeta::ScanStatus::canceled:
 		{
 			scanLine0 = [NSString stringWithFormat:NSLocalizedString(
 				@"Scrub started %@ was canceled at $@", @"Scrub Canceled"),
@@ -333,8 +289,8 @@ void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMe
 	auto scrubItem = [vdevMenu addItemWithTitle:scanLine0 action:nullptr keyEquivalent:@""];
 	auto scrubMenu = [[NSMenu alloc] init];
 	scrubItem.submenu = scrubMenu;
-	NSString * poolName = [NSString stringWithUTF8String:pool.name()];
-	if (scrub.state == zfs::ScanStat::scanning && scrub.passPauseTime == 0)
+	NSString * poolName = [NSString stringWithUTF8String:pool.name.c_str()];
+	if (scrub.state == zeta::ScanStatus::scanning && scrub.passPauseTime == 0)
 	{
 		auto item = [scrubMenu addItemWithTitle:
 			NSLocalizedString(@"Stop Scrub", @"Stop Scrub")
@@ -355,10 +311,12 @@ void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMe
 		item.representedObject = poolName;
 		item.target = delegate;
 	}
-	if (scrub.state == zfs::ScanStat::scanning)
+	if (scrub.state == zeta::ScanStatus::scanning)
 	{
-		// Scan Stats
-		auto elapsed = getElapsed(scrub);
+		// Scan Stats, smoothed by the pool watcher once it has seen the scrub
+		auto estimate = [[delegate poolWatcher] scrubEstimateForPool:pool.guid];
+		if (!estimate.valid)
+			estimate = zeta::passAverage(scrub, time(0));
 		if (scrub.passPauseTime != 0)
 		{
 			auto pauseDate = [NSDate dateWithTimeIntervalSince1970:scrub.passPauseTime];
@@ -371,14 +329,14 @@ void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMe
 		NSString * scanLine1 = [NSString stringWithFormat:NSLocalizedString(
 			@"%s scanned at %s, %s issued at %s", @"Scrub Menu Entry 1"),
 								formatBytes(scrub.scanned).c_str(),
-								formatRate(scrub.passScanned, elapsed).c_str(),
+								formatRate(estimate.rate.scanRate).c_str(),
 								formatBytes(scrub.issued).c_str(),
-								formatRate(scrub.passIssued, elapsed).c_str()];
+								formatRate(estimate.rate.issueRate).c_str()];
 		NSString * scanLine2 = [NSString stringWithFormat:NSLocalizedString(
 			@"%s total, %0.2f %% done, %s remaining, %llu errors", @"Scrub Menu Entry 2"),
 								formatBytes(scrub.total).c_str(),
 								100.0*scrub.issued/scrub.total,
-								formatTimeRemaining(scrub, elapsed).c_str(),
+								formatTimeRemaining(estimate.remaining).c_str(),
 								scrub.errors];
 		auto m1 = [vdevMenu addItemWithTitle:scanLine1 action:nullptr keyEquivalent:@""];
 		auto m2 = [vdevMenu addItemWithTitle:scanLine2 action:nullptr keyEquivalent:@""];
@@ -387,104 +345,104 @@ void createScrubMenu(zfs::ZPool & pool, ZetaMainMenu * delegate, NSMenu * vdevMe
 	}
 }
 
-NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRef daSession)
+NSMenu * createVdevMenu(zeta::PoolState const & pool, ZetaMainMenu * delegate, DASessionRef daSession)
 {
 	NSMenu * vdevMenu = [[NSMenu alloc] init];
 	[vdevMenu setAutoenablesItems:NO];
-	try
+	if (!pool.error.empty())
 	{
-		createScrubMenu(pool, delegate, vdevMenu);
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		// VDevs
-		auto vdevs = pool.vdevs();
-		for (auto && vdev: vdevs)
-		{
-			// VDev
-			addVdev(pool, vdev, vdevMenu, daSession, delegate);
-			// Children
-			auto devices = zfs::vdevChildren(vdev);
-			for (auto && device: devices)
-			{
-				auto item = addVdev(pool, device, vdevMenu, daSession, delegate);
-				[item setIndentationLevel:1];
-			}
-		}
-		// Caches
-		auto caches = pool.caches();
-		if (caches.size() > 0)
-		{
-			[vdevMenu addItemWithTitle:@"cache" action:nullptr keyEquivalent:@""];
-			for (auto && cache: caches)
-			{
-				auto item = addVdev(pool, cache, vdevMenu, daSession, delegate);
-				[item setIndentationLevel:1];
-			}
-		}
-		// Filesystems
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		auto childFileSystems = pool.allFileSystems();
-		if (childFileSystems.empty())
+		[vdevMenu addItemWithTitle:NSLocalizedString(@"Error reading pool configuration", @"Pool Config Error Message")
+							action:nullptr keyEquivalent:@""];
+		return vdevMenu;
+	}
+	createScrubMenu(pool, delegate, vdevMenu);
+	auto forecast = [[delegate poolWatcher] capacityForecastForPool:pool.name];
+	if (forecast.valid && forecast.bytesPerDay > 0)
+	{
+		NSString * forecastLine = [NSString stringWithFormat:NSLocalizedString(
+			@"Full in about %llu days, growing by %s per day", @"Pool Capacity Forecast"),
+			uint64_t(forecast.daysUntilFull), formatBytes(uint64_t(forecast.bytesPerDay)).c_str()];
+		[vdevMenu addItemWithTitle:forecastLine action:nullptr keyEquivalent:@""];
+	}
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	// VDevs
+	for (auto const & vdev: pool.vdevs)
+	{
+		auto item = addVdev(vdev, vdevMenu, daSession, delegate);
+		[item setIndentationLevel:vdev.depth];
+	}
+	// Caches
+	if (pool.caches.size() > 0)
+	{
+		[vdevMenu addItemWithTitle:@"cache" action:nullptr keyEquivalent:@""];
+		for (auto const & cache: pool.caches)
 		{
-			// This seems to happen when a pool is UNAVAIL
-			NSMenuItem * item = [vdevMenu addItemWithTitle:@"No Filesystems!" action:nil keyEquivalent:@""];
-			[item setEnabled:NO];
+			auto item = addVdev(cache, vdevMenu, daSession, delegate);
+			[item setIndentationLevel:1 + cache.depth];
 		}
-		else
+	}
+	// Filesystems
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	if (pool.fileSystems.empty())
+	{
+		// This seems to happen when a pool is UNAVAIL
+		NSMenuItem * item = [vdevMenu addItemWithTitle:@"No Filesystems!" action:nil keyEquivalent:@""];
+		[item setEnabled:NO];
+	}
+	else
+	{
+		for (auto const & fs : pool.fileSystems)
 		{
-			for (auto & fs : childFileSystems)
-			{
-				auto fsLine = formatStatus(fs);
-				NSMenuItem * item = [vdevMenu addItemWithTitle:fsLine action:nullptr keyEquivalent:@""];
-				item.representedObject = [NSString stringWithUTF8String:fs.name()];
-				item.submenu = createFSMenu(std::move(fs), delegate);
-			}
+			auto fsLine = formatStatus(fs);
+			NSMenuItem * item = [vdevMenu addItemWithTitle:fsLine action:nullptr keyEquivalent:@""];
+			// The submenu gets built by its delegate when it is opened
+			NSMenu * fsMenu = [[NSMenu alloc] initWithTitle:fsLine];
+			ZetaFileSystemMenu * fd = [[ZetaFileSystemMenu alloc] initWithFileSystem:fs delegate:delegate];
+			fsMenu.delegate = fd;
+			item.submenu = fsMenu;
+			item.representedObject = fd;
 		}
-		// Command helper
-		NSString * poolName = [NSString stringWithUTF8String:pool.name()];
-		auto addRootFSCommand = [&](NSString * title, SEL selector)
-		{
-			auto item = [vdevMenu addItemWithTitle:title
-				action:selector keyEquivalent:@""];
-			item.representedObject = poolName;
-			item.target = delegate;
-		};
-		// Mount Recursively
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		addRootFSCommand(NSLocalizedString(@"Mount Recursively", @"Mount Recursively"),
-						 @selector(mountFilesystemRecursive:));
-		addRootFSCommand(NSLocalizedString(@"Unmount Recursively", @"Unmount Recursively"),
-						 @selector(unmountFilesystemRecursive:));
-		// Snapshot
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		addRootFSCommand(NSLocalizedString(@"Snapshot Recursively...", @"Snapshot Recursively"),
-						 @selector(snapshotFilesystemRecursive:));
-		// Create
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		addRootFSCommand(NSLocalizedString(@"Create Filesystem...", @"Create Filesystem..."),
-						 @selector(createFilesystem:));
-		addRootFSCommand(NSLocalizedString(@"Create Volume...", @"Create Volume..."),
-						 @selector(createVolume:));
-		// Export Actions
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		addRootFSCommand(NSLocalizedString(@"Export", @"Export"),
-						 @selector(exportPool:));
-		addRootFSCommand(NSLocalizedString(@"Export (Force)", @"Export (Force)"),
-						 @selector(exportPoolForce:));
-		// All Properties
-		[vdevMenu addItem:[NSMenuItem separatorItem]];
-		NSMenu * allProps = [[NSMenu alloc] initWithTitle:@"All Properties"];
-		ZetaPoolPropertyMenu * pd = [[ZetaPoolPropertyMenu alloc] initWithPool:std::move(pool)];
-		allProps.delegate = pd;
-		NSMenuItem * allPropsItem = [[NSMenuItem alloc] initWithTitle:@"All Properties" action:nullptr keyEquivalent:@""];
-		allPropsItem.submenu = allProps;
-		allPropsItem.representedObject = pd;
-		[vdevMenu addItem:allPropsItem];
 	}
-	catch (std::exception const & e)
+	// Command helper
+	NSString * poolName = [NSString stringWithUTF8String:pool.name.c_str()];
+	auto addRootFSCommand = [&](NSString * title, SEL selector)
 	{
-		[vdevMenu addItemWithTitle:NSLocalizedString(@"Error reading pool configuration", @"Pool Config Error Message")
-							action:nullptr keyEquivalent:@""];
-	}
+		auto item = [vdevMenu addItemWithTitle:title
+			action:selector keyEquivalent:@""];
+		item.representedObject = poolName;
+		item.target = delegate;
+	};
+	// Mount Recursively
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	addRootFSCommand(NSLocalizedString(@"Mount Recursively", @"Mount Recursively"),
+					 @selector(mountFilesystemRecursive:));
+	addRootFSCommand(NSLocalizedString(@"Unmount Recursively", @"Unmount Recursively"),
+					 @selector(unmountFilesystemRecursive:));
+	// Snapshot
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	addRootFSCommand(NSLocalizedString(@"Snapshot Recursively...", @"Snapshot Recursively"),
+					 @selector(snapshotFilesystemRecursive:));
+	// Create
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	addRootFSCommand(NSLocalizedString(@"Create Filesystem...", @"Create Filesystem..."),
+					 @selector(createFilesystem:));
+	addRootFSCommand(NSLocalizedString(@"Create Volume...", @"Create Volume..."),
+					 @selector(createVolume:));
+	// Export Actions
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	addRootFSCommand(NSLocalizedString(@"Export", @"Export"),
+					 @selector(exportPool:));
+	addRootFSCommand(NSLocalizedString(@"Export (Force)", @"Export (Force)"),
+					 @selector(exportPoolForce:));
+	// All Properties
+	[vdevMenu addItem:[NSMenuItem separatorItem]];
+	NSMenu * allProps = [[NSMenu alloc] initWithTitle:@"All Properties"];
+	ZetaPoolPropertyMenu * pd = [[ZetaPoolPropertyMenu alloc] initWithPoolName:poolName];
+	allProps.delegate = pd;
+	NSMenuItem * allPropsItem = [[NSMenuItem alloc] initWithTitle:@"All Properties" action:nullptr keyEquivalent:@""];
+	allPropsItem.submenu = allProps;
+	allPropsItem.representedObject = pd;
+	[vdevMenu addItem:allPropsItem];
 	return vdevMenu;
 }
 
@@ -513,29 +471,47 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 		return;
 	NSInteger poolItemRootIdx = poolMenuIdx + 1;
 	NSUInteger poolIdx = 0;
-	try
+	for (auto const & pool: _state->pools)
 	{
-		for (auto && pool: _zfs.pools())
-		{
-			NSString * poolLine = [NSString stringWithFormat:NSLocalizedString(@"%s (%@)", @"Pool Menu Entry"),
-								   pool.name(), zfs::emojistring_pool_status_t(pool.status())];
-			NSMenuItem * poolItem = [[NSMenuItem alloc] initWithTitle:poolLine action:NULL keyEquivalent:@""];
-			NSMenu * vdevMenu = createVdevMenu(std::move(pool), self, _diskArbitrationSession);
-			[poolItem setSubmenu:vdevMenu];
-			[menu insertItem:poolItem atIndex:poolItemRootIdx + poolIdx];
-			[_dynamicMenus addObject:poolItem];
-			++poolIdx;
-		}
+		NSString * poolFormat = pool.stale ?
+			NSLocalizedString(@"%s (%@, refreshing...)", @"Stale Pool Menu Entry") :
+			NSLocalizedString(@"%s (%@)", @"Pool Menu Entry");
+		NSString * poolLine = [NSString stringWithFormat:poolFormat,
+							   pool.name.c_str(), zfs::emojistring_pool_status_t(pool.status)];
+		NSMenuItem * poolItem = [[NSMenuItem alloc] initWithTitle:poolLine action:NULL keyEquivalent:@""];
+		NSMenu * vdevMenu = createVdevMenu(pool, self, _diskArbitrationSession);
+		[poolItem setSubmenu:vdevMenu];
+		[menu insertItem:poolItem atIndex:poolItemRootIdx + poolIdx];
+		[_dynamicMenus addObject:poolItem];
+		++poolIdx;
 	}
-	catch (std::exception const & e)
+	if (!_state->error.empty())
 	{
-		NSString * error = [NSString stringWithFormat:@"Exception during pool iteration: %s", e.what()];
+		NSString * error = [NSString stringWithFormat:@"Exception during pool iteration: %s", _state->error.c_str()];
 		NSMenuItem * errorItem = [[NSMenuItem alloc] initWithTitle:error action:nullptr keyEquivalent:@""];
-		[menu insertItem:errorItem atIndex:poolItemRootIdx];
+		[menu insertItem:errorItem atIndex:poolItemRootIdx + poolIdx];
 		[_dynamicMenus addObject:errorItem];
+		++poolIdx;
+	}
+	if (_showingStale)
+	{
+		NSMenuItem * refreshItem = [[NSMenuItem alloc] initWithTitle:[self formatRefreshing]
+			action:nullptr keyEquivalent:@""];
+		[menu insertItem:refreshItem atIndex:poolItemRootIdx + poolIdx];
+		[_dynamicMenus addObject:refreshItem];
 	}
 }
 
+- (NSString*)formatRefreshing
+{
+	if (_state->refreshTime == std::chrono::system_clock::time_point())
+		return NSLocalizedString(@"Refreshing...", @"Refreshing");
+	auto age = std::chrono::duration_cast<std::chrono::seconds>(
+		std::chrono::system_clock::now() - _state->refreshTime);
+	NSString * format = NSLocalizedString(@"Refreshing... (showing state from %lld s ago)", @"Refreshing with Age");
+	return [NSString stringWithFormat:format, (long long)age.count()];
+}
+
 - (void)createActionMenu:(NSMenu*)menu
 {
 	NSInteger actionMenuIdx = [menu indexOfItemWithTag:ActionAnchorMenuTag];
@@ -560,64 +536,34 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 	lockAllItem.representedObject = unlockedEncryptionRoots;
 	[lockMenu addItem:[NSMenuItem separatorItem]];
 	// Individual entries
-	try
+	for (auto fs : zeta::encryptionRoots(*_state, zeta::FileSystemState::KeyStatus::unavailable))
 	{
-		for (auto && pool: _zfs.pools())
-		{
-			for (auto & fs : pool.allFileSystems())
-			{
-				auto [encRoot, isRoot] = fs.encryptionRoot();
-				auto keyStatus = fs.keyStatus();
-				if (isRoot)
-				{
-					NSString * fsName = [NSString stringWithUTF8String:fs.name()];
-					if (keyStatus == zfs::ZFileSystem::KeyStatus::unavailable)
-					{
-						NSMenuItem * item = [unlockMenu addItemWithTitle:fsName
-																  action:@selector(loadKey:) keyEquivalent:@""];
-						item.representedObject = fsName;
-						item.target = self;
-						[lockedEncryptionRoots addObject:fsName];
-					}
-					else
-					{
-						NSMenuItem * item = [lockMenu addItemWithTitle:fsName
-																action:@selector(unloadKey:) keyEquivalent:@""];
-						item.representedObject = fsName;
-						item.target = self;
-						[unlockedEncryptionRoots addObject:fsName];
-					}
-				}
-			}
-		}
-		if ([unlockedEncryptionRoots count] > 0)
-		{
-			[menu insertItem:lockItem atIndex:actionMenuIdx + 1];
-			[_dynamicMenus addObject:lockItem];
-		}
-		if ([lockedEncryptionRoots count] > 0)
-		{
-			[menu insertItem:unlockItem atIndex:actionMenuIdx + 1];
-			[_dynamicMenus addObject:unlockItem];
-		}
+		NSString * fsName = [NSString stringWithUTF8String:fs->name.c_str()];
+		NSMenuItem * item = [unlockMenu addItemWithTitle:fsName
+												  action:@selector(loadKey:) keyEquivalent:@""];
+		item.representedObject = fsName;
+		item.target = self;
+		[lockedEncryptionRoots addObject:fsName];
 	}
-	catch (std::exception const & e)
+	for (auto fs : zeta::encryptionRoots(*_state, zeta::FileSystemState::KeyStatus::available))
 	{
-		NSString * error = [NSString stringWithFormat:@"Exception during pool iteration: %s", e.what()];
-		NSMenuItem * errorItem = [[NSMenuItem alloc] initWithTitle:error action:nullptr keyEquivalent:@""];
-		[menu insertItem:errorItem atIndex:actionMenuIdx + 1];
+		NSString * fsName = [NSString stringWithUTF8String:fs->name.c_str()];
+		NSMenuItem * item = [lockMenu addItemWithTitle:fsName
+												action:@selector(unloadKey:) keyEquivalent:@""];
+		item.representedObject = fsName;
+		item.target = self;
+		[unlockedEncryptionRoots addObject:fsName];
+	}
+	if ([unlockedEncryptionRoots count] > 0)
+	{
+		[menu insertItem:lockItem atIndex:actionMenuIdx + 1];
 		[_dynamicMenus addObject:lockItem];
 	}
-}
-
-- (void)resetLibZFS
-{
-	// Reset library to get fresh property state. This seems to be essential
-	// for getting up-to-date altroot of pools that have been imported after
-	// being known to the previous libzfs state. Calling zfs_refresh_properties
-	// is insufficient for refreshing this state.
-	// This also invalidates all filesystem and pool handles that still exist.
-	_zfs.reset();
+	if ([lockedEncryptionRoots count] > 0)
+	{
+		[menu insertItem:unlockItem atIndex:actionMenuIdx + 1];
+		[_dynamicMenus addObject:unlockItem];
+	}
 }
 
 - (void)clearDynamicMenu:(NSMenu*)menu
@@ -639,6 +585,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 
 - (void)handleFileSystemChangeReply:(NSError*)error
 {
+	[ZetaSnapshotMenu invalidateSnapshotCache];
 	if (error)
 		[self notifyErrorFromHelper:error];
 }
@@ -692,7 +639,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 - (IBAction)mountFilesystem:(id)sender
 {
 	NSDictionary * opts = @{@"filesystem": [sender representedObject]};
-	[_authorization mountFilesystems:opts withReply:^(NSError * error)
+	[_authorization mountFilesystems:opts withReply:^(NSError * error, NSDictionary * datasetSeconds)
 	 {
 		 if (!error)
 		 {
@@ -710,7 +657,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 - (IBAction)mountFilesystemRecursive:(id)sender
 {
 	NSDictionary * opts = @{@"filesystem": [sender representedObject], @"recursive": @TRUE};
-	[_authorization mountFilesystems:opts withReply:^(NSError * error)
+	[_authorization mountFilesystems:opts withReply:^(NSError * error, NSDictionary * datasetSeconds)
 	 {
 		 if (!error)
 		 {
@@ -729,7 +676,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 - (IBAction)unmountFilesystem:(id)sender
 {
 	NSDictionary * opts = @{@"filesystem": [sender representedObject]};
-	[_authorization unmountFilesystems:opts withReply:^(NSError * error)
+	[_authorization unmountFilesystems:opts withReply:^(NSError * error, NSDictionary * datasetSeconds)
 	 {
 		 if (!error)
 		 {
@@ -748,7 +695,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 - (IBAction)unmountFilesystemRecursive:(id)sender
 {
 	NSDictionary * opts = @{@"filesystem": [sender representedObject], @"recursive": @TRUE};
-	[_authorization unmountFilesystems:opts withReply:^(NSError * error)
+	[_authorization unmountFilesystems:opts withReply:^(NSError * error, NSDictionary * datasetSeconds)
 	 {
 		 if (!error)
 		 {
@@ -767,7 +714,7 @@ NSMenu * createVdevMenu(zfs::ZPool && pool, ZetaMainMenu * delegate, DASessionRe
 - (IBAction)unmountFilesystemForce:(id)sender
 {
 	NSDictionary * opts = @{@"filesystem": [sender representedObject], @"force": @YES};
-	[_authorization unmountFilesystems:opts withReply:^(NSError * error)
+	[_authorization unmountFilesystems:opts withReply:^(NSError * error, NSDictionary * datasetSeconds)
 	 {
 		 if (!error)
 		 {
@@ -842,39 +789,112 @@ static NSString * defaultSnapshotName()
 	 }];
 }
 
-static NSMutableString * appendAsString(NSMutableString * fileSystemString, std::vector<zfs::ZFileSystem> const & fileSystems)
+struct RollbackDependents
+{
+	std::vector<std::string> clones;
+	std::vector<std::string> snapshots;
+	std::vector<std::string> bookmarks;
+	std::string error;
+};
+
+struct DestroyDependents
+{
+	std::vector<std::string> dependents;
+	std::string error;
+};
+
+static std::vector<std::string> toNames(zeta::DependencyGraph const & graph,
+	std::vector<zeta::DatasetIndex> const & datasets)
+{
+	std::vector<std::string> names;
+	names.reserve(datasets.size());
+	for (auto d : datasets)
+		names.push_back(graph.names().name(d));
+	return names;
+}
+
+static RollbackDependents loadRollbackDependents(std::string const & snapName)
+{
+	RollbackDependents deps;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto graph = zeta::loadDependencyGraph(lib, snapName);
+		auto snapIndex = graph.find(snapName);
+		if (snapIndex == zeta::noDataset)
+			throw std::runtime_error("Snapshot " + snapName + " not found");
+		deps.clones = toNames(graph, graph.rollbackClones(snapIndex));
+		deps.snapshots = toNames(graph, graph.laterSnapshots(snapIndex));
+		// Bookmarks are ordered by createtxg, which the graph doesn't know
+		auto snap = lib.filesystem(snapName);
+		auto fs = lib.filesystem(graph.names().name(graph.names().parent(snapIndex)));
+		for (auto const & bookmark : fs.bookmarksSince(snap))
+			deps.bookmarks.push_back(bookmark.name());
+	}
+	catch (std::exception const & e)
+	{
+		deps.error = e.what();
+	}
+	return deps;
+}
+
+static DestroyDependents loadDestroyDependents(std::string const & fsName)
+{
+	DestroyDependents deps;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto graph = zeta::loadDependencyGraph(lib, fsName);
+		auto fsIndex = graph.find(fsName);
+		if (fsIndex == zeta::noDataset)
+			throw std::runtime_error("Dataset " + fsName + " not found");
+		deps.dependents = toNames(graph, graph.destroyDependents(fsIndex));
+	}
+	catch (std::exception const & e)
+	{
+		deps.error = e.what();
+	}
+	return deps;
+}
+
+static NSError * dependencyError(std::string const & error)
+{
+	NSDictionary * userInfo = @{
+		NSLocalizedDescriptionKey: [NSString stringWithUTF8String:error.c_str()]
+	};
+	return [NSError errorWithDomain:@"ZFSError" code:-1 userInfo:userInfo];
+}
+
+static NSMutableString * appendAsString(NSMutableString * fileSystemString, std::vector<std::string> const & fileSystems)
 {
 	for (auto const & d : fileSystems)
-		[fileSystemString appendFormat:@"%s\n", d.name()];
+		[fileSystemString appendFormat:@"%s\n", d.c_str()];
 	return fileSystemString;
 }
 
-static NSMutableString * toString(std::vector<zfs::ZFileSystem> const & fileSystems)
+static NSMutableString * toString(std::vector<std::string> const & fileSystems)
 {
 	NSMutableString * fileSystemString = [NSMutableString string];
 	return appendAsString(fileSystemString, fileSystems);
 }
 
-static NSString * formatRollbackDependents(
-	std::vector<zfs::ZFileSystem> const & clones,
-	std::vector<zfs::ZFileSystem> const & snap,
-	std::vector<zfs::ZFileSystem> const & bookmarks)
+static NSString * formatRollbackDependents(RollbackDependents const & deps)
 {
 	NSMutableString * depString = [NSMutableString string];
-	if (!clones.empty())
+	if (!deps.clones.empty())
 	{
 		[depString appendString:@"# Clones\n"];
-		appendAsString(depString, clones);
+		appendAsString(depString, deps.clones);
 	}
-	if (!snap.empty())
+	if (!deps.snapshots.empty())
 	{
 		[depString appendString:@"# Snapshots\n"];
-		appendAsString(depString, snap);
+		appendAsString(depString, deps.snapshots);
 	}
-	if (!bookmarks.empty())
+	if (!deps.bookmarks.empty())
 	{
 		[depString appendString:@"# Bookmarks\n"];
-		appendAsString(depString, bookmarks);
+		appendAsString(depString, deps.bookmarks);
 	}
 	return depString;
 }
@@ -882,23 +902,6 @@ static NSString * formatRollbackDependents(
 - (IBAction)rollbackFilesystem:(NSString*)snapNameStr Force:(bool)force
 {
 	std::string snapName([snapNameStr UTF8String]);
-	std::string baseName = snapName.substr(0, snapName.find_last_of('@'));
-	zfs::LibZFSHandle lib;
-	auto snap = lib.filesystem(snapName);
-	auto fs = lib.filesystem(baseName);
-	std::vector<zfs::ZFileSystem> clones;
-	auto snapshots = fs.snapshotsSince(snap);
-	for (auto && snap : snapshots)
-	{
-		if (snap.cloneCount() > 0)
-		{
-			auto dep = snap.dependents();
-			std::move(dep.begin(), dep.end(),
-					  std::back_inserter(clones));
-		}
-	}
-	auto bookmarks = fs.bookmarksSince(snap);
-
 	auto rollBackBlock = ^(bool ok)
 	{
 		if (ok)
@@ -923,16 +926,26 @@ static NSString * formatRollbackDependents(
 			 }];
 		}
 	};
-	if (!snapshots.empty() || !clones.empty() || !bookmarks.empty())
+	// The dependency graph of the whole pool is read in the background
+	zeta::loadInBackground<RollbackDependents>(
+		[snapName]{ return loadRollbackDependents(snapName); },
+		[self, rollBackBlock](RollbackDependents const & deps)
 	{
-		[_zetaConfirmDialog addQuery:NSLocalizedString(@"The following will be destroyed by the rollback", @"Rollback Snapshot Query")
-					 withInformation:formatRollbackDependents(clones, snapshots, bookmarks)
-						withCallback:rollBackBlock];
-	}
-	else
-	{
-		rollBackBlock(true);
-	}
+		if (!deps.error.empty())
+		{
+			[self notifyErrorFromHelper:dependencyError(deps.error)];
+		}
+		else if (!deps.snapshots.empty() || !deps.clones.empty() || !deps.bookmarks.empty())
+		{
+			[self->_zetaConfirmDialog addQuery:NSLocalizedString(@"The following will be destroyed by the rollback", @"Rollback Snapshot Query")
+							   withInformation:formatRollbackDependents(deps)
+								  withCallback:rollBackBlock];
+		}
+		else
+		{
+			rollBackBlock(true);
+		}
+	});
 }
 
 - (IBAction)rollbackFilesystem:(id)sender
@@ -1025,44 +1038,49 @@ static NSString * formatRollbackDependents(
 - (IBAction)destroy:(id)sender
 {
 	NSString * fsName = [sender representedObject];
-	zfs::LibZFSHandle lib;
-	auto fs = lib.filesystem([fsName UTF8String]);
-	auto dependents = fs.dependents();
-	if (!dependents.empty())
+	std::string name = [fsName UTF8String];
+	zeta::loadInBackground<DestroyDependents>(
+		[name]{ return loadDestroyDependents(name); },
+		[self, fsName](DestroyDependents const & deps)
 	{
-  // cannot destroy 'tank/nuts': filesystem has children
-		[_zetaConfirmDialog addQuery:NSLocalizedString(@"Unable to destroy, the filesystem has dependent datasets", @"Destroy Dep Failure")
-					 withInformation:toString(dependents)
-						withCallback:^(bool ok)
-		 {
-		 }];
-	}
-	else
-	{
-		NSDictionary * opts = @{@"filesystem": fsName};
-		[_authorization destroy:opts withReply:^(NSError * error)
-		 {
-			 if (!error)
+		if (!deps.error.empty())
+		{
+			[self notifyErrorFromHelper:dependencyError(deps.error)];
+		}
+		else if (!deps.dependents.empty())
+		{
+			// cannot destroy 'tank/nuts': filesystem has children
+			[self->_zetaConfirmDialog addQuery:NSLocalizedString(@"Unable to destroy, the filesystem has dependent datasets", @"Destroy Dep Failure")
+							   withInformation:toString(deps.dependents)
+								  withCallback:^(bool ok)
 			 {
-				 NSString * title = NSLocalizedString(@"Destroy succeeded",
-													  @"Destroy Succeeded");
-				 NSString * text = [NSString stringWithFormat:
-					NSLocalizedString(@"%@ destroyed",
-									  @"Destroy Success format"),
-					[sender representedObject]];
-				 [self notifySuccessWithTitle:title text:text];
-			 }
-			 [self handleFileSystemChangeReply:error];
-		 }];
-	}
+			 }];
+		}
+		else
+		{
+			NSDictionary * opts = @{@"filesystem": fsName};
+			[self->_authorization destroy:opts withReply:^(NSError * error)
+			 {
+				 if (!error)
+				 {
+					 NSString * title = NSLocalizedString(@"Destroy succeeded",
+														  @"Destroy Succeeded");
+					 NSString * text = [NSString stringWithFormat:
+						NSLocalizedString(@"%@ destroyed",
+										  @"Destroy Success format"),
+						fsName];
+					 [self notifySuccessWithTitle:title text:text];
+				 }
+				 [self handleFileSystemChangeReply:error];
+			 }];
+		}
+	});
 }
 
 - (IBAction)destroyRecursive:(id)sender
 {
 	NSString * fsName = [sender representedObject];
-	zfs::LibZFSHandle lib;
-	auto fs = lib.filesystem([fsName UTF8String]);
-	auto dependents = fs.dependents();
+	std::string name = [fsName UTF8String];
 	auto destroyBlock = ^(bool ok)
 	{
 		if (ok)
@@ -1084,16 +1102,25 @@ static NSString * formatRollbackDependents(
 			 }];
 		}
 	};
-	if (!dependents.empty())
+	zeta::loadInBackground<DestroyDependents>(
+		[name]{ return loadDestroyDependents(name); },
+		[self, destroyBlock](DestroyDependents const & deps)
 	{
-		[_zetaConfirmDialog addQuery:NSLocalizedString(@"The following dependent datasets will be destroyed", @"Destroy Dep Query")
-					 withInformation:toString(dependents)
-						withCallback:destroyBlock];
-	}
-	else
-	{
-		destroyBlock(true);
-	}
+		if (!deps.error.empty())
+		{
+			[self notifyErrorFromHelper:dependencyError(deps.error)];
+		}
+		else if (!deps.dependents.empty())
+		{
+			[self->_zetaConfirmDialog addQuery:NSLocalizedString(@"The following dependent datasets will be destroyed", @"Destroy Dep Query")
+							   withInformation:toString(deps.dependents)
+								  withCallback:destroyBlock];
+		}
+		else
+		{
+			destroyBlock(true);
+		}
+	});
 }
 
 - (IBAction)loadKey:(id)sender
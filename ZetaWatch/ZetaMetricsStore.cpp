@@ -0,0 +1,477 @@
+//
+//  ZetaMetricsStore.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaMetricsStore.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace zeta
+{
+	namespace
+	{
+		int64_t const secondsPerDay = 24 * 60 * 60;
+		uint32_t const version = 2;
+		uint32_t const dayMagic = 0x5a4d4459; // ZMDY
+		uint32_t const seriesMagic = 0x5a4d5352; // ZMSR
+		char const * const dayExtension = ".metrics";
+
+		struct DayHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			int64_t dayStart;
+			uint64_t used; //!< Bytes in use, including this header
+			uint32_t resolution; //!< Seconds, 0 if not compacted
+			uint32_t reserved;
+		};
+
+		struct SeriesHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+		};
+
+		struct SeriesKey
+		{
+			uint64_t guid;
+			uint32_t metric;
+			uint32_t reserved;
+		};
+
+		struct ChunkHeader
+		{
+			uint32_t series;
+			uint32_t count;
+			uint64_t previous; //!< Offset of the previous chunk of the series, 0 if none
+			int64_t base; //!< Time of the first record
+		};
+
+#pragma pack(push, 2)
+		struct Record
+		{
+			uint16_t delta; //!< Seconds since the previous record in the chunk, 0 for the first
+			uint64_t value;
+		};
+#pragma pack(pop)
+
+		//! Larger gaps between records of a series start a new chunk
+		int64_t const maxDelta = std::numeric_limits<uint16_t>::max();
+
+		size_t const chunkRecords = 64;
+		size_t const chunkSize = sizeof(ChunkHeader) + chunkRecords * sizeof(Record);
+		size_t const initialChunks = 256;
+
+		std::system_error lastError(char const * what)
+		{
+			return std::system_error(errno, std::generic_category(), what);
+		}
+
+		//! A file that is mapped completely, and can be grown
+		class MappedFile
+		{
+		public:
+			MappedFile(std::string const & path, bool writable) :
+				m_writable(writable)
+			{
+				m_fd = open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+				if (m_fd < 0)
+					throw lastError("Opening metrics file failed");
+				struct stat info;
+				if (fstat(m_fd, &info) != 0)
+				{
+					close(m_fd);
+					throw lastError("Reading metrics file size failed");
+				}
+				try
+				{
+					map(size_t(info.st_size));
+				}
+				catch (...)
+				{
+					close(m_fd);
+					throw;
+				}
+			}
+
+			~MappedFile()
+			{
+				unmap();
+				close(m_fd);
+			}
+
+			MappedFile(MappedFile const &) = delete;
+			MappedFile & operator=(MappedFile const &) = delete;
+
+			char * data() const { return m_data; }
+			size_t size() const { return m_size; }
+
+			void resize(size_t size)
+			{
+				unmap();
+				if (ftruncate(m_fd, off_t(size)) != 0)
+					throw lastError("Growing metrics file failed");
+				map(size);
+			}
+
+		private:
+			void map(size_t size)
+			{
+				m_size = size;
+				if (size == 0)
+					return;
+				int protection = m_writable ? PROT_READ | PROT_WRITE : PROT_READ;
+				void * data = mmap(nullptr, size, protection, MAP_SHARED, m_fd, 0);
+				if (data == MAP_FAILED)
+				{
+					m_size = 0;
+					throw lastError("Mapping metrics file failed");
+				}
+				m_data = static_cast<char *>(data);
+			}
+
+			void unmap()
+			{
+				if (m_data)
+					munmap(m_data, m_size);
+				m_data = nullptr;
+				m_size = 0;
+			}
+
+		private:
+			int m_fd = -1;
+			bool m_writable;
+			char * m_data = nullptr;
+			size_t m_size = 0;
+		};
+	}
+
+	struct MetricsStore::Day
+	{
+		//! Opens an existing day, or creates it if writable
+		Day(std::string const & path, int64_t day, bool writable) :
+			day(day), file(path, writable)
+		{
+			if (file.size() < sizeof(DayHeader) || header()->magic != dayMagic ||
+				header()->version != version)
+			{
+				if (!writable)
+					throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+						"Invalid metrics file");
+				file.resize(sizeof(DayHeader) + initialChunks * chunkSize);
+				*header() = DayHeader{dayMagic, version, day * secondsPerDay, sizeof(DayHeader), 0, 0};
+			}
+			// Ignore a partially written chunk at the end
+			uint64_t used = std::max<uint64_t>(std::min<uint64_t>(header()->used, file.size()), sizeof(DayHeader));
+			used -= (used - sizeof(DayHeader)) % chunkSize;
+			if (writable)
+				header()->used = used;
+			for (uint64_t offset = sizeof(DayHeader); offset < used; offset += chunkSize)
+			{
+				auto series = chunk(offset)->series;
+				if (series >= lastChunk.size())
+					lastChunk.resize(series + 1, 0);
+				lastChunk[series] = offset;
+			}
+			lastTime.resize(lastChunk.size(), 0);
+			for (size_t series = 0; series < lastChunk.size(); ++series)
+			{
+				if (lastChunk[series] != 0)
+					lastTime[series] = endTime(chunk(lastChunk[series]));
+			}
+		}
+
+		DayHeader * header() const
+		{
+			return reinterpret_cast<DayHeader *>(file.data());
+		}
+
+		ChunkHeader * chunk(uint64_t offset) const
+		{
+			return reinterpret_cast<ChunkHeader *>(file.data() + offset);
+		}
+
+		Record * records(ChunkHeader * chunk) const
+		{
+			return reinterpret_cast<Record *>(chunk + 1);
+		}
+
+		//! Time of the last record in the chunk
+		int64_t endTime(ChunkHeader * chunk) const
+		{
+			int64_t time = chunk->base;
+			auto r = records(chunk);
+			auto count = std::min<uint32_t>(chunk->count, chunkRecords);
+			for (uint32_t i = 0; i < count; ++i)
+				time += r[i].delta;
+			return time;
+		}
+
+		void append(uint32_t series, std::time_t time, uint64_t value)
+		{
+			if (series >= lastChunk.size())
+			{
+				lastChunk.resize(series + 1, 0);
+				lastTime.resize(series + 1, 0);
+			}
+			auto offset = lastChunk[series];
+			auto delta = time - lastTime[series];
+			if (offset == 0 || chunk(offset)->count >= chunkRecords || delta < 0 || delta > maxDelta)
+			{
+				auto used = header()->used;
+				if (used + chunkSize > file.size())
+					file.resize(std::max<size_t>(file.size() * 2, used + chunkSize));
+				*chunk(used) = ChunkHeader{series, 0, offset, time};
+				header()->used = used + chunkSize;
+				lastChunk[series] = offset = used;
+				delta = 0;
+			}
+			auto c = chunk(offset);
+			records(c)[c->count] = Record{uint16_t(delta), value};
+			++c->count;
+			lastTime[series] = time;
+		}
+
+		//! Calls f with the time and value of the records of a series, oldest first
+		template<typename F>
+		void forEach(uint32_t series, F f) const
+		{
+			if (series >= lastChunk.size())
+				return;
+			std::vector<ChunkHeader *> chunks;
+			for (auto offset = lastChunk[series]; offset != 0;)
+			{
+				chunks.push_back(chunk(offset));
+				// Chains only point backwards, anything else is corrupt
+				auto previous = chunk(offset)->previous;
+				if (previous >= offset || (previous != 0 && (previous - sizeof(DayHeader)) % chunkSize != 0))
+					break;
+				offset = previous;
+			}
+			for (auto c = chunks.rbegin(); c != chunks.rend(); ++c)
+			{
+				auto r = records(*c);
+				auto count = std::min<uint32_t>((*c)->count, chunkRecords);
+				int64_t time = (*c)->base;
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					time += r[i].delta;
+					f(std::time_t(time), r[i].value);
+				}
+			}
+		}
+
+		int64_t day;
+		MappedFile file;
+		std::vector<uint64_t> lastChunk; //!< Per series, 0 if it has no chunk
+		std::vector<int64_t> lastTime; //!< Per series, time of the last record
+	};
+
+	std::unique_ptr<MetricsStore::Day> MetricsStore::openStoredDay(std::string const & path, int64_t day)
+	{
+		// Days written in another format are skipped until they expire
+		try
+		{
+			return std::make_unique<Day>(path, day, false);
+		}
+		catch (std::system_error const & e)
+		{
+			if (e.code() == std::errc::invalid_argument)
+				return nullptr;
+			throw;
+		}
+	}
+
+	MetricsStore::MetricsStore(std::string directory) :
+		m_directory(std::move(directory))
+	{
+		auto path = m_directory + "/series" + dayExtension;
+		m_seriesFile = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (m_seriesFile < 0)
+			throw lastError("Opening metrics series file failed");
+		SeriesHeader header;
+		if (pread(m_seriesFile, &header, sizeof(header), 0) != sizeof(header) ||
+			header.magic != seriesMagic)
+		{
+			header = SeriesHeader{seriesMagic, version};
+			if (ftruncate(m_seriesFile, 0) != 0 ||
+				pwrite(m_seriesFile, &header, sizeof(header), 0) != sizeof(header))
+			{
+				close(m_seriesFile);
+				throw lastError("Writing metrics series file failed");
+			}
+			return;
+		}
+		SeriesKey key;
+		off_t offset = sizeof(header);
+		while (pread(m_seriesFile, &key, sizeof(key), offset) == sizeof(key))
+		{
+			m_series.emplace(std::make_pair(key.guid, Metric(key.metric)), uint32_t(m_series.size()));
+			offset += sizeof(key);
+		}
+		// Drop a partially written key
+		if (ftruncate(m_seriesFile, offset) != 0)
+		{
+			close(m_seriesFile);
+			throw lastError("Truncating metrics series file failed");
+		}
+	}
+
+	MetricsStore::~MetricsStore()
+	{
+		close(m_seriesFile);
+	}
+
+	uint32_t MetricsStore::seriesIndex(uint64_t guid, Metric metric)
+	{
+		auto it = m_series.find(std::make_pair(guid, metric));
+		if (it != m_series.end())
+			return it->second;
+		uint32_t index = uint32_t(m_series.size());
+		SeriesKey key{guid, uint32_t(metric), 0};
+		off_t offset = sizeof(SeriesHeader) + off_t(index) * sizeof(key);
+		if (pwrite(m_seriesFile, &key, sizeof(key), offset) != sizeof(key))
+			throw lastError("Writing metrics series file failed");
+		m_series.emplace(std::make_pair(guid, metric), index);
+		return index;
+	}
+
+	std::string MetricsStore::dayPath(int64_t day) const
+	{
+		std::time_t start = day * secondsPerDay;
+		std::tm date;
+		gmtime_r(&start, &date);
+		char name[32];
+		strftime(name, sizeof(name), "%Y-%m-%d", &date);
+		return m_directory + "/" + name + dayExtension;
+	}
+
+	std::vector<int64_t> MetricsStore::storedDays() const
+	{
+		std::vector<int64_t> days;
+		DIR * dir = opendir(m_directory.c_str());
+		if (!dir)
+			throw lastError("Listing metrics directory failed");
+		while (dirent * entry = readdir(dir))
+		{
+			std::tm date = {};
+			char extension[16] = {};
+			if (sscanf(entry->d_name, "%4d-%2d-%2d%15s",
+				&date.tm_year, &date.tm_mon, &date.tm_mday, extension) != 4 ||
+				std::string(extension) != dayExtension)
+				continue;
+			date.tm_year -= 1900;
+			date.tm_mon -= 1;
+			days.push_back(timegm(&date) / secondsPerDay);
+		}
+		closedir(dir);
+		std::sort(days.begin(), days.end());
+		return days;
+	}
+
+	void MetricsStore::append(std::time_t time, std::vector<MetricSample> const & samples)
+	{
+		int64_t day = time / secondsPerDay;
+		if (!m_day || m_day->day != day)
+		{
+			m_day.reset();
+			m_day = std::make_unique<Day>(dayPath(day), day, true);
+		}
+		for (auto const & sample : samples)
+			m_day->append(seriesIndex(sample.guid, sample.metric), time, sample.value);
+	}
+
+	std::vector<MetricPoint> MetricsStore::read(uint64_t guid, Metric metric,
+		std::time_t begin, std::time_t end) const
+	{
+		std::vector<MetricPoint> points;
+		auto it = m_series.find(std::make_pair(guid, metric));
+		if (it == m_series.end() || begin >= end)
+			return points;
+		auto collect = [&](std::time_t time, uint64_t value)
+		{
+			if (time >= begin && time < end)
+				points.push_back(MetricPoint{time, value});
+		};
+		for (int64_t day = begin / secondsPerDay; day <= (end - 1) / secondsPerDay; ++day)
+		{
+			if (m_day && m_day->day == day)
+			{
+				m_day->forEach(it->second, collect);
+				continue;
+			}
+			auto path = dayPath(day);
+			if (access(path.c_str(), F_OK) != 0)
+				continue;
+			if (auto stored = openStoredDay(path, day))
+				stored->forEach(it->second, collect);
+		}
+		return points;
+	}
+
+	void MetricsStore::expire(std::time_t before)
+	{
+		for (auto day : storedDays())
+		{
+			if ((day + 1) * secondsPerDay > before)
+				break;
+			if (m_day && m_day->day == day)
+				m_day.reset();
+			if (unlink(dayPath(day).c_str()) != 0)
+				throw lastError("Deleting metrics file failed");
+		}
+	}
+
+	void MetricsStore::compact(std::time_t before, std::chrono::seconds resolution)
+	{
+		for (auto day : storedDays())
+		{
+			if ((day + 1) * secondsPerDay > before)
+				break;
+			if (m_day && m_day->day == day)
+				m_day.reset();
+			auto path = dayPath(day);
+			auto old = openStoredDay(path, day);
+			if (!old || old->header()->resolution >= uint64_t(resolution.count()))
+				continue;
+			// Written to a separate file and renamed, so a failure leaves the old one
+			auto compactedPath = path + ".compacting";
+			unlink(compactedPath.c_str());
+			{
+				Day compacted(compactedPath, day, true);
+				for (uint32_t series = 0; series < old->lastChunk.size(); ++series)
+				{
+					bool pending = false;
+					std::time_t pendingTime = 0;
+					uint64_t pendingValue = 0;
+					old->forEach(series, [&](std::time_t time, uint64_t value)
+					{
+						if (pending && time / resolution.count() != pendingTime / resolution.count())
+							compacted.append(series, pendingTime, pendingValue);
+						pending = true;
+						pendingTime = time;
+						pendingValue = value;
+					});
+					if (pending)
+						compacted.append(series, pendingTime, pendingValue);
+				}
+				compacted.header()->resolution = uint32_t(resolution.count());
+				compacted.file.resize(compacted.header()->used);
+			}
+			if (rename(compactedPath.c_str(), path.c_str()) != 0)
+				throw lastError("Replacing metrics file failed");
+		}
+	}
+}
@@ -0,0 +1,100 @@
+//
+//  ZetaMetricsStore.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaMetricsStore_hpp
+#define ZetaMetricsStore_hpp
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+namespace zeta
+{
+	enum class Metric : uint32_t
+	{
+		alloc,
+		space,
+		fragmentation,
+		errorRead,
+		errorWrite,
+		errorChecksum,
+		scrubIssueRate,
+	};
+
+	//! One value of a series, the guid is the one of the pool or vdev
+	struct MetricSample
+	{
+		uint64_t guid = 0;
+		Metric metric = Metric::alloc;
+		uint64_t value = 0;
+	};
+
+	struct MetricPoint
+	{
+		std::time_t time = 0;
+		uint64_t value = 0;
+	};
+
+	/*!
+	 \brief Append-only history of metric series, in memory-mapped files
+
+	 Every UTC day is stored in its own file, so that the day files are the
+	 index for range reads, and expiring old data is deleting files. A day
+	 file is a sequence of fixed size chunks, each holding the records of a
+	 single series. Each record stores its time as the 16 bit delta to the
+	 previous record of the chunk, since polls are minutes apart, and a gap
+	 too large for that starts a new chunk. The chunks of a series are linked
+	 backwards, so reading a series only touches its own chunks. The series
+	 themselves are listed once in a separate file, records refer to them by
+	 index.
+
+	 Appending only writes to the mapped pages, and the files grow in large
+	 steps. All functions throw std::system_error on I/O errors. The store is
+	 not thread safe.
+	 */
+	class MetricsStore
+	{
+	public:
+		//! Opens or creates the store in directory, which must exist
+		explicit MetricsStore(std::string directory);
+		~MetricsStore();
+
+	public:
+		//! Appends the samples of one poll
+		void append(std::time_t time, std::vector<MetricSample> const & samples);
+		//! Returns the points of a series in [begin, end), oldest first
+		std::vector<MetricPoint> read(uint64_t guid, Metric metric,
+			std::time_t begin, std::time_t end) const;
+
+		//! Deletes the days that end before the given time
+		void expire(std::time_t before);
+		//! Rewrites the days that end before the given time to keep only the
+		//! last record of each series per resolution interval
+		void compact(std::time_t before, std::chrono::seconds resolution);
+
+	private:
+		struct Day;
+
+		static std::unique_ptr<Day> openStoredDay(std::string const & path, int64_t day);
+		uint32_t seriesIndex(uint64_t guid, Metric metric);
+		std::string dayPath(int64_t day) const;
+		std::vector<int64_t> storedDays() const;
+
+	private:
+		std::string m_directory;
+		int m_seriesFile = -1;
+		std::map<std::pair<uint64_t, Metric>, uint32_t> m_series;
+		std::unique_ptr<Day> m_day; //!< The day currently appended to
+	};
+}
+
+#endif /* ZetaMetricsStore_hpp */
@@ -28,6 +28,7 @@
 
 - (void)errorDetected:(std::string const &)error;
 - (void)errorDetectedInPool:(std::string const &)pool;
+- (void)poolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes;
 
 @property (readonly) NSArray<ZetaNotification*> * inProgressActions;
 
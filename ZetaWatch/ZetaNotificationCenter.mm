@@ -10,6 +10,9 @@
 
 #import "ZetaPoolWatcher.h"
 
+#include "ZFSStrings.hpp"
+#include "ZetaFormatHelpers.hpp"
+
 @implementation ZetaNotification
 {
 }
@@ -86,6 +89,65 @@
 	[[NSUserNotificationCenter defaultUserNotificationCenter] deliverNotification:notification];
 }
 
+- (void)poolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes
+{
+	for (auto const & change : changes)
+	{
+		// Only report vdevs that got worse, recovery shows up in the menu
+		if (change.kind == zeta::PoolStateChange::Kind::vdevStateChanged &&
+			change.newValue < change.oldValue)
+		{
+			[self vdevStateChanged:change];
+		}
+		else if (change.kind == zeta::PoolStateChange::Kind::vdevLatencyDiverged)
+		{
+			[self vdevLatencyDiverged:change];
+		}
+		else if (change.kind == zeta::PoolStateChange::Kind::capacityRunningOut)
+		{
+			[self capacityRunningOut:change];
+		}
+	}
+}
+
+- (void)vdevStateChanged:(zeta::PoolStateChange const &)change
+{
+	NSString * oldState = zfs::localized_describe_vdev_state_t(
+		vdev_state_t(change.oldValue), VDEV_AUX_NONE);
+	NSString * newState = zfs::localized_describe_vdev_state_t(
+		vdev_state_t(change.newValue), VDEV_AUX_NONE);
+	NSUserNotification * notification = [[NSUserNotification alloc] init];
+	notification.title = NSLocalizedString(@"ZFS Device State Changed", @"ZFS VDev State Title");
+	NSString * stateFormat = NSLocalizedString(@"Device %s on pool %s changed from %@ to %@.", @"ZFS VDev State Format");
+	notification.informativeText = [NSString stringWithFormat:stateFormat,
+		change.objectName.c_str(), change.poolName.c_str(), oldState, newState];
+	notification.hasActionButton = NO;
+	[[NSUserNotificationCenter defaultUserNotificationCenter] deliverNotification:notification];
+}
+
+- (void)vdevLatencyDiverged:(zeta::PoolStateChange const &)change
+{
+	NSUserNotification * notification = [[NSUserNotification alloc] init];
+	notification.title = NSLocalizedString(@"ZFS Device Slow", @"ZFS VDev Slow Title");
+	NSString * slowFormat = NSLocalizedString(@"Device %s on pool %s has a 99th percentile latency of %s, other devices in the same vdev %s.", @"ZFS VDev Slow Format");
+	notification.informativeText = [NSString stringWithFormat:slowFormat,
+		change.objectName.c_str(), change.poolName.c_str(),
+		formatLatency(change.newValue).c_str(), formatLatency(change.oldValue).c_str()];
+	notification.hasActionButton = NO;
+	[[NSUserNotificationCenter defaultUserNotificationCenter] deliverNotification:notification];
+}
+
+- (void)capacityRunningOut:(zeta::PoolStateChange const &)change
+{
+	NSUserNotification * notification = [[NSUserNotification alloc] init];
+	notification.title = NSLocalizedString(@"ZFS Running Out of Space", @"ZFS Capacity Title");
+	NSString * capacityFormat = NSLocalizedString(@"%s grows by %s per day, and will be full in about %llu days.", @"ZFS Capacity Format");
+	notification.informativeText = [NSString stringWithFormat:capacityFormat,
+		change.objectName.c_str(), formatBytes(change.oldValue).c_str(), change.newValue];
+	notification.hasActionButton = NO;
+	[[NSUserNotificationCenter defaultUserNotificationCenter] deliverNotification:notification];
+}
+
 @synthesize inProgressActions;
 
 @end
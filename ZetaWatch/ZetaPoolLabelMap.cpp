@@ -0,0 +1,147 @@
+//
+//  ZetaPoolLabelMap.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolLabelMap.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace zeta
+{
+	namespace
+	{
+		//! Children of a top level vdev that may be missing
+		uint64_t tolerance(PoolLabel const & label)
+		{
+			if (label.topType == "mirror")
+				return label.topChildren.empty() ? 0 : label.topChildren.size() - 1;
+			if (label.topType == "raidz" || label.topType == "draid")
+				return label.topParity;
+			return 0;
+		}
+	}
+
+	uint64_t PoolLabelMap::deviceAppeared(PoolLabel label)
+	{
+		auto poolGUID = label.poolGUID;
+		deviceDisappeared(label.device);
+		m_pools[poolGUID].devices.push_back(label.device);
+		m_devices.emplace(label.device, std::move(label));
+		update(poolGUID);
+		return poolGUID;
+	}
+
+	uint64_t PoolLabelMap::deviceDisappeared(std::string const & device)
+	{
+		auto it = m_devices.find(device);
+		if (it == m_devices.end())
+			return 0;
+		auto poolGUID = it->second.poolGUID;
+		m_devices.erase(it);
+		auto & devices = m_pools[poolGUID].devices;
+		devices.erase(std::remove(devices.begin(), devices.end(), device), devices.end());
+		if (devices.empty())
+			m_pools.erase(poolGUID);
+		else
+			update(poolGUID);
+		return poolGUID;
+	}
+
+	void PoolLabelMap::update(uint64_t poolGUID)
+	{
+		auto & pool = m_pools[poolGUID];
+		// The newest label of each top level vdev describes it
+		std::vector<PoolLabel const *> tops;
+		std::unordered_set<uint64_t> presentLeaves;
+		PoolLabel const * newest = nullptr;
+		for (auto const & device : pool.devices)
+		{
+			auto const & label = m_devices.at(device);
+			presentLeaves.insert(label.guid);
+			if (!newest || label.txg > newest->txg)
+				newest = &label;
+			if (label.topIndex >= tops.size())
+				tops.resize(label.topIndex + 1, nullptr);
+			auto & top = tops[label.topIndex];
+			if (!top || label.txg > top->txg)
+				top = &label;
+		}
+		pool.complete = newest && tops.size() == newest->vdevChildren &&
+			std::all_of(tops.begin(), tops.end(), [&](PoolLabel const * top)
+		{
+			if (!top)
+				return false;
+			uint64_t missing = 0;
+			for (auto const & child : top->topChildren)
+			{
+				bool present = std::any_of(child.begin(), child.end(), [&](uint64_t leaf)
+				{
+					return presentLeaves.count(leaf) > 0;
+				});
+				missing += present ? 0 : 1;
+			}
+			return missing <= tolerance(*top);
+		});
+	}
+
+	bool PoolLabelMap::complete(uint64_t poolGUID) const
+	{
+		auto it = m_pools.find(poolGUID);
+		return it != m_pools.end() && it->second.complete;
+	}
+
+	PoolLabel const * PoolLabelMap::label(uint64_t poolGUID) const
+	{
+		auto it = m_pools.find(poolGUID);
+		if (it == m_pools.end())
+			return nullptr;
+		PoolLabel const * newest = nullptr;
+		for (auto const & device : it->second.devices)
+		{
+			auto const & label = m_devices.at(device);
+			if (!newest || label.txg > newest->txg)
+				newest = &label;
+		}
+		return newest;
+	}
+
+	std::vector<std::string> PoolLabelMap::devices(uint64_t poolGUID) const
+	{
+		auto it = m_pools.find(poolGUID);
+		if (it == m_pools.end())
+			return {};
+		return it->second.devices;
+	}
+
+	std::vector<uint64_t> PoolLabelMap::pools() const
+	{
+		std::vector<uint64_t> pools;
+		pools.reserve(m_pools.size());
+		for (auto const & pool : m_pools)
+			pools.push_back(pool.first);
+		return pools;
+	}
+
+	ImportDecision decideImport(PoolLabelMap const & labels, uint64_t poolGUID,
+		bool importedBefore, bool importedHere)
+	{
+		auto newest = labels.label(poolGUID);
+		if (!newest || importedBefore)
+			return ImportDecision::ignore;
+		// Destroyed pools, spares and cache devices are not imported
+		if (newest->poolState != poolStateActive && newest->poolState != poolStateExported)
+			return ImportDecision::ignore;
+		if (newest->poolState == poolStateActive && importedHere)
+			return ImportDecision::imported;
+		if (!labels.complete(poolGUID))
+			return ImportDecision::wait;
+		if (newest->poolState == poolStateActive && newest->foreignHost)
+			return ImportDecision::foreignHost;
+		return ImportDecision::importable;
+	}
+}
@@ -0,0 +1,100 @@
+//
+//  ZetaPoolLabelMap.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolLabelMap_hpp
+#define ZetaPoolLabelMap_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace zeta
+{
+	//! The parts of a ZFS label needed to tell if all devices of a pool are present
+	struct PoolLabel
+	{
+		std::string device;
+		std::string poolName;
+		uint64_t poolGUID = 0;
+		uint64_t poolState = 0; //!< pool_state_t
+		bool foreignHost = false; //!< Last imported by a system with another hostid
+		uint64_t txg = 0;
+		uint64_t vdevChildren = 0; //!< Number of top level vdevs of the pool
+		uint64_t guid = 0; //!< Of the leaf vdev on this device
+		uint64_t topIndex = 0;
+		uint64_t topGUID = 0;
+		std::string topType; //!< disk, file, mirror, raidz, draid
+		uint64_t topParity = 0;
+		//! Leaf guids below each child of the top level vdev, a single child
+		//! with the device itself for a top level leaf
+		std::vector<std::vector<uint64_t>> topChildren;
+	};
+
+	/*!
+	 \brief Tracks the labels of the present devices, grouped by pool
+
+	 A pool is complete if every top level vdev has enough children with a
+	 present leaf to be readable. Each top level vdev is described by the
+	 newest label of one of its devices. Adding or removing a device only
+	 looks at its own pool, so the cost per event is independent of the
+	 number of devices in the system.
+	 */
+	class PoolLabelMap
+	{
+	public:
+		//! Returns the guid of the pool of the device
+		uint64_t deviceAppeared(PoolLabel label);
+		//! Returns the guid of the pool the device belonged to, 0 if none
+		uint64_t deviceDisappeared(std::string const & device);
+
+		bool complete(uint64_t poolGUID) const;
+		//! The newest label of a present device of the pool, or nullptr
+		PoolLabel const * label(uint64_t poolGUID) const;
+		std::vector<std::string> devices(uint64_t poolGUID) const;
+		//! Pools with at least one present device
+		std::vector<uint64_t> pools() const;
+
+	private:
+		struct Pool
+		{
+			std::vector<std::string> devices;
+			bool complete = false;
+		};
+
+		void update(uint64_t poolGUID);
+
+	private:
+		std::unordered_map<std::string, PoolLabel> m_devices;
+		std::unordered_map<uint64_t, Pool> m_pools;
+	};
+
+	//! The values of pool_state_t that decideImport distinguishes
+	constexpr uint64_t poolStateActive = 0;
+	constexpr uint64_t poolStateExported = 1;
+
+	enum class ImportDecision
+	{
+		ignore, //!< Known already, or a label that is not importable
+		imported, //!< A device of a pool that is imported on this system
+		wait, //!< Devices are missing
+		importable, //!< All devices present, importable without force
+		foreignHost, //!< All devices present, last in use on another system
+	};
+
+	/*!
+	 Decides what to do with the pool after one of its devices appeared, from
+	 its labels alone. Pools that were not exported are importable like
+	 exported ones if they were last used on this system, for example before
+	 a crash. The pool must have a present device in labels.
+	 */
+	ImportDecision decideImport(PoolLabelMap const & labels, uint64_t poolGUID,
+		bool importedBefore, bool importedHere);
+}
+
+#endif /* ZetaPoolLabelMap_hpp */
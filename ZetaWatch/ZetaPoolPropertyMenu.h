@@ -15,7 +15,7 @@
 
 @interface ZetaPoolPropertyMenu : ZetaCommanderBase <NSMenuDelegate>
 
-- (id)initWithPool:(zfs::ZPool)pool;
+- (id)initWithPoolName:(NSString*)poolName;
 
 - (void)menuNeedsUpdate:(NSMenu*)menu;
 
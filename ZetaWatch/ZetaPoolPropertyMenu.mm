@@ -8,28 +8,74 @@
 
 #import "ZetaPoolPropertyMenu.h"
 
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaBackgroundLoad.hpp"
+
+struct PoolPropertyList
+{
+	std::vector<std::pair<std::string, std::string>> properties;
+	std::string error;
+};
+
 @implementation ZetaPoolPropertyMenu
 {
-	zfs::ZPool _pool;
+	NSString * _poolName;
 }
 
-- (id)initWithPool:(zfs::ZPool)pool
+- (id)initWithPoolName:(NSString*)poolName
 {
 	if (self = [super init])
 	{
-		_pool = std::move(pool);
+		_poolName = poolName;
 	}
 	return self;
 }
 
-- (void)menuNeedsUpdate:(NSMenu*)menu
+PoolPropertyList loadPoolProperties(std::string const & poolName)
+{
+	PoolPropertyList list;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto pool = lib.pool(poolName);
+		for (auto const & p : pool.properties())
+			list.properties.emplace_back(p.name, p.value);
+		zeta::countPropertyReads(list.properties.size());
+	}
+	catch (std::exception const & e)
+	{
+		list.error = e.what();
+	}
+	return list;
+}
+
+- (void)fillMenu:(NSMenu*)menu withProperties:(PoolPropertyList const &)list
 {
 	[menu removeAllItems];
-	auto props = _pool.properties();
-	for (auto const & p : props)
+	for (auto const & [name, value] : list.properties)
 	{
 		addMenuItem(menu, self, NSLocalizedString(@"%-64s \t %s", @"KeyValue"),
-						p.name, p.value);
+						name, value);
+	}
+	if (!list.error.empty())
+	{
+		NSString * error = [NSString stringWithFormat:@"Exception during property iteration: %s", list.error.c_str()];
+		[menu addItemWithTitle:error action:NULL keyEquivalent:@""];
+	}
+}
+
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	[menu removeAllItems];
+	std::string poolName = [_poolName UTF8String];
+	ZetaPoolPropertyMenu __weak * weakSelf = self;
+	bool loaded = zeta::loadInBackground<PoolPropertyList>(
+		[poolName]{ return loadPoolProperties(poolName); },
+		[menu, weakSelf](PoolPropertyList const & list){ [weakSelf fillMenu:menu withProperties:list]; });
+	if (!loaded)
+	{
+		[menu addItemWithTitle:NSLocalizedString(@"Refreshing...", @"Refreshing")
+						action:NULL keyEquivalent:@""];
 	}
 }
 
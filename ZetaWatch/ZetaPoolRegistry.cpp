@@ -0,0 +1,67 @@
+//
+//  ZetaPoolRegistry.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolRegistry.hpp"
+
+namespace zeta
+{
+	void PoolRegistry::insert(uint64_t poolGUID, std::vector<std::string> const & devices)
+	{
+		erase(poolGUID);
+		for (auto const & device : devices)
+			m_devicePools.emplace(device, poolGUID);
+		m_pools.emplace(poolGUID, devices);
+	}
+
+	void PoolRegistry::erase(uint64_t poolGUID)
+	{
+		auto it = m_pools.find(poolGUID);
+		if (it == m_pools.end())
+			return;
+		for (auto const & device : it->second)
+		{
+			auto range = m_devicePools.equal_range(device);
+			for (auto d = range.first; d != range.second; ++d)
+			{
+				if (d->second == poolGUID)
+				{
+					m_devicePools.erase(d);
+					break;
+				}
+			}
+		}
+		m_pools.erase(it);
+	}
+
+	void PoolRegistry::clear()
+	{
+		m_pools.clear();
+		m_devicePools.clear();
+	}
+
+	bool PoolRegistry::contains(uint64_t poolGUID) const
+	{
+		return m_pools.count(poolGUID) > 0;
+	}
+
+	size_t PoolRegistry::size() const
+	{
+		return m_pools.size();
+	}
+
+	std::vector<uint64_t> PoolRegistry::eraseDevice(std::string const & device)
+	{
+		std::vector<uint64_t> pools;
+		auto range = m_devicePools.equal_range(device);
+		for (auto d = range.first; d != range.second; ++d)
+			pools.push_back(d->second);
+		for (auto poolGUID : pools)
+			erase(poolGUID);
+		return pools;
+	}
+}
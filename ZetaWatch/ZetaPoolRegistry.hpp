@@ -0,0 +1,45 @@
+//
+//  ZetaPoolRegistry.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolRegistry_hpp
+#define ZetaPoolRegistry_hpp
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace zeta
+{
+	/*!
+	 \brief Set of pools with an index from device path to pool
+
+	 Pools are identified by guid only. Lookups are constant time, and
+	 removing the pools of a device only touches the devices of those pools.
+	 */
+	class PoolRegistry
+	{
+	public:
+		//! Adds the pool, or replaces its devices
+		void insert(uint64_t poolGUID, std::vector<std::string> const & devices);
+		void erase(uint64_t poolGUID);
+		void clear();
+
+		bool contains(uint64_t poolGUID) const;
+		size_t size() const;
+
+		//! Removes the pools that use the device, and returns their guids
+		std::vector<uint64_t> eraseDevice(std::string const & device);
+
+	private:
+		std::unordered_map<uint64_t, std::vector<std::string>> m_pools;
+		std::unordered_multimap<std::string, uint64_t> m_devicePools;
+	};
+}
+
+#endif /* ZetaPoolRegistry_hpp */
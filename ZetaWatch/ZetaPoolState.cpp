@@ -0,0 +1,60 @@
+//
+//  ZetaPoolState.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolState.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	template<typename T, typename Less>
+	static std::vector<uint32_t> sortedIndices(std::vector<T> const & items, Less less)
+	{
+		std::vector<uint32_t> order(items.size());
+		for (uint32_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+		{
+			return less(items[a], items[b]);
+		});
+		return order;
+	}
+
+	std::vector<uint32_t> sortedByGUID(std::vector<VDevState> const & vdevs)
+	{
+		return sortedIndices(vdevs, [](VDevState const & a, VDevState const & b) { return a.guid < b.guid; });
+	}
+
+	std::vector<uint32_t> sortedByName(std::vector<FileSystemState> const & fileSystems)
+	{
+		return sortedIndices(fileSystems, [](FileSystemState const & a, FileSystemState const & b)
+		{
+			return a.name < b.name;
+		});
+	}
+
+	std::vector<uint32_t> sortedByGUID(std::vector<PoolState> const & pools)
+	{
+		return sortedIndices(pools, [](PoolState const & a, PoolState const & b) { return a.guid < b.guid; });
+	}
+
+	std::vector<FileSystemState const *> encryptionRoots(SystemState const & state,
+		FileSystemState::KeyStatus keyStatus)
+	{
+		std::vector<FileSystemState const *> roots;
+		for (auto const & pool : state.pools)
+		{
+			for (auto const & fs : pool.fileSystems)
+			{
+				if (fs.isEncryptionRoot && fs.keyStatus == keyStatus)
+					roots.push_back(&fs);
+			}
+		}
+		return roots;
+	}
+}
@@ -0,0 +1,158 @@
+//
+//  ZetaPoolState.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolState_hpp
+#define ZetaPoolState_hpp
+
+#include "ZetaDatasetTree.hpp"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+/*!
+ Plain value model of the pool, vdev and dataset state that the UI displays.
+ It is filled in a single pass by the loader, and then only read. It does not
+ depend on libzfs, so it can be created, copied and inspected anywhere.
+ */
+namespace zeta
+{
+	//! Mirror of zfs::VDevStat, state and aux are vdev_state_t and vdev_aux_t
+	struct VDevStatus
+	{
+		uint64_t state = 0;
+		uint64_t aux = 0;
+		uint64_t alloc = 0;
+		uint64_t space = 0;
+		uint64_t fragmentation = 0;
+		uint64_t errorRead = 0;
+		uint64_t errorWrite = 0;
+		uint64_t errorChecksum = 0;
+	};
+
+	constexpr uint32_t noVDev = uint32_t(-1);
+
+	//! One node of the flattened vdev tree, children follow their parent
+	struct VDevState
+	{
+		uint64_t guid = 0;
+		std::string name;
+		std::string device;
+		std::string type;
+		uint32_t parent = noVDev; //!< Index of the parent in the same array
+		uint32_t depth = 0; //!< 0 for top level vdevs
+		VDevStatus stat;
+	};
+
+	//! Indices of the vdevs ordered by guid, for merging with other states
+	std::vector<uint32_t> sortedByGUID(std::vector<VDevState> const & vdevs);
+
+	//! Mirror of zfs::ScanStat
+	struct ScanStatus
+	{
+		enum State
+		{
+			stateNone,
+			scanning,
+			finished,
+			canceled,
+		};
+
+		State state = stateNone;
+		uint64_t scanStartTime = 0;
+		uint64_t scanEndTime = 0;
+		uint64_t passStartTime = 0;
+		uint64_t passPauseTime = 0;
+		uint64_t passPausedSeconds = 0;
+		uint64_t total = 0;
+		uint64_t scanned = 0;
+		uint64_t issued = 0;
+		uint64_t passScanned = 0;
+		uint64_t passIssued = 0;
+		uint64_t errors = 0;
+	};
+
+	struct FileSystemState
+	{
+		enum class Type
+		{
+			filesystem,
+			volume,
+			snapshot,
+			bookmark,
+			other,
+		};
+
+		enum class KeyStatus
+		{
+			none,
+			unavailable,
+			available,
+		};
+
+		std::string name;
+		DatasetIndex index = noDataset; //!< Node in the pool's dataset tree
+		Type type = Type::filesystem;
+		bool isRoot = false;
+		bool mounted = false;
+		bool isEncryptionRoot = false;
+		KeyStatus keyStatus = KeyStatus::none;
+		bool hasSpace = false; //!< Only capacity candidates have used and available read
+		uint64_t used = 0;
+		uint64_t available = 0;
+	};
+
+	//! Properties only shown in the per-dataset submenu, read when it is opened
+	struct FileSystemDetails
+	{
+		bool mountable = false;
+		uint64_t available = 0;
+		uint64_t used = 0;
+		uint64_t referenced = 0;
+		uint64_t logicalused = 0;
+		double compressRatio = 0;
+		std::string mountpoint;
+	};
+
+	struct PoolState
+	{
+		std::string name;
+		uint64_t guid = 0;
+		uint64_t status = 0; //!< zpool_status_t
+		ScanStatus scan;
+		std::vector<VDevState> vdevs;
+		std::vector<VDevState> caches;
+		std::vector<uint32_t> vdevsByGUID; //!< See sortedByGUID
+		std::vector<uint32_t> cachesByGUID;
+		std::vector<FileSystemState> fileSystems;
+		std::vector<uint32_t> fileSystemsByName; //!< See sortedByName
+		DatasetTree datasets; //!< Hierarchy of fileSystems, see FileSystemState::index
+		std::string error; //!< Non-empty if the configuration could not be read
+		bool stale = false; //!< Not yet read by the refresh in progress
+	};
+
+	struct SystemState
+	{
+		std::vector<PoolState> pools;
+		std::vector<uint32_t> poolsByGUID; //!< See sortedByGUID
+		std::chrono::system_clock::time_point refreshTime;
+		std::string error; //!< Non-empty if the pool iteration failed
+	};
+
+	//! Indices of the file systems ordered by name, for merging with other states
+	std::vector<uint32_t> sortedByName(std::vector<FileSystemState> const & fileSystems);
+	//! Indices of the pools ordered by guid, for merging with other states
+	std::vector<uint32_t> sortedByGUID(std::vector<PoolState> const & pools);
+
+	//! Returns the encryption roots with the given key status in all pools
+	std::vector<FileSystemState const *> encryptionRoots(SystemState const & state,
+		FileSystemState::KeyStatus keyStatus);
+}
+
+#endif /* ZetaPoolState_hpp */
@@ -0,0 +1,191 @@
+//
+//  ZetaPoolStateDiff.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolStateDiff.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	namespace
+	{
+		/*!
+		 Calls func(before, after) once for every key in either collection,
+		 with nullptr for the side that does not contain it. The orders are the
+		 indices sorted by key that the loader stores with each state, so this
+		 is a single linear merge. States built without an order, or whose
+		 order doesn't match, are sorted here.
+		 */
+		template<typename T, typename KeyFunc, typename Func>
+		void mergeBy(std::vector<T> const & before, std::vector<uint32_t> const & beforeOrder,
+			std::vector<T> const & after, std::vector<uint32_t> const & afterOrder,
+			KeyFunc key, Func func)
+		{
+			auto sorted = [&](std::vector<T> const & items, std::vector<uint32_t> const & order,
+				std::vector<uint32_t> & storage) -> std::vector<uint32_t> const &
+			{
+				if (order.size() == items.size())
+					return order;
+				storage.resize(items.size());
+				for (uint32_t i = 0; i < storage.size(); ++i)
+					storage[i] = i;
+				std::sort(storage.begin(), storage.end(), [&](uint32_t a, uint32_t b)
+				{
+					return key(items[a]) < key(items[b]);
+				});
+				return storage;
+			};
+			std::vector<uint32_t> sortedBefore, sortedAfter;
+			auto const & bo = sorted(before, beforeOrder, sortedBefore);
+			auto const & ao = sorted(after, afterOrder, sortedAfter);
+			size_t i = 0, j = 0;
+			while (i < bo.size() || j < ao.size())
+			{
+				if (j == ao.size() || (i < bo.size() && key(before[bo[i]]) < key(after[ao[j]])))
+					func(&before[bo[i++]], nullptr);
+				else if (i == bo.size() || key(after[ao[j]]) < key(before[bo[i]]))
+					func(nullptr, &after[ao[j++]]);
+				else
+					func(&before[bo[i++]], &after[ao[j++]]);
+			}
+		}
+
+		uint64_t increase(uint64_t before, uint64_t after)
+		{
+			return after > before ? after - before : 0;
+		}
+
+		PoolStateChange makeChange(PoolStateChange::Kind kind, PoolState const & pool)
+		{
+			PoolStateChange c;
+			c.kind = kind;
+			c.poolGUID = pool.guid;
+			c.poolName = pool.name;
+			return c;
+		}
+
+		void diffVDevs(PoolState const & pool,
+			std::vector<VDevState> const & before, std::vector<uint32_t> const & beforeOrder,
+			std::vector<VDevState> const & after, std::vector<uint32_t> const & afterOrder,
+			std::vector<PoolStateChange> & changes)
+		{
+			auto guid = [](VDevState const & v) { return v.guid; };
+			mergeBy(before, beforeOrder, after, afterOrder, guid, [&](VDevState const * b, VDevState const * a)
+			{
+				if (!a)
+					return;
+				VDevStatus const & old = b ? b->stat : VDevStatus();
+				if (b && b->stat.state != a->stat.state)
+				{
+					auto c = makeChange(PoolStateChange::Kind::vdevStateChanged, pool);
+					c.vdevGUID = a->guid;
+					c.objectName = a->name;
+					c.oldValue = b->stat.state;
+					c.newValue = a->stat.state;
+					changes.push_back(std::move(c));
+				}
+				if (containsMoreErrors(old, a->stat))
+				{
+					auto c = makeChange(PoolStateChange::Kind::vdevErrorsIncreased, pool);
+					c.vdevGUID = a->guid;
+					c.objectName = a->name;
+					c.errorRead = increase(old.errorRead, a->stat.errorRead);
+					c.errorWrite = increase(old.errorWrite, a->stat.errorWrite);
+					c.errorChecksum = increase(old.errorChecksum, a->stat.errorChecksum);
+					changes.push_back(std::move(c));
+				}
+			});
+		}
+
+		void diffScan(PoolState const & before, PoolState const & after,
+			std::vector<PoolStateChange> & changes)
+		{
+			auto const & b = before.scan;
+			auto const & a = after.scan;
+			if (b.state != a.state || b.scanStartTime != a.scanStartTime)
+			{
+				auto c = makeChange(PoolStateChange::Kind::scanStateChanged, after);
+				c.oldValue = b.state;
+				c.newValue = a.state;
+				changes.push_back(std::move(c));
+			}
+			else if (a.state == ScanStatus::scanning && b.issued != a.issued)
+			{
+				auto c = makeChange(PoolStateChange::Kind::scanProgressed, after);
+				c.oldValue = b.issued;
+				c.newValue = a.issued;
+				changes.push_back(std::move(c));
+			}
+		}
+
+		void diffFileSystems(PoolState const & before, PoolState const & after,
+			std::vector<PoolStateChange> & changes)
+		{
+			auto name = [](FileSystemState const & fs) -> std::string const & { return fs.name; };
+			mergeBy(before.fileSystems, before.fileSystemsByName, after.fileSystems, after.fileSystemsByName, name,
+				[&](FileSystemState const * b, FileSystemState const * a)
+			{
+				if (!a || !b)
+					return;
+				if (b->mounted != a->mounted)
+				{
+					auto c = makeChange(a->mounted ?
+						PoolStateChange::Kind::fileSystemMounted :
+						PoolStateChange::Kind::fileSystemUnmounted, after);
+					c.objectName = a->name;
+					changes.push_back(std::move(c));
+				}
+				if (a->isEncryptionRoot && b->keyStatus != a->keyStatus)
+				{
+					if (a->keyStatus == FileSystemState::KeyStatus::available ||
+						b->keyStatus == FileSystemState::KeyStatus::available)
+					{
+						auto c = makeChange(a->keyStatus == FileSystemState::KeyStatus::available ?
+							PoolStateChange::Kind::keyLoaded :
+							PoolStateChange::Kind::keyUnloaded, after);
+						c.objectName = a->name;
+						changes.push_back(std::move(c));
+					}
+				}
+			});
+		}
+	}
+
+	bool containsMoreErrors(VDevStatus const & a, VDevStatus const & b)
+	{
+		return b.errorRead > a.errorRead
+			|| b.errorWrite > a.errorWrite
+			|| b.errorChecksum > a.errorChecksum;
+	}
+
+	std::vector<PoolStateChange> diffSystemState(SystemState const & before, SystemState const & after)
+	{
+		std::vector<PoolStateChange> changes;
+		auto guid = [](PoolState const & p) { return p.guid; };
+		mergeBy(before.pools, before.poolsByGUID, after.pools, after.poolsByGUID, guid, [&](PoolState const * b, PoolState const * a)
+		{
+			if (!a)
+			{
+				changes.push_back(makeChange(PoolStateChange::Kind::poolRemoved, *b));
+				return;
+			}
+			if (!b)
+			{
+				changes.push_back(makeChange(PoolStateChange::Kind::poolAdded, *a));
+				diffVDevs(*a, {}, {}, a->vdevs, a->vdevsByGUID, changes);
+				diffVDevs(*a, {}, {}, a->caches, a->cachesByGUID, changes);
+				return;
+			}
+			diffVDevs(*a, b->vdevs, b->vdevsByGUID, a->vdevs, a->vdevsByGUID, changes);
+			diffVDevs(*a, b->caches, b->cachesByGUID, a->caches, a->cachesByGUID, changes);
+			diffScan(*b, *a, changes);
+			diffFileSystems(*b, *a, changes);
+		});
+		return changes;
+	}
+}
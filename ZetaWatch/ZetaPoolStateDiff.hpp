@@ -0,0 +1,72 @@
+//
+//  ZetaPoolStateDiff.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolStateDiff_hpp
+#define ZetaPoolStateDiff_hpp
+
+#include "ZetaPoolState.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace zeta
+{
+	//! A single difference between two successive system states
+	struct PoolStateChange
+	{
+		enum class Kind
+		{
+			poolAdded,
+			poolRemoved,
+			vdevStateChanged,    //!< oldValue / newValue are vdev_state_t
+			vdevErrorsIncreased, //!< error* contain the increase
+			scanStateChanged,    //!< oldValue / newValue are ScanStatus::State
+			scanProgressed,      //!< oldValue / newValue are issued bytes
+			fileSystemMounted,
+			fileSystemUnmounted,
+			keyLoaded,
+			keyUnloaded,
+			vdevLatencyDiverged, //!< oldValue / newValue are sibling and vdev p99 in ns
+			capacityRunningOut,  //!< oldValue is bytes per day, newValue days until full
+		};
+
+		Kind kind;
+		uint64_t poolGUID = 0;
+		std::string poolName;
+		uint64_t vdevGUID = 0;   //!< Only for vdev changes
+		std::string objectName;  //!< The vdev or dataset name, if any
+		uint64_t oldValue = 0;
+		uint64_t newValue = 0;
+		uint64_t errorRead = 0;
+		uint64_t errorWrite = 0;
+		uint64_t errorChecksum = 0;
+	};
+
+	/*!
+	 Compares two system states and returns what changed between them. Pools,
+	 vdevs and datasets are matched by GUID or name, independent of the order
+	 in which libzfs returned them.
+
+	 Vdevs of newly added pools are compared against zero error counters, so
+	 that errors that are already present are reported once. Datasets of added
+	 or removed pools do not generate events of their own.
+
+	 The cost is linear in the number of pools, vdevs and datasets in both
+	 states, not in the number of changes. Every refresh reads all of them
+	 again, and libzfs offers no cheaper sign that a pool is unchanged. Each
+	 list is walked once along the key orders stored with the states, with
+	 no sorting or allocation beyond the returned changes.
+	 */
+	std::vector<PoolStateChange> diffSystemState(SystemState const & before, SystemState const & after);
+
+	//! Returns true if b has more read, write or checksum errors than a
+	bool containsMoreErrors(VDevStatus const & a, VDevStatus const & b);
+}
+
+#endif /* ZetaPoolStateDiff_hpp */
@@ -0,0 +1,364 @@
+//
+//  ZetaPoolStateLoader.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaVDevDecoder.hpp"
+
+#include <atomic>
+#include <cstring>
+
+namespace zeta
+{
+	static std::atomic<uint64_t> propertyReads(0);
+
+	uint64_t propertyReadCount()
+	{
+		return propertyReads.load(std::memory_order_relaxed);
+	}
+
+	void countPropertyReads(uint64_t count)
+	{
+		propertyReads.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	static ScanStatus toScanStatus(zfs::ScanStat const & stat)
+	{
+		ScanStatus s;
+		switch (stat.state)
+		{
+			case zfs::ScanStat::stateNone: s.state = ScanStatus::stateNone; break;
+			case zfs::ScanStat::scanning: s.state = ScanStatus::scanning; break;
+			case zfs::ScanStat::finished: s.state = ScanStatus::finished; break;
+			case zfs::ScanStat::canceled: s.state = ScanStatus::canceled; break;
+		}
+		s.scanStartTime = stat.scanStartTime;
+		s.scanEndTime = stat.scanEndTime;
+		s.passStartTime = stat.passStartTime;
+		s.passPauseTime = stat.passPauseTime;
+		s.passPausedSeconds = stat.passPausedSeconds;
+		s.total = stat.total;
+		s.scanned = stat.scanned;
+		s.issued = stat.issued;
+		s.passScanned = stat.passScanned;
+		s.passIssued = stat.passIssued;
+		s.errors = stat.errors;
+		return s;
+	}
+
+	//! Appends the device and all its descendants in depth first order
+	static void walkVDevs(zfs::ZPool const & pool, nvlist_t * device,
+		uint32_t parent, uint32_t depth, std::vector<VDevState> & vdevs)
+	{
+		auto f = decodeVDev(device);
+		auto index = uint32_t(vdevs.size());
+		vdevs.emplace_back();
+		auto & v = vdevs.back();
+		v.guid = f.guid;
+		// A non-owning view, libzfs formats the name from the whole vdev
+		zfs::NVList list(device);
+		v.name = pool.vdevName(list);
+		v.device = pool.vdevDevice(list);
+		v.type = f.type ? f.type : "";
+		v.parent = parent;
+		v.depth = depth;
+		v.stat = decodeVDevStatus(f);
+		for (uint_t c = 0; c < f.childCount; ++c)
+			walkVDevs(pool, f.children[c], index, depth + 1, vdevs);
+	}
+
+	static void walkVDevs(zfs::ZPool const & pool, std::vector<zfs::NVList> const & devices,
+		std::vector<VDevState> & vdevs)
+	{
+		for (auto const & device : devices)
+			walkVDevs(pool, device.toList(), noVDev, 0, vdevs);
+	}
+
+	std::vector<VDevIOSample> loadVDevIOSamples(zfs::LibZFSHandle & zfs)
+	{
+		std::vector<VDevIOSample> samples;
+		for (auto && pool : zfs.pools())
+		{
+			for (auto const & device : pool.vdevs())
+				appendVDevIOSamples(device.toList(), samples);
+			for (auto const & device : pool.caches())
+				appendVDevIOSamples(device.toList(), samples);
+		}
+		return samples;
+	}
+
+	static FileSystemState::Type toType(zfs::ZFileSystem::FSType type)
+	{
+		switch (type)
+		{
+			case zfs::ZFileSystem::FSType::filesystem: return FileSystemState::Type::filesystem;
+			case zfs::ZFileSystem::FSType::volume: return FileSystemState::Type::volume;
+			case zfs::ZFileSystem::FSType::snapshot: return FileSystemState::Type::snapshot;
+			case zfs::ZFileSystem::FSType::bookmark: return FileSystemState::Type::bookmark;
+			default: return FileSystemState::Type::other;
+		}
+	}
+
+	LibZFSPropertyBackend::LibZFSPropertyBackend(std::vector<zfs::ZFileSystem const *> fileSystems) :
+		m_fileSystems(std::move(fileSystems))
+	{
+	}
+
+	size_t LibZFSPropertyBackend::datasetCount() const
+	{
+		return m_fileSystems.size();
+	}
+
+	//! Reads the requested properties that are in the dataset's property list
+	static void readPropertyList(zfs::ZFileSystem const & fs, PropertyTable & table, size_t dataset)
+	{
+		nvlist_t * props = zfs_get_all_props(fs.handle());
+		if (!props)
+			return;
+		for (nvpair_t * pair = nvlist_next_nvpair(props, nullptr); pair;
+			pair = nvlist_next_nvpair(props, pair))
+		{
+			DatasetProperty property;
+			if (!propertyFromListName(nvpair_name(pair), property) || !table.contains(property))
+				continue;
+			nvlist_t * entry = nullptr;
+			if (nvpair_type(pair) != DATA_TYPE_NVLIST || nvpair_value_nvlist(pair, &entry) != 0)
+				continue;
+			if (property == DatasetProperty::encryptionRoot)
+			{
+				char * root = nullptr;
+				if (nvlist_lookup_string(entry, ZPROP_VALUE, &root) == 0)
+					table.setListValue(property, dataset, std::strcmp(root, fs.name()) == 0);
+			}
+			else
+			{
+				uint64_t value = 0;
+				if (nvlist_lookup_uint64(entry, ZPROP_VALUE, &value) == 0)
+					table.setListValue(property, dataset, value);
+			}
+		}
+	}
+
+	void LibZFSPropertyBackend::fetch(PropertyTable & table) const
+	{
+		bool needsPropertyList = false;
+		size_t computedCount = 0;
+		for (auto property : table.properties())
+		{
+			if (inPropertyList(property))
+				needsPropertyList = true;
+			else
+				++computedCount;
+		}
+		auto mounted = table.contains(DatasetProperty::mounted) ?
+			table.numericColumn(DatasetProperty::mounted) : nullptr;
+		auto mountable = table.contains(DatasetProperty::mountable) ?
+			table.numericColumn(DatasetProperty::mountable) : nullptr;
+		auto mountpoint = table.contains(DatasetProperty::mountpoint) ?
+			table.stringColumn(DatasetProperty::mountpoint) : nullptr;
+		// Properties absent from the list keep their zero default, which is
+		// what libzfs reports for them as well, for example the key status
+		// of an unencrypted dataset
+		for (size_t i = 0; i < m_fileSystems.size(); ++i)
+		{
+			auto const & fs = *m_fileSystems[i];
+			if (needsPropertyList)
+				readPropertyList(fs, table, i);
+			if (mounted)
+				mounted[i] = fs.mounted();
+			if (mountable)
+				mountable[i] = fs.mountable();
+			if (mountpoint)
+				mountpoint[i] = fs.mountpoint();
+		}
+		countPropertyReads((computedCount + needsPropertyList) * m_fileSystems.size());
+	}
+
+	static std::vector<DatasetProperty> const summaryProperties =
+	{
+		DatasetProperty::mounted,
+		DatasetProperty::encryptionRoot,
+		DatasetProperty::keyStatus,
+	};
+
+	static std::vector<DatasetProperty> const capacityProperties =
+	{
+		DatasetProperty::used,
+		DatasetProperty::available,
+	};
+
+	static std::vector<DatasetProperty> const detailProperties =
+	{
+		DatasetProperty::mountable,
+		DatasetProperty::available,
+		DatasetProperty::used,
+		DatasetProperty::referenced,
+		DatasetProperty::logicalused,
+		DatasetProperty::compressRatio,
+		DatasetProperty::mountpoint,
+	};
+
+	static DatasetKind toDatasetKind(FileSystemState::Type type)
+	{
+		switch (type)
+		{
+			case FileSystemState::Type::volume: return DatasetKind::volume;
+			case FileSystemState::Type::snapshot: return DatasetKind::snapshot;
+			case FileSystemState::Type::bookmark: return DatasetKind::bookmark;
+			default: return DatasetKind::filesystem;
+		}
+	}
+
+	static std::vector<FileSystemState> toFileSystemStates(std::vector<zfs::ZFileSystem> const & fileSystems,
+		DatasetTree & datasets)
+	{
+		// Only what the pool menu shows for each dataset
+		std::vector<zfs::ZFileSystem const *> fsPointers;
+		fsPointers.reserve(fileSystems.size());
+		for (auto const & fs : fileSystems)
+			fsPointers.push_back(&fs);
+		auto table = fetchProperties(LibZFSPropertyBackend(std::move(fsPointers)), summaryProperties);
+		std::vector<FileSystemState> states(fileSystems.size());
+		for (size_t i = 0; i < fileSystems.size(); ++i)
+		{
+			auto & f = states[i];
+			f.name = fileSystems[i].name();
+			f.type = toType(fileSystems[i].type());
+			f.index = datasets.insert(f.name, toDatasetKind(f.type));
+			f.isRoot = datasets.parent(f.index) == noDataset;
+			f.mounted = table.numeric(DatasetProperty::mounted, i) != 0;
+			f.isEncryptionRoot = table.numeric(DatasetProperty::encryptionRoot, i) != 0;
+			f.keyStatus = FileSystemState::KeyStatus(table.numeric(DatasetProperty::keyStatus, i));
+		}
+		return states;
+	}
+
+	//! Reads the space of the capacity candidates, or of all datasets if they are chosen again
+	static void readCapacity(std::string const & poolName, std::vector<zfs::ZFileSystem> const & fileSystems,
+		std::vector<FileSystemState> & states, CapacityCandidates & candidates)
+	{
+		auto now = std::time(nullptr);
+		bool fullRead = candidates.needsFullRead(poolName, now);
+		std::vector<size_t> selected;
+		std::vector<zfs::ZFileSystem const *> fsPointers;
+		for (size_t i = 0; i < states.size(); ++i)
+		{
+			auto const & f = states[i];
+			if (f.type != FileSystemState::Type::filesystem && f.type != FileSystemState::Type::volume)
+				continue;
+			if (fullRead || candidates.contains(poolName, f.name))
+			{
+				selected.push_back(i);
+				fsPointers.push_back(&fileSystems[i]);
+			}
+		}
+		auto table = fetchProperties(LibZFSPropertyBackend(std::move(fsPointers)), capacityProperties);
+		for (size_t j = 0; j < selected.size(); ++j)
+		{
+			auto & f = states[selected[j]];
+			f.hasSpace = true;
+			f.used = table.numeric(DatasetProperty::used, j);
+			f.available = table.numeric(DatasetProperty::available, j);
+		}
+		if (!fullRead)
+			return;
+		// The others were only read to choose from
+		candidates.choose(poolName, states, now);
+		for (auto i : selected)
+		{
+			auto & f = states[i];
+			if (!candidates.contains(poolName, f.name))
+			{
+				f.hasSpace = false;
+				f.used = 0;
+				f.available = 0;
+			}
+		}
+	}
+
+	FileSystemDetails loadFileSystemDetails(zfs::ZFileSystem const & fs)
+	{
+		auto table = fetchProperties(LibZFSPropertyBackend({&fs}), detailProperties);
+		FileSystemDetails d;
+		d.mountable = table.numeric(DatasetProperty::mountable, 0) != 0;
+		d.available = table.numeric(DatasetProperty::available, 0);
+		d.used = table.numeric(DatasetProperty::used, 0);
+		d.referenced = table.numeric(DatasetProperty::referenced, 0);
+		d.logicalused = table.numeric(DatasetProperty::logicalused, 0);
+		d.compressRatio = table.real(DatasetProperty::compressRatio, 0);
+		d.mountpoint = table.string(DatasetProperty::mountpoint, 0);
+		return d;
+	}
+
+	DependencyGraph loadDependencyGraph(zfs::LibZFSHandle & zfs, std::string_view datasetName)
+	{
+		auto fileSystems = zfs.pool(std::string(poolName(datasetName))).allFileSystems();
+		DependencyGraph graph;
+		addFileSystems(graph, fileSystems, [](zfs::ZFileSystem const & snap)
+		{
+			return zfs_prop_get_int(snap.handle(), ZFS_PROP_CREATETXG);
+		});
+		countPropertyReads(fileSystems.size());
+		return graph;
+	}
+
+	PoolState loadPoolState(zfs::ZPool const & pool, CapacityCandidates * candidates)
+	{
+		PoolState p;
+		p.name = pool.name();
+		p.guid = pool.guid();
+		p.status = pool.status();
+		try
+		{
+			p.scan = toScanStatus(pool.scanStat());
+			walkVDevs(pool, pool.vdevs(), p.vdevs);
+			walkVDevs(pool, pool.caches(), p.caches);
+			p.vdevsByGUID = sortedByGUID(p.vdevs);
+			p.cachesByGUID = sortedByGUID(p.caches);
+			auto fileSystems = pool.allFileSystems();
+			p.fileSystems = toFileSystemStates(fileSystems, p.datasets);
+			if (candidates)
+				readCapacity(p.name, fileSystems, p.fileSystems, *candidates);
+			p.fileSystemsByName = sortedByName(p.fileSystems);
+		}
+		catch (std::exception const & e)
+		{
+			p.error = e.what();
+		}
+		return p;
+	}
+
+	SystemState loadSystemState(zfs::LibZFSHandle & zfs)
+	{
+		return loadSystemState(zfs, std::function<void(PoolState const &)>());
+	}
+
+	SystemState loadSystemState(zfs::LibZFSHandle & zfs,
+		std::function<void(PoolState const &)> const & poolLoaded, CapacityCandidates * candidates)
+	{
+		SystemState state;
+		state.refreshTime = std::chrono::system_clock::now();
+		try
+		{
+			for (auto && pool : zfs.pools())
+			{
+				state.pools.push_back(loadPoolState(pool, candidates));
+				if (poolLoaded)
+					poolLoaded(state.pools.back());
+			}
+		}
+		catch (std::exception const & e)
+		{
+			state.error = e.what();
+		}
+		state.poolsByGUID = sortedByGUID(state.pools);
+		// Exported pools
+		if (candidates)
+			candidates->forget(std::time(nullptr) - 24 * 60 * 60);
+		return state;
+	}
+}
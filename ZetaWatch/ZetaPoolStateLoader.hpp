@@ -0,0 +1,74 @@
+//
+//  ZetaPoolStateLoader.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolStateLoader_hpp
+#define ZetaPoolStateLoader_hpp
+
+#include "ZetaPoolState.hpp"
+#include "ZetaPropertyTable.hpp"
+#include "ZetaDependencyGraph.hpp"
+#include "ZetaVDevIOSampler.hpp"
+#include "ZetaCapacityForecast.hpp"
+
+#include "ZFSUtils.hpp"
+
+#include <functional>
+
+namespace zeta
+{
+	/*!
+	 Reads the state of all imported pools, their vdevs and their datasets in
+	 one pass. Errors while reading a single pool are stored in that pool,
+	 errors while iterating the pools in the returned state.
+	 */
+	SystemState loadSystemState(zfs::LibZFSHandle & zfs);
+
+	/*!
+	 Calls poolLoaded after each pool has been read. If candidates is given,
+	 the used and available space of its datasets is read as well, and of
+	 all datasets of the pools whose candidates are chosen again.
+	 */
+	SystemState loadSystemState(zfs::LibZFSHandle & zfs,
+		std::function<void(PoolState const &)> const & poolLoaded,
+		CapacityCandidates * candidates = nullptr);
+
+	/*!
+	 \brief Reads dataset properties from libzfs, one dataset after the other
+
+	 All requested properties libzfs keeps in a dataset's property list are
+	 read in a single pass over that list, instead of one lookup each. Only
+	 mounted, mountable and mountpoint are computed through their accessors.
+	 */
+	class LibZFSPropertyBackend : public PropertyBackend
+	{
+	public:
+		explicit LibZFSPropertyBackend(std::vector<zfs::ZFileSystem const *> fileSystems);
+
+	public:
+		size_t datasetCount() const override;
+		void fetch(PropertyTable & table) const override;
+
+	private:
+		std::vector<zfs::ZFileSystem const *> m_fileSystems;
+	};
+
+	PoolState loadPoolState(zfs::ZPool const & pool, CapacityCandidates * candidates = nullptr);
+	FileSystemDetails loadFileSystemDetails(zfs::ZFileSystem const & fs);
+
+	//! Reads only the I/O counters of all vdevs and caches of all pools
+	std::vector<VDevIOSample> loadVDevIOSamples(zfs::LibZFSHandle & zfs);
+
+	//! Reads the dependency graph of the pool containing the named dataset
+	DependencyGraph loadDependencyGraph(zfs::LibZFSHandle & zfs, std::string_view datasetName);
+
+	//! Number of pool and dataset properties read through libzfs since launch
+	uint64_t propertyReadCount();
+	void countPropertyReads(uint64_t count);
+}
+
+#endif /* ZetaPoolStateLoader_hpp */
@@ -0,0 +1,110 @@
+//
+//  ZetaPoolStateRefresher.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPoolStateRefresher.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	PoolStateRefresher::PoolStateRefresher(Loader loader, Callback published) :
+		m_loader(std::move(loader)), m_published(std::move(published)),
+		m_state(std::make_shared<SystemState>())
+	{
+		m_worker = std::thread([this]{ run(); });
+	}
+
+	PoolStateRefresher::~PoolStateRefresher()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_requestCondition.notify_all();
+		m_completeCondition.notify_all();
+		m_worker.join();
+	}
+
+	void PoolStateRefresher::requestRefresh()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_requested;
+		}
+		m_requestCondition.notify_one();
+	}
+
+	bool PoolStateRefresher::waitForRefresh(std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto target = m_requested;
+		return m_completeCondition.wait_for(lock, timeout, [&]
+		{
+			return m_stop || m_completed >= target;
+		});
+	}
+
+	bool PoolStateRefresher::isRefreshing() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_completed < m_requested;
+	}
+
+	std::shared_ptr<SystemState const> PoolStateRefresher::state() const
+	{
+		return std::atomic_load(&m_state);
+	}
+
+	std::chrono::system_clock::duration PoolStateRefresher::age() const
+	{
+		return std::chrono::system_clock::now() - state()->refreshTime;
+	}
+
+	void PoolStateRefresher::publish(std::shared_ptr<SystemState const> state, bool complete)
+	{
+		std::atomic_store(&m_state, state);
+		if (m_published)
+			m_published(state, complete);
+	}
+
+	void PoolStateRefresher::run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_requestCondition.wait(lock, [&]{ return m_stop || m_completed < m_requested; });
+			if (m_stop)
+				return;
+			auto generation = m_requested;
+			lock.unlock();
+			// The intermediate state starts out as the previous one with all
+			// pools marked as stale, and gets updated one pool at a time
+			SystemState partial = *state();
+			for (auto & pool : partial.pools)
+				pool.stale = true;
+			auto poolLoaded = [&](PoolState const & pool)
+			{
+				auto it = std::find_if(partial.pools.begin(), partial.pools.end(),
+					[&](PoolState const & p) { return p.guid == pool.guid; });
+				if (it != partial.pools.end())
+					*it = pool;
+				else
+				{
+					partial.pools.push_back(pool);
+					partial.poolsByGUID = sortedByGUID(partial.pools);
+				}
+				publish(std::make_shared<SystemState const>(partial), false);
+			};
+			auto next = std::make_shared<SystemState const>(m_loader(poolLoaded));
+			publish(std::move(next), true);
+			lock.lock();
+			m_completed = generation;
+			m_completeCondition.notify_all();
+		}
+	}
+}
@@ -0,0 +1,82 @@
+//
+//  ZetaPoolStateRefresher.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPoolStateRefresher_hpp
+#define ZetaPoolStateRefresher_hpp
+
+#include "ZetaPoolState.hpp"
+
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+namespace zeta
+{
+	/*!
+	 \brief Keeps a system state current from a dedicated worker thread
+
+	 Refreshes run on the worker thread, so that slow or hanging pools never
+	 block the caller. The current state is an immutable snapshot that is
+	 replaced as a whole, readers can keep using a snapshot they obtained while
+	 newer ones are published.
+
+	 While a refresh is in progress, an intermediate snapshot is published
+	 after each pool has been read. Pools of the previous snapshot that were
+	 not read yet are marked as stale.
+	 */
+	class PoolStateRefresher
+	{
+	public:
+		typedef std::function<void(PoolState const &)> PoolCallback;
+		//! Reads the system state, calling the callback after each pool
+		typedef std::function<SystemState(PoolCallback const &)> Loader;
+		/*!
+		 Called on the worker thread with every published snapshot. By the
+		 time a callback dispatched elsewhere runs, state() might already be
+		 a partial snapshot of the next refresh, so use the one passed in.
+		 */
+		typedef std::function<void(std::shared_ptr<SystemState const> const & state, bool complete)> Callback;
+
+	public:
+		PoolStateRefresher(Loader loader, Callback published);
+		~PoolStateRefresher();
+
+	public:
+		//! Schedules a refresh, requests during a refresh cause one more pass
+		void requestRefresh();
+		//! Waits until all requested refreshes completed, returns false on timeout
+		bool waitForRefresh(std::chrono::milliseconds timeout);
+		bool isRefreshing() const;
+
+	public:
+		std::shared_ptr<SystemState const> state() const;
+		//! Time since the current snapshot was completely refreshed
+		std::chrono::system_clock::duration age() const;
+
+	private:
+		void run();
+		void publish(std::shared_ptr<SystemState const> state, bool complete);
+
+	private:
+		Loader m_loader;
+		Callback m_published;
+		std::shared_ptr<SystemState const> m_state;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_requestCondition;
+		std::condition_variable m_completeCondition;
+		uint64_t m_requested = 0;
+		uint64_t m_completed = 0;
+		bool m_stop = false;
+		std::thread m_worker;
+	};
+}
+
+#endif /* ZetaPoolStateRefresher_hpp */
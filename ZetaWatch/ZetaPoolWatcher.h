@@ -12,16 +12,24 @@
 
 #import <Cocoa/Cocoa.h>
 
-#include "ZFSUtils.hpp"
+#include "ZetaPoolStateDiff.hpp"
+#include "ZetaVDevIOSampler.hpp"
+#include "ZetaScrubTracker.hpp"
+#include "ZetaCapacityForecast.hpp"
+#include "ZetaMetricsStore.hpp"
 
 #include <string>
+#include <vector>
+#include <memory>
 
 @protocol ZetaPoolWatcherDelegate <NSObject>
 
 @optional
-- (void)newPoolDetected:(zfs::ZPool const &)pool;
+- (void)newPoolDetected:(zeta::PoolState const &)pool;
 - (void)errorDetectedInPool:(std::string const &)pool;
 - (void)errorDetected:(std::string const &)error;
+- (void)poolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes;
+- (void)poolStateRefreshed;
 
 @end
 
@@ -31,6 +39,30 @@
 
 - (void)checkForChanges;
 
+//! Requests a refresh and waits at most timeout for it, returns true if it finished
+- (bool)refreshWithTimeout:(NSTimeInterval)timeout;
+
+//! The most recent state, possibly with stale pools while refreshing
+@property (readonly, nonatomic) std::shared_ptr<zeta::SystemState const> state;
+@property (readonly, nonatomic) bool isRefreshing;
+
+//! I/O counter increase of the vdev with the given guid over the last minute
+- (zeta::VDevIORates)ioRatesForVDev:(uint64_t)guid;
+
+//! Smoothed rates and remaining time of the scrub of the pool with the given guid
+- (zeta::ScrubEstimate)scrubEstimateForPool:(uint64_t)guid;
+
+//! Growth of the used space of a pool or dataset, fitted over the refreshes
+- (zeta::CapacityForecast)capacityForecastForPool:(std::string const &)name;
+- (zeta::CapacityForecast)capacityForecastForDataset:(std::string const &)name;
+
+//! Recorded values of a pool or vdev metric in [begin, end), empty if recording is disabled
+- (std::vector<zeta::MetricPoint>)metricHistory:(uint64_t)guid metric:(zeta::Metric)metric
+										   from:(std::time_t)begin to:(std::time_t)end;
+
+//! First recorded alloc of the vdev on the day a week ago, as of the last refresh, time is 0 if there is none
+- (zeta::MetricPoint)weekAgoAllocForVDev:(uint64_t)guid;
+
 - (void)keepAwake;
 - (void)stopKeepingAwake;
 
@@ -14,18 +14,42 @@
 
 #import <IOKit/pwr_mgt/IOPMLib.h>
 
-#include <map>
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaPoolStateRefresher.hpp"
+#include "ZetaLatencyHistogram.hpp"
+#include "ZetaMetricsStore.hpp"
+#include "ZetaFormatHelpers.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 
 CFStringRef powerAssertionName = CFSTR("ZFSScrub");
 CFStringRef powerAssertionReason = CFSTR("ZFS Scrub in progress");
 
+static NSString * const vdevSampleIntervalKey = @"vdevStatisticsInterval";
+static size_t const vdevSampleCapacity = 60;
+static NSString * const metricsRetentionKey = @"metricsRetentionDays";
+static std::time_t const metricsCompactionAge = 7 * 24 * 60 * 60;
+static NSString * const capacityWarningKey = @"capacityWarningDays";
+static size_t const capacityWarningDatasets = 5;
+static size_t const capacityCandidateDatasets = 32;
+
 @interface ZetaPoolWatcher ()
 {
 	// ZFS
-	std::vector<uint64_t> _knownPools;
-
-	// Statistics
-	std::map<uint64_t,zfs::VDevStat> _errorStats;
+	std::unique_ptr<zeta::PoolStateRefresher> _refresher;
+	std::shared_ptr<zeta::SystemState const> _checkedState;
+	std::unique_ptr<zeta::VDevIOSampler> _ioSampler;
+	std::unordered_set<uint64_t> _slowVDevs;
+	zeta::ScrubTracker _scrubTracker;
+	std::unique_ptr<zeta::MetricsStore> _metrics;
+	std::time_t _metricsMaintained;
+	std::unordered_map<uint64_t, zeta::MetricPoint> _weekAgoAlloc;
+	std::time_t _weekAgoRead;
+	zeta::CapacityForecaster _poolCapacity;
+	zeta::CapacityForecaster _datasetCapacity;
+	std::unordered_set<std::string> _fillingUp;
 
 	// Sleep Prevention
 	IOPMAssertionID assertionID;
@@ -37,13 +61,6 @@ CFStringRef powerAssertionReason = CFSTR("ZFS Scrub in progress");
 
 @end
 
-bool containsMoreErrors(zfs::VDevStat const & a, zfs::VDevStat const & b)
-{
-	return b.errorRead > a.errorRead
-		|| b.errorWrite > a.errorWrite
-		|| b.errorChecksum > a.errorChecksum;
-}
-
 @implementation ZetaPoolWatcher
 
 - (id)init
@@ -55,17 +72,92 @@ bool containsMoreErrors(zfs::VDevStat const & a, zfs::VDevStat const & b)
 		_autoUpdateTimer.tolerance = 8;
 		[[NSRunLoop currentRunLoop] addTimer:_autoUpdateTimer forMode:NSDefaultRunLoopMode];
 		delegates = [[NSMutableArray alloc] init];
+		ZetaPoolWatcher __weak * weakSelf = self;
+		// Only used by the refresher's worker thread
+		auto candidates = std::make_shared<zeta::CapacityCandidates>(capacityCandidateDatasets);
+		_refresher = std::make_unique<zeta::PoolStateRefresher>(
+			[candidates](zeta::PoolStateRefresher::PoolCallback const & poolLoaded)
+			{
+				zeta::SystemState state;
+				try
+				{
+					// A fresh handle for each refresh, so pools imported or
+					// exported since the last one are always seen
+					zfs::LibZFSHandle zfs;
+					state = zeta::loadSystemState(zfs, poolLoaded, candidates.get());
+				}
+				catch (std::exception const & e)
+				{
+					state.error = e.what();
+				}
+				return state;
+			},
+			[weakSelf](std::shared_ptr<zeta::SystemState const> const & state, bool complete)
+			{
+				dispatch_async(dispatch_get_main_queue(), ^{
+					[weakSelf stateRefreshed:state complete:complete];
+				});
+			});
+		_checkedState = _refresher->state();
+		// One handle for all samples, the pool iteration refreshes the stats
+		auto sampleHandle = std::make_shared<std::unique_ptr<zfs::LibZFSHandle>>();
+		_ioSampler = std::make_unique<zeta::VDevIOSampler>(
+			[sampleHandle]
+			{
+				try
+				{
+					if (!*sampleHandle)
+						*sampleHandle = std::make_unique<zfs::LibZFSHandle>();
+					return zeta::loadVDevIOSamples(**sampleHandle);
+				}
+				catch (std::exception const &)
+				{
+					sampleHandle->reset();
+					return std::vector<zeta::VDevIOSample>();
+				}
+			},
+			[self sampleInterval], vdevSampleCapacity);
+		[[NSUserDefaults standardUserDefaults] addObserver:self forKeyPath:vdevSampleIntervalKey
+												   options:0 context:nullptr];
 	}
 	return self;
 }
 
 - (void)dealloc
 {
+	[[NSUserDefaults standardUserDefaults] removeObserver:self forKeyPath:vdevSampleIntervalKey];
 	[_autoUpdateTimer invalidate];
 	_autoUpdateTimer = nil;
 	[self stopKeepingAwake];
 }
 
+- (std::chrono::milliseconds)sampleInterval
+{
+	// Defaults might not be registered yet when this object is loaded
+	auto sd = [NSUserDefaults standardUserDefaults];
+	double interval = [sd objectForKey:vdevSampleIntervalKey] ? [sd doubleForKey:vdevSampleIntervalKey] : 5;
+	return std::chrono::milliseconds(int64_t(interval * 1000));
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+					  ofObject:(id)object
+						change:(NSDictionary<NSKeyValueChangeKey, id> *)change
+					   context:(void *)context
+{
+	if ([keyPath isEqualToString:vdevSampleIntervalKey])
+		_ioSampler->setInterval([self sampleInterval]);
+}
+
+- (zeta::VDevIORates)ioRatesForVDev:(uint64_t)guid
+{
+	return _ioSampler->rates(guid, std::chrono::seconds(60));
+}
+
+- (zeta::ScrubEstimate)scrubEstimateForPool:(uint64_t)guid
+{
+	return _scrubTracker.estimate(guid);
+}
+
 - (void)timedUpdate:(NSTimer*)timer
 {
 	[self checkForChanges];
@@ -73,70 +165,330 @@ bool containsMoreErrors(zfs::VDevStat const & a, zfs::VDevStat const & b)
 
 - (void)checkForChanges
 {
+	_refresher->requestRefresh();
+}
+
+- (bool)refreshWithTimeout:(NSTimeInterval)timeout
+{
+	_refresher->requestRefresh();
+	auto ms = std::chrono::milliseconds(int64_t(timeout * 1000));
+	return _refresher->waitForRefresh(ms);
+}
+
+- (std::shared_ptr<zeta::SystemState const>)state
+{
+	return _refresher->state();
+}
+
+- (bool)isRefreshing
+{
+	return _refresher->isRefreshing();
+}
+
+- (void)stateRefreshed:(std::shared_ptr<zeta::SystemState const>)state complete:(bool)complete
+{
+	// The completed snapshot, state() might already be a partial one of the next refresh
+	if (complete)
+		[self checkState:std::move(state)];
+	[self notifyPoolStateRefreshed];
+}
+
+- (void)checkState:(std::shared_ptr<zeta::SystemState const>)state
+{
+	if (!state->error.empty())
+	{
+		[self notifyError:state->error];
+		return;
+	}
+	if (state == _checkedState)
+		return;
+	auto changes = zeta::diffSystemState(*_checkedState, *state);
+	[self logFinishedScrubs:changes];
+	_scrubTracker.record(*state, time(0));
+	_checkedState = std::move(state);
+	[self recordMetrics];
+	[self appendLatencyOutliers:changes];
+	[self appendCapacityForecasts:changes];
+	[self handleChanges:changes];
+	auto scrubCounter = [self countScrubsInProgress];
+	auto sd = [NSUserDefaults standardUserDefaults];
+	if (scrubCounter > 0 && [sd boolForKey:@"keepAwakeDuringScrub"])
+		[self keepAwake];
+	else
+		[self stopKeepingAwake];
+}
+
+- (void)logFinishedScrubs:(std::vector<zeta::PoolStateChange> const &)changes
+{
+	for (auto const & change : changes)
+	{
+		if (change.kind != zeta::PoolStateChange::Kind::scanStateChanged ||
+			change.oldValue != zeta::ScanStatus::scanning)
+			continue;
+		auto history = _scrubTracker.history(change.poolGUID);
+		if (history.empty())
+			continue;
+		auto slowest = history.front().issueRate;
+		auto fastest = history.front().issueRate;
+		for (auto const & rate : history)
+		{
+			slowest = std::min(slowest, rate.issueRate);
+			fastest = std::max(fastest, rate.issueRate);
+		}
+		NSLog(@"Scrub of %s ended, issued %s to %s, %s at the end",
+			change.poolName.c_str(), formatRate(slowest).c_str(),
+			formatRate(fastest).c_str(), formatRate(history.back().issueRate).c_str());
+	}
+}
+
+- (zeta::MetricsStore *)metricsStore
+{
+	if (!_metrics)
+	{
+		NSFileManager * fm = [NSFileManager defaultManager];
+		NSURL * support = [fm URLForDirectory:NSApplicationSupportDirectory inDomain:NSUserDomainMask
+							appropriateForURL:nil create:YES error:nil];
+		NSURL * directory = [support URLByAppendingPathComponent:@"ZetaWatch/Metrics" isDirectory:YES];
+		NSError * error;
+		if (![fm createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:&error])
+		{
+			NSLog(@"Error creating metrics directory: %@", error);
+			return nullptr;
+		}
+		_metrics = std::make_unique<zeta::MetricsStore>(directory.fileSystemRepresentation);
+	}
+	return _metrics.get();
+}
+
+- (std::vector<zeta::MetricPoint>)metricHistory:(uint64_t)guid metric:(zeta::Metric)metric
+										   from:(std::time_t)begin to:(std::time_t)end
+{
+	if ([[NSUserDefaults standardUserDefaults] integerForKey:metricsRetentionKey] <= 0)
+		return {};
 	try
 	{
-		zfs::LibZFSHandle zfs;
-		auto p = zfs.pools();
-		[self checkForNewPools:p];
-		[self checkForNewErrors:p];
-		auto scrubCounter = [self countScrubsInProgress:p];
-		auto sd = [NSUserDefaults standardUserDefaults];
-		if (scrubCounter > 0 && [sd boolForKey:@"keepAwakeDuringScrub"])
-			[self keepAwake];
-		else
-			[self stopKeepingAwake];
+		if (auto store = [self metricsStore])
+			return store->read(guid, metric, begin, end);
 	}
 	catch (std::exception const & e)
 	{
-		[self notifyError:e.what()];
+		NSLog(@"Error reading metrics: %s", e.what());
 	}
+	return {};
 }
 
-- (bool)checkDev:(zfs::NVList const &)dev
+- (void)recordMetrics
 {
-	auto guid = vdevGUID(dev);
-	auto newStat = vdevStat(dev);
-	auto & oldStat = _errorStats[guid];
-	bool error = containsMoreErrors(oldStat, newStat);
-	oldStat = newStat;
-	return error;
+	auto retentionDays = [[NSUserDefaults standardUserDefaults] integerForKey:metricsRetentionKey];
+	if (retentionDays <= 0)
+	{
+		_metrics.reset();
+		_weekAgoAlloc.clear();
+		return;
+	}
+	std::vector<zeta::MetricSample> samples;
+	auto add = [&](uint64_t guid, zeta::Metric metric, uint64_t value)
+	{
+		samples.push_back(zeta::MetricSample{guid, metric, value});
+	};
+	auto addVDev = [&](zeta::VDevState const & vdev)
+	{
+		add(vdev.guid, zeta::Metric::alloc, vdev.stat.alloc);
+		add(vdev.guid, zeta::Metric::space, vdev.stat.space);
+		add(vdev.guid, zeta::Metric::fragmentation, vdev.stat.fragmentation);
+		add(vdev.guid, zeta::Metric::errorRead, vdev.stat.errorRead);
+		add(vdev.guid, zeta::Metric::errorWrite, vdev.stat.errorWrite);
+		add(vdev.guid, zeta::Metric::errorChecksum, vdev.stat.errorChecksum);
+	};
+	for (auto const & pool : _checkedState->pools)
+	{
+		for (auto const & vdev : pool.vdevs)
+			addVDev(vdev);
+		for (auto const & cache : pool.caches)
+			addVDev(cache);
+		auto scrub = _scrubTracker.estimate(pool.guid);
+		if (scrub.valid && !scrub.paused)
+			add(pool.guid, zeta::Metric::scrubIssueRate, uint64_t(scrub.rate.issueRate));
+	}
+	auto now = time(0);
+	try
+	{
+		auto store = [self metricsStore];
+		if (!store)
+			return;
+		store->append(now, samples);
+		// Old days are thinned out and deleted once a day
+		if (now - _metricsMaintained >= 24 * 60 * 60)
+		{
+			store->expire(now - retentionDays * 24 * 60 * 60);
+			store->compact(now - metricsCompactionAge, std::chrono::hours(1));
+			_metricsMaintained = now;
+		}
+		// Read for the menu here, not while it opens. Records of a week ago
+		// are compacted to one per hour, so rereading them hourly is enough
+		if (now - _weekAgoRead >= 60 * 60)
+		{
+			_weekAgoAlloc.clear();
+			_weekAgoRead = now;
+		}
+		for (auto const & sample : samples)
+		{
+			if (sample.metric != zeta::Metric::alloc || _weekAgoAlloc.count(sample.guid))
+				continue;
+			auto weekAgo = store->read(sample.guid, zeta::Metric::alloc,
+				now - 7 * 24 * 60 * 60, now - 6 * 24 * 60 * 60);
+			_weekAgoAlloc[sample.guid] = weekAgo.empty() ? zeta::MetricPoint() : weekAgo.front();
+		}
+	}
+	catch (std::exception const & e)
+	{
+		NSLog(@"Error recording metrics: %s", e.what());
+		_metrics.reset();
+		_weekAgoAlloc.clear();
+	}
 }
 
-- (bool)checkForNewErrors:(std::vector<zfs::ZPool> const &)pools
+- (zeta::MetricPoint)weekAgoAllocForVDev:(uint64_t)guid
 {
-	try
+	auto it = _weekAgoAlloc.find(guid);
+	return it != _weekAgoAlloc.end() ? it->second : zeta::MetricPoint();
+}
+
+- (void)appendLatencyOutliers:(std::vector<zeta::PoolStateChange> &)changes
+{
+	// Only vdevs that were not slow at the previous check are reported
+	std::unordered_set<uint64_t> slowVDevs;
+	auto latency = [&](uint64_t guid)
 	{
-		for (auto && pool: pools)
+		return _ioSampler->rates(guid, std::chrono::seconds(60)).latency;
+	};
+	for (auto const & pool : _checkedState->pools)
+	{
+		for (auto & outlier : zeta::findLatencyOutliers(pool, latency))
 		{
-			auto vdevs = pool.vdevs();
-			for (auto && vdev: vdevs)
-			{
-				if ([self checkDev:vdev])
-				{
-					[self notifyErrorInPool:pool.name()];
-					return true;
-				}
+			slowVDevs.insert(outlier.vdevGUID);
+			if (_slowVDevs.count(outlier.vdevGUID) == 0)
+				changes.push_back(std::move(outlier));
+		}
+	}
+	_slowVDevs = std::move(slowVDevs);
+}
 
-				auto devices = zfs::vdevChildren(vdev);
-				for (auto && device: devices)
-				{
-					if ([self checkDev:device])
-					{
-						[self notifyErrorInPool:pool.name()];
-						return true;
-					}
-				}
+- (void)appendCapacityForecasts:(std::vector<zeta::PoolStateChange> &)changes
+{
+	auto now = time(0);
+	auto warningDays = [[NSUserDefaults standardUserDefaults] integerForKey:capacityWarningKey];
+	auto fillingUp = [&](zeta::CapacityForecast const & f)
+	{
+		return f.valid && f.bytesPerDay > 0 && f.daysUntilFull < warningDays;
+	};
+	auto makeChange = [&](zeta::PoolState const & pool, std::string const & name,
+		zeta::CapacityForecast const & f)
+	{
+		zeta::PoolStateChange c;
+		c.kind = zeta::PoolStateChange::Kind::capacityRunningOut;
+		c.poolGUID = pool.guid;
+		c.poolName = pool.name;
+		c.objectName = name;
+		c.oldValue = uint64_t(f.bytesPerDay);
+		c.newValue = uint64_t(f.daysUntilFull);
+		return c;
+	};
+	std::unordered_set<std::string> filling;
+	for (auto const & pool : _checkedState->pools)
+	{
+		uint64_t alloc = 0;
+		uint64_t space = 0;
+		for (auto const & vdev : pool.vdevs)
+		{
+			if (vdev.depth == 0)
+			{
+				alloc += vdev.stat.alloc;
+				space += vdev.stat.space;
 			}
 		}
+		_poolCapacity.record(pool.name, now, alloc, space > alloc ? space - alloc : 0);
+		auto poolForecast = _poolCapacity.forecast(pool.name);
+		if (fillingUp(poolForecast))
+		{
+			filling.insert(pool.name);
+			if (_fillingUp.count(pool.name) == 0)
+				changes.push_back(makeChange(pool, pool.name, poolForecast));
+		}
+		// Only the candidates chosen by the loader have their space read,
+		// and only the first few that fill up before the pool are reported
+		std::vector<std::pair<double, std::string const *>> datasets;
+		for (auto const & fs : pool.fileSystems)
+		{
+			if (!fs.hasSpace)
+				continue;
+			_datasetCapacity.record(fs.name, now, fs.used, fs.available);
+			auto f = _datasetCapacity.forecast(fs.name);
+			if (fillingUp(f) && (!fillingUp(poolForecast) || f.daysUntilFull < poolForecast.daysUntilFull))
+				datasets.emplace_back(f.daysUntilFull, &fs.name);
+		}
+		std::sort(datasets.begin(), datasets.end());
+		datasets.resize(std::min(datasets.size(), capacityWarningDatasets));
+		for (auto const & d : datasets)
+		{
+			filling.insert(*d.second);
+			if (_fillingUp.count(*d.second) == 0)
+				changes.push_back(makeChange(pool, *d.second, _datasetCapacity.forecast(*d.second)));
+		}
 	}
-	catch (std::exception const & e)
+	_fillingUp = std::move(filling);
+	// Pools and datasets that disappeared
+	_poolCapacity.forget(now - 24 * 60 * 60);
+	_datasetCapacity.forget(now - 24 * 60 * 60);
+}
+
+- (zeta::CapacityForecast)capacityForecastForPool:(std::string const &)name
+{
+	return _poolCapacity.forecast(name);
+}
+
+- (zeta::CapacityForecast)capacityForecastForDataset:(std::string const &)name
+{
+	return _datasetCapacity.forecast(name);
+}
+
+- (void)handleChanges:(std::vector<zeta::PoolStateChange> const &)changes
+{
+	if (changes.empty())
+		return;
+	uint64_t lastErrorPool = 0;
+	for (auto const & change : changes)
+	{
+		switch (change.kind)
+		{
+			case zeta::PoolStateChange::Kind::poolAdded:
+				if (auto pool = [self poolWithGUID:change.poolGUID])
+					[self notifyNewPoolDetected:*pool];
+				break;
+			case zeta::PoolStateChange::Kind::vdevErrorsIncreased:
+				// Changes are grouped by pool, notify only once per pool
+				if (change.poolGUID != lastErrorPool)
+					[self notifyErrorInPool:change.poolName];
+				lastErrorPool = change.poolGUID;
+				break;
+			default:
+				break;
+		}
+	}
+	[self notifyPoolStateChanged:changes];
+}
+
+- (zeta::PoolState const *)poolWithGUID:(uint64_t)guid
+{
+	for (auto const & pool : _checkedState->pools)
 	{
-		[self notifyError:e.what()];
+		if (pool.guid == guid)
+			return &pool;
 	}
-	return false;
+	return nullptr;
 }
 
-- (void)notifyNewPoolDetected:(zfs::ZPool const &)pool
+- (void)notifyNewPoolDetected:(zeta::PoolState const &)pool
 {
 	for (id<ZetaPoolWatcherDelegate> d in [self delegates])
 	{
@@ -169,48 +521,35 @@ bool containsMoreErrors(zfs::VDevStat const & a, zfs::VDevStat const & b)
 	}
 }
 
-std::vector<uint64_t> poolsToGUID(std::vector<zfs::ZPool> const & pools)
-{
-	std::vector<uint64_t> guids(pools.size());
-	std::transform(pools.begin(), pools.end(), guids.begin(),
-				   [](auto const & pool) { return pool.guid(); });
-	std::sort(guids.begin(), guids.end());
-	return guids;
-}
-
-- (void)checkForNewPools:(std::vector<zfs::ZPool> const &)pools
+- (void)notifyPoolStateChanged:(std::vector<zeta::PoolStateChange> const &)changes
 {
-	for (auto const & p : pools)
+	for (id<ZetaPoolWatcherDelegate> d in [self delegates])
 	{
-		if (std::binary_search(_knownPools.begin(), _knownPools.end(), p.guid()))
-		{
-			// Already known pool
-		}
-		else
+		if ([d respondsToSelector:@selector(poolStateChanged:)])
 		{
-			// New pool
-			[self notifyNewPoolDetected:p];
+			[d poolStateChanged:changes];
 		}
 	}
-	_knownPools = poolsToGUID(pools);
 }
 
-- (uint64_t)countScrubsInProgress:(std::vector<zfs::ZPool> const &)pools
+- (void)notifyPoolStateRefreshed
 {
-	uint64_t scrubsInProgress = 0;
-	try
+	for (id<ZetaPoolWatcherDelegate> d in [self delegates])
 	{
-		for (auto && pool: pools)
+		if ([d respondsToSelector:@selector(poolStateRefreshed)])
 		{
-			auto vdevs = pool.vdevs();
-			auto scan = pool.scanStat();
-			if (scan.state == zfs::ScanStat::scanning)
-				++scrubsInProgress;
+			[d poolStateRefreshed];
 		}
 	}
-	catch (std::exception const & e)
+}
+
+- (uint64_t)countScrubsInProgress
+{
+	uint64_t scrubsInProgress = 0;
+	for (auto const & pool : _checkedState->pools)
 	{
-		[self notifyError:e.what()];
+		if (pool.scan.state == zeta::ScanStatus::scanning)
+			++scrubsInProgress;
 	}
 	return scrubsInProgress;
 }
@@ -0,0 +1,158 @@
+//
+//  ZetaPropertyTable.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaPropertyTable.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace zeta
+{
+	static constexpr size_t noColumn = size_t(-1);
+
+	PropertyKind propertyKind(DatasetProperty property)
+	{
+		switch (property)
+		{
+			case DatasetProperty::compressRatio:
+				return PropertyKind::real;
+			case DatasetProperty::mountpoint:
+				return PropertyKind::string;
+			default:
+				return PropertyKind::numeric;
+		}
+	}
+
+	bool inPropertyList(DatasetProperty property)
+	{
+		switch (property)
+		{
+			case DatasetProperty::mounted:
+			case DatasetProperty::mountable:
+			case DatasetProperty::mountpoint:
+				return false;
+			default:
+				return true;
+		}
+	}
+
+	bool propertyFromListName(std::string_view name, DatasetProperty & property)
+	{
+		// Called for every entry of every dataset's property list, most of
+		// which are not ours, so one character decides before any comparison
+		if (name.empty())
+			return false;
+		std::string_view expected;
+		switch (name[0])
+		{
+			case 'a': expected = "available"; property = DatasetProperty::available; break;
+			case 'c': expected = "compressratio"; property = DatasetProperty::compressRatio; break;
+			case 'e': expected = "encryptionroot"; property = DatasetProperty::encryptionRoot; break;
+			case 'k': expected = "keystatus"; property = DatasetProperty::keyStatus; break;
+			case 'l': expected = "logicalused"; property = DatasetProperty::logicalused; break;
+			case 'r': expected = "referenced"; property = DatasetProperty::referenced; break;
+			case 'u': expected = "used"; property = DatasetProperty::used; break;
+			default: return false;
+		}
+		return name == expected;
+	}
+
+	PropertyTable::PropertyTable(std::vector<DatasetProperty> properties, size_t datasetCount) :
+		m_properties(std::move(properties)), m_datasetCount(datasetCount)
+	{
+		std::sort(m_properties.begin(), m_properties.end());
+		m_properties.erase(std::unique(m_properties.begin(), m_properties.end()), m_properties.end());
+		m_column.fill(noColumn);
+		size_t numericCount = 0, realCount = 0, stringCount = 0;
+		for (auto property : m_properties)
+		{
+			switch (propertyKind(property))
+			{
+				case PropertyKind::numeric:
+					m_column[size_t(property)] = numericCount++ * datasetCount;
+					break;
+				case PropertyKind::real:
+					m_column[size_t(property)] = realCount++ * datasetCount;
+					break;
+				case PropertyKind::string:
+					m_column[size_t(property)] = stringCount++ * datasetCount;
+					break;
+			}
+		}
+		m_numeric.resize(numericCount * datasetCount);
+		m_real.resize(realCount * datasetCount);
+		m_strings.resize(stringCount * datasetCount);
+	}
+
+	bool PropertyTable::contains(DatasetProperty property) const
+	{
+		return m_column[size_t(property)] != noColumn;
+	}
+
+	size_t PropertyTable::columnOffset(DatasetProperty property, PropertyKind kind) const
+	{
+		auto offset = m_column[size_t(property)];
+		if (offset == noColumn || propertyKind(property) != kind)
+			throw std::logic_error("Property was not fetched as requested type");
+		return offset;
+	}
+
+	uint64_t PropertyTable::numeric(DatasetProperty property, size_t dataset) const
+	{
+		return m_numeric[columnOffset(property, PropertyKind::numeric) + dataset];
+	}
+
+	double PropertyTable::real(DatasetProperty property, size_t dataset) const
+	{
+		return m_real[columnOffset(property, PropertyKind::real) + dataset];
+	}
+
+	std::string const & PropertyTable::string(DatasetProperty property, size_t dataset) const
+	{
+		return m_strings[columnOffset(property, PropertyKind::string) + dataset];
+	}
+
+	uint64_t * PropertyTable::numericColumn(DatasetProperty property)
+	{
+		return m_numeric.data() + columnOffset(property, PropertyKind::numeric);
+	}
+
+	double * PropertyTable::realColumn(DatasetProperty property)
+	{
+		return m_real.data() + columnOffset(property, PropertyKind::real);
+	}
+
+	std::string * PropertyTable::stringColumn(DatasetProperty property)
+	{
+		return m_strings.data() + columnOffset(property, PropertyKind::string);
+	}
+
+	void PropertyTable::setListValue(DatasetProperty property, size_t dataset, uint64_t value)
+	{
+		switch (propertyKind(property))
+		{
+			case PropertyKind::numeric:
+				numericColumn(property)[dataset] = value;
+				break;
+			case PropertyKind::real:
+				// The only ratio, compressratio, is stored in hundredths
+				realColumn(property)[dataset] = double(value) / 100;
+				break;
+			case PropertyKind::string:
+				throw std::logic_error("String properties have no list value");
+		}
+	}
+
+	PropertyTable fetchProperties(PropertyBackend const & backend,
+		std::vector<DatasetProperty> properties)
+	{
+		PropertyTable table(std::move(properties), backend.datasetCount());
+		backend.fetch(table);
+		return table;
+	}
+}
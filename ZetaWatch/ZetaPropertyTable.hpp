@@ -0,0 +1,123 @@
+//
+//  ZetaPropertyTable.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaPropertyTable_hpp
+#define ZetaPropertyTable_hpp
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace zeta
+{
+	//! Dataset properties that can be fetched in a batch
+	enum class DatasetProperty : uint8_t
+	{
+		mounted,
+		mountable,
+		encryptionRoot, //!< Non-zero if the dataset is its own encryption root
+		keyStatus,      //!< FileSystemState::KeyStatus
+		available,
+		used,
+		referenced,
+		logicalused,
+		compressRatio,
+		mountpoint,
+	};
+
+	constexpr size_t datasetPropertyCount = size_t(DatasetProperty::mountpoint) + 1;
+
+	enum class PropertyKind
+	{
+		numeric,
+		real,
+		string,
+	};
+
+	PropertyKind propertyKind(DatasetProperty property);
+
+	/*!
+	 \brief Properties libzfs keeps in the property list of a dataset handle
+
+	 These arrive with the dataset's stats and can be read in one pass over
+	 that list. The others, mounted, mountable and the effective mountpoint,
+	 are computed by libzfs and need their own call.
+	 */
+	bool inPropertyList(DatasetProperty property);
+
+	//! The property stored under the given name in a dataset's property list
+	bool propertyFromListName(std::string_view name, DatasetProperty & property);
+
+	/*!
+	 \brief Columnar storage of properties for a list of datasets
+
+	 Each requested property is stored in one contiguous column with one
+	 entry per dataset, in the order of the dataset list it was fetched for.
+	 Numeric properties such as sizes, flags and enums are stored as uint64_t,
+	 ratios as double and mount points as strings.
+	 */
+	class PropertyTable
+	{
+	public:
+		PropertyTable(std::vector<DatasetProperty> properties, size_t datasetCount);
+
+	public:
+		size_t datasetCount() const { return m_datasetCount; }
+		std::vector<DatasetProperty> const & properties() const { return m_properties; }
+		bool contains(DatasetProperty property) const;
+
+	public:
+		uint64_t numeric(DatasetProperty property, size_t dataset) const;
+		double real(DatasetProperty property, size_t dataset) const;
+		std::string const & string(DatasetProperty property, size_t dataset) const;
+
+	public:
+		//! Columns for the backend to fill, datasetCount() entries each
+		uint64_t * numericColumn(DatasetProperty property);
+		double * realColumn(DatasetProperty property);
+		std::string * stringColumn(DatasetProperty property);
+
+		//! Stores a value as it appears in a dataset's property list
+		void setListValue(DatasetProperty property, size_t dataset, uint64_t value);
+
+	private:
+		size_t columnOffset(DatasetProperty property, PropertyKind kind) const;
+
+	private:
+		std::vector<DatasetProperty> m_properties;
+		size_t m_datasetCount;
+		std::array<size_t, datasetPropertyCount> m_column;
+		std::vector<uint64_t> m_numeric;
+		std::vector<double> m_real;
+		std::vector<std::string> m_strings;
+	};
+
+	/*!
+	 \brief Source of dataset properties for PropertyTable
+
+	 Implementations fill all requested columns for their datasets in a single
+	 call, instead of being asked for each property of each dataset separately.
+	 */
+	class PropertyBackend
+	{
+	public:
+		virtual ~PropertyBackend() = default;
+
+	public:
+		virtual size_t datasetCount() const = 0;
+		virtual void fetch(PropertyTable & table) const = 0;
+	};
+
+	//! Fetches the given properties for all datasets of the backend
+	PropertyTable fetchProperties(PropertyBackend const & backend,
+		std::vector<DatasetProperty> properties);
+}
+
+#endif /* ZetaPropertyTable_hpp */
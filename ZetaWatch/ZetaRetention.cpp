@@ -0,0 +1,204 @@
+//
+//  ZetaRetention.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaRetention.hpp"
+
+#include <limits>
+#include <cstdio>
+
+namespace zeta
+{
+	namespace
+	{
+		constexpr int64_t hourSeconds = 3600;
+		constexpr int64_t daySeconds = 86400;
+		//! 1970-01-01 was a thursday
+		constexpr int64_t mondayOffset = 3;
+
+		constexpr RetentionPeriod periods[] = {
+			RetentionPeriod::hour, RetentionPeriod::day, RetentionPeriod::week, RetentionPeriod::month,
+		};
+
+		char const autoSnapshotPrefix[] = "ZetaAuto-";
+
+		int64_t floorDiv(int64_t a, int64_t b)
+		{
+			return a / b - (a % b != 0 && (a < 0) != (b < 0) ? 1 : 0);
+		}
+
+		// Conversion between days since the epoch and the proleptic gregorian calendar
+		int64_t daysFromCivil(int64_t y, int64_t m, int64_t d)
+		{
+			y -= m <= 2 ? 1 : 0;
+			int64_t era = floorDiv(y, 400);
+			int64_t yoe = y - era * 400;
+			int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+			int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + doe - 719468;
+		}
+
+		void civilFromDays(int64_t z, int64_t & y, int64_t & m, int64_t & d)
+		{
+			z += 719468;
+			int64_t era = floorDiv(z, 146097);
+			int64_t doe = z - era * 146097;
+			int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+			int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+			int64_t mp = (5 * doy + 2) / 153;
+			d = doy - (153 * mp + 2) / 5 + 1;
+			m = mp < 10 ? mp + 3 : mp - 9;
+			y = yoe + era * 400 + (m <= 2 ? 1 : 0);
+		}
+
+		bool readNumber(std::string_view s, size_t & pos, size_t digits, int64_t & value)
+		{
+			if (pos + digits > s.size())
+				return false;
+			value = 0;
+			for (size_t end = pos + digits; pos < end; ++pos)
+			{
+				if (s[pos] < '0' || s[pos] > '9')
+					return false;
+				value = value * 10 + (s[pos] - '0');
+			}
+			return true;
+		}
+	}
+
+	uint32_t RetentionPolicy::keep(RetentionPeriod period) const
+	{
+		switch (period)
+		{
+			case RetentionPeriod::hour: return hourly;
+			case RetentionPeriod::day: return daily;
+			case RetentionPeriod::week: return weekly;
+			case RetentionPeriod::month: return monthly;
+		}
+		return 0;
+	}
+
+	bool RetentionPolicy::empty() const
+	{
+		return hourly == 0 && daily == 0 && weekly == 0 && monthly == 0;
+	}
+
+	int64_t periodIndex(RetentionPeriod period, int64_t time, int64_t utcOffset)
+	{
+		int64_t local = time + utcOffset;
+		switch (period)
+		{
+			case RetentionPeriod::hour:
+				return floorDiv(local, hourSeconds);
+			case RetentionPeriod::day:
+				return floorDiv(local, daySeconds);
+			case RetentionPeriod::week:
+				return floorDiv(floorDiv(local, daySeconds) + mondayOffset, 7);
+			case RetentionPeriod::month:
+			{
+				int64_t y, m, d;
+				civilFromDays(floorDiv(local, daySeconds), y, m, d);
+				return y * 12 + m - 1;
+			}
+		}
+		return 0;
+	}
+
+	int64_t periodStart(RetentionPeriod period, int64_t index, int64_t utcOffset)
+	{
+		switch (period)
+		{
+			case RetentionPeriod::hour:
+				return index * hourSeconds - utcOffset;
+			case RetentionPeriod::day:
+				return index * daySeconds - utcOffset;
+			case RetentionPeriod::week:
+				return (index * 7 - mondayOffset) * daySeconds - utcOffset;
+			case RetentionPeriod::month:
+				return daysFromCivil(floorDiv(index, 12), index - floorDiv(index, 12) * 12 + 1, 1) *
+					daySeconds - utcOffset;
+		}
+		return 0;
+	}
+
+	std::vector<size_t> planPruning(std::vector<int64_t> const & times,
+		RetentionPolicy const & policy, int64_t utcOffset)
+	{
+		if (policy.empty())
+			return {};
+		std::vector<bool> keep(times.size(), false);
+		for (auto period : periods)
+		{
+			uint32_t remaining = policy.keep(period);
+			int64_t lastIndex = std::numeric_limits<int64_t>::max();
+			for (size_t i = times.size(); i > 0 && remaining > 0; --i)
+			{
+				int64_t index = periodIndex(period, times[i-1], utcOffset);
+				if (index != lastIndex)
+				{
+					keep[i-1] = true;
+					lastIndex = index;
+					--remaining;
+				}
+			}
+		}
+		std::vector<size_t> prune;
+		for (size_t i = 0; i < times.size(); ++i)
+		{
+			if (!keep[i])
+				prune.push_back(i);
+		}
+		return prune;
+	}
+
+	int64_t nextSnapshotTime(int64_t newest, bool hasNewest, RetentionPolicy const & policy,
+		int64_t utcOffset)
+	{
+		if (!hasNewest)
+			return std::numeric_limits<int64_t>::min();
+		for (auto period : periods)
+		{
+			if (policy.keep(period) > 0)
+				return periodStart(period, periodIndex(period, newest, utcOffset) + 1, utcOffset);
+		}
+		return std::numeric_limits<int64_t>::max();
+	}
+
+	std::string autoSnapshotName(int64_t time)
+	{
+		int64_t y, m, d;
+		civilFromDays(floorDiv(time, daySeconds), y, m, d);
+		int64_t seconds = time - floorDiv(time, daySeconds) * daySeconds;
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%s%04lld-%02lld-%02lld-%02lld-%02lld-%02lld",
+			autoSnapshotPrefix, (long long)y, (long long)m, (long long)d,
+			(long long)(seconds / 3600), (long long)(seconds / 60 % 60), (long long)(seconds % 60));
+		return buffer;
+	}
+
+	bool parseAutoSnapshotName(std::string_view shortName, int64_t & time)
+	{
+		std::string_view prefix(autoSnapshotPrefix);
+		if (shortName.substr(0, prefix.size()) != prefix)
+			return false;
+		size_t pos = prefix.size();
+		int64_t fields[6];
+		size_t const digits[6] = {4, 2, 2, 2, 2, 2};
+		for (size_t f = 0; f < 6; ++f)
+		{
+			if (f > 0 && (pos >= shortName.size() || shortName[pos++] != '-'))
+				return false;
+			if (!readNumber(shortName, pos, digits[f], fields[f]))
+				return false;
+		}
+		if (pos != shortName.size() || fields[1] < 1 || fields[1] > 12 || fields[2] < 1 || fields[2] > 31)
+			return false;
+		time = daysFromCivil(fields[0], fields[1], fields[2]) * daySeconds +
+			fields[3] * 3600 + fields[4] * 60 + fields[5];
+		return true;
+	}
+}
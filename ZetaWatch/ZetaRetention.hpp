@@ -0,0 +1,72 @@
+//
+//  ZetaRetention.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaRetention_hpp
+#define ZetaRetention_hpp
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace zeta
+{
+	enum class RetentionPeriod
+	{
+		hour,
+		day,
+		week, //!< starting on monday
+		month,
+	};
+
+	//! How many snapshots to keep, the newest of each of the most recent periods
+	struct RetentionPolicy
+	{
+		uint32_t hourly = 0;
+		uint32_t daily = 0;
+		uint32_t weekly = 0;
+		uint32_t monthly = 0;
+
+		uint32_t keep(RetentionPeriod period) const;
+		//! Policies that keep nothing are ignored, instead of destroying all snapshots
+		bool empty() const;
+	};
+
+	//! The number of the period containing time, shifted by utcOffset into local time
+	int64_t periodIndex(RetentionPeriod period, int64_t time, int64_t utcOffset);
+	//! The first second of a period returned by periodIndex
+	int64_t periodStart(RetentionPeriod period, int64_t index, int64_t utcOffset);
+
+	/*!
+	 Returns the indices of the snapshots that the policy does not keep, in
+	 ascending order. times are the creation times of the snapshots in
+	 ascending order. For every period, the newest snapshot of each of the
+	 most recent periods that have one is kept. Linear in the number of
+	 snapshots.
+	 */
+	std::vector<size_t> planPruning(std::vector<int64_t> const & times,
+		RetentionPolicy const & policy, int64_t utcOffset);
+
+	/*!
+	 When the next snapshot is due, given the time of the newest one. That is
+	 the start of the next of the shortest period the policy keeps. Snapshots
+	 are due immediately if there is none yet.
+	 */
+	int64_t nextSnapshotTime(int64_t newest, bool hasNewest, RetentionPolicy const & policy,
+		int64_t utcOffset);
+
+	/*!
+	 Snapshots created by the retention engine are named with a fixed prefix
+	 and their creation time in UTC. Only those are ever pruned.
+	 */
+	std::string autoSnapshotName(int64_t time);
+	//! Returns false for names that autoSnapshotName doesn't create
+	bool parseAutoSnapshotName(std::string_view shortName, int64_t & time);
+}
+
+#endif /* ZetaRetention_hpp */
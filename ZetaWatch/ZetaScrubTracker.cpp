@@ -0,0 +1,149 @@
+//
+//  ZetaScrubTracker.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaScrubTracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace zeta
+{
+	namespace
+	{
+		//! Seconds the current pass was not paused, up to now or the current pause
+		std::time_t activeSeconds(ScanStatus const & scan, std::time_t now)
+		{
+			std::time_t end = scan.passPauseTime != 0 ? std::time_t(scan.passPauseTime) : now;
+			std::time_t active = end - std::time_t(scan.passStartTime) - std::time_t(scan.passPausedSeconds);
+			return std::max<std::time_t>(active, 0);
+		}
+
+		double increase(uint64_t older, uint64_t newer)
+		{
+			return newer > older ? double(newer - older) : 0.0;
+		}
+
+		double secondsRemaining(uint64_t done, uint64_t total, double rate)
+		{
+			return done < total && rate > 0 ? (total - done) / rate : 0.0;
+		}
+
+		void updateRemaining(ScrubEstimate & estimate, ScanStatus const & scan)
+		{
+			// Issuing can not finish before scanning has found all blocks
+			estimate.paused = scan.passPauseTime != 0;
+			estimate.valid = estimate.rate.issueRate > 0;
+			double remaining = std::max(
+				secondsRemaining(scan.scanned, scan.total, estimate.rate.scanRate),
+				secondsRemaining(scan.issued, scan.total, estimate.rate.issueRate));
+			estimate.remaining = std::chrono::seconds(int64_t(remaining));
+		}
+	}
+
+	ScrubEstimate passAverage(ScanStatus const & scan, std::time_t now)
+	{
+		ScrubEstimate estimate;
+		estimate.rate.time = now;
+		if (auto active = activeSeconds(scan, now))
+		{
+			estimate.rate.scanRate = double(scan.passScanned) / active;
+			estimate.rate.issueRate = double(scan.passIssued) / active;
+		}
+		updateRemaining(estimate, scan);
+		return estimate;
+	}
+
+	ScrubTracker::ScrubTracker(std::chrono::seconds timeConstant, size_t historyCapacity) :
+		m_timeConstant(std::max<double>(timeConstant.count(), 1)),
+		m_historyCapacity(std::max<size_t>(historyCapacity, 1))
+	{
+	}
+
+	void ScrubTracker::record(SystemState const & state, std::time_t now)
+	{
+		std::unordered_map<uint64_t, Tracked> pools;
+		for (auto const & pool : state.pools)
+		{
+			if (pool.scan.state != ScanStatus::scanning)
+				continue;
+			auto it = m_pools.find(pool.guid);
+			Tracked tracked;
+			if (it != m_pools.end() && it->second.scanStartTime == pool.scan.scanStartTime)
+				tracked = std::move(it->second);
+			update(tracked, pool.scan, now);
+			pools.emplace(pool.guid, std::move(tracked));
+		}
+		m_pools = std::move(pools);
+	}
+
+	void ScrubTracker::update(Tracked & tracked, ScanStatus const & scan, std::time_t now) const
+	{
+		auto active = activeSeconds(scan, now);
+		auto & rate = tracked.estimate.rate;
+		bool changed = false;
+		if (tracked.scanStartTime != scan.scanStartTime)
+		{
+			// First sample of this scrub, start from the average of the pass
+			tracked.scanStartTime = scan.scanStartTime;
+			tracked.estimate = passAverage(scan, now);
+			changed = active > 0;
+		}
+		else if (tracked.passStartTime == scan.passStartTime && active > tracked.lastActive)
+		{
+			double elapsed = active - tracked.lastActive;
+			double alpha = 1 - std::exp(-elapsed / m_timeConstant);
+			rate.scanRate += alpha * (increase(tracked.lastScanned, scan.scanned) / elapsed - rate.scanRate);
+			rate.issueRate += alpha * (increase(tracked.lastIssued, scan.issued) / elapsed - rate.issueRate);
+			changed = true;
+		}
+		// A new pass after a resume or an import restarts the active time,
+		// the counters are only rebased and the rates kept
+		tracked.passStartTime = scan.passStartTime;
+		tracked.lastActive = active;
+		tracked.lastScanned = scan.scanned;
+		tracked.lastIssued = scan.issued;
+		rate.time = now;
+		updateRemaining(tracked.estimate, scan);
+		if (changed)
+			append(tracked);
+	}
+
+	void ScrubTracker::append(Tracked & tracked) const
+	{
+		if (tracked.history.size() < m_historyCapacity)
+		{
+			tracked.history.push_back(tracked.estimate.rate);
+		}
+		else
+		{
+			tracked.history[tracked.historyNext] = tracked.estimate.rate;
+			tracked.historyNext = (tracked.historyNext + 1) % m_historyCapacity;
+		}
+	}
+
+	ScrubEstimate ScrubTracker::estimate(uint64_t poolGUID) const
+	{
+		auto it = m_pools.find(poolGUID);
+		if (it == m_pools.end())
+			return ScrubEstimate();
+		return it->second.estimate;
+	}
+
+	std::vector<ScrubRate> ScrubTracker::history(uint64_t poolGUID) const
+	{
+		auto it = m_pools.find(poolGUID);
+		if (it == m_pools.end())
+			return {};
+		auto const & tracked = it->second;
+		std::vector<ScrubRate> history;
+		history.reserve(tracked.history.size());
+		history.insert(history.end(), tracked.history.begin() + tracked.historyNext, tracked.history.end());
+		history.insert(history.end(), tracked.history.begin(), tracked.history.begin() + tracked.historyNext);
+		return history;
+	}
+}
@@ -0,0 +1,87 @@
+//
+//  ZetaScrubTracker.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaScrubTracker_hpp
+#define ZetaScrubTracker_hpp
+
+#include "ZetaPoolState.hpp"
+
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+namespace zeta
+{
+	//! Smoothed scan and issue rates of a scrub at one point in time
+	struct ScrubRate
+	{
+		std::time_t time = 0;
+		double scanRate = 0;  //!< Bytes per second
+		double issueRate = 0; //!< Bytes per second
+	};
+
+	struct ScrubEstimate
+	{
+		ScrubRate rate;
+		bool paused = false;
+		bool valid = false; //!< False until some bytes were issued
+		std::chrono::seconds remaining{0};
+	};
+
+	//! Estimate from the averages of the current pass, without history
+	ScrubEstimate passAverage(ScanStatus const & scan, std::time_t now);
+
+	/*!
+	 \brief History of the scan state of all pools with a scrub in progress
+
+	 Rates are exponentially smoothed over the time the scrub was active, so
+	 that the estimate follows the current phase of the scrub instead of the
+	 average since the start of the pass. Paused time is excluded using the
+	 pause time and paused seconds of the pass, and a new pass only rebases
+	 the counters. Pools without a scrub in progress are forgotten.
+	 */
+	class ScrubTracker
+	{
+	public:
+		//! timeConstant is the time in which a rate change is reflected to 63%
+		explicit ScrubTracker(std::chrono::seconds timeConstant = std::chrono::minutes(10),
+			size_t historyCapacity = 128);
+
+		//! Records the scan state of all pools, sampled at now
+		void record(SystemState const & state, std::time_t now);
+		//! The current estimate of the scrub of the given pool
+		ScrubEstimate estimate(uint64_t poolGUID) const;
+		//! Smoothed rates recorded for the current scrub of the given pool, oldest first
+		std::vector<ScrubRate> history(uint64_t poolGUID) const;
+
+	private:
+		struct Tracked
+		{
+			uint64_t scanStartTime = 0;
+			uint64_t passStartTime = 0;
+			std::time_t lastActive = 0; //!< Active seconds of the pass at the last sample
+			uint64_t lastScanned = 0;
+			uint64_t lastIssued = 0;
+			ScrubEstimate estimate;
+			std::vector<ScrubRate> history; //!< Ring buffer
+			size_t historyNext = 0;
+		};
+
+		void update(Tracked & tracked, ScanStatus const & scan, std::time_t now) const;
+		void append(Tracked & tracked) const;
+
+	private:
+		double m_timeConstant;
+		size_t m_historyCapacity;
+		std::unordered_map<uint64_t, Tracked> m_pools;
+	};
+}
+
+#endif /* ZetaScrubTracker_hpp */
@@ -0,0 +1,236 @@
+//
+//  ZetaSnapshotIndex.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaSnapshotIndex.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace zeta
+{
+	SnapshotIndex::SnapshotIndex(std::string const & dataset) :
+		m_dataset(dataset)
+	{
+		m_datasetNode = m_names.insert(dataset, DatasetKind::filesystem);
+	}
+
+	void SnapshotIndex::append(std::string_view snapshotName, std::time_t creation, uint64_t createTXG,
+		uint64_t cloneCount, bool mounted)
+	{
+		auto at = snapshotName.find('@');
+		auto shortName = at == std::string_view::npos ? snapshotName : snapshotName.substr(at + 1);
+		Entry e;
+		e.node = m_names.insertChild(m_datasetNode, shortName, DatasetKind::snapshot);
+		e.createTXG = createTXG;
+		e.creation = creation;
+		e.stamp = creation != 0 ? snapshotStamp(creation) : parseSnapshotStamp(shortName);
+		e.cloneCount = uint32_t(std::min<uint64_t>(cloneCount, UINT32_MAX));
+		e.mounted = mounted;
+		// Usually appended in order, so this is the end
+		auto pos = std::upper_bound(m_entries.begin(), m_entries.end(), createTXG,
+			[](uint64_t txg, Entry const & entry){ return txg < entry.createTXG; });
+		m_entries.insert(pos, e);
+	}
+
+	std::string SnapshotIndex::name(size_t i) const
+	{
+		return m_names.name(m_entries[i].node);
+	}
+
+	std::string_view SnapshotIndex::shortName(size_t i) const
+	{
+		return m_names.component(m_entries[i].node);
+	}
+
+	static bool containsCaseInsensitive(std::string_view haystack, std::string_view needle)
+	{
+		auto lower = [](char c){ return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c; };
+		auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
+			[&](char a, char b){ return lower(a) == lower(b); });
+		return it != haystack.end() || needle.empty();
+	}
+
+	std::vector<uint32_t> SnapshotIndex::select(std::string_view filter) const
+	{
+		std::vector<uint32_t> selection;
+		selection.reserve(filter.empty() ? m_entries.size() : 0);
+		for (size_t i = m_entries.size(); i > 0; --i)
+		{
+			if (filter.empty() || containsCaseInsensitive(shortName(i-1), filter))
+				selection.push_back(uint32_t(i-1));
+		}
+		return selection;
+	}
+
+	static uint32_t groupDivisor(SnapshotGrouping grouping)
+	{
+		switch (grouping)
+		{
+			case SnapshotGrouping::hour: return 1;
+			case SnapshotGrouping::day: return 100;
+			case SnapshotGrouping::month: return 10000;
+			default: return 0;
+		}
+	}
+
+	std::vector<SnapshotIndex::Group> SnapshotIndex::group(std::vector<uint32_t> & selection,
+		SnapshotGrouping grouping) const
+	{
+		std::vector<Group> groups;
+		auto divisor = groupDivisor(grouping);
+		if (divisor == 0)
+		{
+			groups.push_back({0, 0, uint32_t(selection.size())});
+			return groups;
+		}
+		std::stable_partition(selection.begin(), selection.end(),
+			[&](uint32_t i){ return m_entries[i].stamp != 0; });
+		for (uint32_t i = 0; i < selection.size(); ++i)
+		{
+			auto key = m_entries[selection[i]].stamp / divisor;
+			if (groups.empty() || groups.back().key != key)
+				groups.push_back({key, i, i});
+			groups.back().end = i + 1;
+		}
+		return groups;
+	}
+
+	uint32_t snapshotStamp(std::time_t time)
+	{
+		std::tm local = {};
+		if (!localtime_r(&time, &local))
+			return 0;
+		return ((uint32_t(local.tm_year + 1900) * 100 + uint32_t(local.tm_mon + 1)) * 100 +
+			uint32_t(local.tm_mday)) * 100 + uint32_t(local.tm_hour);
+	}
+
+	static bool readDigits(std::string_view s, size_t & pos, size_t count, uint32_t & value)
+	{
+		if (pos + count > s.size())
+			return false;
+		value = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			char c = s[pos + i];
+			if (c < '0' || c > '9')
+				return false;
+			value = value * 10 + uint32_t(c - '0');
+		}
+		pos += count;
+		return true;
+	}
+
+	static bool skipSeparator(std::string_view s, size_t & pos, char const * separators)
+	{
+		if (pos < s.size() && s[pos] != 0 && std::strchr(separators, s[pos]))
+		{
+			++pos;
+			return true;
+		}
+		return false;
+	}
+
+	uint32_t parseSnapshotStamp(std::string_view name)
+	{
+		// Matches the names created by zfs-auto-snapshot, sanoid, znapzend and
+		// similar tools, such as daily-2026-10-16-1200 or 2026-10-16_12:00:00
+		for (size_t start = 0; start + 8 <= name.size(); ++start)
+		{
+			if (start > 0 && name[start-1] >= '0' && name[start-1] <= '9')
+				continue;
+			size_t pos = start;
+			uint32_t year, month, day, hour = 0;
+			if (!readDigits(name, pos, 4, year))
+				continue;
+			skipSeparator(name, pos, "-_.");
+			if (!readDigits(name, pos, 2, month))
+				continue;
+			skipSeparator(name, pos, "-_.");
+			if (!readDigits(name, pos, 2, day))
+				continue;
+			if (year < 1970 || year > 2999 || month < 1 || month > 12 || day < 1 || day > 31)
+				continue;
+			size_t hourPos = pos;
+			if (!skipSeparator(name, hourPos, "-_T ") || !readDigits(name, hourPos, 2, hour) || hour > 23)
+				hour = 0;
+			return ((year * 100 + month) * 100 + day) * 100 + hour;
+		}
+		return 0;
+	}
+
+	std::string formatSnapshotGroup(uint32_t key, SnapshotGrouping grouping)
+	{
+		char buffer[32] = {};
+		switch (grouping)
+		{
+			case SnapshotGrouping::hour:
+				snprintf(buffer, sizeof(buffer), "%04u-%02u-%02u %02u:00",
+					key / 1000000, key / 10000 % 100, key / 100 % 100, key % 100);
+				break;
+			case SnapshotGrouping::day:
+				snprintf(buffer, sizeof(buffer), "%04u-%02u-%02u",
+					key / 10000, key / 100 % 100, key % 100);
+				break;
+			case SnapshotGrouping::month:
+				snprintf(buffer, sizeof(buffer), "%04u-%02u", key / 100, key % 100);
+				break;
+			default:
+				break;
+		}
+		return buffer;
+	}
+
+	SnapshotIndexCache::SnapshotIndexCache(std::chrono::seconds maxAge) :
+		m_maxAge(maxAge)
+	{
+	}
+
+	std::shared_ptr<SnapshotIndex const> SnapshotIndexCache::find(std::string const & dataset,
+		Clock::time_point now)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(dataset);
+		if (it == m_entries.end())
+			return nullptr;
+		if (now - it->second.loadTime > m_maxAge)
+		{
+			m_entries.erase(it);
+			return nullptr;
+		}
+		return it->second.index;
+	}
+
+	void SnapshotIndexCache::insert(std::shared_ptr<SnapshotIndex const> index, Clock::time_point now)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// Datasets that are not opened again would otherwise stay forever
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (now - it->second.loadTime > m_maxAge)
+				it = m_entries.erase(it);
+			else
+				++it;
+		}
+		auto & e = m_entries[index->dataset()];
+		e.index = std::move(index);
+		e.loadTime = now;
+	}
+
+	void SnapshotIndexCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries.clear();
+	}
+
+	size_t SnapshotIndexCache::size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+}
@@ -0,0 +1,129 @@
+//
+//  ZetaSnapshotIndex.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaSnapshotIndex_hpp
+#define ZetaSnapshotIndex_hpp
+
+#include "ZetaDatasetTree.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+
+namespace zeta
+{
+	enum class SnapshotGrouping
+	{
+		none,
+		hour,
+		day,
+		month,
+	};
+
+	/*!
+	 \brief The snapshots of one dataset, ordered by createtxg
+
+	 Entries are small and fixed size, names are interned in a DatasetTree.
+	 Selections are lists of entry indices, and are grouped and paged by the
+	 menu without touching the entries they don't show.
+	 */
+	class SnapshotIndex
+	{
+	public:
+		struct Entry
+		{
+			DatasetIndex node; //!< In names()
+			uint64_t createTXG;
+			std::time_t creation; //!< 0 if unknown
+			uint32_t stamp; //!< YYYYMMDDHH of the creation, or parsed from the name, 0 if neither
+			uint32_t cloneCount;
+			bool mounted;
+		};
+
+		struct Group
+		{
+			uint32_t key; //!< Stamp truncated to the grouping, 0 for undated snapshots
+			uint32_t begin; //!< Range in the grouped selection
+			uint32_t end;
+		};
+
+	public:
+		explicit SnapshotIndex(std::string const & dataset);
+
+		//! Adds a snapshot by its full name, in any order
+		void append(std::string_view snapshotName, std::time_t creation, uint64_t createTXG,
+			uint64_t cloneCount, bool mounted);
+
+	public:
+		std::string const & dataset() const { return m_dataset; }
+		size_t size() const { return m_entries.size(); }
+		Entry const & operator[](size_t i) const { return m_entries[i]; }
+		DatasetTree const & names() const { return m_names; }
+		std::string name(size_t i) const;
+		std::string_view shortName(size_t i) const;
+
+		//! Indices of the snapshots with filter in their name, newest first
+		std::vector<uint32_t> select(std::string_view filter) const;
+		//! Groups a selection, moving undated snapshots into a last group
+		std::vector<Group> group(std::vector<uint32_t> & selection, SnapshotGrouping grouping) const;
+
+	private:
+		std::string m_dataset;
+		DatasetTree m_names;
+		DatasetIndex m_datasetNode;
+		std::vector<Entry> m_entries;
+	};
+
+	//! YYYYMMDDHH of time in the local time zone
+	uint32_t snapshotStamp(std::time_t time);
+	//! Finds a date of the form YYYY-MM-DD with an optional hour in a snapshot name
+	uint32_t parseSnapshotStamp(std::string_view name);
+	std::string formatSnapshotGroup(uint32_t key, SnapshotGrouping grouping);
+
+	/*!
+	 Keeps the snapshot indices of recently opened datasets, so that opening
+	 the menu again does not iterate the snapshots again. Entries expire
+	 after maxAge, since snapshots can be created and destroyed by others,
+	 and are removed when they are found expired or on the next insert.
+	 */
+	class SnapshotIndexCache
+	{
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+	public:
+		explicit SnapshotIndexCache(std::chrono::seconds maxAge);
+
+		std::shared_ptr<SnapshotIndex const> find(std::string const & dataset,
+			Clock::time_point now = Clock::now());
+		void insert(std::shared_ptr<SnapshotIndex const> index, Clock::time_point now = Clock::now());
+		void clear();
+
+		size_t size() const;
+
+	private:
+		struct Entry
+		{
+			std::shared_ptr<SnapshotIndex const> index;
+			Clock::time_point loadTime;
+		};
+
+	private:
+		std::chrono::seconds m_maxAge;
+		mutable std::mutex m_mutex;
+		std::unordered_map<std::string, Entry> m_entries;
+	};
+}
+
+#endif /* ZetaSnapshotIndex_hpp */
@@ -18,10 +18,13 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface ZetaSnapshotMenu : ZetaCommanderBase <NSMenuDelegate>
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs delegate:(ZetaMainMenu*)main;
+- (id)initWithFileSystemName:(NSString*)fsName delegate:(ZetaMainMenu*)main;
 
 - (void)menuNeedsUpdate:(NSMenu*)menu;
 
+//! Forgets the cached snapshot lists, call after changing snapshots
++ (void)invalidateSnapshotCache;
+
 @end
 
 NS_ASSUME_NONNULL_END
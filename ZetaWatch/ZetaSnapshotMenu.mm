@@ -10,27 +10,38 @@
 
 #import "ZetaMainMenu.h"
 
-@implementation ZetaSnapshotMenu
-{
-	zfs::ZFileSystem _fs;
-	ZetaMainMenu __weak * _delegate;
-}
+#include "ZetaPoolStateLoader.hpp"
+#include "ZetaBackgroundLoad.hpp"
+#include "ZetaSnapshotIndex.hpp"
 
-- (id)initWithFileSystem:(zfs::ZFileSystem)fs delegate:(ZetaMainMenu*)delegate
+#include <algorithm>
+
+struct SnapshotList
 {
-	if (self = [super init])
-	{
-		_fs = std::move(fs);
-		_delegate = delegate;
-	}
-	return self;
-}
+	std::shared_ptr<zeta::SnapshotIndex const> index;
+	std::string error;
+};
+
+//! Snapshots are iterated again after this long, or when ZetaWatch changed them
+static zeta::SnapshotIndexCache snapshotCache(std::chrono::seconds(60));
+static zeta::SnapshotGrouping snapshotGrouping = zeta::SnapshotGrouping::day;
+static size_t const snapshotPageSize = 50;
+static NSInteger const snapshotHeaderItems = 3;
+
+@interface ZetaSnapshotPageMenu : NSObject <NSMenuDelegate>
 
-NSMenuItem * createSnapMenu(zfs::ZFileSystem const & snap, ZetaMainMenu * delegate)
+- (id)initWithIndex:(std::shared_ptr<zeta::SnapshotIndex const>)index
+		  selection:(std::shared_ptr<std::vector<uint32_t> const>)selection
+			  begin:(size_t)begin end:(size_t)end delegate:(ZetaMainMenu*)delegate;
+
+@end
+
+NSMenuItem * createSnapMenu(zeta::SnapshotIndex const & index, size_t i, ZetaMainMenu * delegate)
 {
+	auto const & snap = index[i];
 	NSMenu * sMenu = [[NSMenu alloc] init];
 	[sMenu setAutoenablesItems:NO];
-	NSString * sName = [NSString stringWithUTF8String:snap.name()];
+	NSString * sName = [NSString stringWithUTF8String:index.name(i).c_str()];
 	auto addSnapCommand = [&](NSString * title, SEL selector)
 	{
 		auto item = [sMenu addItemWithTitle:title
@@ -42,7 +53,7 @@ NSMenuItem * createSnapMenu(zfs::ZFileSystem const & snap, ZetaMainMenu * delega
 	addSnapCommand(NSLocalizedString(@"Rollback", @"Rollback"), @selector(rollbackFilesystem:));
 	addSnapCommand(NSLocalizedString(@"Rollback (Force)", @"Rollback (Force)"), @selector(rollbackFilesystemForce:));
 	[sMenu addItem:[NSMenuItem separatorItem]];
-	if (!snap.mounted())
+	if (!snap.mounted)
 	{
 		addSnapCommand(NSLocalizedString(@"Mount", @"Mount"), @selector(mountFilesystem:));
 	}
@@ -52,7 +63,7 @@ NSMenuItem * createSnapMenu(zfs::ZFileSystem const & snap, ZetaMainMenu * delega
 		addSnapCommand(NSLocalizedString(@"Unmount (Force)", @"Unmount (Force)"), @selector(unmountFilesystemForce:));
 	}
 	[sMenu addItem:[NSMenuItem separatorItem]];
-	if (snap.cloneCount() == 0)
+	if (snap.cloneCount == 0)
 	{
 		addSnapCommand(NSLocalizedString(@"Destroy", @"Destroy"), @selector(destroy:));
 	}
@@ -66,23 +77,247 @@ NSMenuItem * createSnapMenu(zfs::ZFileSystem const & snap, ZetaMainMenu * delega
 	return item;
 }
 
+NSMenuItem * createPageItem(NSString * title,
+	std::shared_ptr<zeta::SnapshotIndex const> const & index,
+	std::shared_ptr<std::vector<uint32_t> const> const & selection,
+	size_t begin, size_t end, ZetaMainMenu * delegate)
+{
+	NSMenu * pageMenu = [[NSMenu alloc] initWithTitle:title];
+	ZetaSnapshotPageMenu * pd = [[ZetaSnapshotPageMenu alloc] initWithIndex:index
+		selection:selection begin:begin end:end delegate:delegate];
+	pageMenu.delegate = pd;
+	NSMenuItem * item = [[NSMenuItem alloc] initWithTitle:title action:nullptr keyEquivalent:@""];
+	item.submenu = pageMenu;
+	item.representedObject = pd;
+	return item;
+}
+
+//! Adds the selected snapshots in [begin, end), in pages of submenus that are filled when opened
+void fillSnapshotRange(NSMenu * menu,
+	std::shared_ptr<zeta::SnapshotIndex const> const & index,
+	std::shared_ptr<std::vector<uint32_t> const> const & selection,
+	size_t begin, size_t end, ZetaMainMenu * delegate)
+{
+	auto const & sel = *selection;
+	size_t count = end - begin;
+	if (count <= snapshotPageSize)
+	{
+		for (size_t i = begin; i < end; ++i)
+			[menu addItem:createSnapMenu(*index, sel[i], delegate)];
+		return;
+	}
+	// Nest pages so that no menu level has more than a page of items
+	size_t pageSize = snapshotPageSize;
+	while ((count + pageSize - 1) / pageSize > snapshotPageSize)
+		pageSize *= snapshotPageSize;
+	for (size_t b = begin; b < end; b += pageSize)
+	{
+		size_t e = std::min(b + pageSize, end);
+		std::string first(index->shortName(sel[b]));
+		std::string last(index->shortName(sel[e-1]));
+		NSString * title = [NSString stringWithFormat:NSLocalizedString(@"%s ... %s (%zu)", @"Snapshot Page"),
+			first.c_str(), last.c_str(), e - b];
+		[menu addItem:createPageItem(title, index, selection, b, e, delegate)];
+	}
+}
+
+@implementation ZetaSnapshotPageMenu
+{
+	std::shared_ptr<zeta::SnapshotIndex const> _index;
+	std::shared_ptr<std::vector<uint32_t> const> _selection;
+	size_t _begin;
+	size_t _end;
+	ZetaMainMenu __weak * _delegate;
+}
+
+- (id)initWithIndex:(std::shared_ptr<zeta::SnapshotIndex const>)index
+		  selection:(std::shared_ptr<std::vector<uint32_t> const>)selection
+			  begin:(size_t)begin end:(size_t)end delegate:(ZetaMainMenu*)delegate
+{
+	if (self = [super init])
+	{
+		_index = std::move(index);
+		_selection = std::move(selection);
+		_begin = begin;
+		_end = end;
+		_delegate = delegate;
+	}
+	return self;
+}
+
 - (void)menuNeedsUpdate:(NSMenu*)menu
 {
-	[menu removeAllItems];
-	auto snap = _fs.snapshots();
-	if (!snap.empty())
+	if ([menu numberOfItems] > 0)
+		return;
+	fillSnapshotRange(menu, _index, _selection, _begin, _end, _delegate);
+}
+
+@end
+
+@implementation ZetaSnapshotMenu
+{
+	NSString * _fsName;
+	ZetaMainMenu __weak * _delegate;
+	NSMenu __weak * _menu;
+	NSString * _filter;
+	SnapshotList _list;
+}
+
+- (id)initWithFileSystemName:(NSString*)fsName delegate:(ZetaMainMenu*)delegate
+{
+	if (self = [super init])
 	{
-		for (size_t i = snap.size(); i > 0; --i)
+		_fsName = fsName;
+		_delegate = delegate;
+		_filter = @"";
+	}
+	return self;
+}
+
++ (void)invalidateSnapshotCache
+{
+	snapshotCache.clear();
+}
+
+SnapshotList loadSnapshots(std::string const & fsName)
+{
+	SnapshotList list;
+	try
+	{
+		zfs::LibZFSHandle lib;
+		auto fs = lib.filesystem(fsName);
+		// The index orders by createtxg and groups by creation, not by name or iteration order
+		auto index = std::make_shared<zeta::SnapshotIndex>(fsName);
+		for (auto const & snap : fs.snapshots())
 		{
-			NSMenuItem * item = createSnapMenu(snap[i-1], _delegate);
-			[menu addItem:item];
+			auto creation = std::time_t(zfs_prop_get_int(snap.handle(), ZFS_PROP_CREATION));
+			auto createTXG = zfs_prop_get_int(snap.handle(), ZFS_PROP_CREATETXG);
+			index->append(snap.name(), creation, createTXG, snap.cloneCount(), snap.mounted());
 		}
+		zeta::countPropertyReads(4 * index->size());
+		list.index = std::move(index);
 	}
-	else
+	catch (std::exception const & e)
 	{
-		[menu addItemWithTitle:NSLocalizedString(@"No snapshots found", @"No Snapshots")
+		list.error = e.what();
+	}
+	return list;
+}
+
+- (void)addHeaderToMenu:(NSMenu*)menu
+{
+	NSView * searchView = [[NSView alloc] initWithFrame:NSMakeRect(0, 0, 260, 30)];
+	NSSearchField * search = [[NSSearchField alloc] initWithFrame:NSMakeRect(20, 4, 228, 22)];
+	search.placeholderString = NSLocalizedString(@"Filter Snapshots", @"Filter Snapshots");
+	search.stringValue = _filter;
+	search.sendsSearchStringImmediately = YES;
+	search.target = self;
+	search.action = @selector(filterChanged:);
+	[searchView addSubview:search];
+	NSMenuItem * searchItem = [[NSMenuItem alloc] initWithTitle:@"" action:nullptr keyEquivalent:@""];
+	searchItem.view = searchView;
+	[menu addItem:searchItem];
+
+	NSString * groupTitle = NSLocalizedString(@"Group By", @"Group By");
+	NSMenu * groupMenu = [[NSMenu alloc] initWithTitle:groupTitle];
+	auto addGrouping = [&](NSString * title, zeta::SnapshotGrouping grouping)
+	{
+		auto item = [groupMenu addItemWithTitle:title action:@selector(groupingChanged:) keyEquivalent:@""];
+		item.tag = NSInteger(grouping);
+		item.target = self;
+		item.state = grouping == snapshotGrouping ? NSControlStateValueOn : NSControlStateValueOff;
+	};
+	addGrouping(NSLocalizedString(@"None", @"Group None"), zeta::SnapshotGrouping::none);
+	addGrouping(NSLocalizedString(@"Hour", @"Group Hour"), zeta::SnapshotGrouping::hour);
+	addGrouping(NSLocalizedString(@"Day", @"Group Day"), zeta::SnapshotGrouping::day);
+	addGrouping(NSLocalizedString(@"Month", @"Group Month"), zeta::SnapshotGrouping::month);
+	NSMenuItem * groupItem = [[NSMenuItem alloc] initWithTitle:groupTitle action:nullptr keyEquivalent:@""];
+	groupItem.submenu = groupMenu;
+	[menu addItem:groupItem];
+
+	[menu addItem:[NSMenuItem separatorItem]];
+}
+
+- (void)fillMenu:(NSMenu*)menu
+{
+	while ([menu numberOfItems] > snapshotHeaderItems)
+		[menu removeItemAtIndex:snapshotHeaderItems];
+	if (!_list.error.empty())
+	{
+		NSString * error = [NSString stringWithFormat:@"Exception during snapshot iteration: %s", _list.error.c_str()];
+		[menu addItemWithTitle:error action:NULL keyEquivalent:@""];
+		return;
+	}
+	if (!_list.index)
+		return;
+	auto const & index = _list.index;
+	auto selection = index->select([_filter UTF8String]);
+	if (selection.empty())
+	{
+		[menu addItemWithTitle:index->size() == 0 ?
+			NSLocalizedString(@"No snapshots found", @"No Snapshots") :
+			NSLocalizedString(@"No matching snapshots", @"No Matching Snapshots")
+						action:NULL keyEquivalent:@""];
+		return;
+	}
+	auto groups = index->group(selection, snapshotGrouping);
+	auto sharedSelection = std::make_shared<std::vector<uint32_t> const>(std::move(selection));
+	ZetaMainMenu * delegate = _delegate;
+	if (sharedSelection->size() <= snapshotPageSize || groups.size() == 1)
+	{
+		fillSnapshotRange(menu, index, sharedSelection, 0, sharedSelection->size(), delegate);
+		return;
+	}
+	for (auto const & g : groups)
+	{
+		NSString * label = g.key == 0 ? NSLocalizedString(@"Undated", @"Undated Snapshots") :
+			[NSString stringWithUTF8String:zeta::formatSnapshotGroup(g.key, snapshotGrouping).c_str()];
+		NSString * title = [NSString stringWithFormat:@"%@ (%u)", label, g.end - g.begin];
+		[menu addItem:createPageItem(title, index, sharedSelection, g.begin, g.end, delegate)];
+	}
+}
+
+- (IBAction)filterChanged:(NSSearchField*)sender
+{
+	_filter = [sender stringValue];
+	if (NSMenu * menu = _menu)
+		[self fillMenu:menu];
+}
+
+- (IBAction)groupingChanged:(NSMenuItem*)sender
+{
+	snapshotGrouping = zeta::SnapshotGrouping(sender.tag);
+}
+
+- (void)menuNeedsUpdate:(NSMenu*)menu
+{
+	_menu = menu;
+	[menu removeAllItems];
+	[self addHeaderToMenu:menu];
+	std::string fsName = [_fsName UTF8String];
+	if (auto index = snapshotCache.find(fsName))
+	{
+		_list = SnapshotList{index, std::string()};
+		[self fillMenu:menu];
+		return;
+	}
+	ZetaSnapshotMenu __weak * weakSelf = self;
+	bool loaded = zeta::loadInBackground<SnapshotList>(
+		[fsName]{ return loadSnapshots(fsName); },
+		[menu, weakSelf](SnapshotList const & list){ [weakSelf applySnapshots:list toMenu:menu]; });
+	if (!loaded)
+	{
+		[menu addItemWithTitle:NSLocalizedString(@"Refreshing...", @"Refreshing")
 						action:NULL keyEquivalent:@""];
 	}
 }
 
+- (void)applySnapshots:(SnapshotList const &)list toMenu:(NSMenu*)menu
+{
+	if (list.index)
+		snapshotCache.insert(list.index);
+	_list = list;
+	[self fillMenu:menu];
+}
+
 @end
@@ -0,0 +1,22 @@
+//
+//  ZetaSnapshotRetention.h
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#import <Cocoa/Cocoa.h>
+
+#import "ZetaCommanderBase.h"
+
+/*!
+ Creates and prunes snapshots according to the policies in the user default
+ snapshotRetention. It maps dataset names to dictionaries with the number of
+ hourly, daily, weekly and monthly snapshots to keep.
+ */
+@interface ZetaSnapshotRetention : ZetaCommanderBase
+
+- (id)init;
+
+@end
@@ -0,0 +1,285 @@
+//
+//  ZetaSnapshotRetention.mm
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#import "ZetaSnapshotRetention.h"
+
+#import "ZetaSnapshotMenu.h"
+
+#include "ZetaRetention.hpp"
+#include "ZetaTimerWheel.hpp"
+
+#include "ZFSUtils.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <ctime>
+#include <string>
+#include <vector>
+
+static NSString * retentionKey = @"snapshotRetention";
+
+namespace
+{
+	struct RetentionJob
+	{
+		uint64_t id;
+		std::string dataset;
+		zeta::RetentionPolicy policy;
+	};
+
+	struct RetentionPlan
+	{
+		uint64_t id;
+		std::string dataset;
+		bool snapshot = false;
+		std::vector<std::string> prune;
+		int64_t next = 0;
+		std::string error;
+	};
+
+	//! Reads the snapshots of each dataset, and decides what to create and destroy
+	std::vector<RetentionPlan> planRetention(std::vector<RetentionJob> const & jobs,
+		int64_t now, int64_t utcOffset)
+	{
+		std::vector<RetentionPlan> plans;
+		std::unique_ptr<zfs::LibZFSHandle> zfs;
+		for (auto const & job : jobs)
+		{
+			RetentionPlan plan;
+			plan.id = job.id;
+			plan.dataset = job.dataset;
+			try
+			{
+				if (!zfs)
+					zfs = std::make_unique<zfs::LibZFSHandle>();
+				// Only snapshots created by the retention engine are considered
+				std::vector<std::pair<int64_t, std::string>> snapshots;
+				for (auto const & snap : zfs->filesystem(job.dataset).snapshots())
+				{
+					std::string name = snap.name();
+					int64_t time = 0;
+					if (zeta::parseAutoSnapshotName(std::string_view(name).substr(name.find('@') + 1), time))
+						snapshots.emplace_back(time, std::move(name));
+				}
+				plan.snapshot = snapshots.empty() ||
+					zeta::nextSnapshotTime(snapshots.back().first, true, job.policy, utcOffset) <= now;
+				// The new snapshot has no name here, it is never pruned
+				if (plan.snapshot)
+					snapshots.emplace_back(now, std::string());
+				// Creation order matches the names, unless the clock was changed
+				if (!std::is_sorted(snapshots.begin(), snapshots.end()))
+					std::sort(snapshots.begin(), snapshots.end());
+				std::vector<int64_t> times;
+				times.reserve(snapshots.size());
+				for (auto const & s : snapshots)
+					times.push_back(s.first);
+				for (auto i : zeta::planPruning(times, job.policy, utcOffset))
+				{
+					if (!snapshots[i].second.empty())
+						plan.prune.push_back(snapshots[i].second);
+				}
+				plan.next = zeta::nextSnapshotTime(times.back(), true, job.policy, utcOffset);
+			}
+			catch (std::exception const & e)
+			{
+				plan.error = e.what();
+				plan.next = now + 3600;
+				zfs.reset();
+			}
+			plans.push_back(std::move(plan));
+		}
+		return plans;
+	}
+}
+
+@interface ZetaSnapshotRetention ()
+{
+	NSTimer * _tickTimer;
+	std::unique_ptr<zeta::TimerWheel> _wheel;
+	std::vector<RetentionJob> _jobs;
+	uint64_t _generation;
+	bool _running;
+}
+
+@end
+
+@implementation ZetaSnapshotRetention
+
+- (id)init
+{
+	if (self = [super init])
+	{
+		// One tick for all datasets, each is due at most once per hour
+		_wheel = std::make_unique<zeta::TimerWheel>(60, 64, int64_t(time(nullptr)));
+		_generation = 0;
+		_running = false;
+		_tickTimer = [NSTimer timerWithTimeInterval:60
+			target:self selector:@selector(tick:) userInfo:nil repeats:YES];
+		_tickTimer.tolerance = 10;
+		[[NSRunLoop currentRunLoop] addTimer:_tickTimer forMode:NSDefaultRunLoopMode];
+		[self reloadPolicies];
+		[[NSUserDefaults standardUserDefaults] addObserver:self forKeyPath:retentionKey
+												   options:0 context:nullptr];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	[[NSUserDefaults standardUserDefaults] removeObserver:self forKeyPath:retentionKey];
+	[_tickTimer invalidate];
+	_tickTimer = nil;
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath
+					  ofObject:(id)object
+						change:(NSDictionary<NSKeyValueChangeKey, id> *)change
+					   context:(void *)context
+{
+	if ([keyPath isEqualToString:retentionKey])
+		[self reloadPolicies];
+}
+
+- (void)reloadPolicies
+{
+	++_generation;
+	_jobs.clear();
+	_wheel->clear();
+	NSDictionary * config = [[NSUserDefaults standardUserDefaults] dictionaryForKey:retentionKey];
+	for (NSString * dataset in config)
+	{
+		NSDictionary * p = config[dataset];
+		if (![p isKindOfClass:[NSDictionary class]])
+			continue;
+		zeta::RetentionPolicy policy;
+		policy.hourly = [p[@"hourly"] unsignedIntValue];
+		policy.daily = [p[@"daily"] unsignedIntValue];
+		policy.weekly = [p[@"weekly"] unsignedIntValue];
+		policy.monthly = [p[@"monthly"] unsignedIntValue];
+		if (policy.empty())
+			continue;
+		_jobs.push_back({_jobs.size(), [dataset UTF8String], policy});
+	}
+	// All datasets are checked on the next tick
+	for (auto const & job : _jobs)
+		_wheel->schedule(job.id, 0);
+}
+
+- (void)tick:(NSTimer*)timer
+{
+	// Due datasets stay in the wheel until the previous round finished
+	if (_running)
+		return;
+	int64_t now = time(nullptr);
+	std::vector<RetentionJob> jobs;
+	for (auto id : _wheel->advance(now))
+		jobs.push_back(_jobs[id]);
+	if (jobs.empty())
+		return;
+	_running = true;
+	uint64_t generation = _generation;
+	int64_t utcOffset = [[NSTimeZone localTimeZone] secondsFromGMT];
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^
+	{
+		auto plans = planRetention(jobs, now, utcOffset);
+		dispatch_async(dispatch_get_main_queue(), ^
+		{
+			[self applyPlans:plans generation:generation now:now];
+		});
+	});
+}
+
+- (void)applyPlans:(std::vector<RetentionPlan> const &)plans
+		generation:(uint64_t)generation now:(int64_t)now
+{
+	// Plans for outdated policies are dropped, the reload rescheduled everything
+	if (generation != _generation)
+	{
+		_running = false;
+		return;
+	}
+	NSString * snapName = [NSString stringWithUTF8String:zeta::autoSnapshotName(now).c_str()];
+	NSMutableArray<NSString*> * filesystems = [NSMutableArray array];
+	NSMutableDictionary<NSString*, NSArray<NSString*>*> * prune = [NSMutableDictionary dictionary];
+	for (auto const & plan : plans)
+	{
+		_wheel->schedule(plan.id, plan.next);
+		if (!plan.error.empty())
+		{
+			NSLog(@"Error reading snapshots of %s: %s", plan.dataset.c_str(), plan.error.c_str());
+			continue;
+		}
+		NSString * dataset = [NSString stringWithUTF8String:plan.dataset.c_str()];
+		if (plan.snapshot)
+			[filesystems addObject:dataset];
+		NSMutableArray<NSString*> * names = [NSMutableArray arrayWithCapacity:plan.prune.size()];
+		for (auto const & name : plan.prune)
+			[names addObject:[NSString stringWithUTF8String:name.c_str()]];
+		prune[dataset] = names;
+	}
+	if (filesystems.count == 0)
+	{
+		[self destroySnapshots:prune];
+		return;
+	}
+	// All new snapshots share their name, so they are taken in one request
+	NSDictionary * opts = @{@"filesystems": filesystems, @"snapshot": snapName};
+	[_authorization snapshotFilesystems:opts withReply:^(NSError * error, NSDictionary * failures)
+	 {
+		 [ZetaSnapshotMenu invalidateSnapshotCache];
+		 if (error)
+		 {
+			 [self notifyErrorFromHelper:error];
+			 self->_running = false;
+			 return;
+		 }
+		 // Without the new snapshot, pruning could leave too few
+		 for (NSString * dataset in filesystems)
+		 {
+			 if (failures[[NSString stringWithFormat:@"%@@%@", dataset, snapName]])
+				 [prune removeObjectForKey:dataset];
+		 }
+		 [self reportFailures:failures];
+		 [self destroySnapshots:prune];
+	 }];
+}
+
+- (void)destroySnapshots:(NSDictionary<NSString*, NSArray<NSString*>*> *)prune
+{
+	NSMutableArray<NSString*> * snapshots = [NSMutableArray array];
+	for (NSString * dataset in prune)
+		[snapshots addObjectsFromArray:prune[dataset]];
+	if (snapshots.count == 0)
+	{
+		_running = false;
+		return;
+	}
+	[_authorization destroySnapshots:@{@"snapshots": snapshots}
+						   withReply:^(NSError * error, NSDictionary * failures)
+	 {
+		 [ZetaSnapshotMenu invalidateSnapshotCache];
+		 if (error)
+			 [self notifyErrorFromHelper:error];
+		 [self reportFailures:failures];
+		 self->_running = false;
+	 }];
+}
+
+- (void)reportFailures:(NSDictionary *)failures
+{
+	if (failures.count == 0)
+		return;
+	NSMutableArray<NSString*> * messages = [NSMutableArray array];
+	for (NSString * name in failures)
+		[messages addObject:[NSString stringWithFormat:@"%@: %@", name, failures[name]]];
+	NSError * error = [NSError errorWithDomain:@"ZFSError" code:-1 userInfo:@{
+		NSLocalizedDescriptionKey: [messages componentsJoinedByString:@", "]}];
+	[self notifyErrorFromHelper:error];
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  ZetaTimerWheel.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaTimerWheel.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	TimerWheel::TimerWheel(int64_t resolution, size_t slotCount, int64_t now) :
+		m_resolution(std::max<int64_t>(resolution, 1)), m_slots(std::max<size_t>(slotCount, 1))
+	{
+		m_tick = tickOf(now);
+	}
+
+	int64_t TimerWheel::tickOf(int64_t time) const
+	{
+		return time / m_resolution - (time % m_resolution < 0 ? 1 : 0);
+	}
+
+	int64_t TimerWheel::tickAtOrAfter(int64_t time) const
+	{
+		return tickOf(time) + (time % m_resolution != 0 ? 1 : 0);
+	}
+
+	void TimerWheel::schedule(uint64_t id, int64_t deadline)
+	{
+		int64_t tick = std::max(tickAtOrAfter(deadline), m_tick + 1);
+		m_deadlines[id] = tick;
+		m_slots[size_t(tick % int64_t(m_slots.size()))].push_back({id, tick});
+	}
+
+	void TimerWheel::cancel(uint64_t id)
+	{
+		m_deadlines.erase(id);
+	}
+
+	void TimerWheel::clear()
+	{
+		m_deadlines.clear();
+		for (auto & slot : m_slots)
+			slot.clear();
+	}
+
+	std::vector<uint64_t> TimerWheel::advance(int64_t now)
+	{
+		std::vector<uint64_t> expired;
+		int64_t target = tickOf(now);
+		if (target <= m_tick)
+			return expired;
+		// After a long pause, every slot is visited once
+		int64_t steps = std::min(target - m_tick, int64_t(m_slots.size()));
+		for (int64_t t = m_tick + 1; t <= m_tick + steps; ++t)
+		{
+			auto & slot = m_slots[size_t(t % int64_t(m_slots.size()))];
+			auto keep = std::remove_if(slot.begin(), slot.end(), [&](Timer const & timer)
+			{
+				auto it = m_deadlines.find(timer.id);
+				if (it == m_deadlines.end() || it->second != timer.tick)
+					return true; // cancelled or rescheduled
+				if (timer.tick > target)
+					return false; // a later round
+				expired.push_back(timer.id);
+				m_deadlines.erase(it);
+				return true;
+			});
+			slot.erase(keep, slot.end());
+		}
+		m_tick = target;
+		return expired;
+	}
+}
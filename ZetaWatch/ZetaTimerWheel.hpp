@@ -0,0 +1,65 @@
+//
+//  ZetaTimerWheel.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaTimerWheel_hpp
+#define ZetaTimerWheel_hpp
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+namespace zeta
+{
+	/*!
+	 \brief Many timers driven by a single periodic tick
+
+	 Timers are kept in slots by their deadline, modulo the number of slots,
+	 so scheduling is constant time and a tick only looks at the slots it
+	 passes. Deadlines are rounded up to the resolution, so timers expire in
+	 the first advance at or after their deadline, never before. Rescheduling or
+	 cancelling leaves the old entry in its slot, where it is dropped when
+	 the slot is visited.
+	 */
+	class TimerWheel
+	{
+	public:
+		TimerWheel(int64_t resolution, size_t slotCount, int64_t now);
+
+		//! Schedules or reschedules the timer, deadlines in the past expire on the next advance
+		void schedule(uint64_t id, int64_t deadline);
+		void cancel(uint64_t id);
+		void clear();
+
+		//! Moves time forward, and returns the timers that expired
+		std::vector<uint64_t> advance(int64_t now);
+
+		size_t size() const { return m_deadlines.size(); }
+		bool scheduled(uint64_t id) const { return m_deadlines.count(id) > 0; }
+
+	private:
+		struct Timer
+		{
+			uint64_t id;
+			int64_t tick;
+		};
+
+		//! The tick containing time, rounded down
+		int64_t tickOf(int64_t time) const;
+		//! The first tick at or after time
+		int64_t tickAtOrAfter(int64_t time) const;
+
+	private:
+		int64_t m_resolution;
+		int64_t m_tick; //!< The last tick that was processed
+		std::vector<std::vector<Timer>> m_slots;
+		std::unordered_map<uint64_t, int64_t> m_deadlines; //!< Current tick of each timer
+	};
+}
+
+#endif /* ZetaTimerWheel_hpp */
@@ -0,0 +1,156 @@
+//
+//  ZetaVDevDecoder.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaVDevDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+namespace zeta
+{
+	VDevFields decodeVDev(nvlist_t * vdev)
+	{
+		VDevFields f;
+		for (nvpair_t * pair = nvlist_next_nvpair(vdev, nullptr); pair;
+			 pair = nvlist_next_nvpair(vdev, pair))
+		{
+			char const * name = nvpair_name(pair);
+			switch (nvpair_type(pair))
+			{
+				case DATA_TYPE_UINT64:
+					if (std::strcmp(name, ZPOOL_CONFIG_GUID) == 0)
+						nvpair_value_uint64(pair, &f.guid);
+					break;
+				case DATA_TYPE_STRING:
+				{
+					char const ** field = nullptr;
+					if (std::strcmp(name, ZPOOL_CONFIG_TYPE) == 0)
+						field = &f.type;
+					else if (std::strcmp(name, ZPOOL_CONFIG_PATH) == 0)
+						field = &f.path;
+					char * value = nullptr;
+					if (field && nvpair_value_string(pair, &value) == 0)
+						*field = value;
+					break;
+				}
+				case DATA_TYPE_UINT64_ARRAY:
+					if (std::strcmp(name, ZPOOL_CONFIG_VDEV_STATS) == 0)
+					{
+						uint64_t * stat = nullptr;
+						if (nvpair_value_uint64_array(pair, &stat, &f.statCount) == 0)
+							f.stat = reinterpret_cast<vdev_stat_t const *>(stat);
+					}
+					break;
+				case DATA_TYPE_NVLIST:
+					if (std::strcmp(name, ZPOOL_CONFIG_VDEV_STATS_EX) == 0)
+						nvpair_value_nvlist(pair, &f.statsEx);
+					break;
+				case DATA_TYPE_NVLIST_ARRAY:
+					if (std::strcmp(name, ZPOOL_CONFIG_CHILDREN) == 0)
+						nvpair_value_nvlist_array(pair, &f.children, &f.childCount);
+					break;
+				default:
+					break;
+			}
+		}
+		return f;
+	}
+
+	namespace
+	{
+		//! Whether the stats reach to the end of the field at offset with size
+		bool hasStat(VDevFields const & f, size_t offset, size_t size)
+		{
+			return f.stat && f.statCount * sizeof(uint64_t) >= offset + size;
+		}
+
+		//! Stops after both disk histograms, the other queues and histograms follow them
+		void addLatencyHistograms(nvlist_t * statsEx, LatencyHistogram & histogram)
+		{
+			int found = 0;
+			for (nvpair_t * pair = nvlist_next_nvpair(statsEx, nullptr); pair && found < 2;
+				 pair = nvlist_next_nvpair(statsEx, pair))
+			{
+				char const * name = nvpair_name(pair);
+				if (nvpair_type(pair) != DATA_TYPE_UINT64_ARRAY ||
+					(std::strcmp(name, ZPOOL_CONFIG_VDEV_DISK_R_LAT_HISTO) != 0 &&
+					 std::strcmp(name, ZPOOL_CONFIG_VDEV_DISK_W_LAT_HISTO) != 0))
+					continue;
+				uint64_t * buckets = nullptr;
+				uint_t count = 0;
+				if (nvpair_value_uint64_array(pair, &buckets, &count) != 0)
+					continue;
+				++found;
+				for (size_t i = 0; i < std::min<size_t>(count, latencyBucketCount); ++i)
+					histogram.counts[i] += buckets[i];
+			}
+		}
+	}
+
+	void appendVDevIOSamples(nvlist_t * vdev, std::vector<VDevIOSample> & samples)
+	{
+		auto f = decodeVDev(vdev);
+		VDevIOSample s;
+		s.guid = f.guid;
+		if (hasStat(f, offsetof(vdev_stat_t, vs_bytes), sizeof(f.stat->vs_bytes)))
+		{
+			s.counters.readOps = f.stat->vs_ops[ZIO_TYPE_READ];
+			s.counters.writeOps = f.stat->vs_ops[ZIO_TYPE_WRITE];
+			s.counters.readBytes = f.stat->vs_bytes[ZIO_TYPE_READ];
+			s.counters.writeBytes = f.stat->vs_bytes[ZIO_TYPE_WRITE];
+		}
+		if (f.statsEx)
+			addLatencyHistograms(f.statsEx, s.latency);
+		samples.push_back(s);
+		for (uint_t c = 0; c < f.childCount; ++c)
+			appendVDevIOSamples(f.children[c], samples);
+	}
+
+	VDevStatus decodeVDevStatus(VDevFields const & f)
+	{
+		VDevStatus s;
+		if (hasStat(f, offsetof(vdev_stat_t, vs_space), sizeof(f.stat->vs_space)))
+		{
+			s.state = f.stat->vs_state;
+			s.aux = f.stat->vs_aux;
+			s.alloc = f.stat->vs_alloc;
+			s.space = f.stat->vs_space;
+		}
+		if (hasStat(f, offsetof(vdev_stat_t, vs_checksum_errors), sizeof(f.stat->vs_checksum_errors)))
+		{
+			s.errorRead = f.stat->vs_read_errors;
+			s.errorWrite = f.stat->vs_write_errors;
+			s.errorChecksum = f.stat->vs_checksum_errors;
+		}
+		if (hasStat(f, offsetof(vdev_stat_t, vs_fragmentation), sizeof(f.stat->vs_fragmentation)))
+			s.fragmentation = f.stat->vs_fragmentation;
+		return s;
+	}
+
+	namespace
+	{
+		void appendLeafPaths(nvlist_t * vdev, std::vector<std::string> & devices)
+		{
+			auto f = decodeVDev(vdev);
+			if (f.childCount == 0 && f.path)
+				devices.emplace_back(f.path);
+			for (uint_t c = 0; c < f.childCount; ++c)
+				appendLeafPaths(f.children[c], devices);
+		}
+	}
+
+	std::vector<std::string> poolConfigDevices(nvlist_t * config)
+	{
+		std::vector<std::string> devices;
+		nvlist_t * tree = nullptr;
+		if (config && nvlist_lookup_nvlist(config, ZPOOL_CONFIG_VDEV_TREE, &tree) == 0)
+			appendLeafPaths(tree, devices);
+		return devices;
+	}
+}
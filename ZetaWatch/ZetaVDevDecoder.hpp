@@ -0,0 +1,58 @@
+//
+//  ZetaVDevDecoder.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaVDevDecoder_hpp
+#define ZetaVDevDecoder_hpp
+
+#include "ZetaPoolState.hpp"
+#include "ZetaVDevIOSampler.hpp"
+
+#include "ZFSUtils.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace zeta
+{
+	/*!
+	 \brief The parts of a vdev config that ZetaWatch reads
+
+	 Filled by a single pass over the pairs of the nvlist, instead of a lookup
+	 by name for each field. Pointers refer into the nvlist, and are valid as
+	 long as it is. Missing fields are null or zero.
+	 */
+	struct VDevFields
+	{
+		uint64_t guid = 0;
+		char const * type = nullptr;
+		char const * path = nullptr; //!< Only for leaves
+		vdev_stat_t const * stat = nullptr;
+		uint_t statCount = 0; //!< In uint64_t, older kernels report fewer fields
+		nvlist_t * statsEx = nullptr;
+		nvlist_t ** children = nullptr;
+		uint_t childCount = 0;
+	};
+
+	VDevFields decodeVDev(nvlist_t * vdev);
+
+	//! The state and error counters, fields the kernel doesn't report are zero
+	VDevStatus decodeVDevStatus(VDevFields const & fields);
+
+	/*!
+	 Appends the I/O counters and latency histograms of the vdev and all its
+	 descendants in depth first order. Children are visited through the
+	 arrays in the nvlist, nothing is copied out except the sample values.
+	 */
+	void appendVDevIOSamples(nvlist_t * vdev, std::vector<VDevIOSample> & samples);
+
+	//! The paths of the leaf vdevs in the vdev tree of a pool config
+	std::vector<std::string> poolConfigDevices(nvlist_t * config);
+}
+
+#endif /* ZetaVDevDecoder_hpp */
@@ -0,0 +1,165 @@
+//
+//  ZetaVDevIOSampler.cpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#include "ZetaVDevIOSampler.hpp"
+
+#include <algorithm>
+
+namespace zeta
+{
+	VDevIOHistory::VDevIOHistory(size_t capacity) :
+		m_capacity(std::max<size_t>(capacity, 2)), m_times(m_capacity)
+	{
+	}
+
+	void VDevIOHistory::remap(std::vector<VDevIOSample> const & samples)
+	{
+		std::vector<uint64_t> guids;
+		std::vector<uint64_t> firstSample;
+		std::vector<VDevIOCounters> counters(samples.size() * m_capacity);
+		std::vector<LatencyHistogram> latency(samples.size() * m_capacity);
+		guids.reserve(samples.size());
+		firstSample.reserve(samples.size());
+		size_t old = 0;
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			auto guid = samples[i].guid;
+			while (old < m_guids.size() && m_guids[old] < guid)
+				++old;
+			guids.push_back(guid);
+			if (old < m_guids.size() && m_guids[old] == guid)
+			{
+				firstSample.push_back(m_firstSample[old]);
+				std::copy_n(m_counters.begin() + old * m_capacity, m_capacity,
+					counters.begin() + i * m_capacity);
+				std::copy_n(m_latency.begin() + old * m_capacity, m_capacity,
+					latency.begin() + i * m_capacity);
+			}
+			else
+			{
+				firstSample.push_back(m_recorded);
+			}
+		}
+		m_guids = std::move(guids);
+		m_firstSample = std::move(firstSample);
+		m_counters = std::move(counters);
+		m_latency = std::move(latency);
+	}
+
+	void VDevIOHistory::record(Clock::time_point time, std::vector<VDevIOSample> const & samples)
+	{
+		bool sameVDevs = samples.size() == m_guids.size() && std::equal(
+			samples.begin(), samples.end(), m_guids.begin(),
+			[](VDevIOSample const & s, uint64_t guid) { return s.guid == guid; });
+		if (!sameVDevs)
+			remap(samples);
+		size_t slot = m_recorded % m_capacity;
+		m_times[slot] = time;
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			m_counters[i * m_capacity + slot] = samples[i].counters;
+			m_latency[i * m_capacity + slot] = samples[i].latency;
+		}
+		++m_recorded;
+	}
+
+	static uint64_t increase(uint64_t older, uint64_t newer)
+	{
+		// Counters restart from zero when a pool is imported again
+		return newer >= older ? newer - older : 0;
+	}
+
+	VDevIORates VDevIOHistory::rates(uint64_t guid, Clock::duration window) const
+	{
+		VDevIORates rates;
+		auto it = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+		if (it == m_guids.end() || *it != guid || m_recorded < 2)
+			return rates;
+		size_t row = it - m_guids.begin();
+		uint64_t newest = m_recorded - 1;
+		uint64_t oldest = std::max<uint64_t>(m_firstSample[row],
+			m_recorded > m_capacity ? m_recorded - m_capacity : 0);
+		auto newestTime = m_times[newest % m_capacity];
+		uint64_t first = newest;
+		while (first > oldest && newestTime - m_times[(first - 1) % m_capacity] <= window)
+			--first;
+		if (first == newest)
+			return rates;
+		auto seconds = std::chrono::duration<double>(newestTime - m_times[first % m_capacity]).count();
+		auto const & a = m_counters[row * m_capacity + first % m_capacity];
+		auto const & b = m_counters[row * m_capacity + newest % m_capacity];
+		rates.increase.readOps = increase(a.readOps, b.readOps);
+		rates.increase.writeOps = increase(a.writeOps, b.writeOps);
+		rates.increase.readBytes = increase(a.readBytes, b.readBytes);
+		rates.increase.writeBytes = increase(a.writeBytes, b.writeBytes);
+		rates.latency = zeta::increase(m_latency[row * m_capacity + first % m_capacity],
+			m_latency[row * m_capacity + newest % m_capacity]);
+		rates.window = std::chrono::seconds(int64_t(seconds + 0.5));
+		return rates;
+	}
+
+	VDevIOSampler::VDevIOSampler(Loader loader, std::chrono::milliseconds interval, size_t capacity) :
+		m_loader(std::move(loader)), m_history(capacity), m_interval(interval)
+	{
+		m_worker = std::thread([this]{ run(); });
+	}
+
+	VDevIOSampler::~VDevIOSampler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		m_worker.join();
+	}
+
+	void VDevIOSampler::setInterval(std::chrono::milliseconds interval)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_interval = interval;
+		}
+		m_condition.notify_all();
+	}
+
+	VDevIORates VDevIOSampler::rates(uint64_t guid, std::chrono::seconds window) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_history.rates(guid, window);
+	}
+
+	void VDevIOSampler::run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto next = VDevIOHistory::Clock::now();
+		while (true)
+		{
+			if (m_interval.count() <= 0)
+			{
+				m_condition.wait(lock, [&]{ return m_stop || m_interval.count() > 0; });
+				next = VDevIOHistory::Clock::now();
+			}
+			if (m_stop)
+				return;
+			if (m_condition.wait_until(lock, next, [&]{ return m_stop; }))
+				return;
+			if (m_interval.count() <= 0)
+				continue;
+			lock.unlock();
+			auto samples = m_loader();
+			std::sort(samples.begin(), samples.end(),
+				[](VDevIOSample const & a, VDevIOSample const & b) { return a.guid < b.guid; });
+			auto now = VDevIOHistory::Clock::now();
+			lock.lock();
+			m_history.record(now, samples);
+			// Fixed rate, but without catching up on missed samples
+			next = std::max(next + m_interval, now);
+		}
+	}
+}
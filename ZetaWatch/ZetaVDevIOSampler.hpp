@@ -0,0 +1,115 @@
+//
+//  ZetaVDevIOSampler.hpp
+//  ZetaWatch
+//
+//  Created by cbreak on 26.10.16.
+//  Copyright © 2026 the-color-black.net. All rights reserved.
+//
+
+#ifndef ZetaVDevIOSampler_hpp
+#define ZetaVDevIOSampler_hpp
+
+#include "ZetaLatencyHistogram.hpp"
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+namespace zeta
+{
+	//! Cumulative I/O counters of a vdev, from vdev_stat_t
+	struct VDevIOCounters
+	{
+		uint64_t readOps = 0;
+		uint64_t writeOps = 0;
+		uint64_t readBytes = 0;
+		uint64_t writeBytes = 0;
+	};
+
+	struct VDevIOSample
+	{
+		uint64_t guid = 0;
+		VDevIOCounters counters;
+		LatencyHistogram latency; //!< Disk latency of reads and writes combined
+	};
+
+	//! Increase of the counters over window, for formatRate
+	struct VDevIORates
+	{
+		VDevIOCounters increase;
+		LatencyHistogram latency;
+		std::chrono::seconds window{0}; //!< Zero if there were not enough samples
+	};
+
+	/*!
+	 \brief Fixed size history of the I/O counters of all vdevs
+
+	 All vdevs are sampled together, so the sample times are a single ring
+	 buffer, and the counters one ring buffer per vdev, stored row by row in a
+	 single array. Memory is bounded by capacity times the number of vdevs.
+	 Vdevs that are missing from a sample are dropped.
+	 */
+	class VDevIOHistory
+	{
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+	public:
+		explicit VDevIOHistory(size_t capacity);
+
+		//! Adds a sample of all vdevs, which must be sorted by guid
+		void record(Clock::time_point time, std::vector<VDevIOSample> const & samples);
+		//! Rates over the most recent samples covering at most window
+		VDevIORates rates(uint64_t guid, Clock::duration window) const;
+
+	private:
+		void remap(std::vector<VDevIOSample> const & samples);
+
+	private:
+		size_t m_capacity;
+		uint64_t m_recorded = 0;
+		std::vector<Clock::time_point> m_times;
+		std::vector<uint64_t> m_guids;
+		std::vector<uint64_t> m_firstSample; //!< Per vdev, the first sample containing it
+		std::vector<VDevIOCounters> m_counters;
+		std::vector<LatencyHistogram> m_latency;
+	};
+
+	/*!
+	 Samples vdev I/O counters on a worker thread at a fixed interval. The
+	 loader only has to read the vdev statistics, not the rest of the pool
+	 state, so that sampling every second stays cheap.
+	 */
+	class VDevIOSampler
+	{
+	public:
+		typedef std::function<std::vector<VDevIOSample>()> Loader;
+
+	public:
+		//! An interval of zero pauses sampling
+		VDevIOSampler(Loader loader, std::chrono::milliseconds interval, size_t capacity);
+		~VDevIOSampler();
+
+	public:
+		void setInterval(std::chrono::milliseconds interval);
+		VDevIORates rates(uint64_t guid, std::chrono::seconds window) const;
+
+	private:
+		void run();
+
+	private:
+		Loader m_loader;
+		VDevIOHistory m_history;
+		std::chrono::milliseconds m_interval;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stop = false;
+		std::thread m_worker;
+	};
+}
+
+#endif /* ZetaVDevIOSampler_hpp */
@@ -85,6 +85,10 @@
 		@"useKeychain": @NO,
 		@"startAtLogin": @YES,
 		@"keepAwakeDuringScrub": @YES,
+		@"vdevStatisticsInterval": @5,
+		@"metricsRetentionDays": @90,
+		@"capacityWarningDays": @30,
+		@"snapshotRetention": @{},
 		@"defaultAltroot": @"/Volumes",
 		@"useAltroot": @NO,
 		@"searchPathOverride": @[